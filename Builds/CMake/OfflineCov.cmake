@@ -38,18 +38,18 @@ if (coverage)
         USES_TERMINAL
         COMMAND ${CMAKE_COMMAND} -E echo "Generating coverage - results will be in ${CMAKE_BINARY_DIR}/coverage/index.html."
         COMMAND ${CMAKE_COMMAND} -E echo "Running ripple-offline-tool tests."
-        COMMAND ripple-offline-tool --unittest$<$<BOOL:${coverage_test}>:=${coverage_test}>
+        COMMAND ripple-offline-tool-tests $<$<BOOL:${coverage_test}>:${coverage_test}>
         COMMAND ${LLVM_PROFDATA}
           merge -sparse default.profraw -o rip.profdata
         COMMAND ${CMAKE_COMMAND} -E echo "Summary of coverage:"
         COMMAND ${LLVM_COV}
           report -instr-profile=rip.profdata
-          $<TARGET_FILE:ripple-offline-tool> ${extract_pattern}
+          $<TARGET_FILE:ripple-offline-tool-tests> ${extract_pattern}
         # generate html report
         COMMAND ${LLVM_COV}
           show -format=html -output-dir=${CMAKE_BINARY_DIR}/coverage
           -instr-profile=rip.profdata
-          $<TARGET_FILE:ripple-offline-tool> ${extract_pattern}
+          $<TARGET_FILE:ripple-offline-tool-tests> ${extract_pattern}
         BYPRODUCTS coverage/index.html)
     endif ()
   elseif (is_gcc)
@@ -78,7 +78,7 @@ if (coverage)
           | grep -v "ignoring data for external file"
         # run tests
         COMMAND ${CMAKE_COMMAND} -E echo "Running ripple-offline-tool tests for coverage report."
-        COMMAND ripple-offline-tool --unittest$<$<BOOL:${coverage_test}>:=${coverage_test}>
+        COMMAND ripple-offline-tool-tests $<$<BOOL:${coverage_test}>:${coverage_test}>
         # Create test coverage data file
         COMMAND ${LCOV}
           --no-external -d "${CMAKE_CURRENT_SOURCE_DIR}" -c -d . -o tests.info
@@ -114,13 +114,13 @@ if [[ ${TARGET} == "docs" ]]; then
 fi
 popd
 
-export APP_PATH="$PWD/build/${BUILD_DIR}/ripple-offline-tool"
+export APP_PATH="$PWD/build/${BUILD_DIR}/ripple-offline-tool-tests"
 echo "using APP_PATH: ${APP_PATH}"
 
 # See what we've actually built
 ldd ${APP_PATH}
 
-: ${APP_ARGS:="--unittest"}
+: ${APP_ARGS:=""}
 
 if [[ ${coverage} == true && $CC =~ ^gcc ]]; then
     # Push the results (lcov.info) to codecov
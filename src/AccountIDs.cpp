@@ -0,0 +1,338 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <AccountIDs.h>
+
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OFFLINE_HASH_SIMD 1
+#endif
+
+namespace offline {
+
+namespace {
+
+#ifdef OFFLINE_HASH_SIMD
+
+#define OFFLINE_AVX2 __attribute__((target("avx2")))
+#define OFFLINE_AVX512 __attribute__((target("avx512f")))
+// Lets the generic lane code take on the target of its caller
+#define OFFLINE_INLINE inline __attribute__((always_inline))
+
+// The lane helpers pass vectors by value, but are always inlined into
+// a caller built for them, so no call ever uses the changed ABI
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// A 32 bit word of every lane
+using Words8 = std::uint32_t __attribute__((vector_size(32)));
+using Words16 = std::uint32_t __attribute__((vector_size(64)));
+
+std::array<std::uint32_t, 8> constexpr sha256Initial = {
+    0x6a09e667,
+    0xbb67ae85,
+    0x3c6ef372,
+    0xa54ff53a,
+    0x510e527f,
+    0x9b05688c,
+    0x1f83d9ab,
+    0x5be0cd19};
+
+std::array<std::uint32_t, 64> constexpr sha256Constants = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+std::array<std::uint32_t, 5> constexpr ripemdInitial = {
+    0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+// RIPEMD-160 runs two lines of 80 steps side by side. Each line has a
+// constant per round of 16 steps, and each step picks a message word
+// and a rotation.
+std::array<std::uint32_t, 5> constexpr leftConstants = {
+    0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e};
+std::array<std::uint32_t, 5> constexpr rightConstants = {
+    0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000};
+
+std::array<std::uint8_t, 80> constexpr leftWords = {
+    0, 1, 2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+    7, 4, 13, 1,  10, 6,  15, 3,  12, 0,  9,  5,  2,  14, 11, 8,
+    3, 10, 14, 4, 9,  15, 8,  1,  2,  7,  0,  6,  13, 11, 5,  12,
+    1, 9, 11, 10, 0,  8,  12, 4,  13, 3,  7,  15, 14, 5,  6,  2,
+    4, 0, 5,  9,  7,  12, 2,  10, 14, 1,  3,  8,  11, 6,  15, 13};
+std::array<std::uint8_t, 80> constexpr rightWords = {
+    5,  14, 7,  0, 9, 2,  11, 4,  13, 6,  15, 8,  1,  10, 3,  12,
+    6,  11, 3,  7, 0, 13, 5,  10, 14, 15, 8,  12, 4,  9,  1,  2,
+    15, 5,  1,  3, 7, 14, 6,  9,  11, 8,  12, 2,  10, 0,  4,  13,
+    8,  6,  4,  1, 3, 11, 15, 0,  5,  12, 2,  13, 9,  7,  10, 14,
+    12, 15, 10, 4, 1, 5,  8,  7,  6,  2,  13, 14, 0,  3,  9,  11};
+std::array<std::uint8_t, 80> constexpr leftRotations = {
+    11, 14, 15, 12, 5,  8,  7,  9,  11, 13, 14, 15, 6,  7,  9,  8,
+    7,  6,  8,  13, 11, 9,  7,  15, 7,  12, 15, 9,  11, 7,  13, 12,
+    11, 13, 6,  7,  14, 9,  13, 15, 14, 8,  13, 6,  5,  12, 7,  5,
+    11, 12, 14, 15, 14, 15, 9,  8,  9,  14, 5,  6,  8,  6,  5,  12,
+    9,  15, 5,  11, 6,  8,  13, 12, 5,  12, 13, 14, 11, 8,  5,  6};
+std::array<std::uint8_t, 80> constexpr rightRotations = {
+    8,  9,  9,  11, 13, 15, 15, 5,  7,  7,  8,  11, 14, 14, 12, 6,
+    9,  13, 15, 7,  12, 8,  9,  11, 7,  7,  12, 7,  6,  15, 13, 11,
+    9,  7,  15, 11, 8,  6,  6,  14, 12, 13, 5,  14, 13, 13, 7,  5,
+    15, 5,  8,  11, 14, 14, 6,  14, 6,  9,  12, 9,  12, 5,  15, 8,
+    8,  5,  12, 9,  12, 5,  14, 6,  8,  13, 6,  5,  15, 13, 11, 11};
+
+template <class V>
+OFFLINE_INLINE V
+rotr(V x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+template <class V>
+OFFLINE_INLINE V
+rotl(V x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+template <class V>
+OFFLINE_INLINE V
+byteSwap(V x)
+{
+    return (x << 24) | ((x & 0xff00) << 8) | ((x >> 8) & 0xff00) | (x >> 24);
+}
+
+// The RIPEMD-160 boolean function of `round`
+template <class V>
+OFFLINE_INLINE V
+ripemdFunction(int round, V x, V y, V z)
+{
+    switch (round)
+    {
+        case 0:
+            return x ^ y ^ z;
+        case 1:
+            return (x & y) | (~x & z);
+        case 2:
+            return (x | ~y) ^ z;
+        case 3:
+            return (x & z) | (y & ~z);
+        default:
+            return x ^ (y | ~z);
+    }
+}
+
+/** Account IDs of a block of keys in each lane of `V`.
+
+    `words[i]` holds big endian word `i` of every lane's padded
+    SHA-256 block, and `ids[i]` gets word `i` of every lane's
+    RIPEMD-160 digest.
+*/
+template <class V, std::size_t Lanes = sizeof(V) / sizeof(std::uint32_t)>
+OFFLINE_INLINE void
+accountIDLanes(
+    std::uint32_t const (&words)[16][Lanes],
+    std::uint32_t (&ids)[5][Lanes])
+{
+    V w[16];
+    for (int i = 0; i < 16; ++i)
+        std::memcpy(&w[i], words[i], sizeof(V));
+
+    // SHA-256, from the initial state
+    V s[8];
+    for (int i = 0; i < 8; ++i)
+        s[i] = V{} + sha256Initial[i];
+    auto a = s[0], b = s[1], c = s[2], d = s[3];
+    auto e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 64; ++t)
+    {
+        // The message schedule, kept as a ring of 16 words
+        if (t >= 16)
+        {
+            auto const w15 = w[(t - 15) & 15];
+            auto const w2 = w[(t - 2) & 15];
+            w[t & 15] += (rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3)) +
+                w[(t - 7) & 15] +
+                (rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10));
+        }
+        auto const t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+            ((e & f) ^ (~e & g)) + sha256Constants[t] + w[t & 15];
+        auto const t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) +
+            ((a & b) | (c & (a | b)));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    V const digest[8] = {a, b, c, d, e, f, g, h};
+
+    // RIPEMD-160 of the 32 byte digest, read as little endian words
+    V x[16] = {};
+    for (int i = 0; i < 8; ++i)
+        x[i] = byteSwap(s[i] + digest[i]);
+    x[8] = V{} + 0x80;
+    x[14] = V{} + 32 * 8;
+
+    V left[5], right[5];
+    for (int i = 0; i < 5; ++i)
+        left[i] = right[i] = V{} + ripemdInitial[i];
+    for (int j = 0; j < 80; ++j)
+    {
+        auto const round = j / 16;
+        auto t = rotl(
+                     left[0] +
+                         ripemdFunction(round, left[1], left[2], left[3]) +
+                         x[leftWords[j]] + leftConstants[round],
+                     leftRotations[j]) +
+            left[4];
+        left[0] = left[4];
+        left[4] = left[3];
+        left[3] = rotl(left[2], 10);
+        left[2] = left[1];
+        left[1] = t;
+
+        t = rotl(right[0] +
+                     ripemdFunction(4 - round, right[1], right[2], right[3]) +
+                     x[rightWords[j]] + rightConstants[round],
+                 rightRotations[j]) +
+            right[4];
+        right[0] = right[4];
+        right[4] = right[3];
+        right[3] = rotl(right[2], 10);
+        right[2] = right[1];
+        right[1] = t;
+    }
+    V const result[5] = {
+        ripemdInitial[1] + left[2] + right[3],
+        ripemdInitial[2] + left[3] + right[4],
+        ripemdInitial[3] + left[4] + right[0],
+        ripemdInitial[4] + left[0] + right[1],
+        ripemdInitial[0] + left[1] + right[2]};
+    for (int i = 0; i < 5; ++i)
+        std::memcpy(ids[i], &result[i], sizeof(V));
+}
+
+OFFLINE_AVX2 void
+accountIDs8(std::uint32_t const (&words)[16][8], std::uint32_t (&ids)[5][8])
+{
+    accountIDLanes<Words8>(words, ids);
+}
+
+OFFLINE_AVX512 void
+accountIDs16(
+    std::uint32_t const (&words)[16][16],
+    std::uint32_t (&ids)[5][16])
+{
+    accountIDLanes<Words16>(words, ids);
+}
+
+/** Hash the keys `Lanes` at a time with `kernel`.
+
+    Lanes left over in the last group hash the first key again, and
+    their results are ignored.
+*/
+template <std::size_t Lanes, class Kernel>
+void
+hashKeys(
+    ripple::PublicKey const* keys,
+    std::size_t count,
+    ripple::AccountID* out,
+    Kernel kernel)
+{
+    alignas(64) std::uint32_t words[16][Lanes];
+    alignas(64) std::uint32_t ids[5][Lanes];
+    for (std::size_t begin = 0; begin < count; begin += Lanes)
+    {
+        auto const size = std::min(count - begin, Lanes);
+        for (std::size_t l = 0; l < Lanes; ++l)
+        {
+            auto const key = keys[begin + (l < size ? l : 0)].slice();
+            // A public key is 33 bytes, so the padding and length fit
+            // in the same block
+            std::uint8_t block[64] = {};
+            std::memcpy(block, key.data(), key.size());
+            block[key.size()] = 0x80;
+            boost::endian::store_big_u64(block + 56, key.size() * 8);
+            for (int i = 0; i < 16; ++i)
+                words[i][l] = boost::endian::load_big_u32(block + 4 * i);
+        }
+        kernel(words, ids);
+        for (std::size_t l = 0; l < size; ++l)
+        {
+            auto p = out[begin + l].data();
+            for (int i = 0; i < 5; ++i, p += 4)
+                boost::endian::store_little_u32(p, ids[i][l]);
+        }
+    }
+}
+
+#endif
+
+}  // namespace
+
+void
+calcAccountIDs(
+    ripple::PublicKey const* keys,
+    std::size_t count,
+    ripple::AccountID* out,
+    HashKernel kernel)
+{
+    if (!supported(kernel))
+        throw std::logic_error(
+            std::string("Unsupported hash kernel: ") + to_string(kernel));
+    // A lone key gains nothing from the lanes
+    if (count > 1)
+    {
+        switch (kernel)
+        {
+#ifdef OFFLINE_HASH_SIMD
+            case HashKernel::avx2:
+                return hashKeys<8>(keys, count, out, accountIDs8);
+            case HashKernel::avx512:
+                return hashKeys<16>(keys, count, out, accountIDs16);
+#endif
+            default:
+                break;
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = ripple::calcAccountID(keys[i]);
+}
+
+}  // namespace offline
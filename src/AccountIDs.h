@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_ACCOUNTIDS_H_INCLUDED
+#define OFFLINE_ACCOUNTIDS_H_INCLUDED
+
+#include <MultiHash.h>
+
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/PublicKey.h>
+#include <cstddef>
+
+namespace offline {
+
+/** Compute `out[i] = ripple::calcAccountID(keys[i])` for each of
+    `count` public keys.
+
+    An account ID is RIPEMD-160 of SHA-256 of the public key. Both are
+    a single block for any public key, so with a SIMD kernel the keys
+    are hashed eight (AVX2) or sixteen (AVX-512) at a time, one per 32
+    bit lane, and the SHA-256 digests feed RIPEMD-160 without leaving
+    the registers.
+
+    @throws std::logic_error if the kernel isn't supported
+*/
+void
+calcAccountIDs(
+    ripple::PublicKey const* keys,
+    std::size_t count,
+    ripple::AccountID* out,
+    HashKernel kernel = bestHashKernel());
+
+}  // namespace offline
+
+#endif  // !OFFLINE_ACCOUNTIDS_H_INCLUDED
@@ -0,0 +1,137 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <AddressCache.h>
+#include <Base58.h>
+#include <Metrics.h>
+#include <ProtocolTables.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/protocol/jss.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+namespace offline {
+
+namespace {
+
+// Lengths of base58 account addresses. Hex account IDs are 40.
+std::size_t constexpr minAddressSize = 25;
+std::size_t constexpr maxAddressSize = 35;
+
+}  // namespace
+
+AddressCache::AddressCache(std::size_t capacity, std::size_t shards)
+    : shardCapacity_(
+          std::max<std::size_t>(capacity / std::max<std::size_t>(shards, 1), 1))
+    , shards_(std::max<std::size_t>(shards, 1))
+{
+}
+
+std::optional<ripple::AccountID>
+AddressCache::decode(std::string_view address)
+{
+    auto const hash = std::hash<std::string_view>{}(address);
+    auto& shard = shards_[hash % shards_.size()];
+    {
+        std::shared_lock lock(shard.mutex);
+        auto const iter = shard.entries.find(hash);
+        if (iter != shard.entries.end() && iter->second.address == address)
+        {
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            metrics::recordAddressLookup(true);
+            return iter->second.account;
+        }
+    }
+
+    // Decoded outside the lock, so a miss doesn't hold up hits
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    metrics::recordAddressLookup(false);
+    auto const account = decodeAccount(address);
+    if (!account)
+        return std::nullopt;
+    std::unique_lock lock(shard.mutex);
+    if (shard.entries.size() >= shardCapacity_ && !shard.entries.count(hash))
+        shard.entries.erase(shard.entries.begin());
+    shard.entries.insert_or_assign(hash, Entry{std::string(address), *account});
+    return account;
+}
+
+void
+AddressCache::resolveAddress(Json::Value& value)
+{
+    if (!value.isString())
+        return;
+    auto const address = value.asString();
+    if (address.size() < minAddressSize || address.size() > maxAddressSize)
+        return;
+    if (auto const account = decode(address))
+        value = ripple::strHex(*account);
+}
+
+void
+AddressCache::resolve(Json::Value& json)
+{
+    using namespace ripple;
+
+    if (!json.isObject())
+        return;
+    // Issues and bridges also name accounts, but the library only reads
+    // those as addresses, so nested objects are left alone.
+    for (auto iter = json.begin(); iter != json.end(); ++iter)
+    {
+        auto const type = fieldByName(iter.memberName()).fieldType;
+        if (type == STI_ACCOUNT)
+            resolveAddress(*iter);
+        else if (
+            type == STI_AMOUNT && iter->isObject() &&
+            iter->isMember(jss::issuer))
+            resolveAddress((*iter)[jss::issuer]);
+    }
+}
+
+AddressCache::Stats
+AddressCache::stats() const
+{
+    Stats total;
+    for (auto const& shard : shards_)
+    {
+        total.hits += shard.hits.load(std::memory_order_relaxed);
+        total.misses += shard.misses.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::size_t
+AddressCache::size() const
+{
+    std::size_t total = 0;
+    for (auto const& shard : shards_)
+    {
+        std::shared_lock lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+}  // namespace offline
@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_ADDRESSCACHE_H_INCLUDED
+#define OFFLINE_ADDRESSCACHE_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/AccountID.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace offline {
+
+/** Decoded base58 addresses, shared by the threads of a batch.
+
+    Batches of payments tend to name the same few accounts over and
+    over, and each name costs a base58 decode and two SHA-256 hashes to
+    check. The cache is split into shards, each with its own lock, so
+    threads looking up different addresses rarely wait for each other,
+    and lookups of the same address only share a read lock. Each shard
+    holds a bounded number of addresses, and makes room for a new one
+    by dropping an arbitrary old one. Invalid addresses aren't cached.
+*/
+class AddressCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+private:
+    struct Entry
+    {
+        std::string address;
+        ripple::AccountID account;
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex mutex;
+        // By hash of the address
+        std::unordered_map<std::size_t, Entry> entries;
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+    };
+
+    std::size_t const shardCapacity_;
+    std::vector<Shard> shards_;
+
+    void
+    resolveAddress(Json::Value& value);
+
+public:
+    /** @param capacity The most addresses held, across all shards
+        @param shards The number of independently locked shards
+    */
+    explicit AddressCache(std::size_t capacity, std::size_t shards = 16);
+
+    AddressCache(AddressCache const&) = delete;
+    AddressCache&
+    operator=(AddressCache const&) = delete;
+
+    /// The account ID of `address`, or nothing if it isn't one.
+    std::optional<ripple::AccountID>
+    decode(std::string_view address);
+
+    /** Replace the address in each top level account field of `json`,
+        and in the issuer of each top level amount, with its account ID
+        in hex.
+
+        `ripple::STParsedJSONObject` reads hex account IDs directly, so
+        it doesn't decode the address again. Anything that isn't an
+        address is left for it to report. Issues and bridges, such as
+        an AMM's `Asset2`, are left alone, because the library only
+        reads their accounts as addresses.
+    */
+    void
+    resolve(Json::Value& json);
+
+    /// Lookups made since construction.
+    Stats
+    stats() const;
+
+    /// The number of addresses held.
+    std::size_t
+    size() const;
+};
+
+}  // namespace offline
+
+#endif  // !OFFLINE_ADDRESSCACHE_H_INCLUDED
@@ -0,0 +1,528 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Aggregate.h>
+#include <Base58.h>
+#include <FieldScanner.h>
+#include <Ledger.h>
+#include <Parallel.h>
+#include <ProtocolTables.h>
+#include <Serialize.h>
+
+#include <ripple/basics/safe_cast.h>
+#include <ripple/basics/strHex.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/protocol/TER.h>
+#include <ripple/protocol/TxFormats.h>
+#include <ripple/protocol/UintTypes.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <unordered_map>
+
+namespace offline {
+
+char const* const ledgerGroup = "ledger";
+
+namespace {
+
+// Lines processed in parallel at a time
+std::size_t constexpr chunkSize = 4096;
+
+struct FieldRef
+{
+    std::string name;
+    int code = 0;
+    int type = 0;
+    // The ledger index pseudo-field
+    bool ledger = false;
+};
+
+FieldRef
+resolve(std::string const& name, bool numeric)
+{
+    using namespace ripple;
+
+    if (name == ledgerGroup)
+    {
+        if (numeric)
+            throw std::runtime_error("Can't sum or histogram: " + name);
+        return {name, 0, 0, true};
+    }
+    auto const& field = fieldByName(name);
+    if (field.fieldCode == sfInvalid.fieldCode)
+        throw std::runtime_error("Unknown field: " + name);
+    if (numeric &&
+        !(field.fieldType == STI_UINT8 || field.fieldType == STI_UINT16 ||
+          field.fieldType == STI_UINT32 || field.fieldType == STI_UINT64 ||
+          field.fieldType == STI_AMOUNT))
+        throw std::runtime_error("Can't sum or histogram: " + name);
+    return {name, field.fieldCode, field.fieldType, false};
+}
+
+// The value of an integer or XRP amount field. IOU and negative amounts
+// have none.
+std::optional<std::uint64_t>
+numericValue(FieldRef const& ref, ripple::Slice value)
+{
+    if (ref.type != ripple::STI_AMOUNT)
+        return scannedUInt(value);
+    if (value.size() != 8 || !(value[0] & 0x40))
+        return std::nullopt;
+    return scannedUInt(value) & 0x3FFFFFFFFFFFFFFFull;
+}
+
+unsigned
+histogramBucket(std::uint64_t value)
+{
+    unsigned bits = 0;
+    for (; value; value >>= 1)
+        ++bits;
+    return bits;
+}
+
+std::string
+display(FieldRef const& ref, ripple::Slice value)
+{
+    using namespace ripple;
+
+    if (ref.ledger)
+        return std::to_string(scannedUInt(value));
+    if (ref.code == sfTransactionType.fieldCode)
+    {
+        auto const type = static_cast<std::uint16_t>(scannedUInt(value));
+        if (auto const name = txTypeName(type))
+            return std::string(*name);
+        if (auto const item = TxFormats::getInstance().findByType(
+                safe_cast<TxType>(type)))
+            return item->getName();
+    }
+    else if (ref.code == sfLedgerEntryType.fieldCode)
+    {
+        auto const type = static_cast<std::uint16_t>(scannedUInt(value));
+        if (auto const name = ledgerEntryTypeName(type))
+            return std::string(*name);
+        if (auto const item = LedgerFormats::getInstance().findByType(
+                safe_cast<LedgerEntryType>(type)))
+            return item->getName();
+    }
+    else if (ref.code == sfTransactionResult.fieldCode)
+    {
+        auto const code = static_cast<int>(scannedUInt(value));
+        if (auto const name = resultName(code))
+            return std::string(*name);
+        return transToken(TER::fromInt(code));
+    }
+    switch (ref.type)
+    {
+        case STI_UINT8:
+        case STI_UINT16:
+        case STI_UINT32:
+        case STI_UINT64:
+            return std::to_string(scannedUInt(value));
+        case STI_ACCOUNT:
+            if (value.size() == AccountID::size())
+                return encodeToken(TokenType::AccountID, value);
+            break;
+        case STI_AMOUNT:
+            if (auto const drops = numericValue(ref, value))
+                return std::to_string(*drops);
+            break;
+        default:
+            break;
+    }
+    return strHex(value);
+}
+
+struct Totals
+{
+    std::uint64_t count = 0;
+    std::vector<std::uint64_t> sums;
+    std::vector<std::array<std::uint64_t, 65>> histograms;
+
+    void
+    merge(Totals const& other)
+    {
+        count += other.count;
+        for (std::size_t i = 0; i < sums.size(); ++i)
+            sums[i] += other.sums[i];
+        for (std::size_t i = 0; i < histograms.size(); ++i)
+            for (std::size_t b = 0; b < histograms[i].size(); ++b)
+                histograms[i][b] += other.histograms[i][b];
+    }
+};
+
+using Table = std::unordered_map<std::string, Totals>;
+
+// Group keys are the raw values of the group fields, each prefixed by
+// a presence byte and length
+void
+appendKeyPart(std::string& key, std::optional<ripple::Slice> const& value)
+{
+    if (!value)
+    {
+        key += '\0';
+        return;
+    }
+    key += '\1';
+    auto const size = static_cast<std::uint32_t>(value->size());
+    for (int shift = 24; shift >= 0; shift -= 8)
+        key += static_cast<char>((size >> shift) & 0xFF);
+    key.append(reinterpret_cast<char const*>(value->data()), value->size());
+}
+
+std::optional<ripple::Slice>
+readKeyPart(std::string const& key, std::size_t& pos)
+{
+    if (key[pos++] == '\0')
+        return std::nullopt;
+    std::uint32_t size = 0;
+    for (int i = 0; i < 4; ++i)
+        size = (size << 8) | static_cast<std::uint8_t>(key[pos++]);
+    ripple::Slice const value(key.data() + pos, size);
+    pos += size;
+    return value;
+}
+
+class Worker
+{
+private:
+    AggregateOptions const& options_;
+    std::vector<FieldRef> const& groups_;
+    std::vector<FieldRef> const& sums_;
+    std::vector<FieldRef> const& histograms_;
+    // Distinct codes of the fields to find, in serialization order
+    std::vector<int> const& codes_;
+    std::vector<std::optional<ScannedField>> found_;
+    std::string key_;
+
+    std::optional<ripple::Slice>
+    get(FieldRef const& ref) const
+    {
+        auto const i =
+            std::lower_bound(codes_.begin(), codes_.end(), ref.code) -
+            codes_.begin();
+        if (!found_[i])
+            return std::nullopt;
+        return found_[i]->value;
+    }
+
+    void
+    scan(ripple::Slice data)
+    {
+        FieldScanner scanner(data);
+        for (std::size_t i = 0; i < codes_.size(); ++i)
+        {
+            if (found_[i])
+                continue;
+            ScannedField f;
+            if (scanner.find(codes_[i], f))
+                found_[i] = f;
+        }
+    }
+
+public:
+    Table table;
+
+    Worker(
+        AggregateOptions const& options,
+        std::vector<FieldRef> const& groups,
+        std::vector<FieldRef> const& sums,
+        std::vector<FieldRef> const& histograms,
+        std::vector<int> const& codes)
+        : options_(options)
+        , groups_(groups)
+        , sums_(sums)
+        , histograms_(histograms)
+        , codes_(codes)
+        , found_(codes.size())
+    {
+    }
+
+    void
+    add(ripple::Slice tx,
+        ripple::Slice meta,
+        std::optional<std::uint32_t> ledger)
+    {
+        std::fill(found_.begin(), found_.end(), std::nullopt);
+        scan(tx);
+        if (!meta.empty() &&
+            std::any_of(found_.begin(), found_.end(), [](auto const& f) {
+                return !f;
+            }))
+            scan(meta);
+
+        key_.clear();
+        for (auto const& ref : groups_)
+        {
+            if (!ref.ledger)
+            {
+                appendKeyPart(key_, get(ref));
+            }
+            else if (!ledger)
+            {
+                appendKeyPart(key_, std::nullopt);
+            }
+            else
+            {
+                auto const bucket =
+                    *ledger - *ledger % options_.ledgerBucket;
+                std::uint8_t const bytes[] = {
+                    static_cast<std::uint8_t>(bucket >> 24),
+                    static_cast<std::uint8_t>(bucket >> 16),
+                    static_cast<std::uint8_t>(bucket >> 8),
+                    static_cast<std::uint8_t>(bucket)};
+                appendKeyPart(key_, ripple::Slice(bytes, sizeof(bytes)));
+            }
+        }
+
+        auto& totals = table[key_];
+        if (!totals.count)
+        {
+            totals.sums.resize(sums_.size());
+            totals.histograms.resize(histograms_.size());
+        }
+        ++totals.count;
+        for (std::size_t i = 0; i < sums_.size(); ++i)
+        {
+            if (auto const value = get(sums_[i]))
+                if (auto const n = numericValue(sums_[i], *value))
+                    totals.sums[i] += *n;
+        }
+        for (std::size_t i = 0; i < histograms_.size(); ++i)
+        {
+            if (auto const value = get(histograms_[i]))
+                if (auto const n = numericValue(histograms_[i], *value))
+                    ++totals.histograms[i][histogramBucket(*n)];
+        }
+    }
+};
+
+void
+processLine(std::string const& line, Worker& worker)
+{
+    using namespace ripple;
+
+    if (line.front() == '{')
+    {
+        Json::Value jv;
+        if (!Json::Reader{}.parse(line, jv))
+            throw std::runtime_error("Invalid JSON");
+        auto const dump = LedgerDump::fromJson(jv);
+        std::optional<std::uint32_t> ledger;
+        if (dump.header)
+            ledger = dump.header->seq;
+        for (auto const& [tx, meta] : dump.transactions)
+            worker.add(makeSlice(tx), makeSlice(meta), ledger);
+        return;
+    }
+
+    // Reused by every line a worker processes
+    thread_local Blob tx;
+    thread_local Blob meta;
+
+    std::string_view const text(line);
+    auto const split = text.find_first_of(" \t,");
+    if (!unhexInto(text.substr(0, split), tx))
+        throw std::runtime_error("Invalid hex data");
+    meta.clear();
+    if (split != std::string_view::npos)
+    {
+        auto const rest = text.find_first_not_of(" \t,", split);
+        if (rest != std::string_view::npos &&
+            !unhexInto(text.substr(rest), meta))
+            throw std::runtime_error("Invalid hex data");
+    }
+    worker.add(makeSlice(tx), makeSlice(meta), std::nullopt);
+}
+
+void
+writeCsv(
+    std::ostream& out,
+    Table const& table,
+    std::vector<FieldRef> const& groups,
+    std::vector<FieldRef> const& sums,
+    std::vector<FieldRef> const& histograms)
+{
+    char const* separator = "";
+    auto const cell = [&](std::string const& text) {
+        out << separator << text;
+        separator = ",";
+    };
+
+    for (auto const& ref : groups)
+        cell(ref.name);
+    cell("count");
+    for (auto const& ref : sums)
+        cell("sum_" + ref.name);
+    for (auto const& ref : histograms)
+        cell("histogram_" + ref.name);
+    out << "\n";
+
+    std::vector<Table::value_type const*> rows;
+    rows.reserve(table.size());
+    for (auto const& row : table)
+        rows.push_back(&row);
+    std::sort(rows.begin(), rows.end(), [](auto const a, auto const b) {
+        return a->first < b->first;
+    });
+
+    for (auto const row : rows)
+    {
+        auto const& [key, totals] = *row;
+        separator = "";
+        std::size_t pos = 0;
+        for (auto const& ref : groups)
+        {
+            auto const value = readKeyPart(key, pos);
+            cell(value ? display(ref, *value) : std::string{});
+        }
+        cell(std::to_string(totals.count));
+        for (auto const sum : totals.sums)
+            cell(std::to_string(sum));
+        // Lower bound:count for each non-empty power of two bucket
+        for (auto const& histogram : totals.histograms)
+        {
+            std::string text;
+            for (std::size_t b = 0; b < histogram.size(); ++b)
+            {
+                if (!histogram[b])
+                    continue;
+                if (!text.empty())
+                    text += ' ';
+                text += std::to_string(b ? std::uint64_t{1} << (b - 1) : 0);
+                text += ':';
+                text += std::to_string(histogram[b]);
+            }
+            cell(text);
+        }
+        out << "\n";
+    }
+}
+
+}  // namespace
+
+int
+runAggregate(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    AggregateOptions const& options)
+{
+    if (!options.ledgerBucket)
+        throw std::runtime_error("The ledger bucket size must be positive");
+
+    std::vector<FieldRef> groups;
+    std::vector<FieldRef> sums;
+    std::vector<FieldRef> histograms;
+    std::vector<int> codes;
+    auto const addRefs = [&codes](
+                             std::vector<std::string> const& names,
+                             bool numeric,
+                             std::vector<FieldRef>& refs) {
+        for (auto const& name : names)
+        {
+            refs.push_back(resolve(name, numeric));
+            if (!refs.back().ledger)
+                codes.push_back(refs.back().code);
+        }
+    };
+    addRefs(options.groupBy, false, groups);
+    addRefs(options.sums, true, sums);
+    addRefs(options.histograms, true, histograms);
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+
+    auto const threads = workerCount(options.threads);
+    std::vector<Worker> workers;
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(options, groups, sums, histograms, codes);
+
+    std::size_t failures = 0;
+    std::vector<std::string> lines;
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<std::string> errors;
+    std::uint64_t lineNumber = 0;
+    for (bool more = true; more;)
+    {
+        lines.clear();
+        lineNumbers.clear();
+        std::string line;
+        while (lines.size() < chunkSize && (more = !!std::getline(in, line)))
+        {
+            ++lineNumber;
+            boost::trim(line);
+            if (line.empty())
+                continue;
+            lines.push_back(std::move(line));
+            lineNumbers.push_back(lineNumber);
+        }
+
+        // Each worker takes a contiguous share of the lines
+        errors.assign(lines.size(), {});
+        parallelFor(threads, threads, [&](std::uint64_t w) {
+            auto const begin = lines.size() * w / threads;
+            auto const end = lines.size() * (w + 1) / threads;
+            for (auto i = begin; i < end; ++i)
+            {
+                try
+                {
+                    processLine(lines[i], workers[w]);
+                }
+                catch (std::exception const& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+        });
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            if (errors[i].empty())
+                continue;
+            ++failures;
+            err << "Line " << lineNumbers[i] << ": " << errors[i] << "\n";
+        }
+    }
+
+    auto& merged = workers.front().table;
+    for (auto w = workers.begin() + 1; w != workers.end(); ++w)
+    {
+        for (auto& [key, totals] : w->table)
+        {
+            auto const [it, inserted] = merged.try_emplace(key, totals);
+            if (!inserted)
+                it->second.merge(totals);
+        }
+        w->table.clear();
+    }
+    writeCsv(out, merged, groups, sums, histograms);
+    out.flush();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_AGGREGATE_H_INCLUDED
+#define OFFLINE_AGGREGATE_H_INCLUDED
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace offline {
+
+/// The pseudo-field that groups by ledger index bucket.
+extern char const* const ledgerGroup;
+
+struct AggregateOptions
+{
+    /** Fields to group by: any transaction or metadata field, like
+        TransactionType, Account or TransactionResult, or `ledger`.
+    */
+    std::vector<std::string> groupBy = {"TransactionType"};
+    /// Integer or XRP amount fields to sum.
+    std::vector<std::string> sums;
+    /// Integer or XRP amount fields to histogram, in powers of two.
+    std::vector<std::string> histograms;
+    /// Number of ledgers in each `ledger` group.
+    std::uint32_t ledgerBucket = 10000;
+    /// Number of worker threads. Zero means one per hardware thread.
+    unsigned threads = 0;
+};
+
+/** Count, sum and histogram transactions read from `in`, by group, and
+    write the groups to `out` as CSV.
+
+    Each line is a transaction in hex, optionally followed by its
+    metadata, or a binary `ledger` result with expanded transactions.
+    Only the `ledger` results give the ledger index. Fields are found in
+    the transaction first, then in the metadata, by scanning the binary
+    encoding, and only the fields named are decoded. Each worker thread
+    aggregates into its own hash table, and the tables are merged at the
+    end.
+
+    @return EXIT_SUCCESS if every line was processed, otherwise
+        EXIT_FAILURE
+
+    @throws std::runtime_error if a field name is unknown, or the field
+        can't be summed
+*/
+int
+runAggregate(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    AggregateOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_AGGREGATE_H_INCLUDED
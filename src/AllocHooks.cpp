@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+/*  The global operator new and delete, replaced to count allocations for
+    AllocTracker. Only linked into the executables that count them, so
+    the others keep the standard library's allocator.
+*/
+
+#include <AllocTracker.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void*
+allocate(std::size_t size)
+{
+    offline::alloc::detail::note(size);
+    if (size == 0)
+        size = 1;
+    for (;;)
+    {
+        if (auto const p = std::malloc(size))
+            return p;
+        auto const handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void*
+allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    offline::alloc::detail::note(size);
+    auto const align = static_cast<std::size_t>(alignment);
+    if (size == 0)
+        size = 1;
+    for (;;)
+    {
+#ifdef _MSC_VER
+        if (auto const p = _aligned_malloc(size, align))
+            return p;
+#else
+        void* p = nullptr;
+        if (posix_memalign(&p, std::max(align, sizeof(void*)), size) == 0)
+            return p;
+#endif
+        auto const handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void
+deallocateAligned(void* p) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// Tells hooked() that allocations are counted
+struct Registration
+{
+    Registration()
+    {
+        offline::alloc::detail::hooksLinked.store(
+            true, std::memory_order_relaxed);
+    }
+} const registration;
+
+}  // namespace
+
+// LCOV_EXCL_START
+void*
+operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void*
+operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void*
+operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void*
+operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void*
+operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::nothrow_t const&) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete[](void* p, std::nothrow_t const&) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::align_val_t) noexcept
+{
+    deallocateAligned(p);
+}
+
+void
+operator delete[](void* p, std::align_val_t) noexcept
+{
+    deallocateAligned(p);
+}
+
+void
+operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    deallocateAligned(p);
+}
+
+void
+operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    deallocateAligned(p);
+}
+// LCOV_EXCL_STOP
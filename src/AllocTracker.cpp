@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <AllocTracker.h>
+
+#include <array>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+
+namespace offline {
+namespace alloc {
+
+namespace {
+
+// Innermost active scope on this thread. A plain pointer, so that the
+// hook never triggers thread local initialization.
+thread_local Scope* currentScope = nullptr;
+
+struct AtomicTotals
+{
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> bytes{0};
+};
+
+constexpr std::array<char const*, 5> operationNames = {
+    "serialize",
+    "deserialize",
+    "make_sttx",
+    "singleSign",
+    "multiSign"};
+
+std::array<AtomicTotals, operationNames.size()> operationTotals;
+
+}  // namespace
+
+bool
+hooked()
+{
+    return detail::hooksLinked.load(std::memory_order_relaxed);
+}
+
+Scope::Scope() : outer_(currentScope)
+{
+    currentScope = this;
+}
+
+Scope::~Scope()
+{
+    currentScope = outer_;
+    if (outer_)
+    {
+        outer_->counts_.allocations += counts_.allocations;
+        outer_->counts_.bytes += counts_.bytes;
+    }
+}
+
+namespace detail {
+
+std::atomic<bool> reporting{false};
+std::atomic<bool> hooksLinked{false};
+
+void
+record(Operation op, Counts const& counts)
+{
+    auto& t = operationTotals[static_cast<std::size_t>(op)];
+    t.calls.fetch_add(1, std::memory_order_relaxed);
+    t.allocations.fetch_add(counts.allocations, std::memory_order_relaxed);
+    t.bytes.fetch_add(counts.bytes, std::memory_order_relaxed);
+}
+
+void
+note(std::size_t bytes)
+{
+    if (auto const scope = currentScope)
+        scope->note(bytes);
+}
+
+}  // namespace detail
+
+void
+enableReport()
+{
+    for (auto& t : operationTotals)
+    {
+        t.calls.store(0, std::memory_order_relaxed);
+        t.allocations.store(0, std::memory_order_relaxed);
+        t.bytes.store(0, std::memory_order_relaxed);
+    }
+    detail::reporting.store(true, std::memory_order_release);
+}
+
+void
+disableReport()
+{
+    detail::reporting.store(false, std::memory_order_release);
+}
+
+OperationTotals
+totals(Operation op)
+{
+    auto const& t = operationTotals[static_cast<std::size_t>(op)];
+    OperationTotals result;
+    result.calls = t.calls.load(std::memory_order_relaxed);
+    result.counts.allocations = t.allocations.load(std::memory_order_relaxed);
+    result.counts.bytes = t.bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+void
+writeReport(std::ostream& os)
+{
+    if (!hooked())
+    {
+        os << "Allocation tracking is not available in this build.\n";
+        return;
+    }
+    os << "Allocations by operation (including nested operations):\n"
+       << std::left << std::setw(14) << "operation" << std::right
+       << std::setw(10) << "calls" << std::setw(14) << "allocations"
+       << std::setw(14) << "bytes" << std::setw(14) << "allocs/call"
+       << std::setw(14) << "bytes/call"
+       << "\n";
+    for (std::size_t i = 0; i < operationNames.size(); ++i)
+    {
+        auto const t = totals(static_cast<Operation>(i));
+        if (!t.calls)
+            continue;
+        os << std::left << std::setw(14) << operationNames[i] << std::right
+           << std::setw(10) << t.calls << std::setw(14)
+           << t.counts.allocations << std::setw(14) << t.counts.bytes
+           << std::setw(14) << t.counts.allocations / t.calls
+           << std::setw(14) << t.counts.bytes / t.calls << "\n";
+    }
+}
+
+}  // namespace alloc
+}  // namespace offline
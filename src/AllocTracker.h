@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef OFFLINE_ALLOCTRACKER_H_INCLUDED
+#define OFFLINE_ALLOCTRACKER_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+
+namespace offline {
+
+/** Heap allocation accounting.
+
+    Executables linked with AllocHooks.cpp replace the global operator
+    new with one that counts allocations made while a `Scope` is active
+    on the calling thread. The tests and benchmarks always are, and the
+    tool only with the `alloc_tracking` CMake option. Allocations made
+    outside of any scope cost a call and one thread local load.
+
+    Only allocations through operator new are seen. Memory obtained
+    directly from malloc, e.g. by OpenSSL or the JSON string values, is
+    not counted.
+*/
+namespace alloc {
+
+struct Counts
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+/// True if this executable counts allocations.
+bool
+hooked();
+
+/** Count the allocations made by the calling thread during this object's
+    lifetime.
+
+    Scopes nest. When an inner scope ends, its counts are added to the
+    enclosing scope.
+*/
+class Scope
+{
+private:
+    Counts counts_;
+    Scope* const outer_;
+
+public:
+    Scope();
+
+    Scope(Scope const&) = delete;
+    Scope&
+    operator=(Scope const&) = delete;
+
+    ~Scope();
+
+    Counts const&
+    counts() const
+    {
+        return counts_;
+    }
+
+    /// @internal Called by the operator new hook.
+    void
+    note(std::size_t bytes)
+    {
+        ++counts_.allocations;
+        counts_.bytes += bytes;
+    }
+};
+
+/// Instrumented operations reported by `writeReport`.
+enum class Operation {
+    serialize,
+    deserialize,
+    makeSttx,
+    singleSign,
+    multiSign,
+};
+
+namespace detail {
+extern std::atomic<bool> reporting;
+// Set by AllocHooks.cpp, if it is linked in
+extern std::atomic<bool> hooksLinked;
+
+/// Called by the operator new replacements.
+void
+note(std::size_t bytes);
+
+void
+record(Operation op, Counts const& counts);
+}  // namespace detail
+
+/// Start accumulating per-operation totals, resetting any previous ones.
+void
+enableReport();
+
+/// Stop accumulating. The totals are kept until the next `enableReport`.
+void
+disableReport();
+
+/** Attributes the allocations made during its lifetime to an operation,
+    if reporting is enabled.
+
+    Totals are inclusive: an operation that calls another, like
+    `make_sttx` calling `deserialize`, includes the callee's allocations.
+*/
+class Tally
+{
+private:
+    Operation const op_;
+    std::optional<Scope> scope_;
+
+public:
+    explicit Tally(Operation op) : op_(op)
+    {
+        if (detail::reporting.load(std::memory_order_relaxed))
+            scope_.emplace();
+    }
+
+    Tally(Tally const&) = delete;
+    Tally&
+    operator=(Tally const&) = delete;
+
+    ~Tally()
+    {
+        if (scope_)
+        {
+            auto const counts = scope_->counts();
+            // End the scope first, so that recording isn't counted
+            scope_.reset();
+            detail::record(op_, counts);
+        }
+    }
+};
+
+struct OperationTotals
+{
+    std::uint64_t calls = 0;
+    Counts counts;
+};
+
+/// Totals accumulated since `enableReport`.
+OperationTotals
+totals(Operation op);
+
+/// Write a table of per-operation totals and averages.
+void
+writeReport(std::ostream& os);
+
+}  // namespace alloc
+
+}  // namespace offline
+
+#endif  // !OFFLINE_ALLOCTRACKER_H_INCLUDED
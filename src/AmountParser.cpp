@@ -0,0 +1,213 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <AmountParser.h>
+#include <Base58.h>
+
+#include <ripple/protocol/UintTypes.h>
+#include <ripple/protocol/jss.h>
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+#include <limits>
+
+namespace offline {
+
+namespace {
+
+// The most digits amountFromString accepts, before and after the point
+std::size_t constexpr maxDigits = 32;
+// Larger exponents are rare, and left to the library
+std::size_t constexpr maxExponentDigits = 6;
+
+std::uint64_t constexpr ones = 0x0101010101010101ULL;
+
+// True if each of the 8 bytes is an ASCII digit
+bool
+allDigits(std::uint64_t chunk)
+{
+    return (chunk & (0xF0 * ones)) == 0x30 * ones &&
+        ((chunk + 0x06 * ones) & (0xF0 * ones)) == 0x30 * ones;
+}
+
+// The value of 8 digits, with the first in the lowest byte
+std::uint32_t
+eightDigits(std::uint64_t chunk)
+{
+    std::uint64_t constexpr mask = 0x000000FF000000FFULL;
+    // 100 + (1000000 << 32), and 1 + (10000 << 32)
+    std::uint64_t constexpr mul1 = 0x000F424000000064ULL;
+    std::uint64_t constexpr mul2 = 0x0000271000000001ULL;
+    chunk -= 0x30 * ones;
+    // Pairs of digits
+    chunk = (chunk * 10) + (chunk >> 8);
+    return static_cast<std::uint32_t>(
+        (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32);
+}
+
+bool
+isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/** Append the digits at `p` to `mantissa`, and advance `p` past them.
+
+    @return false if the mantissa overflows
+*/
+bool
+readDigits(char const*& p, char const* end, std::uint64_t& mantissa)
+{
+    auto constexpr max = std::numeric_limits<std::uint64_t>::max();
+    while (end - p >= 8)
+    {
+        auto const chunk = boost::endian::load_little_u64(
+            reinterpret_cast<unsigned char const*>(p));
+        if (!allDigits(chunk))
+            break;
+        auto const value = eightDigits(chunk);
+        if (mantissa > (max - value) / 100'000'000)
+            return false;
+        mantissa = mantissa * 100'000'000 + value;
+        p += 8;
+    }
+    for (; p != end && isDigit(*p); ++p)
+    {
+        auto const digit = static_cast<unsigned>(*p - '0');
+        if (mantissa > (max - digit) / 10)
+            return false;
+        mantissa = mantissa * 10 + digit;
+    }
+    return true;
+}
+
+std::string_view
+view(Json::Value const& value)
+{
+    return value.asCString();
+}
+
+}  // namespace
+
+std::optional<DecimalParts>
+parseDecimal(std::string_view text)
+{
+    DecimalParts parts;
+    auto p = text.data();
+    auto const end = p + text.size();
+    if (p != end && (*p == '-' || *p == '+'))
+        parts.negative = *p++ == '-';
+
+    auto const integer = p;
+    if (!readDigits(p, end, parts.mantissa))
+        return std::nullopt;
+    auto digits = static_cast<std::size_t>(p - integer);
+    if (!digits || (digits > 1 && *integer == '0'))
+        return std::nullopt;
+
+    if (p != end && *p == '.')
+    {
+        auto const fraction = ++p;
+        if (!readDigits(p, end, parts.mantissa) || p == fraction)
+            return std::nullopt;
+        parts.fraction = true;
+        parts.exponent = -static_cast<int>(p - fraction);
+        digits += p - fraction;
+    }
+    if (digits > maxDigits)
+        return std::nullopt;
+
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        bool negative = false;
+        if (++p != end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        auto const exponent = p;
+        // Leading zeros don't count towards the limit
+        while (p != end && *p == '0')
+            ++p;
+        auto const significant = p;
+        int value = 0;
+        for (; p != end && isDigit(*p); ++p)
+            value = value * 10 + (*p - '0');
+        if (p == exponent ||
+            static_cast<std::size_t>(p - significant) > maxExponentDigits)
+            return std::nullopt;
+        parts.exponent += negative ? -value : value;
+    }
+    if (p != end)
+        return std::nullopt;
+    return parts;
+}
+
+std::optional<ripple::STAmount>
+parseAmount(Json::Value const& json)
+{
+    using namespace ripple;
+
+    std::optional<DecimalParts> parts;
+    Issue issue;
+    if (json.isString())
+    {
+        // Drops, which must be integral
+        parts = parseDecimal(view(json));
+        if (!parts || parts->fraction || parts->exponent < 0)
+            return std::nullopt;
+        issue = xrpIssue();
+    }
+    else
+    {
+        if (!json.isObject() || json.size() != 3)
+            return std::nullopt;
+        auto const& value = json[jss::value];
+        auto const& currency = json[jss::currency];
+        auto const& issuer = json[jss::issuer];
+        if (!value.isString() || !currency.isString() || !issuer.isString())
+            return std::nullopt;
+        // XRP can't be an object, which the library reports
+        if (!to_currency(issue.currency, currency.asString()) ||
+            isXRP(issue.currency))
+            return std::nullopt;
+        if (!issue.account.parseHex(view(issuer)))
+        {
+            auto const account = decodeAccount(view(issuer));
+            if (!account)
+                return std::nullopt;
+            issue.account = *account;
+        }
+        parts = parseDecimal(view(value));
+        if (!parts)
+            return std::nullopt;
+    }
+
+    try
+    {
+        // Normalizes the same way as the library
+        return STAmount(
+            issue, parts->mantissa, parts->exponent, parts->negative);
+    }
+    catch (std::exception const&)
+    {
+        // Out of range, which the library reports in its own words
+        return std::nullopt;
+    }
+}
+
+}  // namespace offline
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_AMOUNTPARSER_H_INCLUDED
+#define OFFLINE_AMOUNTPARSER_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/STAmount.h>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace offline {
+
+/** A decimal number as `ripple::amountFromString` reads it, before it
+    is normalized.
+*/
+struct DecimalParts
+{
+    std::uint64_t mantissa = 0;
+    int exponent = 0;
+    bool negative = false;
+    /// True if the number has digits after a decimal point.
+    bool fraction = false;
+};
+
+/** Read a decimal number, such as "-12.5e3", without allocating.
+
+    Digits are read eight at a time from a 64 bit word. The grammar is
+    the same as `ripple::amountFromString`'s: an optional sign, an
+    integer without leading zeros, an optional fraction, and an
+    optional exponent.
+
+    @return nothing if the text doesn't match, or is out of the range
+        handled here: more than 32 digits, a mantissa that doesn't fit
+        in 64 bits, or an exponent of more than six digits
+*/
+std::optional<DecimalParts>
+parseDecimal(std::string_view text);
+
+/** Parse a JSON amount, the same as `ripple::amountFromJson`.
+
+    Handles the common forms: a string of drops, and an issued amount
+    object with exactly `value`, `currency` and `issuer` strings.
+
+    @return nothing for any other form, or anything invalid, which is
+        left for `ripple::amountFromJson` to parse or reject
+*/
+std::optional<ripple::STAmount>
+parseAmount(Json::Value const& json);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_AMOUNTPARSER_H_INCLUDED
@@ -0,0 +1,269 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BalanceChanges.h>
+#include <Base58.h>
+#include <Ledger.h>
+#include <Parallel.h>
+#include <Serialize.h>
+#include <TreeHash.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/st.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+
+namespace offline {
+
+char const* const balanceChangesHeader =
+    "tx_hash,kind,account,currency,issuer,delta";
+
+namespace {
+
+// Lines processed in parallel at a time
+std::size_t constexpr chunkSize = 4096;
+
+ripple::STObject const*
+innerObject(ripple::STObject const& node, ripple::SField const& field)
+{
+    return dynamic_cast<ripple::STObject const*>(node.peekAtPField(field));
+}
+
+ripple::STAmount const*
+amountField(ripple::STObject const* fields, ripple::SField const& field)
+{
+    if (!fields)
+        return nullptr;
+    return dynamic_cast<ripple::STAmount const*>(fields->peekAtPField(field));
+}
+
+class Rows
+{
+private:
+    std::string const hash_;
+    std::string& csv_;
+
+public:
+    Rows(ripple::uint256 const& hash, std::string& csv)
+        : hash_(ripple::to_string(hash)), csv_(csv)
+    {
+    }
+
+    void
+    add(char const* kind,
+        ripple::AccountID const& account,
+        ripple::STAmount const& delta,
+        ripple::AccountID const& issuer)
+    {
+        using namespace ripple;
+
+        csv_ += hash_;
+        csv_ += ',';
+        csv_ += kind;
+        csv_ += ',';
+        csv_ += encodeAccount(account);
+        csv_ += ',';
+        csv_ += to_string(delta.getCurrency());
+        csv_ += ',';
+        if (!delta.native())
+            csv_ += encodeAccount(issuer);
+        csv_ += ',';
+        csv_ += delta.getText();
+        csv_ += '\n';
+    }
+};
+
+void
+processLine(std::string const& line, std::string& csv)
+{
+    using namespace ripple;
+
+    if (line.front() == '{')
+    {
+        Json::Value jv;
+        if (!Json::Reader{}.parse(line, jv))
+            throw std::runtime_error("Invalid JSON");
+        auto const dump = LedgerDump::fromJson(jv);
+        for (auto const& [tx, meta] : dump.transactions)
+            appendBalanceChanges(makeSlice(tx), makeSlice(meta), csv);
+        return;
+    }
+
+    // Reused by every line a worker processes
+    thread_local Blob tx;
+    thread_local Blob meta;
+
+    auto const split = line.find_first_of(" \t,");
+    auto const rest = line.find_first_not_of(" \t,", split);
+    if (split == std::string::npos || rest == std::string::npos)
+        throw std::runtime_error("Expected a transaction and metadata");
+    std::string_view const text(line);
+    if (!unhexInto(text.substr(0, split), tx) ||
+        !unhexInto(text.substr(rest), meta))
+        throw std::runtime_error("Invalid hex data");
+    appendBalanceChanges(makeSlice(tx), makeSlice(meta), csv);
+}
+
+}  // namespace
+
+void
+appendBalanceChanges(ripple::Slice tx, ripple::Slice meta, std::string& csv)
+{
+    using namespace ripple;
+
+    SerialIter sit(meta);
+    STObject const parsed(sit, sfTransactionMetaData);
+    if (!parsed.isFieldPresent(sfAffectedNodes))
+        throw std::runtime_error("Not transaction metadata");
+
+    Rows rows(transactionID(tx), csv);
+    for (auto const& node : parsed.getFieldArray(sfAffectedNodes))
+    {
+        auto const& name = node.getFName();
+        bool const created = name == sfCreatedNode;
+        auto const fields =
+            innerObject(node, created ? sfNewFields : sfFinalFields);
+        auto const previous = innerObject(node, sfPreviousFields);
+        if (!fields)
+            continue;
+
+        // The change in an amount field, if it changed. Only changed
+        // fields are listed in PreviousFields.
+        auto const delta =
+            [&](SField const& field) -> std::optional<STAmount> {
+            auto const after = amountField(fields, field);
+            if (!after)
+                return std::nullopt;
+            std::optional<STAmount> change;
+            if (created)
+                change = *after;
+            else if (auto const before = amountField(previous, field))
+                change = *after - *before;
+            if (change && change->signum() == 0)
+                return std::nullopt;
+            return change;
+        };
+
+        switch (node.getFieldU16(sfLedgerEntryType))
+        {
+            case ltACCOUNT_ROOT:
+                if (auto const d = delta(sfBalance))
+                    rows.add(
+                        "balance", fields->getAccountID(sfAccount), *d, {});
+                break;
+            case ltRIPPLE_STATE:
+                if (auto const d = delta(sfBalance))
+                {
+                    // The balance is held by the low account
+                    auto const low = fields->getFieldAmount(sfLowLimit);
+                    auto const high = fields->getFieldAmount(sfHighLimit);
+                    rows.add(
+                        "trustline", low.getIssuer(), *d, high.getIssuer());
+                    rows.add(
+                        "trustline", high.getIssuer(), -*d, low.getIssuer());
+                }
+                break;
+            case ltOFFER:
+                if (created)
+                    break;
+                if (auto const d = delta(sfTakerGets))
+                    rows.add(
+                        "offer_gets",
+                        fields->getAccountID(sfAccount),
+                        *d,
+                        d->getIssuer());
+                if (auto const d = delta(sfTakerPays))
+                    rows.add(
+                        "offer_pays",
+                        fields->getAccountID(sfAccount),
+                        *d,
+                        d->getIssuer());
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+int
+runBalanceChanges(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads)
+{
+    out << balanceChangesHeader << "\n";
+
+    std::size_t failures = 0;
+    std::vector<std::string> lines;
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<std::string> rows;
+    std::vector<std::string> errors;
+    std::uint64_t lineNumber = 0;
+    for (bool more = true; more;)
+    {
+        lines.clear();
+        lineNumbers.clear();
+        std::string line;
+        while (lines.size() < chunkSize && (more = !!std::getline(in, line)))
+        {
+            ++lineNumber;
+            boost::trim(line);
+            if (line.empty())
+                continue;
+            lines.push_back(std::move(line));
+            lineNumbers.push_back(lineNumber);
+        }
+
+        rows.assign(lines.size(), {});
+        errors.assign(lines.size(), {});
+        parallelFor(lines.size(), threads, [&](std::uint64_t i) {
+            try
+            {
+                processLine(lines[i], rows[i]);
+            }
+            catch (std::exception const& e)
+            {
+                rows[i].clear();
+                errors[i] = e.what();
+            }
+        });
+
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            if (!errors[i].empty())
+            {
+                ++failures;
+                err << "Line " << lineNumbers[i] << ": " << errors[i]
+                    << "\n";
+            }
+            out << rows[i];
+        }
+    }
+    out.flush();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
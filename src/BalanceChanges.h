@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_BALANCECHANGES_H_INCLUDED
+#define OFFLINE_BALANCECHANGES_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <iosfwd>
+#include <string>
+
+namespace offline {
+
+/// The header line of the balance changes CSV.
+extern char const* const balanceChangesHeader;
+
+/** Append a CSV row to `csv` for each balance change recorded in a
+    transaction's metadata.
+
+    Rows are `tx_hash,kind,account,currency,issuer,delta`, where kind is
+    one of:
+
+    - `balance`: an account's XRP balance, with the delta in drops.
+    - `trustline`: a trust line balance, as seen by each side of the
+      line. The issuer is the other side.
+    - `offer_gets` and `offer_pays`: how much of an offer's TakerGets or
+      TakerPays was consumed, as a negative delta. New offers and
+      cancelled offers are not changes.
+
+    The metadata is walked as binary fields, without going through JSON.
+
+    @throws std::runtime_error if the metadata can't be parsed
+*/
+void
+appendBalanceChanges(ripple::Slice tx, ripple::Slice meta, std::string& csv);
+
+/** Extract the balance changes of the transactions read from `in`.
+
+    Each line is a transaction and its metadata, in hex, separated by
+    white space or a comma, or a binary `ledger` result with expanded
+    transactions. Lines are processed in parallel, and the CSV rows are
+    written to `out` in input order.
+
+    @return EXIT_SUCCESS if every line was processed, otherwise
+        EXIT_FAILURE
+*/
+int
+runBalanceChanges(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_BALANCECHANGES_H_INCLUDED
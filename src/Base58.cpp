@@ -0,0 +1,250 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Base58.h>
+
+#include <ripple/protocol/digest.h>
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace offline {
+
+namespace {
+
+auto constexpr& alphabet = base58Alphabet;
+
+// The value of each character, or -1 if it isn't a digit
+std::array<std::int8_t, 256> constexpr digitValues = [] {
+    std::array<std::int8_t, 256> values{};
+    for (auto& value : values)
+        value = -1;
+    for (int i = 0; i < 58; ++i)
+        values[static_cast<unsigned char>(alphabet[i])] = i;
+    return values;
+}();
+
+// Digits are converted five at a time, which fits a 32 bit word
+std::size_t constexpr chunkDigits = 5;
+std::uint64_t constexpr chunkBase = 58ULL * 58 * 58 * 58 * 58;
+
+// The type byte, payload and checksum, right aligned in whole words
+std::size_t constexpr maxTokenSize = 1 + maxTokenPayload + 4;
+std::size_t constexpr maxWords = (maxTokenSize + 3) / 4;
+std::size_t constexpr maxDigits =
+    (maxWords * 32 * 1000 / 5857 / chunkDigits + 1) * chunkDigits;
+
+using TokenBytes = std::array<std::uint8_t, maxWords * 4>;
+
+// The first 4 bytes of SHA-256 of SHA-256 of `data`
+void
+checksum(std::uint8_t* out, std::uint8_t const* data, std::size_t size)
+{
+    using namespace ripple;
+
+    sha256_hasher first;
+    first(data, size);
+    auto const digest = static_cast<sha256_hasher::result_type>(first);
+    sha256_hasher second;
+    second(digest.data(), digest.size());
+    std::memcpy(
+        out, static_cast<sha256_hasher::result_type>(second).data(), 4);
+}
+
+}  // namespace
+
+std::string
+encodeToken(ripple::TokenType type, ripple::Slice payload)
+{
+    if (payload.size() > maxTokenPayload)
+        throw std::logic_error(
+            "Token payload of " + std::to_string(payload.size()) +
+            " bytes is too long");
+
+    TokenBytes bytes{};
+    auto const size = payload.size() + 5;
+    auto const token = bytes.data() + bytes.size() - size;
+    token[0] = static_cast<std::uint8_t>(type);
+    std::memcpy(token + 1, payload.data(), payload.size());
+    checksum(token + 1 + payload.size(), token, 1 + payload.size());
+
+    std::uint32_t words[maxWords];
+    for (std::size_t i = 0; i < maxWords; ++i)
+        words[i] = boost::endian::load_big_u32(bytes.data() + 4 * i);
+
+    // Divide out a chunk of digits at a time, least significant first
+    std::uint8_t digits[maxDigits];
+    std::size_t count = 0;
+    for (std::size_t first = 0;;)
+    {
+        while (first < maxWords && !words[first])
+            ++first;
+        if (first == maxWords)
+            break;
+        std::uint64_t remainder = 0;
+        for (auto i = first; i < maxWords; ++i)
+        {
+            auto const value = (remainder << 32) | words[i];
+            words[i] = static_cast<std::uint32_t>(value / chunkBase);
+            remainder = value % chunkBase;
+        }
+        for (std::size_t i = 0; i < chunkDigits; ++i, remainder /= 58)
+            digits[count++] = static_cast<std::uint8_t>(remainder % 58);
+    }
+    while (count && !digits[count - 1])
+        --count;
+
+    // Each leading zero byte is written as a zero digit
+    auto const zeros = static_cast<std::size_t>(
+        std::find_if(token, token + size, [](auto b) { return b != 0; }) -
+        token);
+    std::string result(zeros + count, alphabet[0]);
+    for (std::size_t i = 0; i < count; ++i)
+        result[zeros + i] = alphabet[digits[count - 1 - i]];
+    return result;
+}
+
+bool
+decodeToken(
+    std::string_view text,
+    ripple::TokenType type,
+    std::uint8_t* out,
+    std::size_t size)
+{
+    if (!size || size > maxTokenPayload)
+        return false;
+    auto const tokenSize = size + 5;
+
+    std::size_t zeros = 0;
+    while (zeros < text.size() && text[zeros] == alphabet[0])
+        ++zeros;
+    auto digits = text.substr(zeros);
+    // Anything longer can't fit, and would only take longer to reject
+    if (zeros > tokenSize || digits.size() > maxDigits)
+        return false;
+
+    // Multiply in a chunk of digits at a time, with the odd digits first
+    std::uint32_t words[maxWords] = {};
+    for (auto n = digits.size() % chunkDigits; !digits.empty();
+         n = chunkDigits)
+    {
+        if (!n)
+            continue;
+        std::uint64_t carry = 0;
+        std::uint64_t scale = 1;
+        for (std::size_t i = 0; i < n; ++i, scale *= 58)
+        {
+            auto const value =
+                digitValues[static_cast<unsigned char>(digits[i])];
+            if (value < 0)
+                return false;
+            carry = carry * 58 + value;
+        }
+        digits.remove_prefix(n);
+        for (auto i = maxWords; i-- > 0;)
+        {
+            auto const value = words[i] * scale + carry;
+            words[i] = static_cast<std::uint32_t>(value);
+            carry = value >> 32;
+        }
+        if (carry)
+            return false;
+    }
+
+    TokenBytes bytes;
+    for (std::size_t i = 0; i < maxWords; ++i)
+        boost::endian::store_big_u32(bytes.data() + 4 * i, words[i]);
+    auto const token = bytes.data() + bytes.size() - tokenSize;
+    auto const nonZero = [](auto b) { return b != 0; };
+    // The value must fit the token, with exactly as many leading zero
+    // bytes as there were zero digits
+    if (std::any_of(bytes.data(), token, nonZero) ||
+        std::find_if(token, token + tokenSize, nonZero) - token !=
+            static_cast<std::ptrdiff_t>(zeros))
+        return false;
+    if (token[0] != static_cast<std::uint8_t>(type))
+        return false;
+    std::uint8_t check[4];
+    checksum(check, token, tokenSize - 4);
+    if (std::memcmp(check, token + tokenSize - 4, 4))
+        return false;
+    std::memcpy(out, token + 1, size);
+    return true;
+}
+
+void
+encodeTokens(
+    ripple::TokenType type,
+    ripple::Slice const* payloads,
+    std::size_t count,
+    std::string* out)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = encodeToken(type, payloads[i]);
+}
+
+std::size_t
+decodeTokens(
+    std::string_view const* texts,
+    std::size_t count,
+    ripple::TokenType type,
+    std::uint8_t* out,
+    std::size_t size)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (!decodeToken(texts[i], type, out + i * size, size))
+            return i;
+    }
+    return count;
+}
+
+std::string
+encodeAccount(ripple::AccountID const& account)
+{
+    return encodeToken(
+        ripple::TokenType::AccountID,
+        ripple::Slice(account.data(), account.size()));
+}
+
+std::optional<ripple::AccountID>
+decodeAccount(std::string_view text)
+{
+    ripple::AccountID account;
+    if (!decodeToken(
+            text, ripple::TokenType::AccountID, account.data(), account.size()))
+        return std::nullopt;
+    return account;
+}
+
+std::optional<ripple::Seed>
+decodeSeed(std::string_view text)
+{
+    std::array<std::uint8_t, 16> bytes;
+    if (!decodeToken(
+            text, ripple::TokenType::FamilySeed, bytes.data(), bytes.size()))
+        return std::nullopt;
+    return ripple::Seed(ripple::Slice(bytes.data(), bytes.size()));
+}
+
+}  // namespace offline
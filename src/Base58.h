@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_BASE58_H_INCLUDED
+#define OFFLINE_BASE58_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/Seed.h>
+#include <ripple/protocol/tokens.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace offline {
+
+/** Base58check for the fixed size payloads of keys and addresses.
+
+    The general codec converts one digit at a time, so its cost grows
+    with the square of the length. Every token here is at most 38
+    bytes, with its type byte and checksum, so these convert five
+    digits at a time through a few 32 bit words on the stack, without
+    allocating. The results are the same as `ripple::encodeBase58Token`
+    and `ripple::decodeBase58Token`.
+*/
+
+/// The largest payload, a public key.
+std::size_t constexpr maxTokenPayload = 33;
+
+/// The digits, in order of their values.
+char constexpr base58Alphabet[] =
+    "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+
+/** The base58check text of `payload` as a token of `type`.
+
+    @throws std::logic_error if the payload is too long
+*/
+std::string
+encodeToken(ripple::TokenType type, ripple::Slice payload);
+
+/** Decode `text` as a token of `type` with a payload of `size` bytes,
+    into `out`.
+
+    @return false if `text` isn't such a token
+*/
+bool
+decodeToken(
+    std::string_view text,
+    ripple::TokenType type,
+    std::uint8_t* out,
+    std::size_t size);
+
+/// Encode `count` payloads, each as a token of `type`, into `out`.
+void
+encodeTokens(
+    ripple::TokenType type,
+    ripple::Slice const* payloads,
+    std::size_t count,
+    std::string* out);
+
+/** Decode `count` texts, each as a token of `type` with a payload of
+    `size` bytes, into consecutive payloads of `out`.
+
+    @return the number decoded before the first that isn't a token,
+        or `count` if they all are
+*/
+std::size_t
+decodeTokens(
+    std::string_view const* texts,
+    std::size_t count,
+    ripple::TokenType type,
+    std::uint8_t* out,
+    std::size_t size);
+
+/// The same as `ripple::toBase58` of an account ID.
+std::string
+encodeAccount(ripple::AccountID const& account);
+
+/// The same as `ripple::parseBase58<ripple::AccountID>`.
+std::optional<ripple::AccountID>
+decodeAccount(std::string_view text);
+
+/// The same as `ripple::parseBase58<ripple::Seed>`.
+std::optional<ripple::Seed>
+decodeSeed(std::string_view text);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_BASE58_H_INCLUDED
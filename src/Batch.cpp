@@ -0,0 +1,418 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <AddressCache.h>
+#include <Batch.h>
+#include <Metrics.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+#include <Trace.h>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace offline {
+
+namespace {
+
+// Same order as metrics::Command
+enum class Op { serialize, deserialize, sign, multisign };
+
+struct Record
+{
+    std::uint64_t index;
+    std::size_t line;
+    std::string data;
+};
+
+struct Result
+{
+    std::size_t line;
+    std::string output;
+    std::string error;
+};
+
+/** Fixed capacity multi-producer, multi-consumer queue.
+
+    `push` blocks while the queue is full, and `pop` blocks while it is
+    empty and not yet closed.
+*/
+template <class T>
+class BoundedQueue
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<T> items_;
+    std::size_t const capacity_;
+    bool closed_ = false;
+
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity)
+    {
+    }
+
+    /// @return the number of queued items, including this one
+    std::size_t
+    push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return items_.size() < capacity_; });
+        items_.push_back(std::move(item));
+        auto const size = items_.size();
+        lock.unlock();
+        notEmpty_.notify_one();
+        return size;
+    }
+
+    /// @return false once the queue is closed and drained
+    bool
+    pop(T& item, std::size_t& remaining)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty())
+            return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        remaining = items_.size();
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void
+    close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+    }
+};
+
+/** Hands results to the writer in input order, whatever order they finish.
+
+    A worker that finishes a result too far ahead of the next one to be
+    written waits, so one slow record can't let the results after it
+    pile up without limit.
+*/
+class OrderedResults
+{
+private:
+    std::size_t const window_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable taken_;
+    std::map<std::uint64_t, Result> pending_;
+    // The index of the next result to be written
+    std::uint64_t next_ = 0;
+    bool closed_ = false;
+
+public:
+    /// @param window The most results, from the next one to be written on
+    explicit OrderedResults(std::size_t window) : window_(window)
+    {
+    }
+
+    /// @return the number of results waiting to be written
+    std::size_t
+    put(std::uint64_t index, Result result)
+    {
+        std::size_t size;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // The worker with the next result never waits, so this ends
+            taken_.wait(lock, [&] { return index - next_ < window_; });
+            pending_.emplace(index, std::move(result));
+            size = pending_.size();
+        }
+        ready_.notify_one();
+        return size;
+    }
+
+    /// @return false once closed and there is no result for `index`
+    bool
+    take(std::uint64_t index, Result& result)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(
+                lock, [&] { return closed_ || pending_.count(index); });
+            auto const iter = pending_.find(index);
+            if (iter == pending_.end())
+                return false;
+            result = std::move(iter->second);
+            pending_.erase(iter);
+            next_ = index + 1;
+        }
+        taken_.notify_all();
+        return true;
+    }
+
+    void
+    close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+};
+
+std::string
+process(
+    Op const op,
+    Record const& record,
+    std::optional<RippleKey> const& key,
+    AddressCache* addresses,
+    BatchOptions const& options)
+{
+    using namespace ripple;
+
+    auto const index = record.index;
+    switch (op)
+    {
+        case Op::serialize: {
+            std::optional<STObject> obj;
+            {
+                trace::Span span("parse", index);
+                auto json = parseJson(record.data);
+                if (json)
+                {
+                    if (addresses)
+                        addresses->resolve(json);
+                    obj = makeObject(std::move(json));
+                }
+                if (!obj)
+                    throw std::runtime_error("invalid JSON");
+            }
+            trace::Span span("write", index);
+            return serialize(*obj);
+        }
+        case Op::deserialize: {
+            if (options.output != OutputFormat::json)
+            {
+                trace::Span span("parse", index);
+                return decodeAs(record.data, options.type, options.output);
+            }
+            if (options.type != BlobType::generic)
+            {
+                Json::Value jv;
+                {
+                    trace::Span span("parse", index);
+                    jv = decode(record.data, options.type);
+                }
+                trace::Span span("write", index);
+                return toCompactJson(std::move(jv));
+            }
+            std::optional<STObject> obj;
+            {
+                trace::Span span("parse", index);
+                obj = deserialize(record.data);
+                if (!obj)
+                    throw std::runtime_error("Is this valid serialized data?");
+            }
+            trace::Span span("write", index);
+            return toCompactJson(obj->getJson(JsonOptions::none));
+        }
+        case Op::sign:
+        case Op::multisign: {
+            BOOST_ASSERT(key);
+            std::optional<STTx> tx;
+            {
+                trace::Span span("parse", index);
+                tx.emplace(make_sttx(record.data, addresses));
+            }
+            {
+                trace::Span span("sign", index);
+                auto const start = std::chrono::steady_clock::now();
+                if (op == Op::sign)
+                    key->singleSign(tx);
+                else
+                    key->multiSign(tx);
+                metrics::recordSignLatency(
+                    key->keyType(), std::chrono::steady_clock::now() - start);
+            }
+            {
+                trace::Span span("verify", index);
+                auto const check =
+                    tx->checkSign(STTx::RequireFullyCanonicalSig::yes);
+                if (!check)
+                    throw std::runtime_error(
+                        "Signature verification failed: " + check.error());
+            }
+            trace::Span span("write", index);
+            if (options.output != OutputFormat::json)
+                return encodeTransaction(*tx, options.output);
+            return toCompactJson(tx->getJson(JsonOptions::none));
+        }
+    }
+    // LCOV_EXCL_START
+    throw std::logic_error("Unhandled batch operation");
+    // LCOV_EXCL_STOP
+}
+
+}  // namespace
+
+int
+runBatch(
+    std::string const& command,
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    boost::filesystem::path const& keyFile,
+    BatchOptions const& options)
+{
+    static std::map<std::string, Op> const commands = {
+        {"serialize", Op::serialize},
+        {"deserialize", Op::deserialize},
+        {"sign", Op::sign},
+        {"multisign", Op::multisign},
+    };
+
+    auto const iCommand = commands.find(command);
+    if (iCommand == commands.end())
+        throw std::runtime_error(
+            "Command does not support batch mode: " + command);
+    auto const op = iCommand->second;
+    bool const binary = options.output != OutputFormat::json;
+    if (binary && op == Op::serialize)
+        throw std::runtime_error(
+            "Command does not support binary output: " + command);
+    // Stands in for a failed record
+    auto const null = binary ? encodeNull(options.output) : std::string{};
+
+    std::optional<RippleKey> key;
+    if (op == Op::sign || op == Op::multisign)
+        key.emplace(RippleKey::make_RippleKey(keyFile));
+    // Only JSON records name accounts by address
+    std::optional<AddressCache> addresses;
+    if (op != Op::deserialize && options.addressCache)
+        addresses.emplace(options.addressCache);
+
+    auto const threads = options.threads
+        ? options.threads
+        : std::max(1u, std::thread::hardware_concurrency());
+    auto const queueDepth =
+        options.queueDepth ? options.queueDepth : threads * 4;
+    BoundedQueue<Record> queue(queueDepth);
+    // Room for every worker's result and the queued records behind them
+    OrderedResults results(threads + queueDepth);
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&, i] {
+            trace::setThreadName("worker " + std::to_string(i));
+            Record record;
+            std::size_t remaining;
+            while (queue.pop(record, remaining))
+            {
+                trace::counter("input queue", remaining);
+                metrics::setQueueDepth(metrics::Queue::input, remaining);
+                Result result{record.line, {}, {}};
+                try
+                {
+                    result.output = process(
+                        op,
+                        record,
+                        key,
+                        addresses ? &*addresses : nullptr,
+                        options);
+                }
+                catch (std::exception const& e)
+                {
+                    result.error = e.what();
+                }
+                auto const pending =
+                    results.put(record.index, std::move(result));
+                trace::counter("reorder buffer", pending);
+                metrics::setQueueDepth(metrics::Queue::reorder, pending);
+            }
+        });
+    }
+
+    std::size_t failures = 0;
+    std::thread writer([&] {
+        trace::setThreadName("writer");
+        Result result;
+        for (std::uint64_t index = 0; results.take(index, result); ++index)
+        {
+            trace::Span span("output", index);
+            metrics::recordResult(
+                static_cast<metrics::Command>(op), result.error.empty());
+            if (!result.error.empty())
+            {
+                ++failures;
+                err << "Line " << result.line << ": Unable to " << command
+                    << ": " << result.error << "\n";
+                if (binary)
+                    result.output = null;
+            }
+            metrics::addBytesOut(result.output.size() + !binary);
+            out << result.output;
+            if (!binary)
+                out << "\n";
+        }
+        out.flush();
+    });
+
+    trace::setThreadName("reader");
+    std::uint64_t index = 0;
+    std::size_t lineNumber = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        metrics::addBytesIn(line.size() + 1);
+        boost::trim(line);
+        if (line.empty())
+            continue;
+        auto const queued =
+            queue.push(Record{index++, lineNumber, std::move(line)});
+        trace::counter("input queue", queued);
+        metrics::setQueueDepth(metrics::Queue::input, queued);
+        line.clear();
+    }
+    queue.close();
+    for (auto& worker : workers)
+        worker.join();
+    results.close();
+    writer.join();
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
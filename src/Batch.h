@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef OFFLINE_BATCH_H_INCLUDED
+#define OFFLINE_BATCH_H_INCLUDED
+
+#include <OutputFormat.h>
+#include <Serialize.h>
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace boost {
+namespace filesystem {
+class path;
+}
+}  // namespace boost
+
+namespace offline {
+
+struct BatchOptions
+{
+    /// Number of worker threads. Zero means one per hardware thread.
+    unsigned threads = 0;
+    /// Maximum records waiting for a worker. Zero means 4 per worker.
+    std::size_t queueDepth = 0;
+    /// What `deserialize` expects each record to hold.
+    BlobType type = BlobType::generic;
+    /// How `deserialize`, `sign` and `multisign` write results.
+    OutputFormat output = OutputFormat::json;
+    /// Most addresses in JSON records decoded once and reused by every
+    /// worker. Zero decodes every address on every record.
+    std::size_t addressCache = 65536;
+};
+
+/** Run one command over many records using a pool of worker threads.
+
+    Each non-blank line of `in` is one record. Results are written to
+    `out` in input order, one line per record. A record that fails
+    produces an empty output line, so output lines always correspond to
+    input records, and a message on `err`. With MessagePack or CBOR
+    output, results are written back to back instead of as lines, and a
+    record that fails produces a null value.
+
+    Supported commands are `serialize`, `deserialize`, `sign` and
+    `multisign`. The key file is read once, before any records.
+
+    @return EXIT_SUCCESS if every record succeeded, otherwise EXIT_FAILURE
+
+    @throws std::runtime_error if the command can not be run in batch mode
+*/
+int
+runBatch(
+    std::string const& command,
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    boost::filesystem::path const& keyFile,
+    BatchOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_BATCH_H_INCLUDED
@@ -0,0 +1,227 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Chain.h>
+#include <Parallel.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/json/json_reader.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+
+namespace offline {
+
+namespace {
+
+// Headers parsed and hashed in parallel at a time
+std::size_t constexpr chunkSize = 1 << 16;
+
+struct Parsed
+{
+    std::uint64_t line = 0;
+    std::optional<LedgerHeader> header;
+    ripple::uint256 hash;
+    /// The ledger_hash given alongside a JSON header, if any.
+    std::optional<ripple::uint256> claimed;
+    std::string error;
+};
+
+// The ledger_hash of a ledger result. Binary results give it beside the
+// "ledger" object, others within it.
+std::optional<ripple::uint256>
+claimedHash(Json::Value const& jv)
+{
+    auto const& root = jv.isMember("result") ? jv["result"] : jv;
+    auto const& value = root["ledger"].isMember("ledger_hash")
+        ? root["ledger"]["ledger_hash"]
+        : root["ledger_hash"];
+    if (value.isNull())
+        return std::nullopt;
+    ripple::uint256 hash;
+    if (!value.isString() || !hash.parseHex(value.asString()))
+        throw std::runtime_error("Invalid ledger_hash");
+    return hash;
+}
+
+LedgerHeader
+parseHeader(
+    std::string const& text,
+    std::optional<ripple::uint256>& claimed)
+{
+    if (text.front() == '{')
+    {
+        Json::Value jv;
+        if (!Json::Reader{}.parse(text, jv))
+            throw std::runtime_error("Invalid JSON");
+        auto dump = LedgerDump::fromJson(jv);
+        if (!dump.header)
+            throw std::runtime_error("No ledger header");
+        claimed = claimedHash(jv);
+        return *dump.header;
+    }
+    auto const blob = ripple::strUnHex(text);
+    if (!blob)
+        throw std::runtime_error("Invalid hex data");
+    return LedgerHeader::fromSlice(ripple::makeSlice(*blob));
+}
+
+// Why `header` does not follow `prev`, if it doesn't
+std::optional<std::string>
+checkLink(Parsed const& prev, LedgerHeader const& header)
+{
+    using ripple::to_string;
+
+    if (header.seq != prev.header->seq + 1)
+        return "Sequence " + std::to_string(header.seq) + " does not follow " +
+            std::to_string(prev.header->seq);
+    if (header.parentHash != prev.hash)
+        return "parent_hash " + to_string(header.parentHash) +
+            " is not the hash of the previous ledger, " + to_string(prev.hash);
+    if (header.parentCloseTime != prev.header->closeTime)
+        return "parent_close_time " + std::to_string(header.parentCloseTime) +
+            " is not the close time of the previous ledger, " +
+            std::to_string(prev.header->closeTime);
+    if (header.closeTime <= prev.header->closeTime)
+        return "close_time " + std::to_string(header.closeTime) +
+            " is not after the previous ledger's, " +
+            std::to_string(prev.header->closeTime);
+    return std::nullopt;
+}
+
+}  // namespace
+
+ChainSummary
+verifyChain(
+    std::istream& in,
+    std::function<void(ChainBreak const&)> const& onBreak,
+    unsigned threads)
+{
+    ChainSummary summary;
+    // The last header of the previous chunk
+    std::optional<Parsed> prev;
+    std::vector<Parsed> chunk;
+    std::vector<std::string> lines;
+    std::uint64_t lineNumber = 0;
+
+    auto const reportBreak = [&](Parsed const& p, std::string error) {
+        ++summary.breaks;
+        ChainBreak b;
+        b.line = p.line;
+        if (p.header)
+            b.seq = p.header->seq;
+        b.error = std::move(error);
+        onBreak(b);
+    };
+
+    for (bool more = true; more;)
+    {
+        lines.clear();
+        chunk.clear();
+        std::string line;
+        while (lines.size() < chunkSize && (more = !!std::getline(in, line)))
+        {
+            ++lineNumber;
+            boost::trim(line);
+            if (line.empty())
+                continue;
+            lines.push_back(std::move(line));
+            chunk.emplace_back().line = lineNumber;
+        }
+
+        parallelFor(lines.size(), threads, [&](std::uint64_t i) {
+            auto& p = chunk[i];
+            try
+            {
+                p.header = parseHeader(lines[i], p.claimed);
+                p.hash = p.header->hash();
+            }
+            catch (std::exception const& e)
+            {
+                p.error = e.what();
+            }
+        });
+
+        for (auto& p : chunk)
+        {
+            if (!p.header)
+            {
+                reportBreak(p, std::move(p.error));
+                prev.reset();
+                continue;
+            }
+            ++summary.ledgers;
+            if (!summary.first)
+                summary.first = p.header;
+            summary.last = p.header;
+            if (p.claimed && *p.claimed != p.hash)
+                reportBreak(
+                    p,
+                    "ledger_hash " + ripple::to_string(*p.claimed) +
+                        " is not the hash of the header, " +
+                        ripple::to_string(p.hash));
+            if (prev)
+            {
+                if (auto const error = checkLink(*prev, *p.header))
+                    reportBreak(p, *error);
+            }
+            prev = std::move(p);
+        }
+    }
+    return summary;
+}
+
+int
+runVerifyChain(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream&,
+    unsigned threads)
+{
+    auto const summary = verifyChain(
+        in,
+        [&out](ChainBreak const& b) {
+            Json::Value jv(Json::objectValue);
+            jv["line"] = static_cast<Json::UInt>(b.line);
+            if (b.seq)
+                jv["ledger_index"] = *b.seq;
+            jv["error"] = b.error;
+            out << toCompactJson(std::move(jv)) << "\n";
+        },
+        threads);
+
+    Json::Value jv(Json::objectValue);
+    jv["ledgers"] = static_cast<Json::UInt>(summary.ledgers);
+    jv["breaks"] = static_cast<Json::UInt>(summary.breaks);
+    if (summary.first)
+    {
+        jv["first_ledger_index"] = summary.first->seq;
+        jv["last_ledger_index"] = summary.last->seq;
+        jv["last_ledger_hash"] = ripple::to_string(summary.last->hash());
+    }
+    jv["verified"] = summary.breaks == 0;
+    out << toCompactJson(std::move(jv)) << std::endl;
+    return summary.breaks ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
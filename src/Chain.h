@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_CHAIN_H_INCLUDED
+#define OFFLINE_CHAIN_H_INCLUDED
+
+#include <Ledger.h>
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+namespace offline {
+
+/// A point at which a chain of ledger headers fails to verify.
+struct ChainBreak
+{
+    /// Input line of the header after the break.
+    std::uint64_t line = 0;
+    /// Its sequence, if it could be parsed.
+    std::optional<std::uint32_t> seq;
+    std::string error;
+};
+
+struct ChainSummary
+{
+    std::uint64_t ledgers = 0;
+    std::uint64_t breaks = 0;
+    std::optional<LedgerHeader> first;
+    std::optional<LedgerHeader> last;
+};
+
+/** Check the continuity of a chain of ledger headers.
+
+    Each line of `in` is a serialized header in hex, or a binary `ledger`
+    result. The headers are parsed and hashed in parallel, a chunk at a
+    time. A streaming pass then checks that each header follows the one
+    before it: the sequence is one higher, `parent_hash` is the hash of
+    the previous header, `parent_close_time` is its close time, and the
+    close time is later. A `ledger_hash` given with a JSON header must be
+    the hash of that header.
+
+    @param onBreak Called for each break, in input order.
+*/
+ChainSummary
+verifyChain(
+    std::istream& in,
+    std::function<void(ChainBreak const&)> const& onBreak,
+    unsigned threads);
+
+/** Verify the chain read from `in`, writing one line of JSON to `out`
+    for each break, followed by a summary line.
+
+    @return EXIT_SUCCESS if the chain has no breaks, otherwise EXIT_FAILURE
+*/
+int
+runVerifyChain(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_CHAIN_H_INCLUDED
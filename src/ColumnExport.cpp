@@ -0,0 +1,536 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <ColumnExport.h>
+#include <FieldScanner.h>
+#include <Ledger.h>
+#include <Parallel.h>
+#include <Serialize.h>
+#include <TreeHash.h>
+
+#include <ripple/json/json_reader.h>
+#include <ripple/protocol/SField.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <unordered_map>
+
+namespace offline {
+
+char const* const columnFileMagic = "XRPLCOL1";
+
+namespace {
+
+struct Row
+{
+    std::uint64_t line = 0;
+    ripple::Blob tx;
+    ripple::Blob meta;
+    std::optional<std::uint32_t> ledger;
+    ripple::uint256 hash;
+    /// Top level fields of the transaction and metadata, by code
+    std::vector<ScannedField> fields;
+
+    ScannedField const*
+    find(int code) const
+    {
+        auto const iter = std::lower_bound(
+            fields.begin(), fields.end(), code, [](auto const& f, int c) {
+                return f.code() < c;
+            });
+        if (iter == fields.end() || iter->code() != code)
+            return nullptr;
+        return &*iter;
+    }
+};
+
+void
+scanRow(Row& row)
+{
+    using namespace ripple;
+
+    row.hash = transactionID(makeSlice(row.tx));
+    ScannedField f;
+    for (FieldScanner scanner(makeSlice(row.tx)); scanner.next(f);)
+        row.fields.push_back(f);
+    for (FieldScanner scanner(makeSlice(row.meta)); scanner.next(f);)
+        row.fields.push_back(f);
+    for (auto const& field : row.fields)
+    {
+        // Dictionary entries are fixed width
+        if (field.type == ripple::STI_ACCOUNT && field.value.size() != 20)
+            throw std::runtime_error("Invalid AccountID length");
+    }
+    // If a field is in both, the transaction's is kept
+    auto const less = [](auto const& a, auto const& b) {
+        return a.code() < b.code();
+    };
+    auto const equal = [](auto const& a, auto const& b) {
+        return a.code() == b.code();
+    };
+    std::stable_sort(row.fields.begin(), row.fields.end(), less);
+    row.fields.erase(
+        std::unique(row.fields.begin(), row.fields.end(), equal),
+        row.fields.end());
+}
+
+std::vector<Row>
+decodeLine(std::string const& line, std::uint64_t lineNumber)
+{
+    using namespace ripple;
+
+    std::vector<Row> rows;
+    if (line.front() == '{')
+    {
+        Json::Value jv;
+        if (!Json::Reader{}.parse(line, jv))
+            throw std::runtime_error("Invalid JSON");
+        auto dump = LedgerDump::fromJson(jv);
+        rows.resize(dump.transactions.size());
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            auto& row = rows[i];
+            row.line = lineNumber;
+            row.tx = std::move(dump.transactions[i].first);
+            row.meta = std::move(dump.transactions[i].second);
+            if (dump.header)
+                row.ledger = dump.header->seq;
+            scanRow(row);
+        }
+        return rows;
+    }
+
+    auto& row = rows.emplace_back();
+    row.line = lineNumber;
+    std::string_view const text(line);
+    auto const split = text.find_first_of(" \t,");
+    if (!unhexInto(text.substr(0, split), row.tx))
+        throw std::runtime_error("Invalid hex data");
+    if (split != std::string_view::npos)
+    {
+        auto const rest = text.find_first_not_of(" \t,", split);
+        if (rest != std::string_view::npos &&
+            !unhexInto(text.substr(rest), row.meta))
+            throw std::runtime_error("Invalid hex data");
+    }
+    scanRow(row);
+    return rows;
+}
+
+void
+appendLittleEndian(std::string& out, std::uint64_t value, unsigned width)
+{
+    for (unsigned i = 0; i < width; ++i, value >>= 8)
+        out += static_cast<char>(value & 0xFF);
+}
+
+struct ColumnChunk
+{
+    std::string name;
+    std::string type;
+    unsigned width = 0;
+    std::size_t values = 0;
+    std::string data;
+};
+
+/// Builds the chunk of one column for one row group.
+class ColumnWriter
+{
+public:
+    enum class Kind { unsignedInt, signedInt, fixedBinary, binary, dictionary };
+
+private:
+    ColumnChunk chunk_;
+    Kind kind_;
+    std::string bitmap_;
+    std::string values_;
+    std::vector<std::uint32_t> offsets_;
+    std::unordered_map<std::string, std::uint32_t> dictionary_;
+    std::string entries_;
+
+    void
+    present(std::size_t row)
+    {
+        bitmap_[row / 8] |= static_cast<char>(1 << (row % 8));
+        ++chunk_.values;
+    }
+
+public:
+    /** @param width the size of each integer or dictionary entry. Fixed
+            binary columns take the size of their first value.
+    */
+    ColumnWriter(std::string name, Kind kind, unsigned width, std::size_t rows)
+        : kind_(kind), bitmap_((rows + 7) / 8, '\0')
+    {
+        chunk_.name = std::move(name);
+        chunk_.width = width;
+        switch (kind)
+        {
+            case Kind::unsignedInt:
+                chunk_.type = "uint" + std::to_string(width * 8);
+                break;
+            case Kind::signedInt:
+                chunk_.type = "int" + std::to_string(width * 8);
+                break;
+            case Kind::fixedBinary:
+                chunk_.type = "fixed_binary";
+                break;
+            case Kind::binary:
+                chunk_.type = "binary";
+                break;
+            case Kind::dictionary:
+                chunk_.type = "dictionary";
+                break;
+        }
+    }
+
+    void
+    addInt(std::size_t row, std::uint64_t value)
+    {
+        present(row);
+        appendLittleEndian(values_, value, chunk_.width);
+    }
+
+    void
+    addBytes(std::size_t row, ripple::Slice value)
+    {
+        present(row);
+        auto const bytes = reinterpret_cast<char const*>(value.data());
+        if (kind_ == Kind::dictionary)
+        {
+            auto const [iter, inserted] = dictionary_.try_emplace(
+                std::string(bytes, value.size()),
+                static_cast<std::uint32_t>(dictionary_.size()));
+            if (inserted)
+                entries_.append(bytes, value.size());
+            appendLittleEndian(values_, iter->second, 4);
+            return;
+        }
+        if (kind_ == Kind::binary)
+            offsets_.push_back(static_cast<std::uint32_t>(values_.size()));
+        else if (!chunk_.width)
+            chunk_.width = static_cast<unsigned>(value.size());
+        values_.append(bytes, value.size());
+    }
+
+    bool
+    empty() const
+    {
+        return chunk_.values == 0;
+    }
+
+    ColumnChunk
+    finish()
+    {
+        chunk_.data = std::move(bitmap_);
+        if (kind_ == Kind::dictionary)
+        {
+            appendLittleEndian(chunk_.data, dictionary_.size(), 4);
+            chunk_.data += entries_;
+        }
+        else if (kind_ == Kind::binary)
+        {
+            offsets_.push_back(static_cast<std::uint32_t>(values_.size()));
+            for (auto const offset : offsets_)
+                appendLittleEndian(chunk_.data, offset, 4);
+        }
+        chunk_.data += values_;
+        return std::move(chunk_);
+    }
+};
+
+/// The columns of an amount field, split into typed parts.
+class AmountColumns
+{
+private:
+    ColumnWriter value_;
+    ColumnWriter exponent_;
+    ColumnWriter currency_;
+    ColumnWriter issuer_;
+    ColumnWriter mpt_;
+
+public:
+    AmountColumns(std::string const& name, std::size_t rows)
+        : value_(name + ".value", ColumnWriter::Kind::signedInt, 8, rows)
+        , exponent_(name + ".exponent", ColumnWriter::Kind::signedInt, 1, rows)
+        , currency_(
+              name + ".currency", ColumnWriter::Kind::dictionary, 20, rows)
+        , issuer_(name + ".issuer", ColumnWriter::Kind::dictionary, 20, rows)
+        , mpt_(
+              name + ".mpt_issuance_id",
+              ColumnWriter::Kind::dictionary,
+              24,
+              rows)
+    {
+    }
+
+    void
+    add(std::size_t row, ripple::Slice value)
+    {
+        static std::uint8_t const xrp[20] = {};
+        auto const amount = scannedAmount(value);
+        value_.addInt(row, static_cast<std::uint64_t>(amount.value));
+        exponent_.addInt(row, static_cast<std::uint8_t>(amount.exponent));
+        if (!amount.mptIssuanceID.empty())
+            mpt_.addBytes(row, amount.mptIssuanceID);
+        else if (amount.native())
+            currency_.addBytes(row, ripple::Slice(xrp, sizeof(xrp)));
+        else
+            currency_.addBytes(row, amount.currency);
+        if (!amount.issuer.empty())
+            issuer_.addBytes(row, amount.issuer);
+    }
+
+    void
+    finish(std::vector<ColumnChunk>& chunks)
+    {
+        for (auto writer : {&value_, &exponent_, &currency_, &issuer_, &mpt_})
+        {
+            if (!writer->empty())
+                chunks.push_back(writer->finish());
+        }
+    }
+};
+
+/// Encode the column, or the columns of an amount, of one field.
+std::vector<ColumnChunk>
+encodeField(int code, std::vector<Row> const& rows)
+{
+    using Kind = ColumnWriter::Kind;
+
+    auto const name = fieldName(code);
+    auto const type = code >> 16;
+    std::vector<ColumnChunk> chunks;
+
+    if (type == ripple::STI_AMOUNT)
+    {
+        AmountColumns columns(name, rows.size());
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            if (auto const f = rows[i].find(code))
+                columns.add(i, f->value);
+        }
+        columns.finish(chunks);
+        return chunks;
+    }
+
+    auto const [kind, width] = [&]() -> std::pair<Kind, unsigned> {
+        switch (type)
+        {
+            case ripple::STI_UINT8:
+                return {Kind::unsignedInt, 1};
+            case ripple::STI_UINT16:
+                return {Kind::unsignedInt, 2};
+            case ripple::STI_UINT32:
+                return {Kind::unsignedInt, 4};
+            case ripple::STI_UINT64:
+                return {Kind::unsignedInt, 8};
+            case ripple::STI_ACCOUNT:
+            case ripple::STI_UINT160:
+                return {Kind::dictionary, 20};
+            case ripple::STI_VL:
+            case ripple::STI_OBJECT:
+            case ripple::STI_ARRAY:
+            case ripple::STI_PATHSET:
+            case ripple::STI_VECTOR256:
+            case ripple::STI_ISSUE:
+            case ripple::STI_XCHAIN_BRIDGE:
+                return {Kind::binary, 0};
+            default:
+                // The other types are fixed width hashes and numbers
+                return {Kind::fixedBinary, 0};
+        }
+    }();
+    ColumnWriter writer(name, kind, width, rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        auto const f = rows[i].find(code);
+        if (!f)
+            continue;
+        if (kind == Kind::unsignedInt)
+            writer.addInt(i, scannedUInt(f->value));
+        else
+            writer.addBytes(i, f->value);
+    }
+    chunks.push_back(writer.finish());
+    return chunks;
+}
+
+/// Writes row groups, and records their layout for the footer.
+class ColumnFile
+{
+private:
+    std::ostream& out_;
+    std::uint64_t offset_ = 0;
+    std::string footer_;
+
+public:
+    explicit ColumnFile(std::ostream& out) : out_(out)
+    {
+        out_ << columnFileMagic;
+        offset_ = std::char_traits<char>::length(columnFileMagic);
+    }
+
+    void
+    writeRowGroup(std::size_t rows, std::vector<ColumnChunk> const& chunks)
+    {
+        // Column names need no escaping
+        footer_ += footer_.empty() ? "" : ",";
+        footer_ += "{\"rows\":" + std::to_string(rows) + ",\"columns\":[";
+        char const* separator = "";
+        for (auto const& chunk : chunks)
+        {
+            footer_ += separator;
+            footer_ += "{\"name\":\"" + chunk.name + "\",\"type\":\"" +
+                chunk.type + "\"";
+            if (chunk.type == "fixed_binary" || chunk.type == "dictionary")
+                footer_ += ",\"width\":" + std::to_string(chunk.width);
+            footer_ += ",\"offset\":" + std::to_string(offset_) +
+                ",\"size\":" + std::to_string(chunk.data.size()) +
+                ",\"values\":" + std::to_string(chunk.values) + "}";
+            separator = ",";
+            out_.write(chunk.data.data(), chunk.data.size());
+            offset_ += chunk.data.size();
+        }
+        footer_ += "]}";
+    }
+
+    void
+    finish()
+    {
+        auto const footer =
+            "{\"format\":\"xrpl-columns\",\"version\":1,\"row_groups\":[" +
+            footer_ + "]}";
+        std::string length;
+        appendLittleEndian(length, footer.size(), 4);
+        out_ << footer << length << columnFileMagic;
+        out_.flush();
+    }
+};
+
+std::vector<ColumnChunk>
+encodeRowGroup(std::vector<Row> const& rows, unsigned threads)
+{
+    using Kind = ColumnWriter::Kind;
+
+    std::vector<ColumnChunk> chunks;
+    ColumnWriter hash("hash", Kind::fixedBinary, 0, rows.size());
+    ColumnWriter ledger("ledger_index", Kind::unsignedInt, 4, rows.size());
+    std::vector<int> codes;
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        hash.addBytes(
+            i, ripple::Slice(rows[i].hash.data(), rows[i].hash.size()));
+        if (rows[i].ledger)
+            ledger.addInt(i, *rows[i].ledger);
+        for (auto const& f : rows[i].fields)
+            codes.push_back(f.code());
+    }
+    chunks.push_back(hash.finish());
+    if (!ledger.empty())
+        chunks.push_back(ledger.finish());
+
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+    std::vector<std::vector<ColumnChunk>> fields(codes.size());
+    parallelFor(codes.size(), threads, [&](std::uint64_t i) {
+        fields[i] = encodeField(codes[i], rows);
+    });
+    for (auto& field : fields)
+        std::move(field.begin(), field.end(), std::back_inserter(chunks));
+    return chunks;
+}
+
+}  // namespace
+
+int
+runExportColumns(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    ColumnExportOptions const& options)
+{
+    if (!options.rowGroupLines)
+        throw std::runtime_error("The row group size must be positive");
+
+    ColumnFile file(out);
+    std::size_t failures = 0;
+    std::vector<std::string> lines;
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<std::vector<Row>> decoded;
+    std::vector<std::string> errors;
+    std::vector<Row> rows;
+    std::uint64_t lineNumber = 0;
+    for (bool more = true; more;)
+    {
+        lines.clear();
+        lineNumbers.clear();
+        std::string line;
+        while (lines.size() < options.rowGroupLines &&
+               (more = !!std::getline(in, line)))
+        {
+            ++lineNumber;
+            boost::trim(line);
+            if (line.empty())
+                continue;
+            lines.push_back(std::move(line));
+            lineNumbers.push_back(lineNumber);
+        }
+
+        decoded.assign(lines.size(), {});
+        errors.assign(lines.size(), {});
+        parallelFor(lines.size(), options.threads, [&](std::uint64_t i) {
+            try
+            {
+                decoded[i] = decodeLine(lines[i], lineNumbers[i]);
+            }
+            catch (std::exception const& e)
+            {
+                decoded[i].clear();
+                errors[i] = e.what();
+            }
+        });
+
+        rows.clear();
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            if (!errors[i].empty())
+            {
+                ++failures;
+                err << "Line " << lineNumbers[i] << ": " << errors[i]
+                    << "\n";
+            }
+            std::move(
+                decoded[i].begin(), decoded[i].end(), std::back_inserter(rows));
+        }
+        if (!rows.empty())
+            file.writeRowGroup(
+                rows.size(), encodeRowGroup(rows, options.threads));
+    }
+    file.finish();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_COLUMNEXPORT_H_INCLUDED
+#define OFFLINE_COLUMNEXPORT_H_INCLUDED
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace offline {
+
+/** The magic number at the start and end of a column file. */
+extern char const* const columnFileMagic;
+
+struct ColumnExportOptions
+{
+    /// Input lines decoded into each row group.
+    std::size_t rowGroupLines = 65536;
+    /// Number of worker threads. Zero means one per hardware thread.
+    unsigned threads = 0;
+};
+
+/** Write the transactions read from `in` to `out` as a column file.
+
+    Input is the same as `runAggregate`: a transaction in hex, optionally
+    followed by its metadata, or a binary `ledger` result, per line.
+    Each row is a transaction, and each top level transaction and
+    metadata field is a column, along with the computed `hash`, and
+    `ledger_index` for rows from `ledger` results.
+
+    The file is the magic number, the row groups, a footer of compact
+    JSON, the footer's length as a little endian 32 bit integer, and the
+    magic number again. The footer lists each row group's row count and
+    column chunks:
+
+    @code
+    {"format":"xrpl-columns","version":1,"row_groups":[{"rows":2,
+    "columns":[{"name":"Fee","type":"uint64","offset":8,"size":17,
+    "values":2}, ...]}]}
+    @endcode
+
+    A column chunk is a bitmap of the rows that have a value (least
+    significant bit first), then the values of those rows. Numbers are
+    little endian. Column types are:
+
+    - `uint8` to `uint64` and `int8`, `int64`: fixed width integers.
+    - `fixed_binary`: `width` bytes per value.
+    - `dictionary`: a 32 bit count of `width` byte entries, the entries
+      in order of first use, then a 32 bit entry index per value.
+      AccountIDs and currency codes use dictionaries.
+    - `binary`: 32 bit offsets, one more than there are values, then
+      the bytes. Objects, arrays and variable length fields are stored
+      as their encoded value.
+
+    An amount field `X` is split into `X.value` (int64 drops, or the
+    mantissa), `X.exponent` (int8), `X.currency` (a dictionary, with all
+    zeros for XRP), `X.issuer` (a dictionary) and `X.mpt_issuance_id`
+    (a dictionary). Row groups can have different columns, and a
+    column missing from a row group has no values in it.
+
+    Lines are decoded in parallel, and then the columns of each row
+    group are encoded in parallel.
+
+    @return EXIT_SUCCESS if every line was exported, otherwise
+        EXIT_FAILURE
+*/
+int
+runExportColumns(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    ColumnExportOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_COLUMNEXPORT_H_INCLUDED
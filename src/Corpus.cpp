@@ -0,0 +1,573 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <AccountIDs.h>
+#include <Corpus.h>
+#include <Parallel.h>
+#include <Serialize.h>
+
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/Seed.h>
+#include <ripple/protocol/TxFlags.h>
+#include <ripple/protocol/digest.h>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <ostream>
+
+namespace offline {
+
+namespace {
+
+constexpr std::array<char const*, 7> kindNames = {
+    "XRPPayment",
+    "IOUPayment",
+    "OfferCreate",
+    "TrustSet",
+    "AccountSet",
+    "SignerListSet",
+    "EscrowCreate"};
+
+constexpr std::array<char const*, 8> currencyCodes =
+    {"USD", "EUR", "BTC", "JPY", "CNY", "GBP", "ETH", "KRW"};
+
+// Ledger sequences and close times near the present, so that fields
+// like LastLedgerSequence and CancelAfter look plausible
+std::uint32_t constexpr ledgerBase = 80'000'000;
+std::uint32_t constexpr timeBase = 750'000'000;
+
+std::uint64_t
+mix64(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/// SplitMix64, which is small, fast, and the same on every platform.
+class Random
+{
+private:
+    std::uint64_t state_;
+
+public:
+    Random(std::uint64_t seed, std::uint64_t index)
+        : state_(mix64(seed + 0x9e3779b97f4a7c15ULL) ^ mix64(index))
+    {
+    }
+
+    std::uint64_t
+    next()
+    {
+        return mix64(state_ += 0x9e3779b97f4a7c15ULL);
+    }
+
+    std::uint32_t
+    u32()
+    {
+        return static_cast<std::uint32_t>(next());
+    }
+
+    /// Uniform in [lo, hi]. The modulo bias is negligible for our ranges.
+    std::uint64_t
+    between(std::uint64_t lo, std::uint64_t hi)
+    {
+        return lo + next() % (hi - lo + 1);
+    }
+
+    bool
+    chance(unsigned percent)
+    {
+        return next() % 100 < percent;
+    }
+
+    /// In [lo, hi], skewed toward lo, the way field sizes usually are.
+    std::uint64_t
+    skewed(std::uint64_t lo, std::uint64_t hi)
+    {
+        return std::min(between(lo, hi), between(lo, hi));
+    }
+
+    std::string
+    text(std::size_t size, char const* alphabet)
+    {
+        std::string const chars = alphabet;
+        std::string result(size, ' ');
+        for (auto& c : result)
+            c = chars[between(0, chars.size() - 1)];
+        return result;
+    }
+
+    ripple::Blob
+    bytes(std::size_t size)
+    {
+        ripple::Blob result(size);
+        for (auto& b : result)
+            b = static_cast<std::uint8_t>(next());
+        return result;
+    }
+};
+
+char const* const lowercase = "abcdefghijklmnopqrstuvwxyz";
+char const* const printable =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .,-";
+
+ripple::STAmount
+xrpAmount(Random& rng)
+{
+    // Spread over magnitudes, from 1 drop to 100,000 XRP
+    auto const magnitude = rng.between(0, 10);
+    std::uint64_t low = 1;
+    for (std::uint64_t i = 0; i < magnitude; ++i)
+        low *= 10;
+    return ripple::STAmount(rng.between(low, low * 10 - 1));
+}
+
+ripple::Currency
+currency(Random& rng)
+{
+    if (rng.chance(90))
+        return ripple::to_currency(
+            currencyCodes[rng.between(0, currencyCodes.size() - 1)]);
+    // A nonstandard currency code. A nonzero first byte keeps it from
+    // being read as an ISO code.
+    ripple::Currency result;
+    for (auto& b : result)
+        b = static_cast<std::uint8_t>(rng.next());
+    result.data()[0] = static_cast<std::uint8_t>(rng.between(1, 255));
+    return result;
+}
+
+ripple::STAmount
+iouAmount(
+    Random& rng,
+    ripple::Currency const& currency,
+    ripple::AccountID const& issuer)
+{
+    // Drawn in order, not as arguments, to be the same on every compiler
+    auto const mantissa = rng.between(1, 9'999'999);
+    auto const exponent = static_cast<int>(rng.between(0, 10)) - 6;
+    return ripple::STAmount(
+        ripple::Issue(currency, issuer), mantissa, exponent);
+}
+
+}  // namespace
+
+Encoding
+parseEncoding(std::string const& name)
+{
+    if (name == "hex")
+        return Encoding::hex;
+    if (name == "json")
+        return Encoding::json;
+    throw std::runtime_error("Unknown encoding: " + name);
+}
+
+std::string
+encode(ripple::STObject const& object, Encoding encoding)
+{
+    switch (encoding)
+    {
+        case Encoding::hex:
+            return serialize(object);
+        case Encoding::json:
+            return toCompactJson(object.getJson(ripple::JsonOptions::none));
+    }
+    // LCOV_EXCL_START
+    throw std::logic_error("Unhandled encoding");
+    // LCOV_EXCL_STOP
+}
+
+std::array<unsigned, 7>
+parseCorpusMix(std::string const& mix)
+{
+    std::array<unsigned, 7> result{};
+    std::vector<std::string> entries;
+    boost::split(entries, mix, [](char c) { return c == ','; });
+    for (auto entry : entries)
+    {
+        boost::trim(entry);
+        auto const eq = entry.find('=');
+        auto const name =
+            boost::trim_copy(entry.substr(0, std::min(eq, entry.size())));
+        auto const iter =
+            std::find(kindNames.begin(), kindNames.end(), name);
+        if (eq == std::string::npos || iter == kindNames.end())
+            throw std::runtime_error("Invalid transaction mix entry: " + entry);
+        try
+        {
+            auto const weight = std::stoul(entry.substr(eq + 1));
+            result[iter - kindNames.begin()] = static_cast<unsigned>(weight);
+        }
+        catch (std::exception const&)
+        {
+            throw std::runtime_error("Invalid transaction mix entry: " + entry);
+        }
+    }
+    return result;
+}
+
+Corpus::Corpus(CorpusOptions const& options) : options_(options)
+{
+    if (options_.accounts < 10)
+        throw std::runtime_error("A corpus needs at least 10 accounts.");
+    unsigned total = 0;
+    for (std::size_t i = 0; i < options_.mix.size(); ++i)
+        cumulativeMix_[i] = total += options_.mix[i];
+    if (!total)
+        throw std::runtime_error("The transaction mix is empty.");
+
+    // Deriving secp256k1 keys is relatively slow
+    std::vector<std::optional<RippleKey>> keys(options_.accounts);
+    parallelFor(keys.size(), options_.threads, [&](std::uint64_t i) {
+        keys[i].emplace(
+            i % 2 ? ripple::KeyType::ed25519 : ripple::KeyType::secp256k1,
+            ripple::generateSeed(
+                "gen-corpus " + std::to_string(options_.seed) + " " +
+                std::to_string(i)));
+    });
+    keys_.reserve(keys.size());
+    std::vector<ripple::PublicKey> publicKeys;
+    publicKeys.reserve(keys.size());
+    for (auto& key : keys)
+    {
+        publicKeys.push_back(key->publicKey());
+        keys_.push_back(std::move(*key));
+    }
+    accounts_.resize(publicKeys.size());
+    calcAccountIDs(publicKeys.data(), publicKeys.size(), accounts_.data());
+}
+
+CorpusKind
+Corpus::kind(std::uint64_t index) const
+{
+    Random rng(options_.seed, index);
+    auto const pick = rng.between(0, cumulativeMix_.back() - 1);
+    auto const iter = std::upper_bound(
+        cumulativeMix_.begin(), cumulativeMix_.end(), pick);
+    return static_cast<CorpusKind>(iter - cumulativeMix_.begin());
+}
+
+ripple::STTx
+Corpus::generate(std::uint64_t index) const
+{
+    using namespace ripple;
+
+    // The first draw picks the kind, the same as `kind`
+    auto const kind = this->kind(index);
+    Random rng(options_.seed, index);
+    rng.next();
+
+    auto const sender = rng.between(0, accounts_.size() - 1);
+    auto const account = accounts_[sender];
+    auto const other = [&] {
+        auto const offset = rng.between(1, accounts_.size() - 1);
+        return accounts_[(sender + offset) % accounts_.size()];
+    };
+
+    // Function arguments are evaluated in an unspecified order, so every
+    // draw from `rng` is sequenced explicitly to keep output identical
+    // across compilers.
+    auto const anyIou = [&] {
+        auto const cur = currency(rng);
+        auto const issuer = other();
+        return iouAmount(rng, cur, issuer);
+    };
+
+    auto const common = [&](STObject& obj, std::uint32_t flags) {
+        obj.setAccountID(sfAccount, account);
+        obj.setFieldAmount(sfFee, STAmount(rng.skewed(10, 5000)));
+        obj.setFieldU32(sfSequence, rng.between(1, ledgerBase));
+        obj.setFieldU32(sfFlags, tfFullyCanonicalSig | flags);
+        obj.setFieldVL(sfSigningPubKey, keys_[sender].publicKey().slice());
+        if (rng.chance(60))
+            obj.setFieldU32(
+                sfLastLedgerSequence, ledgerBase + rng.between(0, 1000));
+        if (rng.chance(10))
+            obj.setFieldU32(sfSourceTag, rng.u32());
+        if (options_.maxMemoBytes && rng.chance(15))
+        {
+            STArray memos;
+            for (auto n = rng.between(1, 2); n; --n)
+            {
+                STObject memo(sfMemo);
+                std::string const type = "text/plain";
+                memo.setFieldVL(sfMemoType, Slice(type.data(), type.size()));
+                auto const data = rng.text(
+                    rng.skewed(1, options_.maxMemoBytes), printable);
+                memo.setFieldVL(
+                    sfMemoData, Slice(data.data(), data.size()));
+                memos.push_back(std::move(memo));
+            }
+            obj.setFieldArray(sfMemos, memos);
+        }
+    };
+
+    std::optional<STTx> tx;
+    switch (kind)
+    {
+        case CorpusKind::xrpPayment:
+            tx.emplace(ttPAYMENT, [&](STObject& obj) {
+                common(obj, 0);
+                obj.setAccountID(sfDestination, other());
+                obj.setFieldAmount(sfAmount, xrpAmount(rng));
+                if (rng.chance(30))
+                    obj.setFieldU32(sfDestinationTag, rng.u32());
+            });
+            break;
+        case CorpusKind::iouPayment:
+            tx.emplace(ttPAYMENT, [&](STObject& obj) {
+                bool const partial = rng.chance(20);
+                common(obj, partial ? tfPartialPayment : 0);
+                obj.setAccountID(sfDestination, other());
+                auto const cur = currency(rng);
+                auto const amount = iouAmount(rng, cur, other());
+                obj.setFieldAmount(sfAmount, amount);
+                if (partial)
+                    obj.setFieldAmount(
+                        sfDeliverMin,
+                        iouAmount(rng, cur, amount.getIssuer()));
+
+                auto const pathCount = rng.skewed(0, options_.maxPaths);
+                if (pathCount)
+                {
+                    // Cross currency, sent as XRP or another IOU
+                    obj.setFieldAmount(
+                        sfSendMax,
+                        rng.chance(50) ? xrpAmount(rng) : anyIou());
+                    STPathSet paths;
+                    for (std::uint64_t p = 0; p < pathCount; ++p)
+                    {
+                        std::vector<STPathElement> steps;
+                        for (auto s = rng.between(1, 3); s; --s)
+                        {
+                            if (rng.chance(50))
+                                steps.emplace_back(
+                                    other(), xrpCurrency(), xrpAccount());
+                            else
+                            {
+                                auto const cur = currency(rng);
+                                steps.emplace_back(xrpAccount(), cur, other());
+                            }
+                        }
+                        paths.push_back(STPath(std::move(steps)));
+                    }
+                    obj.setFieldPathSet(sfPaths, paths);
+                }
+                else if (rng.chance(50))
+                {
+                    obj.setFieldAmount(
+                        sfSendMax, iouAmount(rng, cur, account));
+                }
+                if (rng.chance(30))
+                    obj.setFieldU32(sfDestinationTag, rng.u32());
+            });
+            break;
+        case CorpusKind::offerCreate:
+            tx.emplace(ttOFFER_CREATE, [&](STObject& obj) {
+                std::uint32_t flags = 0;
+                if (rng.chance(10))
+                    flags |= tfPassive;
+                if (rng.chance(10))
+                    flags |= tfImmediateOrCancel;
+                if (rng.chance(20))
+                    flags |= tfSell;
+                common(obj, flags);
+                auto const pays = anyIou();
+                auto const gets = rng.chance(60) ? xrpAmount(rng) : anyIou();
+                bool const flip = rng.chance(50);
+                obj.setFieldAmount(sfTakerPays, flip ? gets : pays);
+                obj.setFieldAmount(sfTakerGets, flip ? pays : gets);
+                if (rng.chance(20))
+                    obj.setFieldU32(
+                        sfExpiration, timeBase + rng.between(0, 86400));
+                if (rng.chance(25))
+                    obj.setFieldU32(
+                        sfOfferSequence, rng.between(1, ledgerBase));
+            });
+            break;
+        case CorpusKind::trustSet:
+            tx.emplace(ttTRUST_SET, [&](STObject& obj) {
+                common(
+                    obj,
+                    rng.chance(50) ? tfSetNoRipple
+                                   : (rng.chance(10) ? tfClearNoRipple : 0));
+                obj.setFieldAmount(sfLimitAmount, anyIou());
+                if (rng.chance(5))
+                    obj.setFieldU32(sfQualityIn, rng.between(1, 2'000'000'000));
+                if (rng.chance(5))
+                    obj.setFieldU32(
+                        sfQualityOut, rng.between(1, 2'000'000'000));
+            });
+            break;
+        case CorpusKind::accountSet:
+            tx.emplace(ttACCOUNT_SET, [&](STObject& obj) {
+                common(obj, 0);
+                if (rng.chance(50))
+                    obj.setFieldU32(sfSetFlag, rng.between(1, 10));
+                else if (rng.chance(30))
+                    obj.setFieldU32(sfClearFlag, rng.between(1, 10));
+                if (rng.chance(40))
+                {
+                    auto const domain =
+                        rng.text(rng.skewed(3, 40), lowercase) + ".com";
+                    obj.setFieldVL(
+                        sfDomain, Slice(domain.data(), domain.size()));
+                }
+                if (rng.chance(10))
+                    obj.setFieldH128(
+                        sfEmailHash, uint128::fromVoid(rng.bytes(16).data()));
+                if (rng.chance(10))
+                    obj.setFieldU32(
+                        sfTransferRate,
+                        rng.between(1'000'000'000, 2'000'000'000));
+            });
+            break;
+        case CorpusKind::signerListSet:
+            tx.emplace(ttSIGNER_LIST_SET, [&](STObject& obj) {
+                common(obj, 0);
+                std::vector<std::pair<AccountID, std::uint16_t>> signers;
+                for (auto n = rng.skewed(1, 8); n; --n)
+                {
+                    auto const signer = other();
+                    if (std::none_of(
+                            signers.begin(), signers.end(), [&](auto const& s) {
+                                return s.first == signer;
+                            }))
+                        signers.emplace_back(signer, rng.between(1, 3));
+                }
+                std::sort(signers.begin(), signers.end());
+                STArray entries;
+                std::uint32_t totalWeight = 0;
+                for (auto const& [signer, weight] : signers)
+                {
+                    STObject entry(sfSignerEntry);
+                    entry.setAccountID(sfAccount, signer);
+                    entry.setFieldU16(sfSignerWeight, weight);
+                    entries.push_back(std::move(entry));
+                    totalWeight += weight;
+                }
+                obj.setFieldU32(sfSignerQuorum, rng.between(1, totalWeight));
+                obj.setFieldArray(sfSignerEntries, entries);
+            });
+            break;
+        case CorpusKind::escrowCreate:
+            tx.emplace(ttESCROW_CREATE, [&](STObject& obj) {
+                common(obj, 0);
+                obj.setAccountID(sfDestination, other());
+                obj.setFieldAmount(sfAmount, xrpAmount(rng));
+                auto const finishAfter = timeBase + rng.between(0, 86400 * 30);
+                if (rng.chance(70))
+                    obj.setFieldU32(sfFinishAfter, finishAfter);
+                if (!obj.isFieldPresent(sfFinishAfter) || rng.chance(50))
+                    obj.setFieldU32(
+                        sfCancelAfter,
+                        finishAfter + rng.between(3600, 86400 * 365));
+                if (rng.chance(30))
+                {
+                    // PREIMAGE-SHA-256 condition for a 32 byte preimage
+                    auto const preimage = rng.bytes(32);
+                    openssl_sha256_hasher hasher;
+                    hasher(preimage.data(), preimage.size());
+                    auto const fingerprint =
+                        static_cast<openssl_sha256_hasher::result_type>(hasher);
+                    Blob condition{0xA0, 0x25, 0x80, 0x20};
+                    condition.insert(
+                        condition.end(),
+                        fingerprint.begin(),
+                        fingerprint.end());
+                    condition.insert(condition.end(), {0x81, 0x01, 0x20});
+                    obj.setFieldVL(sfCondition, condition);
+                }
+                if (rng.chance(30))
+                    obj.setFieldU32(sfDestinationTag, rng.u32());
+            });
+            break;
+    }
+
+    if (options_.sign)
+        keys_[sender].singleSign(tx);
+    return std::move(*tx);
+}
+
+void
+writeCorpus(CorpusOptions const& options, std::ostream& out)
+{
+    Corpus const corpus(options);
+    auto const threads = workerCount(options.threads);
+
+    // Generate a block in parallel, then write it in order
+    std::uint64_t const blockSize = threads * 1024;
+    std::vector<std::string> lines;
+    for (std::uint64_t start = 0; start < options.count; start += blockSize)
+    {
+        lines.assign(std::min(blockSize, options.count - start), {});
+        parallelFor(lines.size(), threads, [&](std::uint64_t i) {
+            lines[i] = encode(corpus.generate(start + i), options.encoding);
+        });
+        for (auto const& line : lines)
+            out << line << '\n';
+    }
+    out.flush();
+}
+
+std::uint64_t
+checkRoundTrip(CorpusOptions const& options, std::ostream& err)
+{
+    using namespace ripple;
+
+    Corpus const corpus(options);
+    std::atomic<std::uint64_t> failures{0};
+    std::mutex errMutex;
+    parallelFor(options.count, options.threads, [&](std::uint64_t i) {
+        std::string problem;
+        try
+        {
+            auto const hex = serialize(corpus.generate(i));
+            auto const obj = deserialize(hex);
+            if (!obj)
+                problem = "Unable to deserialize";
+            else if (serialize(*obj) != hex)
+                problem = "Binary round trip differs";
+            else if (serialize(*makeObject(obj->getJson(JsonOptions::none))) !=
+                     hex)
+                problem = "JSON round trip differs";
+        }
+        catch (std::exception const& e)
+        {
+            problem = e.what();
+        }
+        if (!problem.empty())
+        {
+            ++failures;
+            std::lock_guard<std::mutex> lock(errMutex);
+            auto const kind = static_cast<std::size_t>(corpus.kind(i));
+            err << "Record " << i << " (" << kindNames[kind]
+                << "): " << problem << "\n";
+        }
+    });
+    return failures;
+}
+
+}  // namespace offline
@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_CORPUS_H_INCLUDED
+#define OFFLINE_CORPUS_H_INCLUDED
+
+#include <RippleKey.h>
+
+#include <ripple/protocol/STTx.h>
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace offline {
+
+/// Output encodings for generated records.
+enum class Encoding { hex, json };
+
+/** Parse an encoding name.
+
+    @throws std::runtime_error if the name is not known
+*/
+Encoding
+parseEncoding(std::string const& name);
+
+/// Encode an object as one line of output, without the newline.
+std::string
+encode(ripple::STObject const& object, Encoding encoding);
+
+/// Kinds of transaction `Corpus` generates.
+enum class CorpusKind {
+    xrpPayment,
+    iouPayment,
+    offerCreate,
+    trustSet,
+    accountSet,
+    signerListSet,
+    escrowCreate,
+};
+
+struct CorpusOptions
+{
+    /// Number of records to generate.
+    std::uint64_t count = 1000;
+    /// Every record is a function of the seed and its index only.
+    std::uint64_t seed = 0;
+    /** Relative weight of each kind, indexed by `CorpusKind`.
+
+        The default roughly follows the mix of transactions on the
+        network.
+    */
+    std::array<unsigned, 7> mix = {30, 20, 20, 10, 10, 5, 5};
+    /// Number of generated accounts transactions are drawn between.
+    std::size_t accounts = 1000;
+    /// Largest memo, in bytes. Zero means no memos.
+    std::size_t maxMemoBytes = 64;
+    /// Most paths on an IOU payment.
+    std::size_t maxPaths = 3;
+    /// Sign each transaction with its account's key.
+    bool sign = false;
+    Encoding encoding = Encoding::hex;
+    /// Number of worker threads. Zero means one per hardware thread.
+    unsigned threads = 0;
+};
+
+/** Parse a transaction mix such as "XRPPayment=50,OfferCreate=50".
+
+    Kinds that are not named get weight zero. The kind names are
+    XRPPayment, IOUPayment, OfferCreate, TrustSet, AccountSet,
+    SignerListSet and EscrowCreate.
+
+    @throws std::runtime_error if the mix can not be parsed
+*/
+std::array<unsigned, 7>
+parseCorpusMix(std::string const& mix);
+
+/** Deterministic generator of valid, realistic transactions.
+
+    Record `i` is generated from its own random stream, seeded from the
+    corpus seed and `i`, so records can be generated in any order, on any
+    number of threads, with identical results. The random streams and
+    distributions are implemented here rather than taken from the
+    standard library, so that output does not depend on the platform.
+*/
+class Corpus
+{
+private:
+    CorpusOptions const options_;
+    std::vector<RippleKey> keys_;
+    std::vector<ripple::AccountID> accounts_;
+    std::array<unsigned, 7> cumulativeMix_;
+
+public:
+    /** Derive the account keys. Alternate accounts use secp256k1 and
+        ed25519 keys.
+
+        @throws std::runtime_error if the options are invalid
+    */
+    explicit Corpus(CorpusOptions const& options);
+
+    CorpusOptions const&
+    options() const
+    {
+        return options_;
+    }
+
+    /// Generate record `index`. Safe to call concurrently.
+    ripple::STTx
+    generate(std::uint64_t index) const;
+
+    /// The kind of record `index`.
+    CorpusKind
+    kind(std::uint64_t index) const;
+};
+
+/** Write `options.count` records to `out`, one per line.
+
+    Records are generated in parallel and written in index order.
+*/
+void
+writeCorpus(CorpusOptions const& options, std::ostream& out);
+
+/** Check that `serialize(deserialize(x)) == x` for every record of a
+    corpus, and that the record's JSON parses back to the same binary.
+
+    Failures are reported on `err` by record index.
+
+    @return The number of records that failed
+*/
+std::uint64_t
+checkRoundTrip(CorpusOptions const& options, std::ostream& err);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_CORPUS_H_INCLUDED
@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <AccountIDs.h>
+#include <Base58.h>
+#include <Derive.h>
+#include <Parallel.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/protocol/jss.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace offline {
+
+namespace {
+
+// Accounts derived before their lines are written
+std::size_t constexpr chunkSize = 4096;
+// Accounts a worker derives at a time, and hashes together
+std::size_t constexpr groupSize = 64;
+
+std::uint32_t
+parseOrdinal(std::string const& text, std::string const& range)
+{
+    std::size_t used = 0;
+    unsigned long long value = 0;
+    try
+    {
+        if (!text.empty() && std::isdigit(static_cast<unsigned char>(text[0])))
+            value = std::stoull(text, &used);
+    }
+    catch (std::exception const&)
+    {
+        used = 0;
+    }
+    if (!used || used != text.size() ||
+        value > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Invalid account range: " + range);
+    return static_cast<std::uint32_t>(value);
+}
+
+}  // namespace
+
+std::pair<std::uint32_t, std::uint32_t>
+parseAccountRange(std::string const& range)
+{
+    auto const dots = range.find("..");
+    if (dots == std::string::npos)
+    {
+        auto const ordinal = parseOrdinal(range, range);
+        return {ordinal, ordinal};
+    }
+    auto const first = parseOrdinal(range.substr(0, dots), range);
+    auto const last = parseOrdinal(range.substr(dots + 2), range);
+    if (first > last)
+        throw std::runtime_error("Invalid account range: " + range);
+    return {first, last};
+}
+
+int
+runDerive(
+    ripple::Seed const& seed,
+    std::ostream& out,
+    DeriveOptions const& options)
+{
+    using namespace ripple;
+
+    if (options.first > options.last)
+        throw std::runtime_error("Invalid account range");
+    if (options.keyDir)
+    {
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(*options.keyDir, ec);
+        if (!boost::filesystem::is_directory(*options.keyDir))
+            throw std::runtime_error(
+                "Cannot create directory: " + *options.keyDir);
+    }
+
+    FamilyGenerator const family(seed);
+    std::uint64_t const count =
+        std::uint64_t{options.last} - options.first + 1;
+    std::vector<std::string> outputs;
+    for (std::uint64_t begin = 0; begin < count; begin += chunkSize)
+    {
+        auto const size = std::min<std::uint64_t>(chunkSize, count - begin);
+        outputs.assign(size, {});
+        auto const groups = (size + groupSize - 1) / groupSize;
+        parallelFor(groups, options.threads, [&](std::uint64_t group) {
+            // Reused by every group a worker derives
+            thread_local std::vector<std::pair<PublicKey, SecretKey>> keys;
+            thread_local std::vector<PublicKey> publicKeys;
+            thread_local std::vector<AccountID> accountIDs;
+
+            auto const from = group * groupSize;
+            auto const to = std::min(from + groupSize, size);
+            auto const ordinal = [&](std::uint64_t i) {
+                return static_cast<std::uint32_t>(options.first + begin + i);
+            };
+            keys.clear();
+            publicKeys.clear();
+            for (auto i = from; i < to; ++i)
+            {
+                keys.push_back(family(ordinal(i)));
+                publicKeys.push_back(keys.back().first);
+            }
+            accountIDs.resize(publicKeys.size());
+            calcAccountIDs(
+                publicKeys.data(), publicKeys.size(), accountIDs.data());
+
+            for (std::size_t j = 0; j < keys.size(); ++j)
+            {
+                auto const account = encodeAccount(accountIDs[j]);
+                if (options.keyDir)
+                {
+                    auto const keyFile =
+                        boost::filesystem::path(*options.keyDir) /
+                        (account + ".json");
+                    if (exists(keyFile))
+                        throw std::runtime_error(
+                            "Refusing to overwrite existing key file: " +
+                            keyFile.string());
+                    RippleKey::make_RippleKey(
+                        family, ordinal(from + j), keys[j])
+                        .writeToFile(keyFile);
+                }
+
+                auto const& publicKey = publicKeys[j];
+                Json::Value jv(Json::objectValue);
+                jv["account_index"] = ordinal(from + j);
+                jv[jss::account_id] = account;
+                jv[jss::public_key] =
+                    encodeToken(TokenType::AccountPublic, publicKey.slice());
+                jv[jss::public_key_hex] = strHex(publicKey);
+                outputs[from + j] = toCompactJson(std::move(jv));
+            }
+        });
+        for (auto const& line : outputs)
+            out << line << "\n";
+    }
+    out << std::flush;
+    return EXIT_SUCCESS;
+}
+
+}  // namespace offline
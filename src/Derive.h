@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_DERIVE_H_INCLUDED
+#define OFFLINE_DERIVE_H_INCLUDED
+
+#include <ripple/protocol/Seed.h>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace offline {
+
+struct DeriveOptions
+{
+    /// First and last account ordinals, inclusive.
+    std::uint32_t first = 0;
+    std::uint32_t last = 0;
+    /// If set, a key file is written to this directory for each account,
+    /// named by its account ID.
+    std::optional<std::string> keyDir;
+    /// Zero means one per hardware thread.
+    unsigned threads = 0;
+};
+
+/** Parse an inclusive range of account ordinals, "A..B", or a single
+    ordinal.
+
+    @throws std::runtime_error if the range is invalid or empty
+*/
+std::pair<std::uint32_t, std::uint32_t>
+parseAccountRange(std::string const& range);
+
+/** Write the secp256k1 accounts of a seed's family, one JSON object per
+    line in ordinal order, with the ordinal, account ID and public key.
+
+    The family's root is derived once, and the accounts in parallel.
+    Secret keys are only written to the key files.
+
+    @throws std::runtime_error if a key file can't be written, or
+        already exists
+*/
+int
+runDerive(
+    ripple::Seed const& seed,
+    std::ostream& out,
+    DeriveOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_DERIVE_H_INCLUDED
@@ -0,0 +1,317 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Diff.h>
+#include <FieldScanner.h>
+#include <Parallel.h>
+#include <ProtocolTables.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/protocol/SField.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+
+namespace offline {
+
+namespace {
+
+// Lines compared in parallel at a time
+std::size_t constexpr chunkSize = 4096;
+
+/// Walks two encodings side by side, recording where they differ.
+class Differ
+{
+private:
+    std::vector<int> const& ignore_;
+    std::vector<FieldDifference>& differences_;
+
+    static std::vector<ScannedField>
+    scan(ripple::Slice data)
+    {
+        std::vector<ScannedField> fields;
+        FieldScanner scanner(data);
+        ScannedField f;
+        while (scanner.next(f))
+            fields.push_back(f);
+        return fields;
+    }
+
+    bool
+    ignored(int code) const
+    {
+        return std::binary_search(ignore_.begin(), ignore_.end(), code);
+    }
+
+    void
+    add(std::string path,
+        FieldDifference::Change change,
+        ripple::Slice from,
+        ripple::Slice to)
+    {
+        differences_.push_back({std::move(path), change, from, to});
+    }
+
+    void
+    added(ScannedField const& f, std::string path)
+    {
+        if (!ignored(f.code()))
+            add(std::move(path), FieldDifference::Change::added, {}, f.value);
+    }
+
+    void
+    removed(ScannedField const& f, std::string path)
+    {
+        if (!ignored(f.code()))
+            add(std::move(path), FieldDifference::Change::removed, f.value, {});
+    }
+
+    // Both fields have the same code
+    void
+    changed(ScannedField const& from, ScannedField const& to, std::string path)
+    {
+        if (ignored(from.code()) || from.encoded == to.encoded)
+            return;
+        if (from.type == ripple::STI_OBJECT)
+            object(from.value, to.value, path + ".");
+        else if (from.type == ripple::STI_ARRAY)
+            array(from.value, to.value, path);
+        else
+            add(std::move(path),
+                FieldDifference::Change::changed,
+                from.value,
+                to.value);
+    }
+
+    void
+    array(ripple::Slice from, ripple::Slice to, std::string const& path)
+    {
+        auto const a = scan(from);
+        auto const b = scan(to);
+        for (std::size_t i = 0; i < std::max(a.size(), b.size()); ++i)
+        {
+            auto const element = path + "[" + std::to_string(i) + "].";
+            if (i < a.size() && i < b.size() && a[i].code() == b[i].code())
+            {
+                changed(a[i], b[i], element + fieldName(a[i].code()));
+                continue;
+            }
+            if (i < a.size())
+                removed(a[i], element + fieldName(a[i].code()));
+            if (i < b.size())
+                added(b[i], element + fieldName(b[i].code()));
+        }
+    }
+
+public:
+    Differ(
+        std::vector<int> const& ignore,
+        std::vector<FieldDifference>& differences)
+        : ignore_(ignore), differences_(differences)
+    {
+    }
+
+    // Fields are serialized in code order, so the two sides merge
+    void
+    object(ripple::Slice from, ripple::Slice to, std::string const& prefix)
+    {
+        if (from == to)
+            return;
+        auto const a = scan(from);
+        auto const b = scan(to);
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < a.size() || j < b.size())
+        {
+            if (j == b.size() || (i < a.size() && a[i].code() < b[j].code()))
+            {
+                removed(a[i], prefix + fieldName(a[i].code()));
+                ++i;
+            }
+            else if (i == a.size() || b[j].code() < a[i].code())
+            {
+                added(b[j], prefix + fieldName(b[j].code()));
+                ++j;
+            }
+            else
+            {
+                changed(a[i], b[j], prefix + fieldName(a[i].code()));
+                ++i;
+                ++j;
+            }
+        }
+    }
+};
+
+// Writes the JSON line for a pair that differs
+void
+compareLine(
+    std::string const& line,
+    std::uint64_t lineNumber,
+    std::vector<int> const& ignore,
+    std::string& output)
+{
+    using namespace ripple;
+
+    // Reused by every line a worker processes
+    thread_local Blob from;
+    thread_local Blob to;
+
+    auto const split = line.find_first_of(" \t,");
+    auto const rest = line.find_first_not_of(" \t,", split);
+    if (split == std::string::npos || rest == std::string::npos)
+        throw std::runtime_error("Expected two objects");
+    std::string_view const text(line);
+    if (!unhexInto(text.substr(0, split), from) ||
+        !unhexInto(text.substr(rest), to))
+        throw std::runtime_error("Invalid hex data");
+
+    auto const differences =
+        diffObjects(makeSlice(from), makeSlice(to), ignore);
+    if (differences.empty())
+        return;
+    output = "{\"line\":" + std::to_string(lineNumber) + ",\"differences\":[";
+    for (auto const& d : differences)
+    {
+        if (&d != &differences.front())
+            output += ',';
+        output += "{\"field\":\"" + d.field + "\",\"change\":\"" +
+            to_string(d.change) + "\"";
+        if (d.change != FieldDifference::Change::added)
+            output += ",\"from\":\"" + strHex(d.from) + "\"";
+        if (d.change != FieldDifference::Change::removed)
+            output += ",\"to\":\"" + strHex(d.to) + "\"";
+        output += '}';
+    }
+    output += "]}\n";
+}
+
+}  // namespace
+
+char const*
+to_string(FieldDifference::Change change)
+{
+    switch (change)
+    {
+        case FieldDifference::Change::added:
+            return "added";
+        case FieldDifference::Change::removed:
+            return "removed";
+        case FieldDifference::Change::changed:
+            return "changed";
+    }
+    // LCOV_EXCL_START
+    throw std::logic_error("Unhandled change");
+    // LCOV_EXCL_STOP
+}
+
+std::vector<FieldDifference>
+diffObjects(
+    ripple::Slice from,
+    ripple::Slice to,
+    std::vector<int> const& ignore)
+{
+    std::vector<FieldDifference> differences;
+    Differ(ignore, differences).object(from, to, {});
+    return differences;
+}
+
+int
+runDiff(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    DiffOptions const& options)
+{
+    using namespace ripple;
+
+    std::vector<int> ignore;
+    for (auto const& name : options.ignore)
+    {
+        auto const& field = fieldByName(name);
+        if (field.fieldCode == sfInvalid.fieldCode)
+            throw std::runtime_error("Unknown field: " + name);
+        ignore.push_back(field.fieldCode);
+    }
+    std::sort(ignore.begin(), ignore.end());
+
+    std::uint64_t pairs = 0;
+    std::uint64_t different = 0;
+    std::size_t failures = 0;
+    std::vector<std::string> lines;
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<std::string> outputs;
+    std::vector<std::string> errors;
+    std::uint64_t lineNumber = 0;
+    for (bool more = true; more;)
+    {
+        lines.clear();
+        lineNumbers.clear();
+        std::string line;
+        while (lines.size() < chunkSize && (more = !!std::getline(in, line)))
+        {
+            ++lineNumber;
+            boost::trim(line);
+            if (line.empty())
+                continue;
+            lines.push_back(std::move(line));
+            lineNumbers.push_back(lineNumber);
+        }
+
+        outputs.assign(lines.size(), {});
+        errors.assign(lines.size(), {});
+        parallelFor(lines.size(), options.threads, [&](std::uint64_t i) {
+            try
+            {
+                compareLine(lines[i], lineNumbers[i], ignore, outputs[i]);
+            }
+            catch (std::exception const& e)
+            {
+                outputs[i].clear();
+                errors[i] = e.what();
+            }
+        });
+
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            ++pairs;
+            if (!errors[i].empty())
+            {
+                ++failures;
+                err << "Line " << lineNumbers[i] << ": " << errors[i]
+                    << "\n";
+            }
+            else if (!outputs[i].empty())
+            {
+                ++different;
+                out << outputs[i];
+            }
+        }
+    }
+    out << "{\"pairs\":" << pairs << ",\"different\":" << different
+        << ",\"failed\":" << failures << "}" << std::endl;
+    return failures || different ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_DIFF_H_INCLUDED
+#define OFFLINE_DIFF_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace offline {
+
+/// A field that differs between two serialized objects.
+struct FieldDifference
+{
+    enum class Change { added, removed, changed };
+
+    /** The path to the field, e.g. "Fee" or "Memos[0].Memo.MemoData".
+
+        Array elements are numbered by position, and named by their
+        wrapper object.
+    */
+    std::string field;
+    Change change = Change::changed;
+    /// The encoded values, pointing into the compared data. `from` is
+    /// empty for an added field, and `to` for a removed one.
+    ripple::Slice from;
+    ripple::Slice to;
+};
+
+/// The name of a change, as written by `diff`.
+char const*
+to_string(FieldDifference::Change change);
+
+/** Compare two serialized objects field by field.
+
+    Fields are matched by their codes, on the encoded form, without
+    decoding either side. Objects and arrays that differ are compared
+    in turn, so only the innermost fields that differ are listed.
+    Array elements are compared by position.
+
+    @param ignore The codes of fields that are never listed, at any
+        depth, in ascending order.
+
+    @return The differences, in field order
+    @throws std::runtime_error if either side is malformed
+*/
+std::vector<FieldDifference>
+diffObjects(
+    ripple::Slice from,
+    ripple::Slice to,
+    std::vector<int> const& ignore = {});
+
+struct DiffOptions
+{
+    /// Names of fields that are not compared.
+    std::vector<std::string> ignore;
+    /// 0 for one per core.
+    unsigned threads = 0;
+};
+
+/** Compare the pairs of serialized objects read from `in`.
+
+    Each line is two objects in hex, separated by white space or a
+    comma. Lines are compared in parallel. For each pair that differs,
+    a JSON line with its differences is written to `out`, in input
+    order, followed by a summary line.
+
+    @return EXIT_SUCCESS if every pair was read and none differ,
+        otherwise EXIT_FAILURE
+    @throws std::runtime_error if an ignored field is unknown
+*/
+int
+runDiff(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    DiffOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_DIFF_H_INCLUDED
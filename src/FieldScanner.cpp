@@ -0,0 +1,307 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <FieldScanner.h>
+
+#include <ripple/protocol/SField.h>
+#include <stdexcept>
+#include <string>
+
+namespace offline {
+
+namespace {
+
+// Objects and arrays end with a field of their own type and code 1
+int constexpr endMarkerField = 1;
+
+}  // namespace
+
+std::uint8_t
+FieldScanner::byte()
+{
+    if (pos_ >= size_)
+        throw std::runtime_error("Unexpected end of data");
+    return data_[pos_++];
+}
+
+void
+FieldScanner::skip(std::size_t n)
+{
+    if (n > size_ - pos_)
+        throw std::runtime_error("Unexpected end of data");
+    pos_ += n;
+}
+
+std::size_t
+FieldScanner::length()
+{
+    std::size_t const b1 = byte();
+    if (b1 <= 192)
+        return b1;
+    if (b1 <= 240)
+    {
+        std::size_t const b2 = byte();
+        return 193 + (b1 - 193) * 256 + b2;
+    }
+    if (b1 <= 254)
+    {
+        std::size_t const b2 = byte();
+        std::size_t const b3 = byte();
+        return 12481 + (b1 - 241) * 65536 + b2 * 256 + b3;
+    }
+    throw std::runtime_error("Invalid variable length");
+}
+
+void
+FieldScanner::fieldID(int& type, int& field)
+{
+    auto const b = byte();
+    type = b >> 4;
+    field = b & 0x0F;
+    if (type == 0)
+    {
+        type = byte();
+        if (type < 16)
+            throw std::runtime_error("Invalid field type");
+    }
+    if (field == 0)
+    {
+        field = byte();
+        if (field < 16)
+            throw std::runtime_error("Invalid field code");
+    }
+}
+
+void
+FieldScanner::skipFields(int endType)
+{
+    for (;;)
+    {
+        int type;
+        int field;
+        fieldID(type, field);
+        if (field == endMarkerField &&
+            (type == ripple::STI_OBJECT || type == ripple::STI_ARRAY))
+        {
+            if (type != endType)
+                throw std::runtime_error("Mismatched end marker");
+            return;
+        }
+        skipValue(type);
+    }
+}
+
+void
+FieldScanner::skipValue(int type)
+{
+    switch (type)
+    {
+        case ripple::STI_UINT8:
+            return skip(1);
+        case ripple::STI_UINT16:
+            return skip(2);
+        case ripple::STI_UINT32:
+            return skip(4);
+        case ripple::STI_UINT64:
+            return skip(8);
+        case ripple::STI_UINT96:
+            return skip(12);
+        case ripple::STI_UINT128:
+            return skip(16);
+        case ripple::STI_UINT160:
+        case ripple::STI_CURRENCY:
+            return skip(20);
+        case ripple::STI_UINT192:
+            return skip(24);
+        case ripple::STI_UINT256:
+            return skip(32);
+        case ripple::STI_UINT384:
+            return skip(48);
+        case ripple::STI_UINT512:
+            return skip(64);
+        case ripple::STI_AMOUNT: {
+            auto const first = byte();
+            --pos_;
+            // IOU, MPT or XRP
+            return skip(first & 0x80 ? 48 : first & 0x20 ? 33 : 8);
+        }
+        case ripple::STI_VL:
+        case ripple::STI_ACCOUNT:
+        case ripple::STI_VECTOR256:
+            return skip(length());
+        case ripple::STI_OBJECT:
+            return skipFields(ripple::STI_OBJECT);
+        case ripple::STI_ARRAY:
+            return skipFields(ripple::STI_ARRAY);
+        case ripple::STI_PATHSET:
+            for (;;)
+            {
+                auto const t = byte();
+                if (t == 0x00)
+                    return;
+                if (t == 0xFF)
+                    continue;
+                skip(
+                    ((t & 0x01) ? 20 : 0) + ((t & 0x10) ? 20 : 0) +
+                    ((t & 0x20) ? 20 : 0));
+            }
+        case ripple::STI_ISSUE: {
+            skip(20);
+            // XRP has no issuer
+            bool xrp = true;
+            for (auto i = pos_ - 20; i < pos_; ++i)
+                xrp = xrp && data_[i] == 0;
+            return skip(xrp ? 0 : 20);
+        }
+        case ripple::STI_XCHAIN_BRIDGE:
+            skip(length());
+            skipValue(ripple::STI_ISSUE);
+            skip(length());
+            return skipValue(ripple::STI_ISSUE);
+        default:
+            throw std::runtime_error(
+                "Unknown field type " + std::to_string(type));
+    }
+}
+
+bool
+FieldScanner::next(ScannedField& f)
+{
+    if (pos_ >= size_)
+        return false;
+    auto const start = pos_;
+    fieldID(f.type, f.field);
+    if (f.field == endMarkerField &&
+        (f.type == ripple::STI_OBJECT || f.type == ripple::STI_ARRAY))
+        throw std::runtime_error("Unexpected end marker");
+
+    auto valueStart = pos_;
+    std::size_t valueEnd;
+    switch (f.type)
+    {
+        case ripple::STI_VL:
+        case ripple::STI_ACCOUNT:
+        case ripple::STI_VECTOR256: {
+            auto const n = length();
+            valueStart = pos_;
+            skip(n);
+            valueEnd = pos_;
+            break;
+        }
+        case ripple::STI_OBJECT:
+        case ripple::STI_ARRAY:
+            skipValue(f.type);
+            // Less the end marker
+            valueEnd = pos_ - 1;
+            break;
+        default:
+            skipValue(f.type);
+            valueEnd = pos_;
+            break;
+    }
+    f.value = ripple::Slice(data_ + valueStart, valueEnd - valueStart);
+    f.encoded = ripple::Slice(data_ + start, pos_ - start);
+    return true;
+}
+
+bool
+FieldScanner::find(int code, ScannedField& f)
+{
+    for (;;)
+    {
+        auto const before = pos_;
+        if (!next(f))
+            return false;
+        if (f.code() == code)
+            return true;
+        if (f.code() > code)
+        {
+            // Leave the later field to be found next
+            pos_ = before;
+            return false;
+        }
+    }
+}
+
+std::uint64_t
+scannedUInt(ripple::Slice value)
+{
+    if (value.size() > 8)
+        throw std::runtime_error("Integer is too large");
+    std::uint64_t result = 0;
+    for (auto const b : value)
+        result = (result << 8) | b;
+    return result;
+}
+
+ScannedAmount
+scannedAmount(ripple::Slice value)
+{
+    auto const part = [&value](std::size_t pos, std::size_t size) {
+        return ripple::Slice(value.data() + pos, size);
+    };
+    auto const withSign = [](std::uint64_t magnitude, bool positive) {
+        auto const v = static_cast<std::int64_t>(magnitude);
+        return positive ? v : -v;
+    };
+
+    ScannedAmount amount;
+    switch (value.size())
+    {
+        case 8: {
+            auto const bits = scannedUInt(value);
+            amount.value =
+                withSign(bits & ((1ull << 62) - 1), bits & (1ull << 62));
+            break;
+        }
+        case 48: {
+            auto const bits = scannedUInt(part(0, 8));
+            auto const mantissa = bits & ((1ull << 54) - 1);
+            amount.value = withSign(mantissa, bits & (1ull << 62));
+            if (mantissa)
+                amount.exponent = static_cast<int>((bits >> 54) & 0xFF) - 97;
+            amount.currency = part(8, 20);
+            amount.issuer = part(28, 20);
+            break;
+        }
+        case 33:
+            // Flags, the amount, then the issuance ID
+            amount.value = withSign(
+                scannedUInt(part(1, 8)) & ((1ull << 63) - 1), value[0] & 0x40);
+            amount.mptIssuanceID = part(9, 24);
+            break;
+        default:
+            throw std::runtime_error("Invalid amount length");
+    }
+    return amount;
+}
+
+std::string
+fieldName(int code)
+{
+    auto const& field = ripple::SField::getField(code);
+    if (field.fieldCode == ripple::sfInvalid.fieldCode)
+        return "field_" + std::to_string(code >> 16) + "_" +
+            std::to_string(code & 0xFFFF);
+    return field.getName();
+}
+
+}  // namespace offline
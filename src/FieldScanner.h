@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_FIELDSCANNER_H_INCLUDED
+#define OFFLINE_FIELDSCANNER_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace offline {
+
+/** A field found by `FieldScanner`, pointing into the scanned data. */
+struct ScannedField
+{
+    /// The field's type and field codes, as in `ripple::SField`.
+    int type = 0;
+    int field = 0;
+    /** The encoded value.
+
+        Variable length values exclude their length prefix, and objects
+        and arrays exclude their end marker, so an object or array value
+        can be scanned in turn.
+    */
+    ripple::Slice value;
+    /// The whole field, including its header.
+    ripple::Slice encoded;
+
+    /// The same as `ripple::SField::fieldCode`.
+    int
+    code() const
+    {
+        return (type << 16) | field;
+    }
+};
+
+/** Walks the fields of a serialized object without decoding them.
+
+    Values are located from the binary encoding alone, so the fields
+    that aren't wanted cost only the work of skipping them, and nothing
+    is allocated. The top level fields are visited in order. Objects
+    and arrays are skipped as a whole, and can be scanned separately.
+*/
+class FieldScanner
+{
+private:
+    std::uint8_t const* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+
+    std::uint8_t
+    byte();
+
+    void
+    skip(std::size_t n);
+
+    std::size_t
+    length();
+
+    void
+    fieldID(int& type, int& field);
+
+    void
+    skipValue(int type);
+
+    void
+    skipFields(int endType);
+
+public:
+    explicit FieldScanner(ripple::Slice data)
+        : data_(data.data()), size_(data.size())
+    {
+    }
+
+    /** Find the next field.
+
+        @return false when there are no more fields
+        @throws std::runtime_error if the data is malformed
+    */
+    bool
+    next(ScannedField& f);
+
+    /** Find the field with the given code, starting from the current
+        position.
+
+        Fields are serialized in code order, so the scan stops at the
+        first field with a larger code.
+    */
+    bool
+    find(int code, ScannedField& f);
+};
+
+/// Decode a big endian unsigned integer value of up to 8 bytes.
+std::uint64_t
+scannedUInt(ripple::Slice value);
+
+/// The parts of an encoded amount, pointing into the scanned data.
+struct ScannedAmount
+{
+    /// Drops for XRP, the mantissa for issued currencies, or the MPT
+    /// amount, with its sign.
+    std::int64_t value = 0;
+    int exponent = 0;
+    /// Issued currency amounts only.
+    ripple::Slice currency;
+    ripple::Slice issuer;
+    /// MPT amounts only.
+    ripple::Slice mptIssuanceID;
+
+    bool
+    native() const
+    {
+        return currency.empty() && mptIssuanceID.empty();
+    }
+};
+
+/** Decode an encoded amount of 8 (XRP), 33 (MPT) or 48 (issued
+    currency) bytes.
+
+    @throws std::runtime_error if the amount is another size
+*/
+ScannedAmount
+scannedAmount(ripple::Slice value);
+
+/** The name of the field with the given code, or `field_<type>_<field>`
+    for a field this build doesn't know.
+*/
+std::string
+fieldName(int code);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_FIELDSCANNER_H_INCLUDED
@@ -0,0 +1,413 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Ledger.h>
+#include <Parallel.h>
+#include <Serialize.h>
+#include <TreeHash.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <cstdlib>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+namespace offline {
+
+namespace {
+
+ripple::Blob
+unhex(Json::Value const& value, std::string const& what)
+{
+    auto blob =
+        value.isString() ? ripple::strUnHex(value.asString()) : std::nullopt;
+    if (!blob || blob->empty())
+        throw std::runtime_error("Invalid hex data in " + what);
+    return std::move(*blob);
+}
+
+ripple::uint256
+parseKey(Json::Value const& value, std::string const& what)
+{
+    ripple::uint256 key;
+    if (!value.isString() || !key.parseHex(value.asString()))
+        throw std::runtime_error("Invalid index in " + what);
+    return key;
+}
+
+// Run `f` on each dump read from `in`. `f` returns false if the dump
+// failed a check, but still produced output.
+int
+forEachDump(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    std::function<bool(LedgerDump const&, Json::Value&)> const& f)
+{
+    std::size_t failures = 0;
+    forEachJsonDocument(
+        in, [&](std::uint64_t n, Json::Value const& document) {
+            try
+            {
+                if (!document.isObject())
+                    throw std::runtime_error("Not a JSON object");
+                Json::Value jv;
+                if (!f(LedgerDump::fromJson(document), jv))
+                    ++failures;
+                out << toCompactJson(std::move(jv)) << "\n";
+            }
+            catch (std::exception const& e)
+            {
+                ++failures;
+                out << "\n";
+                err << "Document " << n << ": " << e.what() << "\n";
+            }
+        });
+    out.flush();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace
+
+LedgerHeader
+LedgerHeader::fromSlice(ripple::Slice data)
+{
+    using namespace ripple;
+
+    if (data.size() == size + 4)
+    {
+        SerialIter prefix(data.data(), 4);
+        if (prefix.get32() ==
+            static_cast<std::uint32_t>(HashPrefix::ledgerMaster))
+            data.remove_prefix(4);
+    }
+    if (data.size() != size)
+        throw std::runtime_error(
+            "A ledger header is " + std::to_string(size) + " bytes, not " +
+            std::to_string(data.size()));
+
+    SerialIter sit(data);
+    LedgerHeader header;
+    header.seq = sit.get32();
+    header.drops = sit.get64();
+    header.parentHash = sit.get256();
+    header.txHash = sit.get256();
+    header.accountHash = sit.get256();
+    header.parentCloseTime = sit.get32();
+    header.closeTime = sit.get32();
+    header.closeTimeResolution = sit.get8();
+    header.closeFlags = sit.get8();
+    return header;
+}
+
+ripple::Blob
+LedgerHeader::serialize() const
+{
+    ripple::Serializer s(size);
+    s.add32(seq);
+    s.add64(drops);
+    s.addBitString(parentHash);
+    s.addBitString(txHash);
+    s.addBitString(accountHash);
+    s.add32(parentCloseTime);
+    s.add32(closeTime);
+    s.add8(closeTimeResolution);
+    s.add8(closeFlags);
+    return s.getData();
+}
+
+ripple::uint256
+LedgerHeader::hash() const
+{
+    // The same as rippled's calculateLedgerHash
+    return ripple::sha512Half(
+        ripple::HashPrefix::ledgerMaster,
+        seq,
+        drops,
+        parentHash,
+        txHash,
+        accountHash,
+        parentCloseTime,
+        closeTime,
+        closeTimeResolution,
+        closeFlags);
+}
+
+Json::Value
+LedgerHeader::getJson() const
+{
+    using ripple::to_string;
+
+    Json::Value jv(Json::objectValue);
+    jv["ledger_index"] = seq;
+    jv["ledger_hash"] = to_string(hash());
+    // Can exceed the range of a JSON number
+    jv["total_coins"] = std::to_string(drops);
+    jv["parent_hash"] = to_string(parentHash);
+    jv["transaction_hash"] = to_string(txHash);
+    jv["account_hash"] = to_string(accountHash);
+    jv["parent_close_time"] = parentCloseTime;
+    jv["close_time"] = closeTime;
+    jv["close_time_resolution"] = closeTimeResolution;
+    jv["close_flags"] = closeFlags;
+    jv["closed"] = true;
+    return jv;
+}
+
+LedgerDump
+LedgerDump::fromJson(Json::Value const& result)
+{
+    auto const& root = result.isObject() && result.isMember("result")
+        ? result["result"]
+        : result;
+    if (!root.isObject())
+        throw std::runtime_error("Not a ledger result");
+    if (root.isMember("error"))
+        throw std::runtime_error(
+            "Result is an error: " + root["error"].asString());
+
+    LedgerDump dump;
+    bool found = false;
+
+    auto const readState = [&dump](Json::Value const& entries) {
+        for (auto const& entry : entries)
+        {
+            if (!entry.isObject())
+                throw std::runtime_error(
+                    "State entries must be requested with "
+                    "\"binary\": true and \"expand\": true");
+            dump.state.emplace_back(
+                parseKey(entry["index"], "state entry"),
+                unhex(entry["data"], "state entry"));
+        }
+    };
+
+    auto const& ledger = root["ledger"];
+    if (ledger.isObject())
+    {
+        if (!ledger.isMember("ledger_data"))
+            throw std::runtime_error(
+                "The ledger must be requested with \"binary\": true");
+        dump.header = LedgerHeader::fromSlice(
+            ripple::makeSlice(unhex(ledger["ledger_data"], "ledger_data")));
+        found = true;
+
+        if (ledger.isMember("transactions"))
+        {
+            for (auto const& tx : ledger["transactions"])
+            {
+                if (!tx.isObject())
+                    throw std::runtime_error(
+                        "Transactions must be requested with "
+                        "\"expand\": true");
+                dump.transactions.emplace_back(
+                    unhex(tx["tx_blob"], "tx_blob"),
+                    unhex(tx["meta"], "meta"));
+            }
+        }
+        if (ledger.isMember("accountState"))
+            readState(ledger["accountState"]);
+    }
+    // ledger_data results list the state separately
+    if (root.isMember("state"))
+    {
+        readState(root["state"]);
+        found = true;
+    }
+
+    if (!found)
+        throw std::runtime_error("No ledger or state data found");
+    return dump;
+}
+
+Json::Value
+decodeLedgerDump(LedgerDump const& dump, unsigned threads)
+{
+    using namespace ripple;
+
+    auto const txCount = dump.transactions.size();
+    std::vector<Json::Value> decoded(txCount + dump.state.size());
+    parallelFor(decoded.size(), threads, [&](std::uint64_t i) {
+        try
+        {
+            if (i < txCount)
+            {
+                auto const& [tx, meta] = dump.transactions[i];
+                auto jv = decode(makeSlice(tx), BlobType::tx);
+                jv["metaData"] = decode(makeSlice(meta), BlobType::meta);
+                decoded[i] = std::move(jv);
+            }
+            else
+            {
+                auto const& [key, data] = dump.state[i - txCount];
+                auto jv = decode(makeSlice(data), BlobType::ledgerEntry);
+                jv["index"] = to_string(key);
+                decoded[i] = std::move(jv);
+            }
+        }
+        catch (std::exception const& e)
+        {
+            throw std::runtime_error(
+                (i < txCount ? "Transaction " + std::to_string(i)
+                             : "State entry " + std::to_string(i - txCount)) +
+                ": " + e.what());
+        }
+    });
+
+    Json::Value result =
+        dump.header ? dump.header->getJson() : Json::Value(Json::objectValue);
+    if (txCount)
+    {
+        auto& txs = result["transactions"] = Json::arrayValue;
+        for (std::size_t i = 0; i < txCount; ++i)
+            txs.append(std::move(decoded[i]));
+    }
+    if (!dump.state.empty())
+    {
+        auto& state = result["accountState"] = Json::arrayValue;
+        for (auto i = txCount; i < decoded.size(); ++i)
+            state.append(std::move(decoded[i]));
+    }
+    return result;
+}
+
+void
+forEachJsonDocument(
+    std::istream& in,
+    std::function<void(std::uint64_t, Json::Value const&)> const& f)
+{
+    std::uint64_t n = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        boost::trim(line);
+        if (line.empty())
+            continue;
+        Json::Value jv;
+        bool const parsed = Json::Reader{}.parse(line, jv) && jv.isObject();
+        if (!parsed && n == 0)
+        {
+            // One document, spanning lines
+            std::stringstream ss;
+            ss << line << "\n" << in.rdbuf();
+            if (!Json::Reader{}.parse(ss.str(), jv) || !jv.isObject())
+                throw std::runtime_error("Input is not JSON");
+            f(1, jv);
+            return;
+        }
+        // One document per line. A line that is not an object is null.
+        f(++n, parsed ? jv : Json::Value{});
+    }
+}
+
+int
+runDeserializeLedger(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads)
+{
+    return forEachDump(
+        in, out, err, [threads](LedgerDump const& dump, Json::Value& jv) {
+            jv = decodeLedgerDump(dump, threads);
+            return true;
+        });
+}
+
+Json::Value
+verifyLedgerTxs(LedgerDump const& dump, unsigned threads)
+{
+    using namespace ripple;
+
+    if (!dump.header)
+        throw std::runtime_error("A ledger header is needed to verify");
+
+    auto const count = dump.transactions.size();
+    auto leaves = transactionLeaves(dump.transactions, threads);
+    // Empty if the transaction is good
+    std::vector<std::string> errors(count);
+    parallelFor(count, threads, [&](std::uint64_t i) {
+        try
+        {
+            SerialIter sit{makeSlice(dump.transactions[i].first)};
+            STTx const stx{sit};
+            // Pseudo-transactions are not signed. Fully canonical
+            // signatures were only required by a later amendment.
+            if (!isPseudoTx(stx))
+            {
+                if (auto const check = stx.checkSign(
+                        STTx::RequireFullyCanonicalSig::no);
+                    !check)
+                    errors[i] = check.error();
+            }
+        }
+        catch (std::exception const& e)
+        {
+            errors[i] = e.what();
+        }
+    });
+
+    auto const computed = treeRoot(std::move(leaves), threads);
+
+    Json::Value result(Json::objectValue);
+    result["ledger_index"] = dump.header->seq;
+    result["ledger_hash"] = to_string(dump.header->hash());
+    result["transaction_hash"] = to_string(dump.header->txHash);
+    result["computed_transaction_hash"] = to_string(computed);
+    result["transactions"] = static_cast<Json::UInt>(count);
+    auto& failures = result["failures"] = Json::arrayValue;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (errors[i].empty())
+            continue;
+        Json::Value failure(Json::objectValue);
+        failure["index"] = static_cast<Json::UInt>(i);
+        failure["hash"] =
+            to_string(transactionID(makeSlice(dump.transactions[i].first)));
+        failure["error"] = errors[i];
+        failures.append(std::move(failure));
+    }
+    result["verified"] = computed == dump.header->txHash && failures.empty();
+    return result;
+}
+
+int
+runVerifyLedgerTxs(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads)
+{
+    return forEachDump(
+        in, out, err, [threads](LedgerDump const& dump, Json::Value& jv) {
+            jv = verifyLedgerTxs(dump, threads);
+            return jv["verified"].asBool();
+        });
+}
+
+}  // namespace offline
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_LEDGER_H_INCLUDED
+#define OFFLINE_LEDGER_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace offline {
+
+/** A ledger header, as serialized by rippled for `binary` RPC results.
+
+    The wire format is 118 bytes: sequence (32 bits), total drops (64),
+    parent hash, transaction tree hash, state tree hash (256 each), parent
+    close time, close time (32 each), close time resolution and close
+    flags (8 each). It may be preceded by the 4 byte ledger master hash
+    prefix.
+*/
+struct LedgerHeader
+{
+    static std::size_t constexpr size = 118;
+
+    std::uint32_t seq = 0;
+    std::uint64_t drops = 0;
+    ripple::uint256 parentHash;
+    ripple::uint256 txHash;
+    ripple::uint256 accountHash;
+    std::uint32_t parentCloseTime = 0;
+    std::uint32_t closeTime = 0;
+    std::uint8_t closeTimeResolution = 0;
+    std::uint8_t closeFlags = 0;
+
+    /** Parse a serialized header.
+
+        @throws std::runtime_error if the data is not a ledger header
+    */
+    static LedgerHeader
+    fromSlice(ripple::Slice data);
+
+    ripple::Blob
+    serialize() const;
+
+    /// The ledger hash, computed from the header fields.
+    ripple::uint256
+    hash() const;
+
+    /// Fields named as in rippled's JSON results, including the hash.
+    Json::Value
+    getJson() const;
+};
+
+/** The binary contents of a `ledger` or `ledger_data` RPC result.
+
+    Either may be wrapped in a "result" object, as returned by the JSON
+    RPC or command line interfaces.
+*/
+struct LedgerDump
+{
+    std::optional<LedgerHeader> header;
+    /// Transaction and metadata blobs, in result order.
+    std::vector<std::pair<ripple::Blob, ripple::Blob>> transactions;
+    /// State entry keys and blobs, in result order.
+    std::vector<std::pair<ripple::uint256, ripple::Blob>> state;
+
+    /** Extract the binary fields of a result requested with
+        `"binary": true`.
+
+        @throws std::runtime_error if the result is malformed, or was
+            not requested as binary
+    */
+    static LedgerDump
+    fromJson(Json::Value const& result);
+};
+
+/** Decode every blob of a dump into JSON, in parallel.
+
+    The result is shaped like a `ledger` result requested with
+    `"expand": true` and without `"binary"`: header fields, plus
+    "transactions" with "metaData", and "accountState" with "index".
+*/
+Json::Value
+decodeLedgerDump(LedgerDump const& dump, unsigned threads);
+
+/** Check the transactions of a dump against its header.
+
+    Rebuilds the transaction tree from the transaction and metadata
+    blobs, compares its root with the header's transaction hash, and
+    checks the signature of every transaction. Transactions are hashed
+    and checked in parallel.
+
+    The result holds the ledger's index and hashes, the computed
+    "computed_transaction_hash", a "failures" array with the "index",
+    "hash" and "error" of each transaction that could not be parsed or
+    has a bad signature, and "verified", which is true if the hashes
+    match and there are no failures.
+
+    @throws std::runtime_error if the dump has no ledger header
+*/
+Json::Value
+verifyLedgerTxs(LedgerDump const& dump, unsigned threads);
+
+/** Read JSON documents from a stream, passing each to `f` before the
+    next is read.
+
+    The input is one document per line, unless its first non-empty line
+    is not a complete JSON object. Then the whole input is read as one
+    document, which may span lines.
+
+    `f` is given the number of the document, from 1, and the document.
+    A later line that is not a JSON object is passed as null.
+
+    @throws std::runtime_error if a single document can not be parsed
+*/
+void
+forEachJsonDocument(
+    std::istream& in,
+    std::function<void(std::uint64_t, Json::Value const&)> const& f);
+
+/** Decode every ledger dump read from `in`, writing one line of JSON per
+    dump to `out`.
+
+    Dumps are read as by `forEachJsonDocument`, so one dump per line is
+    decoded and written before the next is read.
+
+    @return EXIT_SUCCESS if every dump was decoded, otherwise EXIT_FAILURE
+*/
+int
+runDeserializeLedger(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads);
+
+/** Verify the transactions of every ledger dump read from `in`, writing
+    one line of JSON per dump to `out`, as each is read.
+
+    @return EXIT_SUCCESS if every ledger was verified, otherwise
+        EXIT_FAILURE
+*/
+int
+runVerifyLedgerTxs(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_LEDGER_H_INCLUDED
@@ -0,0 +1,364 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <Metrics.h>
+
+#include <boost/filesystem.hpp>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace offline {
+namespace metrics {
+
+namespace {
+
+constexpr std::array<char const*, 4> commandNames = {
+    "serialize",
+    "deserialize",
+    "sign",
+    "multisign"};
+
+constexpr std::array<char const*, 2> keyTypeNames = {"secp256k1", "ed25519"};
+
+// Upper bounds of the signing latency buckets, in nanoseconds
+constexpr std::array<std::uint64_t, 9> latencyBuckets = {
+    50'000,
+    100'000,
+    250'000,
+    500'000,
+    1'000'000,
+    2'500'000,
+    5'000'000,
+    10'000'000,
+    25'000'000};
+
+// Slot layout within a shard
+std::size_t constexpr resultSlots = 0;
+std::size_t constexpr bytesInSlot = resultSlots + commandNames.size() * 2;
+std::size_t constexpr bytesOutSlot = bytesInSlot + 1;
+// Address cache hits, then misses
+std::size_t constexpr addressSlots = bytesOutSlot + 1;
+std::size_t constexpr histogramSlots = addressSlots + 2;
+// Per key type: one slot per bucket, one for +Inf, then sum and count
+std::size_t constexpr histogramSize = latencyBuckets.size() + 3;
+std::size_t constexpr slotCount =
+    histogramSlots + keyTypeNames.size() * histogramSize;
+
+std::size_t constexpr shardCount = 32;
+
+struct alignas(64) Shard
+{
+    std::array<std::atomic<std::uint64_t>, slotCount> slots;
+};
+
+std::array<Shard, shardCount> shards;
+std::array<std::atomic<std::int64_t>, 2> queueDepths;
+
+Shard&
+localShard()
+{
+    static std::atomic<std::size_t> nextThread{0};
+    thread_local std::size_t const index =
+        nextThread.fetch_add(1, std::memory_order_relaxed) % shardCount;
+    return shards[index];
+}
+
+void
+add(std::size_t slot, std::uint64_t value)
+{
+    localShard().slots[slot].fetch_add(value, std::memory_order_relaxed);
+}
+
+std::uint64_t
+sum(std::size_t slot)
+{
+    std::uint64_t total = 0;
+    for (auto const& shard : shards)
+        total += shard.slots[slot].load(std::memory_order_relaxed);
+    return total;
+}
+
+std::size_t
+keyTypeIndex(ripple::KeyType keyType)
+{
+    return keyType == ripple::KeyType::ed25519 ? 1 : 0;
+}
+
+void
+writeSeconds(std::ostream& os, std::uint64_t nanos)
+{
+    os << nanos / 1'000'000'000 << '.';
+    auto const fraction = std::to_string(nanos % 1'000'000'000);
+    os << std::string(9 - fraction.size(), '0') << fraction;
+}
+
+}  // namespace
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}
+
+void
+enable()
+{
+    for (auto& shard : shards)
+        for (auto& slot : shard.slots)
+            slot.store(0, std::memory_order_relaxed);
+    for (auto& depth : queueDepths)
+        depth.store(0, std::memory_order_relaxed);
+    detail::enabled.store(true, std::memory_order_release);
+}
+
+void
+disable()
+{
+    detail::enabled.store(false, std::memory_order_release);
+}
+
+void
+recordResult(Command command, bool success)
+{
+    if (enabled())
+        add(resultSlots + static_cast<std::size_t>(command) * 2 +
+                (success ? 0 : 1),
+            1);
+}
+
+void
+recordSignLatency(ripple::KeyType keyType, std::chrono::nanoseconds latency)
+{
+    if (!enabled())
+        return;
+    auto const base = histogramSlots + keyTypeIndex(keyType) * histogramSize;
+    auto const nanos = static_cast<std::uint64_t>(latency.count());
+    std::size_t bucket = 0;
+    while (bucket < latencyBuckets.size() && nanos > latencyBuckets[bucket])
+        ++bucket;
+    // Buckets are stored non-cumulatively, and summed when written
+    add(base + bucket, 1);
+    add(base + latencyBuckets.size() + 1, nanos);
+    add(base + latencyBuckets.size() + 2, 1);
+}
+
+void
+addBytesIn(std::uint64_t bytes)
+{
+    if (enabled())
+        add(bytesInSlot, bytes);
+}
+
+void
+addBytesOut(std::uint64_t bytes)
+{
+    if (enabled())
+        add(bytesOutSlot, bytes);
+}
+
+void
+recordAddressLookup(bool hit)
+{
+    if (enabled())
+        add(addressSlots + (hit ? 0 : 1), 1);
+}
+
+void
+setQueueDepth(Queue queue, std::int64_t depth)
+{
+    if (enabled())
+        queueDepths[static_cast<std::size_t>(queue)].store(
+            depth, std::memory_order_relaxed);
+}
+
+std::uint64_t
+peakRss()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    // Reported in bytes
+    return usage.ru_maxrss;
+#else
+    // Reported in kilobytes
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void
+write(std::ostream& os)
+{
+    os << "# HELP offline_records_total Records processed, by command and "
+          "result.\n"
+          "# TYPE offline_records_total counter\n";
+    for (std::size_t c = 0; c < commandNames.size(); ++c)
+    {
+        for (auto const success : {true, false})
+        {
+            os << "offline_records_total{command=\"" << commandNames[c]
+               << "\",result=\"" << (success ? "success" : "failure")
+               << "\"} " << sum(resultSlots + c * 2 + (success ? 0 : 1))
+               << "\n";
+        }
+    }
+
+    os << "# HELP offline_sign_duration_seconds Time to sign one "
+          "transaction, by key type.\n"
+          "# TYPE offline_sign_duration_seconds histogram\n";
+    for (std::size_t k = 0; k < keyTypeNames.size(); ++k)
+    {
+        auto const base = histogramSlots + k * histogramSize;
+        std::uint64_t cumulative = 0;
+        for (std::size_t b = 0; b <= latencyBuckets.size(); ++b)
+        {
+            cumulative += sum(base + b);
+            os << "offline_sign_duration_seconds_bucket{key_type=\""
+               << keyTypeNames[k] << "\",le=\"";
+            if (b < latencyBuckets.size())
+                writeSeconds(os, latencyBuckets[b]);
+            else
+                os << "+Inf";
+            os << "\"} " << cumulative << "\n";
+        }
+        os << "offline_sign_duration_seconds_sum{key_type=\""
+           << keyTypeNames[k] << "\"} ";
+        writeSeconds(os, sum(base + latencyBuckets.size() + 1));
+        os << "\n"
+           << "offline_sign_duration_seconds_count{key_type=\""
+           << keyTypeNames[k] << "\"} "
+           << sum(base + latencyBuckets.size() + 2) << "\n";
+    }
+
+    os << "# HELP offline_input_bytes_total Bytes of input records read.\n"
+          "# TYPE offline_input_bytes_total counter\n"
+          "offline_input_bytes_total "
+       << sum(bytesInSlot)
+       << "\n"
+          "# HELP offline_output_bytes_total Bytes of results written.\n"
+          "# TYPE offline_output_bytes_total counter\n"
+          "offline_output_bytes_total "
+       << sum(bytesOutSlot) << "\n";
+
+    os << "# HELP offline_address_cache_lookups_total Addresses looked up "
+          "in the batch address cache, by result.\n"
+          "# TYPE offline_address_cache_lookups_total counter\n"
+          "offline_address_cache_lookups_total{result=\"hit\"} "
+       << sum(addressSlots)
+       << "\n"
+          "offline_address_cache_lookups_total{result=\"miss\"} "
+       << sum(addressSlots + 1) << "\n";
+
+    os << "# HELP offline_queue_depth Records waiting in each pipeline "
+          "queue.\n"
+          "# TYPE offline_queue_depth gauge\n"
+          "offline_queue_depth{queue=\"input\"} "
+       << queueDepths[static_cast<std::size_t>(Queue::input)].load(
+              std::memory_order_relaxed)
+       << "\n"
+          "offline_queue_depth{queue=\"reorder\"} "
+       << queueDepths[static_cast<std::size_t>(Queue::reorder)].load(
+              std::memory_order_relaxed)
+       << "\n";
+
+    os << "# HELP offline_peak_rss_bytes Peak resident set size.\n"
+          "# TYPE offline_peak_rss_bytes gauge\n"
+          "offline_peak_rss_bytes "
+       << peakRss() << "\n";
+
+    using namespace std::chrono;
+    os << "# HELP offline_last_update_timestamp_seconds When this file was "
+          "written.\n"
+          "# TYPE offline_last_update_timestamp_seconds gauge\n"
+          "offline_last_update_timestamp_seconds "
+       << duration_cast<seconds>(system_clock::now().time_since_epoch())
+              .count()
+       << "\n";
+}
+
+Reporter::Reporter(
+    boost::filesystem::path const& path,
+    std::chrono::milliseconds interval)
+    : path_(path), interval_(interval)
+{
+    // Fail early, on the calling thread, if the file can't be written
+    writeFile();
+    thread_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_.wait_for(lock, interval_, [this] { return stopping_; }))
+        {
+            try
+            {
+                writeFile();
+            }
+            catch (std::exception const& e)
+            {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    });
+}
+
+Reporter::~Reporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_.notify_all();
+    thread_.join();
+    try
+    {
+        writeFile();
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void
+Reporter::writeFile() const
+{
+    auto const temp = path_.string() + ".tmp";
+    {
+        std::ofstream o(temp, std::ios::trunc);
+        if (o.fail())
+            throw std::runtime_error("Cannot open metrics file: " + temp);
+        write(o);
+        if (o.flush().fail())
+            throw std::runtime_error("Cannot write metrics file: " + temp);
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(temp, path_, ec);
+    if (ec)
+        throw std::runtime_error(
+            "Cannot replace metrics file: " + path_.string());
+}
+
+}  // namespace metrics
+}  // namespace offline
@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef OFFLINE_METRICS_H_INCLUDED
+#define OFFLINE_METRICS_H_INCLUDED
+
+#include <ripple/protocol/KeyType.h>
+#include <boost/filesystem/path.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace offline {
+
+/** Process metrics in Prometheus text exposition format.
+
+    Counters and histograms are sharded: each thread updates its own
+    cache line with relaxed atomic adds, so the hot path takes no locks.
+    Shards are only summed when the metrics are written.
+*/
+namespace metrics {
+
+enum class Command { serialize, deserialize, sign, multisign };
+
+enum class Queue { input, reorder };
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}
+
+/// Start collecting, resetting every metric to zero.
+void
+enable();
+
+/// Stop collecting. Collected values are kept until the next `enable`.
+void
+disable();
+
+inline bool
+enabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Count one processed record.
+void
+recordResult(Command command, bool success);
+
+/// Add one observation to the signing latency histogram.
+void
+recordSignLatency(ripple::KeyType keyType, std::chrono::nanoseconds latency);
+
+void
+addBytesIn(std::uint64_t bytes);
+
+void
+addBytesOut(std::uint64_t bytes);
+
+/// Count one lookup in a batch's address cache.
+void
+recordAddressLookup(bool hit);
+
+void
+setQueueDepth(Queue queue, std::int64_t depth);
+
+/// Peak resident set size of this process in bytes, or 0 if unknown.
+std::uint64_t
+peakRss();
+
+/// Write all metrics in Prometheus text format.
+void
+write(std::ostream& os);
+
+/** Periodically write the metrics to a file for node_exporter's textfile
+    collector.
+
+    The file is replaced atomically by writing a temporary file next to
+    it and renaming it. A final write is made on destruction.
+*/
+class Reporter
+{
+private:
+    boost::filesystem::path const path_;
+    std::chrono::milliseconds const interval_;
+    std::mutex mutex_;
+    std::condition_variable stop_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+public:
+    Reporter(
+        boost::filesystem::path const& path,
+        std::chrono::milliseconds interval);
+
+    Reporter(Reporter const&) = delete;
+    Reporter&
+    operator=(Reporter const&) = delete;
+
+    ~Reporter();
+
+    /** Write the metrics file now.
+
+        @throws std::runtime_error if the file can not be written
+    */
+    void
+    writeFile() const;
+};
+
+}  // namespace metrics
+
+}  // namespace offline
+
+#endif  // !OFFLINE_METRICS_H_INCLUDED
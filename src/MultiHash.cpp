@@ -0,0 +1,615 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <MultiHash.h>
+#include <Parallel.h>
+#include <Serialize.h>
+
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/digest.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OFFLINE_HASH_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace offline {
+
+namespace {
+
+// Lines hashed at a time, and by each worker in turn
+std::size_t constexpr chunkSize = 4096;
+std::size_t constexpr groupSize = 64;
+
+std::size_t constexpr blockSize = 128;
+
+std::array<std::uint64_t, 8> constexpr initialState = {
+    0x6a09e667f3bcc908ULL,
+    0xbb67ae8584caa73bULL,
+    0x3c6ef372fe94f82bULL,
+    0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL,
+    0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL,
+    0x5be0cd19137e2179ULL};
+
+std::array<std::uint64_t, 80> constexpr roundConstants = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+
+/** The padded SHA-512 message of a `HashInput`, produced a block at a
+    time, without copying the whole message.
+*/
+class Message
+{
+private:
+    HashInput const* input_ = nullptr;
+    std::array<std::uint8_t, 4> prefix_{};
+    // Length of the prefix, data and suffix
+    std::uint64_t size_ = 0;
+    std::uint64_t blocks_ = 0;
+
+public:
+    Message() = default;
+
+    explicit Message(HashInput const& input)
+        : input_(&input)
+        , prefix_{
+              static_cast<std::uint8_t>(input.prefix >> 24),
+              static_cast<std::uint8_t>(input.prefix >> 16),
+              static_cast<std::uint8_t>(input.prefix >> 8),
+              static_cast<std::uint8_t>(input.prefix)}
+        , size_(4 + input.data.size() + input.suffix.size())
+        // The 0x80 marker and the 16 byte length follow the message
+        , blocks_((size_ + 17 + blockSize - 1) / blockSize)
+    {
+    }
+
+    std::uint64_t
+    blocks() const
+    {
+        return blocks_;
+    }
+
+    /** Block `index`, which points into the data where it can, and is
+        otherwise built in `scratch`.
+    */
+    std::uint8_t const*
+    block(std::uint64_t index, std::uint8_t* scratch) const
+    {
+        auto const begin = index * blockSize;
+        if (begin >= 4 && begin + blockSize <= 4 + input_->data.size())
+            return input_->data.data() + (begin - 4);
+        fill(begin, scratch);
+        return scratch;
+    }
+
+private:
+    void
+    fill(std::uint64_t begin, std::uint8_t* block) const
+    {
+        auto const end = begin + blockSize;
+        std::memset(block, 0, blockSize);
+        // Copy the part of message bytes [at, at + size) in this block
+        auto const copy = [&](std::uint64_t at, ripple::Slice part) {
+            auto const from = std::max(begin, at);
+            auto const to = std::min<std::uint64_t>(end, at + part.size());
+            if (from < to)
+                std::memcpy(
+                    block + (from - begin),
+                    part.data() + (from - at),
+                    to - from);
+        };
+        copy(0, ripple::Slice(prefix_.data(), prefix_.size()));
+        copy(4, input_->data);
+        copy(4 + input_->data.size(), input_->suffix);
+        if (size_ >= begin && size_ < end)
+            block[size_ - begin] = 0x80;
+        if (end == blocks_ * blockSize)
+        {
+            // Bit length, in the last 8 of the 16 length bytes
+            auto const bits = size_ * 8;
+            for (int i = 0; i < 8; ++i)
+                block[blockSize - 1 - i] =
+                    static_cast<std::uint8_t>(bits >> (8 * i));
+        }
+    }
+};
+
+// The first half of a lane's state, big endian
+template <std::size_t Lanes>
+void
+storeHalf(
+    std::uint64_t const (&state)[8][Lanes],
+    std::size_t lane,
+    ripple::uint256& out)
+{
+    auto p = out.data();
+    for (int i = 0; i < 4; ++i)
+        for (int j = 7; j >= 0; --j)
+            *p++ = static_cast<std::uint8_t>(state[i][lane] >> (8 * j));
+}
+
+/** Hash the inputs `Lanes` at a time with `compress`, which hashes one
+    block in each lane.
+
+    Each lane takes the next input as soon as it finishes one, so
+    inputs of different lengths keep the lanes busy. Lanes left without
+    an input hash leftovers, whose results are ignored.
+*/
+template <std::size_t Lanes, class Compress>
+void
+hashLanes(
+    HashInput const* inputs,
+    std::size_t count,
+    ripple::uint256* out,
+    Compress compress)
+{
+    struct Lane
+    {
+        std::size_t input = 0;
+        Message message;
+        std::uint64_t block = 0;
+        bool active = false;
+    };
+
+    // state[i] holds word i of every lane
+    alignas(64) std::uint64_t state[8][Lanes] = {};
+    std::uint8_t scratch[Lanes][blockSize] = {};
+    std::uint8_t const* blocks[Lanes];
+    std::array<Lane, Lanes> lanes;
+    std::size_t next = 0;
+
+    auto const start = [&](std::size_t l) {
+        auto& lane = lanes[l];
+        lane.active = next < count;
+        if (!lane.active)
+            return;
+        lane.input = next++;
+        lane.message = Message(inputs[lane.input]);
+        lane.block = 0;
+        for (int i = 0; i < 8; ++i)
+            state[i][l] = initialState[i];
+    };
+    for (std::size_t l = 0; l < Lanes; ++l)
+    {
+        blocks[l] = scratch[l];
+        start(l);
+    }
+
+    for (auto active = std::min(count, Lanes); active;)
+    {
+        for (std::size_t l = 0; l < Lanes; ++l)
+        {
+            if (lanes[l].active)
+                blocks[l] =
+                    lanes[l].message.block(lanes[l].block, scratch[l]);
+        }
+        compress(state, blocks);
+        for (std::size_t l = 0; l < Lanes; ++l)
+        {
+            auto& lane = lanes[l];
+            if (!lane.active || ++lane.block < lane.message.blocks())
+                continue;
+            storeHalf(state, l, out[lane.input]);
+            start(l);
+            active -= !lane.active;
+        }
+    }
+}
+
+#ifdef OFFLINE_HASH_SIMD
+
+#define OFFLINE_AVX2 __attribute__((target("avx2")))
+#define OFFLINE_AVX512 __attribute__((target("avx512f")))
+
+std::uint64_t
+loadBigEndian(std::uint8_t const* p)
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return boost::endian::big_to_native(v);
+}
+
+OFFLINE_AVX2 inline __m256i
+rotr4(__m256i x, int n)
+{
+    return _mm256_or_si256(
+        _mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - n));
+}
+
+OFFLINE_AVX2 inline __m256i
+add4(__m256i a, __m256i b)
+{
+    return _mm256_add_epi64(a, b);
+}
+
+OFFLINE_AVX2 inline __m256i
+xor4(__m256i a, __m256i b, __m256i c)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+}
+
+OFFLINE_AVX2 inline __m256i
+load4(std::uint8_t const* p)
+{
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+}
+
+// One block in each of 4 lanes. AVX2 has no 64 bit rotate, so each
+// rotate is two shifts.
+OFFLINE_AVX2 void
+compress4(std::uint64_t (&state)[8][4], std::uint8_t const* const (&blocks)[4])
+{
+    // Reverses the bytes of each 64 bit word
+    auto const byteSwap = _mm256_set_epi8(
+        8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+        8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+
+    // Transpose each lane's words into word by word vectors
+    __m256i w[16];
+    for (int g = 0; g < 4; ++g)
+    {
+        auto const r0 = load4(blocks[0] + 32 * g);
+        auto const r1 = load4(blocks[1] + 32 * g);
+        auto const r2 = load4(blocks[2] + 32 * g);
+        auto const r3 = load4(blocks[3] + 32 * g);
+        auto const t0 = _mm256_unpacklo_epi64(r0, r1);
+        auto const t1 = _mm256_unpackhi_epi64(r0, r1);
+        auto const t2 = _mm256_unpacklo_epi64(r2, r3);
+        auto const t3 = _mm256_unpackhi_epi64(r2, r3);
+        w[4 * g] = _mm256_shuffle_epi8(
+            _mm256_permute2x128_si256(t0, t2, 0x20), byteSwap);
+        w[4 * g + 1] = _mm256_shuffle_epi8(
+            _mm256_permute2x128_si256(t1, t3, 0x20), byteSwap);
+        w[4 * g + 2] = _mm256_shuffle_epi8(
+            _mm256_permute2x128_si256(t0, t2, 0x31), byteSwap);
+        w[4 * g + 3] = _mm256_shuffle_epi8(
+            _mm256_permute2x128_si256(t1, t3, 0x31), byteSwap);
+    }
+
+    __m256i s[8];
+    for (int i = 0; i < 8; ++i)
+        s[i] = load4(reinterpret_cast<std::uint8_t const*>(state[i]));
+    auto a = s[0], b = s[1], c = s[2], d = s[3];
+    auto e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 80; ++t)
+    {
+        // The message schedule, kept as a ring of 16 words
+        if (t >= 16)
+        {
+            auto const w15 = w[(t - 15) & 15];
+            auto const w2 = w[(t - 2) & 15];
+            auto const s0 =
+                xor4(rotr4(w15, 1), rotr4(w15, 8), _mm256_srli_epi64(w15, 7));
+            auto const s1 =
+                xor4(rotr4(w2, 19), rotr4(w2, 61), _mm256_srli_epi64(w2, 6));
+            w[t & 15] =
+                add4(add4(w[t & 15], s0), add4(w[(t - 7) & 15], s1));
+        }
+        auto const ch = _mm256_xor_si256(
+            _mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        auto const maj = _mm256_or_si256(
+            _mm256_and_si256(a, _mm256_or_si256(b, c)),
+            _mm256_and_si256(b, c));
+        auto const t1 = add4(
+            add4(h, xor4(rotr4(e, 14), rotr4(e, 18), rotr4(e, 41))),
+            add4(
+                add4(ch, _mm256_set1_epi64x(roundConstants[t])),
+                w[t & 15]));
+        auto const t2 =
+            add4(xor4(rotr4(a, 28), rotr4(a, 34), rotr4(a, 39)), maj);
+        h = g;
+        g = f;
+        f = e;
+        e = add4(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = add4(t1, t2);
+    }
+    __m256i const result[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; ++i)
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(state[i]), add4(s[i], result[i]));
+}
+
+// Bitwise functions of three inputs, as `_mm512_ternarylogic_epi64`
+// truth tables
+int constexpr xor3 = 0x96;
+int constexpr choose = 0xCA;
+int constexpr majority = 0xE8;
+
+OFFLINE_AVX512 inline __m512i
+add8(__m512i a, __m512i b)
+{
+    return _mm512_add_epi64(a, b);
+}
+
+OFFLINE_AVX512 inline __m512i
+sigma8(__m512i x, int r1, int r2, int r3)
+{
+    return _mm512_ternarylogic_epi64(
+        _mm512_ror_epi64(x, r1),
+        _mm512_ror_epi64(x, r2),
+        _mm512_ror_epi64(x, r3),
+        xor3);
+}
+
+// One block in each of 8 lanes
+OFFLINE_AVX512 void
+compress8(std::uint64_t (&state)[8][8], std::uint8_t const* const (&blocks)[8])
+{
+    alignas(64) std::uint64_t words[16][8];
+    for (int l = 0; l < 8; ++l)
+        for (int t = 0; t < 16; ++t)
+            words[t][l] = loadBigEndian(blocks[l] + 8 * t);
+    __m512i w[16];
+    for (int t = 0; t < 16; ++t)
+        w[t] = _mm512_load_si512(words[t]);
+
+    __m512i s[8];
+    for (int i = 0; i < 8; ++i)
+        s[i] = _mm512_load_si512(state[i]);
+    auto a = s[0], b = s[1], c = s[2], d = s[3];
+    auto e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 80; ++t)
+    {
+        if (t >= 16)
+        {
+            auto const w15 = w[(t - 15) & 15];
+            auto const w2 = w[(t - 2) & 15];
+            auto const s0 = _mm512_ternarylogic_epi64(
+                _mm512_ror_epi64(w15, 1),
+                _mm512_ror_epi64(w15, 8),
+                _mm512_srli_epi64(w15, 7),
+                xor3);
+            auto const s1 = _mm512_ternarylogic_epi64(
+                _mm512_ror_epi64(w2, 19),
+                _mm512_ror_epi64(w2, 61),
+                _mm512_srli_epi64(w2, 6),
+                xor3);
+            w[t & 15] =
+                add8(add8(w[t & 15], s0), add8(w[(t - 7) & 15], s1));
+        }
+        auto const t1 = add8(
+            add8(h, sigma8(e, 14, 18, 41)),
+            add8(
+                add8(
+                    _mm512_ternarylogic_epi64(e, f, g, choose),
+                    _mm512_set1_epi64(roundConstants[t])),
+                w[t & 15]));
+        auto const t2 = add8(
+            sigma8(a, 28, 34, 39),
+            _mm512_ternarylogic_epi64(a, b, c, majority));
+        h = g;
+        g = f;
+        f = e;
+        e = add8(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = add8(t1, t2);
+    }
+    __m512i const result[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; ++i)
+        _mm512_store_si512(state[i], add8(s[i], result[i]));
+}
+
+#endif
+
+}  // namespace
+
+char const*
+to_string(HashKernel kernel)
+{
+    switch (kernel)
+    {
+        case HashKernel::scalar:
+            return "scalar";
+        case HashKernel::avx2:
+            return "avx2";
+        case HashKernel::avx512:
+            return "avx512";
+    }
+    // LCOV_EXCL_START
+    throw std::logic_error("Unhandled hash kernel");
+    // LCOV_EXCL_STOP
+}
+
+bool
+supported(HashKernel kernel)
+{
+    switch (kernel)
+    {
+        case HashKernel::scalar:
+            return true;
+#ifdef OFFLINE_HASH_SIMD
+        case HashKernel::avx2:
+            return __builtin_cpu_supports("avx2");
+        case HashKernel::avx512:
+            return __builtin_cpu_supports("avx512f");
+#else
+        default:
+            return false;
+#endif
+    }
+    return false;
+}
+
+HashKernel
+bestHashKernel()
+{
+    static HashKernel const best = [] {
+        for (auto const kernel : {HashKernel::avx512, HashKernel::avx2})
+        {
+            if (supported(kernel))
+                return kernel;
+        }
+        return HashKernel::scalar;
+    }();
+    return best;
+}
+
+void
+sha512HalfMany(
+    HashInput const* inputs,
+    std::size_t count,
+    ripple::uint256* out,
+    HashKernel kernel)
+{
+    if (!supported(kernel))
+        throw std::logic_error(
+            std::string("Unsupported hash kernel: ") + to_string(kernel));
+    // A lone message gains nothing from the lanes
+    if (count > 1)
+    {
+        switch (kernel)
+        {
+#ifdef OFFLINE_HASH_SIMD
+            case HashKernel::avx2:
+                return hashLanes<4>(inputs, count, out, compress4);
+            case HashKernel::avx512:
+                return hashLanes<8>(inputs, count, out, compress8);
+#endif
+            default:
+                break;
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = ripple::sha512Half(
+            inputs[i].prefix, inputs[i].data, inputs[i].suffix);
+}
+
+int
+runHash(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads)
+{
+    auto const prefix =
+        static_cast<std::uint32_t>(ripple::HashPrefix::transactionID);
+
+    std::size_t failures = 0;
+    std::vector<std::string> lines;
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<std::string> outputs;
+    std::vector<std::string> errors;
+    std::uint64_t lineNumber = 0;
+    for (bool more = true; more;)
+    {
+        lines.clear();
+        lineNumbers.clear();
+        std::string line;
+        while (lines.size() < chunkSize && (more = !!std::getline(in, line)))
+        {
+            ++lineNumber;
+            boost::trim(line);
+            if (line.empty())
+                continue;
+            lines.push_back(std::move(line));
+            lineNumbers.push_back(lineNumber);
+        }
+
+        outputs.assign(lines.size(), {});
+        errors.assign(lines.size(), {});
+        auto const groups = (lines.size() + groupSize - 1) / groupSize;
+        parallelFor(groups, threads, [&](std::uint64_t group) {
+            // Reused by every group a worker hashes
+            thread_local std::vector<ripple::Blob> blobs(groupSize);
+            thread_local std::vector<HashInput> inputs;
+            thread_local std::vector<std::size_t> indexes;
+            thread_local std::vector<ripple::uint256> ids;
+
+            inputs.clear();
+            indexes.clear();
+            auto const begin = group * groupSize;
+            auto const end = std::min(begin + groupSize, lines.size());
+            for (auto i = begin; i < end; ++i)
+            {
+                auto& blob = blobs[i - begin];
+                if (!unhexInto(lines[i], blob))
+                {
+                    errors[i] = "Invalid hex data";
+                    continue;
+                }
+                inputs.push_back({prefix, ripple::makeSlice(blob)});
+                indexes.push_back(i);
+            }
+            ids.resize(inputs.size());
+            sha512HalfMany(inputs.data(), inputs.size(), ids.data());
+            for (std::size_t j = 0; j < indexes.size(); ++j)
+                outputs[indexes[j]] = to_string(ids[j]);
+        });
+
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            if (!errors[i].empty())
+            {
+                ++failures;
+                err << "Line " << lineNumbers[i] << ": " << errors[i]
+                    << "\n";
+            }
+            out << outputs[i] << "\n";
+        }
+    }
+    out.flush();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace offline
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_MULTIHASH_H_INCLUDED
+#define OFFLINE_MULTIHASH_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace offline {
+
+/** SHA-512Half over many independent messages at once.
+
+    Transaction IDs and tree leaf hashes are SHA-512Half over short,
+    unrelated messages, so several can be hashed side by side in the
+    lanes of SIMD registers. Each lane runs its own message, and takes
+    the next one as soon as it finishes, so messages of different
+    lengths keep every lane busy.
+*/
+
+/// Ways to compute many hashes.
+enum class HashKernel {
+    /// One message at a time, with the libxrpl hashers. Always
+    /// available.
+    scalar,
+    /// AVX2 registers: four SHA-512 lanes, or eight 32 bit lanes.
+    avx2,
+    /// AVX-512 registers: eight SHA-512 lanes, or sixteen 32 bit
+    /// lanes.
+    avx512,
+};
+
+char const*
+to_string(HashKernel kernel);
+
+/// True if this build and CPU can run `kernel`.
+bool
+supported(HashKernel kernel);
+
+/// The fastest supported kernel, detected once at runtime.
+HashKernel
+bestHashKernel();
+
+/// A message to hash: a 4 byte hash prefix, as in `ripple::HashPrefix`,
+/// followed by `data` and then `suffix`.
+struct HashInput
+{
+    std::uint32_t prefix = 0;
+    ripple::Slice data;
+    /// e.g. the key of a tree leaf
+    ripple::Slice suffix;
+};
+
+/** Compute `out[i] = sha512Half(prefix, data, suffix)` for each of
+    `count` inputs.
+
+    @throws std::logic_error if the kernel isn't supported
+*/
+void
+sha512HalfMany(
+    HashInput const* inputs,
+    std::size_t count,
+    ripple::uint256* out,
+    HashKernel kernel = bestHashKernel());
+
+/** Write the transaction ID of each serialized transaction read from
+    `in`, one per line in hex, to `out`.
+
+    The blobs are hashed as they are, without being decoded. Lines are
+    hashed in parallel, and written in input order, with an empty line
+    for a line that isn't hex.
+
+    @return EXIT_SUCCESS if every line was hashed, otherwise
+        EXIT_FAILURE
+*/
+int
+runHash(
+    std::istream& in,
+    std::ostream& out,
+    std::ostream& err,
+    unsigned threads);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_MULTIHASH_H_INCLUDED
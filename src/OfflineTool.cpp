@@ -18,27 +18,19 @@
 */
 //==============================================================================
 
+#include <Base58.h>
 #include <OfflineTool.h>
 #include <RippleKey.h>
 #include <Serialize.h>
 
 #include <ripple/beast/core/SemanticVersion.h>
-#include <ripple/beast/unit_test.h>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/format.hpp>
 #include <boost/preprocessor/stringize.hpp>
-#include <boost/program_options.hpp>
-#include <beast/unit_test/dstream.hpp>
-#ifdef BOOST_MSVC
-#ifndef WIN32_LEAN_AND_MEAN  // VC_EXTRALEAN
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#undef WIN32_LEAN_AND_MEAN
-#else
-#include <windows.h>
-#endif
-#endif
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
 
 //------------------------------------------------------------------------------
 char const* const versionString =
@@ -66,24 +58,12 @@ char const* const versionString =
     //--------------------------------------------------------------------------
     ;
 
-static int
-runUnitTests()
-{
-    using namespace beast::unit_test;
-    beast::unit_test::dstream dout{std::cout};
-    reporter r{dout};
-    bool const anyFailed = r.run_each(global_suites());
-    if (anyFailed)
-        return EXIT_FAILURE;  // LCOV_EXCL_LINE
-    return EXIT_SUCCESS;
-}
-
 int
 doSerialize(std::string const& data)
 {
     auto const tx = [&] {
-        auto const json = offline::parseJson(data);
-        return json ? offline::makeObject(json) : std::nullopt;
+        auto json = offline::parseJson(data);
+        return json ? offline::makeObject(std::move(json)) : std::nullopt;
     }();
     if (!tx)
     {
@@ -98,7 +78,10 @@ doSerialize(std::string const& data)
 }
 
 int
-doDeserialize(std::string const& data)
+doDeserialize(
+    std::string const& data,
+    offline::BlobType type,
+    offline::OutputFormat output)
 {
     using namespace ripple;
 
@@ -107,6 +90,21 @@ doDeserialize(std::string const& data)
     };
     try
     {
+        if (output != offline::OutputFormat::json)
+        {
+            std::cout << offline::decodeAs(
+                             boost::trim_copy(data), type, output)
+                      << std::flush;
+            return EXIT_SUCCESS;
+        }
+        if (type != offline::BlobType::generic)
+        {
+            std::cout << offline::decode(boost::trim_copy(data), type)
+                             .toStyledString()
+                      << std::endl;
+            return EXIT_SUCCESS;
+        }
+
         auto const result = offline::deserialize(boost::trim_copy(data));
 
         if (result)
@@ -137,7 +135,8 @@ doSign(
     boost::filesystem::path const& keyFile,
     std::function<
         void(offline::RippleKey const& key, std::optional<ripple::STTx>& tx)>
-        signingOp)
+        signingOp,
+    offline::OutputFormat output)
 {
     using namespace ripple;
     using namespace offline;
@@ -162,6 +161,11 @@ doSign(
 
         signingOp(rippleKey, tx);
 
+        if (output != offline::OutputFormat::json)
+        {
+            std::cout << offline::encodeTransaction(*tx, output) << std::flush;
+            return EXIT_SUCCESS;
+        }
         std::cout << tx->getJson(JsonOptions::none).toStyledString()
                   << std::endl;
         return EXIT_SUCCESS;
@@ -175,25 +179,33 @@ doSign(
 }
 
 int
-doSingleSign(std::string const& data, boost::filesystem::path const& keyFile)
+doSingleSign(
+    std::string const& data,
+    boost::filesystem::path const& keyFile,
+    offline::OutputFormat output)
 {
     return doSign(
         data,
         keyFile,
         [](offline::RippleKey const& key, std::optional<ripple::STTx>& tx) {
             key.singleSign(tx);
-        });
+        },
+        output);
 }
 
 int
-doMultiSign(std::string const& data, boost::filesystem::path const& keyFile)
+doMultiSign(
+    std::string const& data,
+    boost::filesystem::path const& keyFile,
+    offline::OutputFormat output)
 {
     return doSign(
         data,
         keyFile,
         [](offline::RippleKey const& key, std::optional<ripple::STTx>& tx) {
             key.multiSign(tx);
-        });
+        },
+        output);
 }
 
 int
@@ -223,8 +235,8 @@ doCreateKeyfile(
     std::cout << "New ripple key created "
               << "in " << keyFile.string() << "\n"
               << "Key type is " << to_string(key.keyType()) << ", and "
-              << "account ID is " << toBase58(calcAccountID(key.publicKey()))
-              << "\n"
+              << "account ID is "
+              << encodeAccount(calcAccountID(key.publicKey())) << "\n"
               << "\nThis file should be stored securely and not shared\n\n";
 
     return EXIT_SUCCESS;
@@ -244,58 +256,82 @@ runCommand(
     std::vector<std::string> const& args,
     boost::filesystem::path const& keyFile,
     std::optional<std::string> const& keyType,
-    InputType const& inputType)
+    InputType const& inputType,
+    offline::BlobType blobType,
+    offline::OutputFormat output)
 {
     using namespace std;
 
     struct commandParams
     {
         bool const allowNoInput;
+        bool const allowBinaryOutput;
         std::function<int(
             std::optional<std::string> const& input,
             boost::filesystem::path const& keyFile,
-            std::optional<std::string> const& keyType)> const action;
+            std::optional<std::string> const& keyType,
+            offline::BlobType blobType,
+            offline::OutputFormat output)> const action;
     };
     /* TODO: VC compiler doesn't like
             std::function<void(std::string const& input)> const action;
         with each of the lamdas capturing other local variables.
     */
-    auto const serialize = [](auto const& input, auto const&, auto const&) {
+    auto const serialize =
+        [](auto const& input, auto const&, auto const&, auto, auto) {
+            BOOST_ASSERT(input);
+            return doSerialize(*input);
+        };
+    auto const deserialize = [](auto const& input,
+                                auto const&,
+                                auto const&,
+                                auto blobType,
+                                auto output) {
         BOOST_ASSERT(input);
-        return doSerialize(*input);
+        return doDeserialize(*input, blobType, output);
     };
-    auto const deserialize = [](auto const& input, auto const&, auto const&) {
+    auto const sign = [](auto const& input,
+                         auto const& keyFile,
+                         auto const&,
+                         auto,
+                         auto output) {
         BOOST_ASSERT(input);
-        return doDeserialize(*input);
+        return doSingleSign(*input, keyFile, output);
     };
-    auto const sign = [](auto const& input, auto const& keyFile, auto const&) {
+    auto const multisign = [](auto const& input,
+                              auto const& keyFile,
+                              auto const&,
+                              auto,
+                              auto output) {
         BOOST_ASSERT(input);
-        return doSingleSign(*input, keyFile);
+        return doMultiSign(*input, keyFile, output);
+    };
+    auto const createkeyfile = [](auto const& seed,
+                                  auto const& keyFile,
+                                  auto const& keyType,
+                                  auto,
+                                  auto) {
+        return doCreateKeyfile(keyFile, keyType, seed);
     };
-    auto const multisign =
-        [](auto const& input, auto const& keyFile, auto const&) {
-            BOOST_ASSERT(input);
-            return doMultiSign(*input, keyFile);
-        };
-    auto const createkeyfile =
-        [](auto const& seed, auto const& keyFile, auto const& keyType) {
-            return doCreateKeyfile(keyFile, keyType, seed);
-        };
     auto const argumenterror = []() {
         throw std::runtime_error("Syntax error: Wrong number of arguments");
     };
     static map<string, commandParams> const commandArgs = {
-        {"serialize", {false, serialize}},
-        {"deserialize", {false, deserialize}},
-        {"sign", {false, sign}},
-        {"multisign", {false, multisign}},
-        {"createkeyfile", {true, createkeyfile}},
+        {"serialize", {false, false, serialize}},
+        {"deserialize", {false, true, deserialize}},
+        {"sign", {false, true, sign}},
+        {"multisign", {false, true, multisign}},
+        {"createkeyfile", {true, false, createkeyfile}},
     };
 
     auto const iArgs = commandArgs.find(command);
 
     if (iArgs == commandArgs.end())
         throw std::runtime_error("Unknown command: " + command);
+    if (output != offline::OutputFormat::json &&
+        !iArgs->second.allowBinaryOutput)
+        throw std::runtime_error(
+            "Command does not support binary output: " + command);
 
     // getInputType has already resolved conflicts
     std::optional<std::string> input;
@@ -318,73 +354,9 @@ runCommand(
     }
 
     BOOST_ASSERT(iArgs->second.action);
-    return iArgs->second.action(input, keyFile, keyType);
-}
-
-// LCOV_EXCL_START
-static std::string
-getEnvVar(char const* name)
-{
-    std::string value;
-
-    auto const v = getenv(name);
-
-    if (v != nullptr)
-        value = v;
-
-    return value;
+    return iArgs->second.action(input, keyFile, keyType, blobType, output);
 }
 
-void
-printHelp(
-    const boost::program_options::options_description& desc,
-    boost::filesystem::path const& defaultKeyfile)
-{
-    static std::string const name = "ripple-offline-tool";
-
-    std::cerr << name << " [options] <command> [<argument> ...]\n"
-              << desc << std::endl
-              <<
-        R"(Commands:
-  Serialization:
-    serialize <argument>|--stdin        Serialize from JSON.
-    deserialize <argument>|--stdin      Deserialize to JSON.
-  Transaction signing:
-    sign <argument>|--stdin             Sign for submission.
-    multisign <argument>|--stdin        Apply a multi-signature.
-      Signing commands require a valid keyfile.
-      Input is serialized or unserialized JSON.
-      Output is unserialized JSON.
-  Key Management:
-    createkeyfile [<key>|--stdin]       Create keyfile. A random
-      seed will be used if no <key> is provided on the command line
-      or from standard input using --stdin.
-
-      Default keyfile is: )"
-              << defaultKeyfile << "\n";
-}
-
-InputType
-getInputType(boost::program_options::variables_map const& vm)
-{
-    namespace po = boost::program_options;
-
-    bool const readstdin = vm.count("stdin") && !vm["stdin"].defaulted();
-    bool const commandline =
-        !vm["arguments"].empty() && !vm["arguments"].defaulted();
-
-    if (readstdin && commandline)
-        throw std::runtime_error(
-            "Conflicting inputs: May only specify one of \"--stdin\" "
-            "and command line parameters.");
-    if (readstdin)
-        return InputType::readstdin;
-    if (commandline)
-        return InputType::commandline;
-    return InputType::none;
-}
-// LCOV_EXCL_STOP
-
 std::string const&
 getVersionString()
 {
@@ -398,127 +370,3 @@ getVersionString()
     }();
     return value;
 }
-
-int
-main(int argc, char** argv)
-{
-#if defined(__GNUC__) && !defined(__clang__)
-    auto constexpr gccver =
-        (__GNUC__ * 100 * 100) + (__GNUC_MINOR__ * 100) + __GNUC_PATCHLEVEL__;
-
-    static_assert(
-        gccver >= 50100,
-        "GCC version 5.1.0 or later is required to compile "
-        "ripple-offline-tool.");
-#endif
-
-    static_assert(
-        BOOST_VERSION >= 105700,
-        "Boost version 1.57 or later is required to compile "
-        "ripple-offline-tool");
-
-    namespace po = boost::program_options;
-
-    po::variables_map vm;
-
-    // Set up option parsing.
-    //
-    po::options_description general("General Options");
-    general.add_options()("help,h", "Display this message.")(
-        "unittest,u", "Perform unit tests.")(
-        "version", "Display the build version.")(
-        "keyfile,f", po::value<std::string>(), "Specify the key file.")(
-        "stdin,i", "Read input (private key or argument) from stdin.");
-
-    po::options_description key("Key File Creation Options");
-    key.add_options()(
-        "keytype,t",
-        po::value<std::string>(),
-        "Valid keytypes are secp256k1 and ed25519. Default is secp256k1.");
-
-    // Interpret positional arguments as --parameters.
-    po::options_description hidden("Hidden options");
-    hidden.add_options()("command", po::value<std::string>(), "Command.")(
-        "arguments",
-        po::value<std::vector<std::string>>()->default_value(
-            std::vector<std::string>(), "empty"),
-        "Arguments.");
-    po::positional_options_description p;
-    p.add("command", 1).add("arguments", -1);
-
-    po::options_description help_options;
-    help_options.add(general).add(key);
-    po::options_description cmdline_options;
-    cmdline_options.add(help_options).add(hidden);
-
-    // Parse options, if no error.
-    try
-    {
-        po::store(
-            po::command_line_parser(argc, argv)
-                .options(cmdline_options)  // Parse options.
-                .positional(p)             // Remainder as --parameters.
-                .run(),
-            vm);
-        po::notify(vm);  // Invoke option notify functions.
-    }
-    // LCOV_EXCL_START
-    catch (std::exception const&)
-    {
-        std::cerr << "ripple-offline-tool: Incorrect command line syntax."
-                  << std::endl;
-        std::cerr << "Use '--help' for a list of options." << std::endl;
-        return EXIT_FAILURE;
-    }
-    // LCOV_EXCL_STOP
-
-    // Run the unit tests if requested.
-    // The unit tests will exit the application with an appropriate return code.
-    if (vm.count("unittest"))
-        return runUnitTests();
-
-    // LCOV_EXCL_START
-    if (vm.count("version"))
-    {
-        std::cout << "ripple-offline-tool version " << getVersionString()
-                  << std::endl;
-        return EXIT_SUCCESS;
-    }
-
-    boost::filesystem::path const homeDir = getEnvVar("HOME");
-    auto const defaultKeyfile =
-        (homeDir.empty() ? boost::filesystem::current_path() : homeDir) /
-        ".ripple" / "secret-key.txt";
-
-    if (vm.count("help") || !vm.count("command"))
-    {
-        printHelp(help_options, defaultKeyfile);
-        return EXIT_SUCCESS;
-    }
-
-    try
-    {
-        using namespace boost::filesystem;
-
-        path const keyFile = vm.count("keyfile")
-            ? vm["keyfile"].as<std::string>()
-            : defaultKeyfile;
-        auto const keyType = vm.count("keytype")
-            ? std::optional<std::string>(vm["keytype"].as<std::string>())
-            : std::nullopt;
-        auto const inputType = getInputType(vm);
-
-        return runCommand(
-            vm["command"].as<std::string>(),
-            vm["arguments"].as<std::vector<std::string>>(),
-            keyFile,
-            keyType,
-            inputType);
-    }
-    catch (std::exception const& e)
-    {
-        std::cerr << e.what() << "\n";
-        return EXIT_FAILURE;
-    }
-    // LCOV_EXCL_STOP
-}
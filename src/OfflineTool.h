@@ -18,6 +18,9 @@
 */
 //==============================================================================
 
+#include <OutputFormat.h>
+#include <Serialize.h>
+
 #include <optional>
 #include <string>
 #include <vector>
@@ -34,13 +37,22 @@ int
 doSerialize(std::string const& data);
 
 int
-doDeserialize(std::string const& data);
+doDeserialize(
+    std::string const& data,
+    offline::BlobType type = offline::BlobType::generic,
+    offline::OutputFormat output = offline::OutputFormat::json);
 
 int
-doSingleSign(std::string const& data, boost::filesystem::path const& keyFile);
+doSingleSign(
+    std::string const& data,
+    boost::filesystem::path const& keyFile,
+    offline::OutputFormat output = offline::OutputFormat::json);
 
 int
-doMultiSign(std::string const& data, boost::filesystem::path const& keyFile);
+doMultiSign(
+    std::string const& data,
+    boost::filesystem::path const& keyFile,
+    offline::OutputFormat output = offline::OutputFormat::json);
 
 int
 doCreateKeyfile(
@@ -54,7 +66,13 @@ runCommand(
     std::vector<std::string> const& args,
     boost::filesystem::path const& keyFile,
     std::optional<std::string> const& keyType,
-    InputType const& inputType);
+    InputType const& inputType,
+    offline::BlobType blobType = offline::BlobType::generic,
+    offline::OutputFormat output = offline::OutputFormat::json);
+
+/// Everything on standard input.
+std::string
+getStdin();
 
 std::string const&
 getVersionString();
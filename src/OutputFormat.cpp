@@ -0,0 +1,474 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <FieldScanner.h>
+#include <OutputFormat.h>
+
+#include <ripple/protocol/st.h>
+#include <stdexcept>
+
+namespace offline {
+
+namespace {
+
+/// Writes MessagePack or CBOR values.
+class Writer
+{
+private:
+    OutputFormat const format_;
+    std::string& out_;
+
+    void
+    byte(unsigned b)
+    {
+        out_ += static_cast<char>(b);
+    }
+
+    void
+    bigEndian(std::uint64_t value, unsigned width)
+    {
+        for (unsigned i = width; i-- > 0;)
+            byte((value >> (i * 8)) & 0xFF);
+    }
+
+    // A CBOR major type and its argument
+    void
+    head(unsigned major, std::uint64_t value)
+    {
+        major <<= 5;
+        if (value < 24)
+        {
+            byte(major | value);
+        }
+        else if (value <= 0xFF)
+        {
+            byte(major | 24);
+            bigEndian(value, 1);
+        }
+        else if (value <= 0xFFFF)
+        {
+            byte(major | 25);
+            bigEndian(value, 2);
+        }
+        else if (value <= 0xFFFFFFFF)
+        {
+            byte(major | 26);
+            bigEndian(value, 4);
+        }
+        else
+        {
+            byte(major | 27);
+            bigEndian(value, 8);
+        }
+    }
+
+    /** A MessagePack length: a fixed size marker if `size` is less than
+        `fixLimit`, otherwise the marker for the smallest of 8 (if any),
+        16 or 32 bits.
+    */
+    void
+    length(
+        std::size_t size,
+        unsigned fixMarker,
+        std::size_t fixLimit,
+        unsigned marker8,
+        unsigned marker16,
+        unsigned marker32)
+    {
+        if (size < fixLimit)
+        {
+            byte(fixMarker | size);
+        }
+        else if (marker8 && size <= 0xFF)
+        {
+            byte(marker8);
+            bigEndian(size, 1);
+        }
+        else if (size <= 0xFFFF)
+        {
+            byte(marker16);
+            bigEndian(size, 2);
+        }
+        else
+        {
+            byte(marker32);
+            bigEndian(size, 4);
+        }
+    }
+
+public:
+    Writer(OutputFormat format, std::string& out) : format_(format), out_(out)
+    {
+    }
+
+    void
+    unsignedInt(std::uint64_t value)
+    {
+        if (format_ == OutputFormat::cbor)
+            return head(0, value);
+        if (value < 0x80)
+        {
+            byte(value);
+        }
+        else if (value <= 0xFF)
+        {
+            byte(0xCC);
+            bigEndian(value, 1);
+        }
+        else if (value <= 0xFFFF)
+        {
+            byte(0xCD);
+            bigEndian(value, 2);
+        }
+        else if (value <= 0xFFFFFFFF)
+        {
+            byte(0xCE);
+            bigEndian(value, 4);
+        }
+        else
+        {
+            byte(0xCF);
+            bigEndian(value, 8);
+        }
+    }
+
+    void
+    signedInt(std::int64_t value)
+    {
+        if (value >= 0)
+            return unsignedInt(value);
+        auto const bits = static_cast<std::uint64_t>(value);
+        if (format_ == OutputFormat::cbor)
+            return head(1, ~bits);
+        if (value >= -32)
+        {
+            byte(bits & 0xFF);
+        }
+        else if (value >= INT8_MIN)
+        {
+            byte(0xD0);
+            bigEndian(bits, 1);
+        }
+        else if (value >= INT16_MIN)
+        {
+            byte(0xD1);
+            bigEndian(bits, 2);
+        }
+        else if (value >= INT32_MIN)
+        {
+            byte(0xD2);
+            bigEndian(bits, 4);
+        }
+        else
+        {
+            byte(0xD3);
+            bigEndian(bits, 8);
+        }
+    }
+
+    void
+    bytes(ripple::Slice value)
+    {
+        if (format_ == OutputFormat::cbor)
+            head(2, value.size());
+        else
+            length(value.size(), 0, 0, 0xC4, 0xC5, 0xC6);
+        out_.append(reinterpret_cast<char const*>(value.data()), value.size());
+    }
+
+    void
+    text(std::string const& value)
+    {
+        if (format_ == OutputFormat::cbor)
+            head(3, value.size());
+        else
+            length(value.size(), 0xA0, 32, 0xD9, 0xDA, 0xDB);
+        out_ += value;
+    }
+
+    void
+    array(std::size_t size)
+    {
+        if (format_ == OutputFormat::cbor)
+            head(4, size);
+        else
+            length(size, 0x90, 16, 0, 0xDC, 0xDD);
+    }
+
+    void
+    map(std::size_t size)
+    {
+        if (format_ == OutputFormat::cbor)
+            head(5, size);
+        else
+            length(size, 0x80, 16, 0, 0xDE, 0xDF);
+    }
+
+    void
+    null()
+    {
+        byte(format_ == OutputFormat::cbor ? 0xF6 : 0xC0);
+    }
+};
+
+template <class BaseUInt>
+ripple::Slice
+sliceOf(BaseUInt const& value)
+{
+    return {value.data(), value.size()};
+}
+
+template <class BitString>
+ripple::Slice
+bitStringSlice(ripple::STBase const& field)
+{
+    return sliceOf(static_cast<BitString const&>(field).value());
+}
+
+void
+writeObject(Writer& w, ripple::STObject const& object, std::size_t extra);
+
+void
+writeAmount(Writer& w, ripple::STBase const& field)
+{
+    using namespace ripple;
+
+    // Reused by every amount the thread writes
+    thread_local Serializer s;
+    s.erase();
+    field.add(s);
+    auto const amount = scannedAmount(s.slice());
+    if (amount.native())
+        return w.signedInt(amount.value);
+    if (!amount.mptIssuanceID.empty())
+    {
+        w.map(2);
+        w.text("value");
+        w.signedInt(amount.value);
+        w.text("mpt_issuance_id");
+        w.bytes(amount.mptIssuanceID);
+        return;
+    }
+    w.map(4);
+    w.text("value");
+    w.signedInt(amount.value);
+    w.text("exponent");
+    w.signedInt(amount.exponent);
+    w.text("currency");
+    w.bytes(amount.currency);
+    w.text("issuer");
+    w.bytes(amount.issuer);
+}
+
+void
+writePathSet(Writer& w, ripple::STPathSet const& paths)
+{
+    using namespace ripple;
+
+    w.array(paths.size());
+    for (auto const& path : paths)
+    {
+        w.array(path.size());
+        for (auto const& element : path)
+        {
+            w.map(
+                element.isAccount() + element.hasCurrency() +
+                element.hasIssuer());
+            if (element.isAccount())
+            {
+                w.text("account");
+                w.bytes(sliceOf(element.getAccountID()));
+            }
+            if (element.hasCurrency())
+            {
+                w.text("currency");
+                w.bytes(sliceOf(element.getCurrency()));
+            }
+            if (element.hasIssuer())
+            {
+                w.text("issuer");
+                w.bytes(sliceOf(element.getIssuerID()));
+            }
+        }
+    }
+}
+
+void
+writeValue(Writer& w, ripple::STBase const& field)
+{
+    using namespace ripple;
+
+    auto const& name = field.getFName();
+    switch (field.getSType())
+    {
+        case STI_UINT8:
+        case STI_UINT16:
+            // Enumerations are written by name, as in JSON
+            if (name == sfTransactionType || name == sfLedgerEntryType ||
+                name == sfTransactionResult)
+            {
+                auto const jv = field.getJson(JsonOptions::none);
+                if (jv.isString())
+                    return w.text(jv.asString());
+            }
+            if (field.getSType() == STI_UINT8)
+                return w.unsignedInt(
+                    static_cast<STUInt8 const&>(field).value());
+            return w.unsignedInt(static_cast<STUInt16 const&>(field).value());
+        case STI_UINT32:
+            return w.unsignedInt(static_cast<STUInt32 const&>(field).value());
+        case STI_UINT64:
+            return w.unsignedInt(static_cast<STUInt64 const&>(field).value());
+        case STI_UINT128:
+            return w.bytes(bitStringSlice<STUInt128>(field));
+        case STI_UINT160:
+            return w.bytes(bitStringSlice<STUInt160>(field));
+        case STI_UINT256:
+            return w.bytes(bitStringSlice<STUInt256>(field));
+        case STI_VL:
+            return w.bytes(static_cast<STBlob const&>(field).value());
+        case STI_ACCOUNT:
+            return w.bytes(
+                sliceOf(static_cast<STAccount const&>(field).value()));
+        case STI_AMOUNT:
+            return writeAmount(w, field);
+        case STI_OBJECT:
+            return writeObject(w, static_cast<STObject const&>(field), 0);
+        case STI_ARRAY: {
+            auto const& array = static_cast<STArray const&>(field);
+            w.array(array.size());
+            for (auto const& object : array)
+            {
+                w.map(1);
+                w.text(object.getFName().getName());
+                writeObject(w, object, 0);
+            }
+            return;
+        }
+        case STI_PATHSET:
+            return writePathSet(w, static_cast<STPathSet const&>(field));
+        case STI_VECTOR256: {
+            auto const& vector = static_cast<STVector256 const&>(field);
+            w.array(vector.size());
+            for (auto const& hash : vector)
+                w.bytes(sliceOf(hash));
+            return;
+        }
+        default: {
+            thread_local Serializer s;
+            s.erase();
+            field.add(s);
+            return w.bytes(s.slice());
+        }
+    }
+}
+
+/// Write an object's fields, leaving room for `extra` more entries.
+void
+writeObject(Writer& w, ripple::STObject const& object, std::size_t extra)
+{
+    using namespace ripple;
+
+    std::size_t count = 0;
+    for (auto const& field : object)
+    {
+        if (field.getSType() != STI_NOTPRESENT)
+            ++count;
+    }
+    w.map(count + extra);
+    for (auto const& field : object)
+    {
+        if (field.getSType() == STI_NOTPRESENT)
+            continue;
+        w.text(field.getFName().getName());
+        writeValue(w, field);
+    }
+}
+
+void
+checkBinary(OutputFormat format)
+{
+    if (format == OutputFormat::json)
+        throw std::logic_error("JSON is not a binary output format");
+}
+
+}  // namespace
+
+OutputFormat
+parseOutputFormat(std::string const& name)
+{
+    if (name == "json")
+        return OutputFormat::json;
+    if (name == "msgpack")
+        return OutputFormat::msgpack;
+    if (name == "cbor")
+        return OutputFormat::cbor;
+    throw std::runtime_error("Unknown output format: " + name);
+}
+
+std::string
+encodeObject(ripple::STObject const& object, OutputFormat format)
+{
+    checkBinary(format);
+    std::string out;
+    Writer w(format, out);
+    writeObject(w, object, 0);
+    return out;
+}
+
+std::string
+encodeTransaction(ripple::STTx const& tx, OutputFormat format)
+{
+    checkBinary(format);
+    std::string out;
+    Writer w(format, out);
+    writeObject(w, tx, 1);
+    w.text("hash");
+    w.bytes(sliceOf(tx.getTransactionID()));
+    return out;
+}
+
+std::string
+decodeAs(std::string const& hex, BlobType type, OutputFormat format)
+{
+    using namespace ripple;
+
+    auto const blob = unhexScratch(hex);
+    if (!blob)
+        throw std::runtime_error("Invalid hex data");
+    if (type != BlobType::tx)
+        return encodeObject(decodeObject(*blob, type), format);
+    if (blob->empty())
+        throw std::runtime_error("No data");
+    SerialIter sit{*blob};
+    return encodeTransaction(STTx{sit}, format);
+}
+
+std::string
+encodeNull(OutputFormat format)
+{
+    checkBinary(format);
+    std::string out;
+    Writer(format, out).null();
+    return out;
+}
+
+}  // namespace offline
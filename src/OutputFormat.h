@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_OUTPUTFORMAT_H_INCLUDED
+#define OFFLINE_OUTPUTFORMAT_H_INCLUDED
+
+#include <Serialize.h>
+
+#include <ripple/protocol/STObject.h>
+#include <ripple/protocol/STTx.h>
+#include <string>
+
+namespace offline {
+
+/// How decoded objects are written.
+enum class OutputFormat {
+    /// Styled JSON, or one line of JSON per batch record.
+    json,
+    msgpack,
+    cbor,
+};
+
+/** Parse an output format name: json, msgpack or cbor.
+
+    @throws std::runtime_error if the name is not recognized
+*/
+OutputFormat
+parseOutputFormat(std::string const& name);
+
+/** Encode an object as MessagePack or CBOR.
+
+    The result is a map from field names to values, in field order,
+    taken from the fields themselves rather than their JSON:
+
+    - Integers are integers, except TransactionType, LedgerEntryType and
+      TransactionResult, which are their names, as in JSON.
+    - Hashes, blobs and AccountIDs are byte strings.
+    - XRP amounts are integer drops. Issued currency amounts are maps of
+      `value` (the mantissa), `exponent`, `currency` and `issuer`, and
+      MPT amounts are maps of `value` and `mpt_issuance_id`.
+    - Objects are maps, and arrays are arrays of single entry maps, as
+      in JSON. Paths are arrays of arrays of maps of `account`,
+      `currency` and `issuer`.
+    - Any other type is the byte string of its encoding.
+
+    @param format msgpack or cbor
+*/
+std::string
+encodeObject(ripple::STObject const& object, OutputFormat format);
+
+/// @copydoc encodeObject, with the transaction's `hash` added last.
+std::string
+encodeTransaction(ripple::STTx const& tx, OutputFormat format);
+
+/** Decode a hex blob, checked against the format of its type, as
+    MessagePack or CBOR. Transactions include their hash.
+
+    @throws std::runtime_error if the blob is not valid for the type, or
+        is a ledger header
+*/
+std::string
+decodeAs(std::string const& hex, BlobType type, OutputFormat format);
+
+/// The encoding of a null value, which stands in for a failed record.
+std::string
+encodeNull(OutputFormat format);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_OUTPUTFORMAT_H_INCLUDED
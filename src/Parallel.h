@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_PARALLEL_H_INCLUDED
+#define OFFLINE_PARALLEL_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace offline {
+
+/// Number of worker threads to use. Zero means one per hardware thread.
+inline unsigned
+workerCount(unsigned requested)
+{
+    return requested ? requested
+                     : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/** Call `f(i)` for every `i` in [0, count), spread over `threads` threads.
+
+    Indexes are handed out in small chunks on demand, so uneven work
+    balances itself. The calling thread is one of the workers. If any
+    call throws, the remaining indexes are skipped and the first
+    exception is rethrown once every thread has stopped.
+*/
+template <class F>
+void
+parallelFor(std::uint64_t count, unsigned threads, F&& f)
+{
+    threads = static_cast<unsigned>(
+        std::min<std::uint64_t>(workerCount(threads), count));
+    if (threads <= 1)
+    {
+        for (std::uint64_t i = 0; i < count; ++i)
+            f(i);
+        return;
+    }
+
+    std::uint64_t const chunk =
+        std::clamp<std::uint64_t>(count / (threads * 16), 1, 256);
+    std::atomic<std::uint64_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto const work = [&] {
+        try
+        {
+            while (!failed.load(std::memory_order_relaxed))
+            {
+                auto const begin =
+                    next.fetch_add(chunk, std::memory_order_relaxed);
+                if (begin >= count)
+                    break;
+                auto const end = std::min(begin + chunk, count);
+                for (auto i = begin; i < end; ++i)
+                    f(i);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back(work);
+    work();
+    for (auto& worker : workers)
+        worker.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}  // namespace offline
+
+#endif  // !OFFLINE_PARALLEL_H_INCLUDED
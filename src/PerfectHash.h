@@ -0,0 +1,202 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_PERFECTHASH_H_INCLUDED
+#define OFFLINE_PERFECTHASH_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace offline {
+
+/// FNV-1a, folded so the low bits depend on every byte.
+constexpr std::uint64_t
+perfectHash(std::string_view key)
+{
+    std::uint64_t h = 0xCBF29CE484222325ULL;
+    for (char const c : key)
+        h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ULL;
+    return h ^ (h >> 29);
+}
+
+/// A second hash of a key, from its `perfectHash` and a seed.
+constexpr std::uint64_t
+perfectHash(std::uint64_t hash, std::uint32_t seed)
+{
+    // The splitmix64 finalizer
+    auto h = hash ^ (seed * 0x9E3779B97F4A7C15ULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+/** A collision free hash table of `N` names, built at compile time.
+
+    Names are split into buckets by their hash, and each bucket is given
+    the seed of a second hash, mixed from the first, that puts all of
+    its names in empty slots. A lookup hashes the name once, and makes
+    at most one comparison.
+
+    Construction throws if the names aren't unique, so a table declared
+    `constexpr` with a duplicate name doesn't compile.
+*/
+template <std::size_t N>
+class PerfectHash
+{
+    static_assert(N > 0 && N < 0xFFFF, "Unsupported table size");
+
+    static constexpr std::size_t
+    powerOfTwo(std::size_t n)
+    {
+        std::size_t p = 1;
+        while (p < n)
+            p *= 2;
+        return p;
+    }
+
+    // Half full, with two names to a bucket on average
+    static constexpr std::size_t slotCount = powerOfTwo(2 * N);
+    static constexpr std::size_t bucketCount = (slotCount + 3) / 4;
+    static constexpr std::uint16_t empty = 0xFFFF;
+
+    std::array<std::string_view, N> names_{};
+    std::array<std::uint16_t, slotCount> slots_{};
+    std::array<std::uint32_t, bucketCount> seeds_{};
+
+    static constexpr std::size_t
+    bucket(std::uint64_t hash)
+    {
+        return hash & (bucketCount - 1);
+    }
+
+    static constexpr std::size_t
+    slot(std::uint64_t hash, std::uint32_t seed)
+    {
+        return perfectHash(hash, seed) & (slotCount - 1);
+    }
+
+    /** Find a seed that puts the `count` names at `members`, which are
+        bucket `b`, in empty slots. `taken` has room for a slot each.
+    */
+    constexpr void
+    place(
+        std::size_t b,
+        std::uint16_t const* members,
+        std::uint64_t const* hashes,
+        std::size_t count,
+        std::size_t* taken)
+    {
+        for (std::uint32_t seed = 1; seed < (1u << 20); ++seed)
+        {
+            bool fits = true;
+            for (std::size_t i = 0; fits && i < count; ++i)
+            {
+                auto const s = slot(hashes[members[i]], seed);
+                fits = slots_[s] == empty;
+                for (std::size_t j = 0; fits && j < i; ++j)
+                    fits = taken[j] != s;
+                taken[i] = s;
+            }
+            if (!fits)
+                continue;
+            for (std::size_t i = 0; i < count; ++i)
+                slots_[taken[i]] = members[i];
+            seeds_[b] = seed;
+            return;
+        }
+        throw std::logic_error("No perfect hash found");
+    }
+
+public:
+    constexpr explicit PerfectHash(std::array<std::string_view, N> const& names)
+        : names_(names)
+    {
+        // Hash each name once, and group the names by bucket, so that
+        // each seed tried only looks at the names of its own bucket
+        std::array<std::uint64_t, N> hashes{};
+        std::array<std::size_t, N> buckets{};
+        std::array<std::size_t, bucketCount + 1> starts{};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            hashes[i] = perfectHash(names_[i]);
+            buckets[i] = bucket(hashes[i]);
+            ++starts[buckets[i] + 1];
+        }
+        for (std::size_t b = 0; b < bucketCount; ++b)
+            starts[b + 1] += starts[b];
+        std::array<std::uint16_t, N> members{};
+        auto next = starts;
+        for (std::size_t i = 0; i < N; ++i)
+            members[next[buckets[i]]++] = static_cast<std::uint16_t>(i);
+
+        std::size_t largest = 0;
+        for (std::size_t b = 0; b < bucketCount; ++b)
+        {
+            // Equal names share every slot, so no seed would separate them
+            for (auto i = starts[b]; i < starts[b + 1]; ++i)
+                for (auto j = starts[b]; j < i; ++j)
+                    if (names_[members[i]] == names_[members[j]])
+                        throw std::logic_error("Duplicate name");
+            largest = std::max(largest, starts[b + 1] - starts[b]);
+        }
+        for (auto& s : slots_)
+            s = empty;
+        std::array<std::size_t, N> taken{};
+        // The largest buckets first, while there are the most empty slots
+        for (auto size = largest; size > 0; --size)
+            for (std::size_t b = 0; b < bucketCount; ++b)
+                if (starts[b + 1] - starts[b] == size)
+                    place(
+                        b,
+                        members.data() + starts[b],
+                        hashes.data(),
+                        size,
+                        taken.data());
+    }
+
+    /// The index of `name` in the table, or `N` if it isn't there.
+    constexpr std::size_t
+    find(std::string_view name) const
+    {
+        auto const hash = perfectHash(name);
+        auto const i = slots_[slot(hash, seeds_[bucket(hash)])];
+        return i != empty && names_[i] == name ? i : N;
+    }
+
+    static constexpr std::size_t
+    size()
+    {
+        return N;
+    }
+
+    constexpr std::string_view
+    operator[](std::size_t i) const
+    {
+        return names_[i];
+    }
+};
+
+}  // namespace offline
+
+#endif  // !OFFLINE_PERFECTHASH_H_INCLUDED
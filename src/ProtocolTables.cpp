@@ -0,0 +1,431 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <PerfectHash.h>
+#include <ProtocolTables.h>
+
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/protocol/TER.h>
+#include <ripple/protocol/TxFormats.h>
+#include <string>
+
+namespace offline {
+
+namespace {
+
+template <class Value>
+struct Entry
+{
+    std::string_view name;
+    Value value;
+};
+
+// The name is spelled the same as the library's identifier, so a field
+// or result missing from the library doesn't compile
+#define OFFLINE_FIELD(name) \
+    Entry<ripple::SField const*> { #name, &ripple::sf##name }
+#define OFFLINE_RESULT(code) \
+    Entry<int> { #code, ripple::code }
+
+constexpr Entry<ripple::SField const*> fields[] = {
+    // Integers
+    OFFLINE_FIELD(TransactionResult),
+    OFFLINE_FIELD(TickSize),
+    OFFLINE_FIELD(LedgerEntryType),
+    OFFLINE_FIELD(TransactionType),
+    OFFLINE_FIELD(SignerWeight),
+    OFFLINE_FIELD(TransferFee),
+    OFFLINE_FIELD(Flags),
+    OFFLINE_FIELD(SourceTag),
+    OFFLINE_FIELD(Sequence),
+    OFFLINE_FIELD(PreviousTxnLgrSeq),
+    OFFLINE_FIELD(LedgerSequence),
+    OFFLINE_FIELD(CloseTime),
+    OFFLINE_FIELD(ParentCloseTime),
+    OFFLINE_FIELD(SigningTime),
+    OFFLINE_FIELD(Expiration),
+    OFFLINE_FIELD(TransferRate),
+    OFFLINE_FIELD(OwnerCount),
+    OFFLINE_FIELD(DestinationTag),
+    OFFLINE_FIELD(QualityIn),
+    OFFLINE_FIELD(QualityOut),
+    OFFLINE_FIELD(OfferSequence),
+    OFFLINE_FIELD(FirstLedgerSequence),
+    OFFLINE_FIELD(LastLedgerSequence),
+    OFFLINE_FIELD(TransactionIndex),
+    OFFLINE_FIELD(SetFlag),
+    OFFLINE_FIELD(ClearFlag),
+    OFFLINE_FIELD(SignerQuorum),
+    OFFLINE_FIELD(CancelAfter),
+    OFFLINE_FIELD(FinishAfter),
+    OFFLINE_FIELD(SettleDelay),
+    OFFLINE_FIELD(TicketCount),
+    OFFLINE_FIELD(TicketSequence),
+    OFFLINE_FIELD(NFTokenTaxon),
+    OFFLINE_FIELD(IndexNext),
+    OFFLINE_FIELD(IndexPrevious),
+    OFFLINE_FIELD(BookNode),
+    OFFLINE_FIELD(OwnerNode),
+    OFFLINE_FIELD(ExchangeRate),
+    OFFLINE_FIELD(LowNode),
+    OFFLINE_FIELD(HighNode),
+    OFFLINE_FIELD(DestinationNode),
+    // Hashes
+    OFFLINE_FIELD(LedgerHash),
+    OFFLINE_FIELD(ParentHash),
+    OFFLINE_FIELD(TransactionHash),
+    OFFLINE_FIELD(AccountHash),
+    OFFLINE_FIELD(PreviousTxnID),
+    OFFLINE_FIELD(LedgerIndex),
+    OFFLINE_FIELD(RootIndex),
+    OFFLINE_FIELD(AccountTxnID),
+    OFFLINE_FIELD(NFTokenID),
+    OFFLINE_FIELD(BookDirectory),
+    OFFLINE_FIELD(InvoiceID),
+    OFFLINE_FIELD(Channel),
+    OFFLINE_FIELD(CheckID),
+    OFFLINE_FIELD(NFTokenBuyOffer),
+    OFFLINE_FIELD(NFTokenSellOffer),
+    // Amounts
+    OFFLINE_FIELD(Amount),
+    OFFLINE_FIELD(Balance),
+    OFFLINE_FIELD(LimitAmount),
+    OFFLINE_FIELD(TakerPays),
+    OFFLINE_FIELD(TakerGets),
+    OFFLINE_FIELD(LowLimit),
+    OFFLINE_FIELD(HighLimit),
+    OFFLINE_FIELD(Fee),
+    OFFLINE_FIELD(SendMax),
+    OFFLINE_FIELD(DeliverMin),
+    OFFLINE_FIELD(DeliveredAmount),
+    OFFLINE_FIELD(NFTokenBrokerFee),
+    // Blobs
+    OFFLINE_FIELD(PublicKey),
+    OFFLINE_FIELD(MessageKey),
+    OFFLINE_FIELD(SigningPubKey),
+    OFFLINE_FIELD(TxnSignature),
+    OFFLINE_FIELD(URI),
+    OFFLINE_FIELD(Signature),
+    OFFLINE_FIELD(Domain),
+    OFFLINE_FIELD(MemoType),
+    OFFLINE_FIELD(MemoData),
+    OFFLINE_FIELD(MemoFormat),
+    OFFLINE_FIELD(Fulfillment),
+    OFFLINE_FIELD(Condition),
+    // Accounts
+    OFFLINE_FIELD(Account),
+    OFFLINE_FIELD(Owner),
+    OFFLINE_FIELD(Destination),
+    OFFLINE_FIELD(Issuer),
+    OFFLINE_FIELD(Authorize),
+    OFFLINE_FIELD(Unauthorize),
+    OFFLINE_FIELD(RegularKey),
+    OFFLINE_FIELD(NFTokenMinter),
+    // Paths and vectors
+    OFFLINE_FIELD(Paths),
+    OFFLINE_FIELD(Indexes),
+    OFFLINE_FIELD(Hashes),
+    OFFLINE_FIELD(Amendments),
+    OFFLINE_FIELD(NFTokenOffers),
+    // Objects and arrays
+    OFFLINE_FIELD(TransactionMetaData),
+    OFFLINE_FIELD(CreatedNode),
+    OFFLINE_FIELD(DeletedNode),
+    OFFLINE_FIELD(ModifiedNode),
+    OFFLINE_FIELD(PreviousFields),
+    OFFLINE_FIELD(FinalFields),
+    OFFLINE_FIELD(NewFields),
+    OFFLINE_FIELD(Memo),
+    OFFLINE_FIELD(SignerEntry),
+    OFFLINE_FIELD(NFToken),
+    OFFLINE_FIELD(Signer),
+    OFFLINE_FIELD(Majority),
+    OFFLINE_FIELD(Signers),
+    OFFLINE_FIELD(SignerEntries),
+    OFFLINE_FIELD(AffectedNodes),
+    OFFLINE_FIELD(Memos),
+    OFFLINE_FIELD(NFTokens),
+    OFFLINE_FIELD(Majorities),
+};
+
+// Transaction type names aren't identifiers, so they're only checked by
+// the tests
+constexpr Entry<std::uint16_t> txTypes[] = {
+    {"Payment", ripple::ttPAYMENT},
+    {"EscrowCreate", ripple::ttESCROW_CREATE},
+    {"EscrowFinish", ripple::ttESCROW_FINISH},
+    {"AccountSet", ripple::ttACCOUNT_SET},
+    {"EscrowCancel", ripple::ttESCROW_CANCEL},
+    {"SetRegularKey", ripple::ttREGULAR_KEY_SET},
+    {"OfferCreate", ripple::ttOFFER_CREATE},
+    {"OfferCancel", ripple::ttOFFER_CANCEL},
+    {"TicketCreate", ripple::ttTICKET_CREATE},
+    {"SignerListSet", ripple::ttSIGNER_LIST_SET},
+    {"PaymentChannelCreate", ripple::ttPAYCHAN_CREATE},
+    {"PaymentChannelFund", ripple::ttPAYCHAN_FUND},
+    {"PaymentChannelClaim", ripple::ttPAYCHAN_CLAIM},
+    {"CheckCreate", ripple::ttCHECK_CREATE},
+    {"CheckCash", ripple::ttCHECK_CASH},
+    {"CheckCancel", ripple::ttCHECK_CANCEL},
+    {"DepositPreauth", ripple::ttDEPOSIT_PREAUTH},
+    {"TrustSet", ripple::ttTRUST_SET},
+    {"AccountDelete", ripple::ttACCOUNT_DELETE},
+    {"NFTokenMint", ripple::ttNFTOKEN_MINT},
+    {"NFTokenBurn", ripple::ttNFTOKEN_BURN},
+    {"NFTokenCreateOffer", ripple::ttNFTOKEN_CREATE_OFFER},
+    {"NFTokenCancelOffer", ripple::ttNFTOKEN_CANCEL_OFFER},
+    {"NFTokenAcceptOffer", ripple::ttNFTOKEN_ACCEPT_OFFER},
+    {"EnableAmendment", ripple::ttAMENDMENT},
+    {"SetFee", ripple::ttFEE},
+    {"UNLModify", ripple::ttUNL_MODIFY},
+};
+
+constexpr Entry<std::uint16_t> ledgerEntryTypes[] = {
+    {"AccountRoot", ripple::ltACCOUNT_ROOT},
+    {"DirectoryNode", ripple::ltDIR_NODE},
+    {"RippleState", ripple::ltRIPPLE_STATE},
+    {"Ticket", ripple::ltTICKET},
+    {"SignerList", ripple::ltSIGNER_LIST},
+    {"Offer", ripple::ltOFFER},
+    {"LedgerHashes", ripple::ltLEDGER_HASHES},
+    {"Amendments", ripple::ltAMENDMENTS},
+    {"FeeSettings", ripple::ltFEE_SETTINGS},
+    {"Escrow", ripple::ltESCROW},
+    {"PayChannel", ripple::ltPAYCHAN},
+    {"Check", ripple::ltCHECK},
+    {"DepositPreauth", ripple::ltDEPOSIT_PREAUTH},
+    {"NegativeUNL", ripple::ltNEGATIVE_UNL},
+    {"NFTokenPage", ripple::ltNFTOKEN_PAGE},
+    {"NFTokenOffer", ripple::ltNFTOKEN_OFFER},
+};
+
+constexpr Entry<int> results[] = {
+    OFFLINE_RESULT(tesSUCCESS),
+    OFFLINE_RESULT(tecCLAIM),
+    OFFLINE_RESULT(tecPATH_PARTIAL),
+    OFFLINE_RESULT(tecUNFUNDED_ADD),
+    OFFLINE_RESULT(tecUNFUNDED_OFFER),
+    OFFLINE_RESULT(tecUNFUNDED_PAYMENT),
+    OFFLINE_RESULT(tecFAILED_PROCESSING),
+    OFFLINE_RESULT(tecDIR_FULL),
+    OFFLINE_RESULT(tecINSUF_RESERVE_LINE),
+    OFFLINE_RESULT(tecINSUF_RESERVE_OFFER),
+    OFFLINE_RESULT(tecNO_DST),
+    OFFLINE_RESULT(tecNO_DST_INSUF_XRP),
+    OFFLINE_RESULT(tecNO_LINE_INSUF_RESERVE),
+    OFFLINE_RESULT(tecNO_LINE_REDUNDANT),
+    OFFLINE_RESULT(tecPATH_DRY),
+    OFFLINE_RESULT(tecUNFUNDED),
+    OFFLINE_RESULT(tecNO_ALTERNATIVE_KEY),
+    OFFLINE_RESULT(tecNO_REGULAR_KEY),
+    OFFLINE_RESULT(tecOWNERS),
+    OFFLINE_RESULT(tecNO_ISSUER),
+    OFFLINE_RESULT(tecNO_AUTH),
+    OFFLINE_RESULT(tecNO_LINE),
+    OFFLINE_RESULT(tecINSUFF_FEE),
+    OFFLINE_RESULT(tecFROZEN),
+    OFFLINE_RESULT(tecNO_TARGET),
+    OFFLINE_RESULT(tecNO_PERMISSION),
+    OFFLINE_RESULT(tecNO_ENTRY),
+    OFFLINE_RESULT(tecINSUFFICIENT_RESERVE),
+    OFFLINE_RESULT(tecNEED_MASTER_KEY),
+    OFFLINE_RESULT(tecDST_TAG_NEEDED),
+    OFFLINE_RESULT(tecINTERNAL),
+    OFFLINE_RESULT(tecOVERSIZE),
+    OFFLINE_RESULT(tecCRYPTOCONDITION_ERROR),
+    OFFLINE_RESULT(tecINVARIANT_FAILED),
+    OFFLINE_RESULT(tecEXPIRED),
+    OFFLINE_RESULT(tecDUPLICATE),
+    OFFLINE_RESULT(tecKILLED),
+    OFFLINE_RESULT(tecHAS_OBLIGATIONS),
+    OFFLINE_RESULT(tecTOO_SOON),
+};
+
+#undef OFFLINE_FIELD
+#undef OFFLINE_RESULT
+
+template <class Value, std::size_t N>
+constexpr std::array<std::string_view, N>
+namesOf(Entry<Value> const (&entries)[N])
+{
+    std::array<std::string_view, N> names{};
+    for (std::size_t i = 0; i < N; ++i)
+        names[i] = entries[i].name;
+    return names;
+}
+
+// Codes below 256, each mapped to its entry, or to N if none
+template <class Value, std::size_t N>
+constexpr std::array<std::uint8_t, 256>
+codesOf(Entry<Value> const (&entries)[N])
+{
+    static_assert(N < 256, "Too many codes");
+    std::array<std::uint8_t, 256> codes{};
+    for (auto& c : codes)
+        c = N;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        auto const code = static_cast<int>(entries[i].value);
+        if (code < 0 || code >= 256)
+            throw std::logic_error("Code out of range");
+        if (codes[code] != N)
+            throw std::logic_error("Duplicate code");
+        codes[code] = static_cast<std::uint8_t>(i);
+    }
+    return codes;
+}
+
+// Every name finds its own entry, and only that
+template <std::size_t N>
+constexpr bool
+findsAll(PerfectHash<N> const& table)
+{
+    for (std::size_t i = 0; i < N; ++i)
+        if (table.find(table[i]) != i)
+            return false;
+    return table.find("") == N && table.find("Invalid") == N;
+}
+
+constexpr PerfectHash<std::size(fields)> fieldNames(namesOf(fields));
+constexpr PerfectHash<std::size(txTypes)> txTypeNames(namesOf(txTypes));
+constexpr PerfectHash<std::size(ledgerEntryTypes)> ledgerEntryTypeNames(
+    namesOf(ledgerEntryTypes));
+constexpr PerfectHash<std::size(results)> resultNames(namesOf(results));
+
+constexpr auto txTypeCodes = codesOf(txTypes);
+constexpr auto ledgerEntryTypeCodes = codesOf(ledgerEntryTypes);
+constexpr auto resultCodes = codesOf(results);
+
+static_assert(findsAll(fieldNames));
+static_assert(findsAll(txTypeNames));
+static_assert(findsAll(ledgerEntryTypeNames));
+static_assert(findsAll(resultNames));
+static_assert(
+    txTypeCodes[ripple::ttPAYMENT] == 0 &&
+    resultCodes[ripple::tesSUCCESS] == 0);
+
+template <class Value, std::size_t N>
+std::optional<Value>
+findValue(
+    Entry<Value> const (&entries)[N],
+    PerfectHash<N> const& table,
+    std::string_view name)
+{
+    auto const i = table.find(name);
+    if (i == N)
+        return std::nullopt;
+    return entries[i].value;
+}
+
+template <class Value, std::size_t N>
+std::optional<std::string_view>
+findName(
+    Entry<Value> const (&entries)[N],
+    std::array<std::uint8_t, 256> const& codes,
+    int code)
+{
+    if (code < 0 || code >= 256 || codes[code] == N)
+        return std::nullopt;
+    return entries[codes[code]].name;
+}
+
+template <std::size_t N>
+std::vector<std::string_view>
+allNames(PerfectHash<N> const& table)
+{
+    std::vector<std::string_view> names;
+    for (std::size_t i = 0; i < N; ++i)
+        names.push_back(table[i]);
+    return names;
+}
+
+}  // namespace
+
+ripple::SField const&
+fieldByName(std::string_view name)
+{
+    if (auto const field = findValue(fields, fieldNames, name))
+        return **field;
+    return ripple::SField::getField(std::string(name));
+}
+
+std::optional<std::uint16_t>
+txTypeByName(std::string_view name)
+{
+    return findValue(txTypes, txTypeNames, name);
+}
+
+std::optional<std::uint16_t>
+ledgerEntryTypeByName(std::string_view name)
+{
+    return findValue(ledgerEntryTypes, ledgerEntryTypeNames, name);
+}
+
+std::optional<int>
+resultByName(std::string_view name)
+{
+    return findValue(results, resultNames, name);
+}
+
+std::optional<std::string_view>
+txTypeName(std::uint16_t type)
+{
+    return findName(txTypes, txTypeCodes, type);
+}
+
+std::optional<std::string_view>
+ledgerEntryTypeName(std::uint16_t type)
+{
+    return findName(ledgerEntryTypes, ledgerEntryTypeCodes, type);
+}
+
+std::optional<std::string_view>
+resultName(int code)
+{
+    return findName(results, resultCodes, code);
+}
+
+std::vector<std::string_view>
+knownFieldNames()
+{
+    return allNames(fieldNames);
+}
+
+std::vector<std::string_view>
+knownTxTypeNames()
+{
+    return allNames(txTypeNames);
+}
+
+std::vector<std::string_view>
+knownLedgerEntryTypeNames()
+{
+    return allNames(ledgerEntryTypeNames);
+}
+
+std::vector<std::string_view>
+knownResultNames()
+{
+    return allNames(resultNames);
+}
+
+}  // namespace offline
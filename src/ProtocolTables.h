@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_PROTOCOLTABLES_H_INCLUDED
+#define OFFLINE_PROTOCOLTABLES_H_INCLUDED
+
+#include <ripple/protocol/SField.h>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/** Protocol names, looked up in tables built at compile time.
+
+    The tables hold the fields, transaction types, ledger entry types and
+    results that appear in nearly every transaction and ledger entry,
+    taken from the libxrpl definitions. Looking one up is a perfect hash
+    instead of the library's maps of strings. Names that aren't in the
+    tables, such as those added by newer versions of the library, are
+    left to the library.
+*/
+namespace offline {
+
+/// The same as `ripple::SField::getField`, including `sfInvalid` for
+/// unknown names.
+ripple::SField const&
+fieldByName(std::string_view name);
+
+std::optional<std::uint16_t>
+txTypeByName(std::string_view name);
+
+std::optional<std::uint16_t>
+ledgerEntryTypeByName(std::string_view name);
+
+/// The code of a `tes` or `tec` result.
+std::optional<int>
+resultByName(std::string_view name);
+
+std::optional<std::string_view>
+txTypeName(std::uint16_t type);
+
+std::optional<std::string_view>
+ledgerEntryTypeName(std::uint16_t type);
+
+std::optional<std::string_view>
+resultName(int code);
+
+/// Every name in each table, to check them against the library.
+std::vector<std::string_view>
+knownFieldNames();
+
+std::vector<std::string_view>
+knownTxTypeNames();
+
+std::vector<std::string_view>
+knownLedgerEntryTypeNames();
+
+std::vector<std::string_view>
+knownResultNames();
+
+}  // namespace offline
+
+#endif  // !OFFLINE_PROTOCOLTABLES_H_INCLUDED
@@ -0,0 +1,378 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Base58.h>
+#include <Parallel.h>
+#include <Recover.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/crypto/RFC1751.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/Seed.h>
+#include <ripple/protocol/jss.h>
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace offline {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// Candidates a worker checks at a time
+std::uint64_t constexpr groupSize = 64;
+// Candidates checked between looks at the clock, at first and at most
+std::uint64_t constexpr minChunkSize = 4096;
+std::uint64_t constexpr maxChunkSize = 1 << 24;
+
+// The number of ways to fill `unknowns` places with `choices` each
+std::uint64_t
+candidateCount(std::uint64_t choices, std::size_t unknowns)
+{
+    std::uint64_t count = 1;
+    for (std::size_t i = 0; i < unknowns; ++i)
+    {
+        if (count > std::numeric_limits<std::uint64_t>::max() / choices)
+            throw std::runtime_error(
+                "Too many unknowns to search: " + std::to_string(unknowns));
+        count *= choices;
+    }
+    return count;
+}
+
+/// A base58 seed, with `?` for each unknown character.
+class Base58Pattern
+{
+private:
+    std::string text_;
+    std::vector<std::size_t> unknowns_;
+
+public:
+    explicit Base58Pattern(std::string const& text) : text_(text)
+    {
+        // Every 16 byte family seed encodes to this many digits
+        if (text_.size() != 29)
+            throw std::runtime_error(
+                "A seed has 29 characters, not " +
+                std::to_string(text_.size()) + ": " + text_);
+        for (std::size_t i = 0; i < text_.size(); ++i)
+        {
+            if (text_[i] == '?')
+                unknowns_.push_back(i);
+            else if (!text_[i] || !std::strchr(base58Alphabet, text_[i]))
+                throw std::runtime_error(
+                    "Invalid seed character '" + text_.substr(i, 1) +
+                    "' at position " + std::to_string(i + 1));
+        }
+    }
+
+    std::uint64_t
+    count() const
+    {
+        return candidateCount(58, unknowns_.size());
+    }
+
+    /// Candidate `i`, or nothing if its checksum is wrong.
+    std::optional<ripple::Seed>
+    operator()(std::uint64_t i) const
+    {
+        // Reused by every candidate the thread checks
+        thread_local std::string candidate;
+
+        candidate = text_;
+        for (auto const position : unknowns_)
+        {
+            candidate[position] = base58Alphabet[i % 58];
+            i /= 58;
+        }
+        std::array<std::uint8_t, 16> payload;
+        if (!decodeToken(
+                candidate,
+                ripple::TokenType::FamilySeed,
+                payload.data(),
+                payload.size()))
+            return std::nullopt;
+        return ripple::Seed(ripple::Slice(payload.data(), payload.size()));
+    }
+};
+
+// The index of each RFC 1751 word
+std::unordered_map<std::string, std::uint16_t> const&
+wordIndexes()
+{
+    static auto const indexes = [] {
+        std::unordered_map<std::string, std::uint16_t> indexes;
+        for (std::uint16_t w = 0; w < 2048; ++w)
+        {
+            // The first word of a key is its first 11 bits
+            std::string key(16, '\0');
+            key[0] = static_cast<char>(w >> 3);
+            key[1] = static_cast<char>((w & 7) << 5);
+            std::string english;
+            ripple::RFC1751::getEnglishFromKey(english, key);
+            indexes.emplace(english.substr(0, english.find(' ')), w);
+        }
+        return indexes;
+    }();
+    return indexes;
+}
+
+// The sum of the 2 bit groups of `data`, modulo 4
+std::size_t
+parity(std::uint64_t data)
+{
+    std::uint64_t constexpr low = 0x5555555555555555;
+    auto const ones = std::bitset<64>(data & low).count();
+    auto const twos = std::bitset<64>(data & ~low).count();
+    return (ones + 2 * twos) & 3;
+}
+
+/** The twelve RFC 1751 words of a seed, with `?` for each unknown word.
+
+    Each six words hold 64 bits of the key and 2 bits of parity, so
+    three in four candidates for a half with an unknown word are
+    discarded without deriving a key.
+*/
+class WordPattern
+{
+private:
+    std::array<std::uint16_t, 12> words_{};
+    std::vector<std::size_t> unknowns_;
+
+public:
+    explicit WordPattern(std::string const& text)
+    {
+        std::istringstream ss(text);
+        std::vector<std::string> words;
+        for (std::string word; ss >> word;)
+            words.push_back(word);
+        if (words.size() != words_.size())
+            throw std::runtime_error(
+                "A seed has 12 words, not " + std::to_string(words.size()));
+
+        auto const& indexes = wordIndexes();
+        for (std::size_t i = 0; i < words.size(); ++i)
+        {
+            if (words[i] == "?")
+            {
+                unknowns_.push_back(i);
+                continue;
+            }
+            // The same normalization as RFC1751::getKeyFromEnglish
+            auto word = words[i];
+            for (auto& c : word)
+            {
+                c = static_cast<char>(
+                    std::toupper(static_cast<unsigned char>(c)));
+                if (c == '1')
+                    c = 'L';
+                else if (c == '0')
+                    c = 'O';
+                else if (c == '5')
+                    c = 'S';
+            }
+            auto const it = indexes.find(word);
+            if (it == indexes.end())
+                throw std::runtime_error("Unknown word: " + words[i]);
+            words_[i] = it->second;
+        }
+    }
+
+    std::uint64_t
+    count() const
+    {
+        return candidateCount(2048, unknowns_.size());
+    }
+
+    /// Candidate `i`, or nothing if the parity of either half is wrong.
+    std::optional<ripple::Seed>
+    operator()(std::uint64_t i) const
+    {
+        auto words = words_;
+        for (auto const position : unknowns_)
+        {
+            words[position] = static_cast<std::uint16_t>(i & 2047);
+            i >>= 11;
+        }
+        std::array<std::uint8_t, 16> key;
+        for (std::size_t half = 0; half < 2; ++half)
+        {
+            auto const w = words.data() + 6 * half;
+            std::uint64_t const data = (std::uint64_t{w[0]} << 53) |
+                (std::uint64_t{w[1]} << 42) | (std::uint64_t{w[2]} << 31) |
+                (std::uint64_t{w[3]} << 20) | (std::uint64_t{w[4]} << 9) |
+                (w[5] >> 2);
+            if (parity(data) != (w[5] & 3u))
+                return std::nullopt;
+            boost::endian::store_big_u64(key.data() + 8 * half, data);
+        }
+        // The words are of the seed's bytes in reverse
+        std::reverse(key.begin(), key.end());
+        return ripple::Seed(ripple::Slice(key.data(), key.size()));
+    }
+};
+
+std::string
+formatDuration(double seconds)
+{
+    auto const s = static_cast<std::uint64_t>(seconds + 0.5);
+    std::ostringstream ss;
+    if (s >= 86400)
+        ss << s / 86400 << "d " << s % 86400 / 3600 << "h";
+    else if (s >= 3600)
+        ss << s / 3600 << "h " << s % 3600 / 60 << "m";
+    else if (s >= 60)
+        ss << s / 60 << "m " << s % 60 << "s";
+    else
+        ss << s << "s";
+    return ss.str();
+}
+
+template <class Pattern>
+std::optional<ripple::Seed>
+search(Pattern const& pattern, std::ostream& err, RecoverOptions const& options)
+{
+    using namespace ripple;
+
+    auto const total = pattern.count();
+    err << "Searching " << total << " candidates" << std::endl;
+
+    std::atomic<std::uint64_t> checked{0};
+    std::atomic<std::uint64_t> valid{0};
+    std::atomic<bool> found{false};
+    std::optional<Seed> result;
+    std::mutex resultMutex;
+
+    auto const start = clock_type::now();
+    auto reported = start;
+    auto const elapsed = [&start](clock_type::time_point now) {
+        return std::chrono::duration<double>(now - start).count();
+    };
+    auto chunkSize = minChunkSize;
+    for (std::uint64_t begin = 0; begin < total && !found;)
+    {
+        auto const size = std::min(chunkSize, total - begin);
+        auto const chunkStart = clock_type::now();
+        auto const groups = (size + groupSize - 1) / groupSize;
+        parallelFor(groups, options.threads, [&](std::uint64_t group) {
+            if (found.load(std::memory_order_relaxed))
+                return;
+            auto const from = begin + group * groupSize;
+            auto const to = std::min(from + groupSize, begin + size);
+            auto i = from;
+            std::uint64_t survivors = 0;
+            for (; i < to; ++i)
+            {
+                auto const seed = pattern(i);
+                if (!seed)
+                    continue;
+                ++survivors;
+                auto const publicKey =
+                    generateKeyPair(options.keyType, *seed).first;
+                if (calcAccountID(publicKey) == options.account)
+                {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    result = seed;
+                    found = true;
+                    ++i;
+                    break;
+                }
+            }
+            checked.fetch_add(i - from, std::memory_order_relaxed);
+            valid.fetch_add(survivors, std::memory_order_relaxed);
+        });
+        begin += size;
+
+        auto const now = clock_type::now();
+        // Grow the chunks until one takes a tenth of a second, so
+        // progress is timely however long a candidate takes to check
+        if (now - chunkStart < std::chrono::milliseconds(100) &&
+            chunkSize < maxChunkSize)
+            chunkSize *= 2;
+        if (options.progressInterval.count() && begin < total && !found &&
+            now - reported >= options.progressInterval)
+        {
+            reported = now;
+            auto const rate = begin / elapsed(now);
+            err << "Checked " << begin << " of " << total << " candidates ("
+                << std::fixed << std::setprecision(1)
+                << 100.0 * begin / total << "%), "
+                << static_cast<std::uint64_t>(rate) << " per second, about "
+                << formatDuration((total - begin) / rate) << " left"
+                << std::defaultfloat << std::endl;
+        }
+    }
+
+    err << "Checked " << checked << " candidates, " << valid
+        << " with a valid checksum or parity, in "
+        << formatDuration(elapsed(clock_type::now())) << std::endl;
+    return result;
+}
+
+}  // namespace
+
+int
+runRecover(
+    std::string const& partial,
+    std::ostream& out,
+    std::ostream& err,
+    RecoverOptions const& options)
+{
+    using namespace ripple;
+
+    auto const words = partial.find_first_of(" \t\n") != std::string::npos;
+    auto const seed = words ? search(WordPattern(partial), err, options)
+                            : search(Base58Pattern(partial), err, options);
+    if (!seed)
+    {
+        err << "No seed matches " << encodeAccount(options.account)
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Enough of a key file to sign with
+    Json::Value jv(Json::objectValue);
+    jv[jss::key_type] = to_string(options.keyType);
+    jv[jss::master_seed] =
+        encodeToken(TokenType::FamilySeed, Slice(seed->data(), seed->size()));
+    jv[jss::master_seed_hex] = strHex(*seed);
+    jv[jss::master_key] = seedAs1751(*seed);
+    jv[jss::account_id] = encodeAccount(options.account);
+    out << toCompactJson(std::move(jv)) << std::endl;
+    return EXIT_SUCCESS;
+}
+
+}  // namespace offline
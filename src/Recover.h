@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_RECOVER_H_INCLUDED
+#define OFFLINE_RECOVER_H_INCLUDED
+
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/KeyType.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace offline {
+
+struct RecoverOptions
+{
+    /// The account of the seed's master key.
+    ripple::AccountID account;
+    ripple::KeyType keyType = ripple::KeyType::secp256k1;
+    /// Zero means one per hardware thread.
+    unsigned threads = 0;
+    /// How often progress is written. Zero writes none.
+    std::chrono::milliseconds progressInterval{1000};
+};
+
+/** Search for the seed that `partial` is missing parts of.
+
+    `partial` is either a base58 seed with a `?` for each unknown
+    character, or the twelve RFC 1751 words of a key file's `master_key`
+    with a `?` for each unknown word. Candidates are checked in
+    parallel, and only those that pass the base58 checksum or the word
+    parity have a key derived from them.
+
+    Writes the seed to `out` as a one line key file, and progress, with
+    the rate and the time left, to `err`.
+
+    @return EXIT_SUCCESS if a seed matches `options.account`, otherwise
+        EXIT_FAILURE
+
+    @throws std::runtime_error if `partial` is invalid, or has too many
+        unknowns to search
+*/
+int
+runRecover(
+    std::string const& partial,
+    std::ostream& out,
+    std::ostream& err,
+    RecoverOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_RECOVER_H_INCLUDED
@@ -18,18 +18,131 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 //==============================================================================
 
+#include <AllocTracker.h>
+#include <Base58.h>
 #include <RippleKey.h>
 
 #include <ripple/basics/strHex.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/to_string.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/protocol/Sign.h>
 #include <ripple/protocol/jss.h>
+#include <boost/endian/conversion.hpp>
 #include <boost/filesystem.hpp>
+#include <secp256k1.h>
 #include <fstream>
+#include <limits>
 
 namespace offline {
 
+namespace {
+
+secp256k1_context const*
+secp256k1Context()
+{
+    static secp256k1_context const* const context =
+        secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    return context;
+}
+
+std::uint8_t*
+putUInt32(std::uint8_t* out, std::uint32_t value)
+{
+    boost::endian::store_big_u32(out, value);
+    return out + 4;
+}
+
+// The first hash of `prefix` and a counter that is a valid secret key,
+// the same as rippled's deterministic key derivation
+template <std::size_t N>
+ripple::uint256
+firstValidKey(std::array<std::uint8_t, N + 4>& buffer)
+{
+    for (std::uint32_t counter = 0;; ++counter)
+    {
+        putUInt32(buffer.data() + N, counter);
+        auto const key = ripple::sha512Half_s(ripple::makeSlice(buffer));
+        if (secp256k1_ec_seckey_verify(secp256k1Context(), key.data()) == 1)
+            return key;
+        if (counter == std::numeric_limits<std::uint32_t>::max())
+            throw std::runtime_error("Unable to derive key");
+    }
+}
+
+}  // namespace
+
+ripple::Seed
+parseSeed(std::string const& rawseed)
+{
+    // Most seeds are base58, which parseGenericSeed only tries
+    // after ruling out every other kind of token
+    auto seed = decodeSeed(rawseed);
+    if (!seed)
+        seed = ripple::parseGenericSeed(rawseed);
+
+    if (!seed)
+        throw std::runtime_error("Unable to parse seed: " + rawseed);
+    return *seed;
+}
+
+FamilyGenerator::FamilyGenerator(ripple::Seed const& seed)
+    : seed_(seed), root_([&] {
+        std::array<std::uint8_t, 20> buffer;
+        std::copy(seed.begin(), seed.end(), buffer.begin());
+        auto const root = firstValidKey<16>(buffer);
+        return ripple::SecretKey(ripple::Slice(root.data(), root.size()));
+    }())
+{
+    auto const context = secp256k1Context();
+    secp256k1_pubkey point;
+    std::size_t size = generator_.size();
+    if (secp256k1_ec_pubkey_create(context, &point, root_.data()) != 1 ||
+        secp256k1_ec_pubkey_serialize(
+            context,
+            generator_.data(),
+            &size,
+            &point,
+            SECP256K1_EC_COMPRESSED) != 1)
+        throw std::runtime_error("Unable to derive key");
+}
+
+std::pair<ripple::PublicKey, ripple::SecretKey>
+FamilyGenerator::operator()(std::uint32_t ordinal) const
+{
+    using namespace ripple;
+
+    std::array<std::uint8_t, 41> buffer;
+    putUInt32(
+        std::copy(generator_.begin(), generator_.end(), buffer.begin()),
+        ordinal);
+    auto const tweak = firstValidKey<37>(buffer);
+
+    // The account's secret is the root plus the tweak, and its public
+    // key is computed from that directly, which is cheaper than adding
+    // the tweak to the generator
+    auto const context = secp256k1Context();
+    std::array<std::uint8_t, 32> secret;
+    std::copy(root_.data(), root_.data() + root_.size(), secret.begin());
+    secp256k1_pubkey point;
+    std::array<std::uint8_t, 33> compressed;
+    std::size_t size = compressed.size();
+    if (secp256k1_ec_privkey_tweak_add(
+            context, secret.data(), tweak.data()) != 1 ||
+        secp256k1_ec_pubkey_create(context, &point, secret.data()) != 1 ||
+        secp256k1_ec_pubkey_serialize(
+            context,
+            compressed.data(),
+            &size,
+            &point,
+            SECP256K1_EC_COMPRESSED) != 1)
+        throw std::runtime_error("Unable to derive key");
+
+    SecretKey secretKey(makeSlice(secret));
+    std::fill(secret.begin(), secret.end(), 0);
+    return {PublicKey(makeSlice(compressed)), std::move(secretKey)};
+}
+
 RippleKey::RippleKey(ripple::KeyType const& keyType, ripple::Seed const& seed)
     : keyType_(keyType), seed_(seed)
 {
@@ -37,20 +150,25 @@ RippleKey::RippleKey(ripple::KeyType const& keyType, ripple::Seed const& seed)
     std::tie(publicKey_, secretKey_) = generateKeyPair(keyType_, seed_);
 }
 
+RippleKey::RippleKey(
+    FamilyGenerator const& family,
+    std::uint32_t accountIndex,
+    std::pair<ripple::PublicKey, ripple::SecretKey> const& keyPair)
+    : keyType_(ripple::KeyType::secp256k1)
+    , seed_(family.seed())
+    , publicKey_(keyPair.first)
+    , secretKey_(keyPair.second)
+    , accountIndex_(accountIndex)
+{
+}
+
 RippleKey
 RippleKey::make_RippleKey(
     std::optional<ripple::KeyType> const& keyType,
     std::optional<std::string> const& rawseed)
 {
     if (keyType && rawseed)
-    {
-        auto const seed = ripple::parseGenericSeed(*rawseed);
-
-        if (!seed)
-            throw std::runtime_error("Unable to parse seed: " + *rawseed);
-
-        return RippleKey{*keyType, *seed};
-    }
+        return RippleKey{*keyType, parseSeed(*rawseed)};
     if (rawseed)
         return RippleKey::make_RippleKey(RippleKey::defaultKeyType(), *rawseed);
     if (keyType)
@@ -98,8 +216,34 @@ RippleKey::make_RippleKey(boost::filesystem::path const& keyFile)
             "\" found in key file: " + keyFile.string());
     }
 
+    if (!jKeys.isMember("account_index"))
+        return RippleKey::make_RippleKey(
+            *keyType, jKeys[jss::master_seed].asString());
+
+    auto const& accountIndex = jKeys["account_index"];
+    if (!accountIndex.isIntegral() ||
+        (accountIndex.isInt() && accountIndex.asInt() < 0))
+        throw std::runtime_error(
+            "Invalid 'account_index' field found in key file: " +
+            keyFile.string());
+    if (*keyType != KeyType::secp256k1)
+        throw std::runtime_error(
+            "Only secp256k1 keys have an 'account_index', in key file: " +
+            keyFile.string());
     return RippleKey::make_RippleKey(
-        *keyType, jKeys[jss::master_seed].asString());
+        FamilyGenerator(parseSeed(jKeys[jss::master_seed].asString())),
+        accountIndex.asUInt());
+}
+
+RippleKey
+RippleKey::make_RippleKey(
+    FamilyGenerator const& family,
+    std::uint32_t accountIndex,
+    std::optional<std::pair<ripple::PublicKey, ripple::SecretKey>> const&
+        keyPair)
+{
+    return RippleKey{
+        family, accountIndex, keyPair ? *keyPair : family(accountIndex)};
 }
 
 void
@@ -110,14 +254,20 @@ RippleKey::writeToFile(boost::filesystem::path const& keyFile) const
 
     Json::Value jv(Json::objectValue);
     jv[jss::key_type] = to_string(keyType_);
-    jv[jss::master_seed] = toBase58(seed_);
+    jv[jss::master_seed] =
+        encodeToken(TokenType::FamilySeed, Slice(seed_.data(), seed_.size()));
     jv[jss::master_seed_hex] = strHex(seed_);
     jv[jss::master_key] = seedAs1751(seed_);
-    jv[jss::account_id] = toBase58(calcAccountID(publicKey_));
-    jv[jss::public_key] = toBase58(TokenType::AccountPublic, publicKey_);
+    jv[jss::account_id] = encodeAccount(calcAccountID(publicKey_));
+    jv[jss::public_key] =
+        encodeToken(TokenType::AccountPublic, publicKey_.slice());
     jv[jss::public_key_hex] = strHex(publicKey_);
-    jv["secret_key"] = toBase58(TokenType::AccountSecret, secretKey_);
+    jv["secret_key"] = encodeToken(
+        TokenType::AccountSecret,
+        Slice(secretKey_.data(), secretKey_.size()));
     jv["secret_key_hex"] = strHex(secretKey_);
+    if (accountIndex_)
+        jv["account_index"] = accountIndex_;
 
     if (!keyFile.parent_path().empty())
     {
@@ -146,6 +296,7 @@ RippleKey::singleSign(std::optional<ripple::STTx>& tx) const
             "Internal error.  "
             "Empty std::optional passed to RippleKey::singleSign.");
     }
+    alloc::Tally const tally(alloc::Operation::singleSign);
     using namespace ripple;
     tx->setFieldVL(sfSigningPubKey, publicKey_.slice());
     tx->makeFieldAbsent(sfSigners);
@@ -161,6 +312,7 @@ RippleKey::multiSign(std::optional<ripple::STTx>& tx) const
             "Internal error.  "
             "Empty std::optional passed to RippleKey::multiSign.");
     }
+    alloc::Tally const tally(alloc::Operation::multiSign);
     using namespace ripple;
     tx->setFieldVL(sfSigningPubKey, Slice{nullptr, 0});
     tx->makeFieldAbsent(sfTxnSignature);
@@ -192,10 +344,11 @@ RippleKey::multiSign(std::optional<ripple::STTx>& tx) const
         });
 
     // Re-serialize this signed and sorted STTx so the hash is freshly computed.
-    Serializer s2;
+    // The buffer is reused by every transaction the thread signs.
+    thread_local Serializer s2;
+    s2.erase();
     tx->add(s2);
-    Blob txBlob = s2.getData();
-    SerialIter sit{makeSlice(txBlob)};
+    SerialIter sit{s2.slice()};
     tx.emplace(sit);
 }
 
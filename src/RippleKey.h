@@ -18,7 +18,14 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 //==============================================================================
 
+#ifndef OFFLINE_RIPPLEKEY_H_INCLUDED
+#define OFFLINE_RIPPLEKEY_H_INCLUDED
+
 #include <ripple/protocol/st.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
 
 namespace boost {
 namespace filesystem {
@@ -28,6 +35,44 @@ class path;
 
 namespace offline {
 
+/** Parse a seed in any of the forms `ripple::parseGenericSeed` accepts.
+
+    @throws std::runtime_error if `rawseed` can't be parsed
+*/
+ripple::Seed
+parseSeed(std::string const& rawseed);
+
+/** The family of secp256k1 keys derived from one seed.
+
+    rippled derives a root key and its public generator from the seed,
+    and the key of each account ordinal from the generator. Only ordinal
+    0 is used for a seed's master key. The root is derived once here,
+    so each further account costs one hash and one point multiplication.
+*/
+class FamilyGenerator
+{
+private:
+    ripple::Seed seed_;
+    ripple::SecretKey root_;
+    // The compressed public key of the root
+    std::array<std::uint8_t, 33> generator_;
+
+public:
+    explicit FamilyGenerator(ripple::Seed const& seed);
+
+    ripple::Seed const&
+    seed() const
+    {
+        return seed_;
+    }
+
+    /** The key pair of account `ordinal`. Safe to call from any number
+        of threads at once.
+    */
+    std::pair<ripple::PublicKey, ripple::SecretKey>
+    operator()(std::uint32_t ordinal) const;
+};
+
 class RippleKey
 {
 private:
@@ -39,6 +84,13 @@ private:
     ripple::Seed seed_;
     ripple::PublicKey publicKey_;
     ripple::SecretKey secretKey_;
+    // The account ordinal within the seed's secp256k1 family
+    std::uint32_t accountIndex_ = 0;
+
+    RippleKey(
+        FamilyGenerator const& family,
+        std::uint32_t accountIndex,
+        std::pair<ripple::PublicKey, ripple::SecretKey> const& keyPair);
 
 public:
     RippleKey() : RippleKey(RippleKey::defaultKeyType())
@@ -74,6 +126,18 @@ public:
     static RippleKey
     make_RippleKey(boost::filesystem::path const& keyFile);
 
+    /** Returns the secp256k1 key of account `accountIndex` in a family
+
+        @param keyPair The key pair `family` derives for `accountIndex`,
+            if it has already been derived
+    */
+    static RippleKey
+    make_RippleKey(
+        FamilyGenerator const& family,
+        std::uint32_t accountIndex,
+        std::optional<std::pair<ripple::PublicKey, ripple::SecretKey>> const&
+            keyPair = std::nullopt);
+
     /** Write key to JSON file
 
         @param keyFile Path to file to write
@@ -113,5 +177,14 @@ public:
     {
         return publicKey_;
     }
+
+    /// Account ordinal of this key within its seed's family
+    std::uint32_t
+    accountIndex() const
+    {
+        return accountIndex_;
+    }
 };
 }  // namespace offline
+
+#endif  // !OFFLINE_RIPPLEKEY_H_INCLUDED
@@ -18,21 +18,51 @@
 */
 //==============================================================================
 
+#include <AddressCache.h>
+#include <AllocTracker.h>
+#include <AmountParser.h>
+#include <Ledger.h>
+#include <ProtocolTables.h>
 #include <Serialize.h>
 
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/base64.h>
+#include <ripple/basics/safe_cast.h>
 #include <ripple/basics/strHex.h>
 #include <ripple/json/json_reader.h>
+#include <ripple/json/json_writer.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/LedgerFormats.h>
 #include <ripple/protocol/Sign.h>
+#include <boost/container/small_vector.hpp>
 #include <boost/filesystem.hpp>
 #include <fstream>
+#include <sstream>
+#include <utility>
 
 namespace offline {
 
+namespace {
+
+// Decode whole bytes of hex into `out`, which has room for them
+bool
+unhexBytes(std::string_view hex, std::uint8_t* out)
+{
+    for (std::size_t i = 0; i < hex.size(); i += 2)
+    {
+        auto const hi = ripple::charUnHex(hex[i]);
+        auto const lo = ripple::charUnHex(hex[i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        *out++ = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+}  // namespace
+
 Json::Value
 parseJson(std::string const& raw)
 {
@@ -56,32 +86,83 @@ makeObject(Json::Value const& json)
     return parsed.object;
 }
 
+std::optional<ripple::STObject>
+makeObject(Json::Value&& json)
+{
+    using namespace ripple;
+
+    if (!json.isObject())
+        return makeObject(std::as_const(json));
+
+    // A transaction has at most a few, such as Amount and Fee
+    boost::container::small_vector<std::pair<SField const*, STAmount>, 4>
+        amounts;
+    for (auto it = json.begin(); it != json.end(); ++it)
+    {
+        auto const& field = fieldByName(it.memberName());
+        if (field.fieldType == STI_AMOUNT)
+        {
+            if (auto amount = parseAmount(*it))
+                amounts.emplace_back(&field, std::move(*amount));
+        }
+        else if (it->isString())
+        {
+            // Names the library would look up again, given as codes
+            auto const name = std::string_view(it->asCString());
+            std::optional<int> code;
+            if (field == sfTransactionType)
+                code = txTypeByName(name);
+            else if (field == sfLedgerEntryType)
+                code = ledgerEntryTypeByName(name);
+            else if (field == sfTransactionResult)
+                code = resultByName(name);
+            if (code)
+                *it = static_cast<Json::UInt>(*code);
+        }
+    }
+    for (auto const& [field, amount] : amounts)
+        json.removeMember(field->getJsonName());
+
+    auto object = makeObject(std::as_const(json));
+    // Fields are serialized in canonical order, not the order they are set
+    for (auto const& [field, amount] : amounts)
+        object->setFieldAmount(*field, amount);
+    return object;
+}
+
 std::string
 serialize(ripple::STObject const& object)
 {
     using namespace ripple;
+    alloc::Tally const tally(alloc::Operation::serialize);
 
-    return strHex(object.getSerializer().peekData());
+    // Reused by every object the thread serializes
+    thread_local Serializer s;
+    s.erase();
+    object.add(s);
+    return strHex(s.slice());
 }
 
 std::optional<ripple::STObject>
 deserialize(std::string const& blob)
 {
     using namespace ripple;
+    alloc::Tally const tally(alloc::Operation::deserialize);
 
-    auto const unhex{strUnHex(blob)};
+    auto const unhex = unhexScratch(blob);
 
-    if (!unhex || !unhex->size())
+    if (!unhex || unhex->empty())
         return {};
 
-    SerialIter sitTrans{makeSlice(*unhex)};
+    SerialIter sitTrans{*unhex};
     // Can Throw
     return STObject{std::ref(sitTrans), sfGeneric};
 }
 
 ripple::STTx
-make_sttx(std::string const& data)
+make_sttx(std::string const& data, AddressCache* addresses)
 {
+    alloc::Tally const tally(alloc::Operation::makeSttx);
     std::optional<ripple::STObject> obj;
     try
     {
@@ -95,11 +176,12 @@ make_sttx(std::string const& data)
     }
     if (!obj)
     {
-        auto const json = offline::parseJson(data);
-        if (json)
-            obj = offline::makeObject(json);
-        else
+        auto json = offline::parseJson(data);
+        if (!json)
             throw std::runtime_error("invalid JSON");
+        if (addresses)
+            addresses->resolve(json);
+        obj = offline::makeObject(std::move(json));
         if (!obj)
             throw std::runtime_error("invalid JSON");
     }
@@ -111,4 +193,138 @@ make_sttx(std::string const& data)
     return STTx{std::move(*obj)};
 }
 
+BlobType
+parseBlobType(std::string const& name)
+{
+    if (name == "tx")
+        return BlobType::tx;
+    if (name == "meta")
+        return BlobType::meta;
+    if (name == "ledger-entry")
+        return BlobType::ledgerEntry;
+    if (name == "ledger-header")
+        return BlobType::ledgerHeader;
+    throw std::runtime_error("Unknown blob type: " + name);
+}
+
+ripple::STObject
+decodeObject(ripple::Slice data, BlobType type)
+{
+    using namespace ripple;
+
+    if (data.empty())
+        throw std::runtime_error("No data");
+
+    SerialIter sit{data};
+    auto const checkEnd = [&sit] {
+        if (!sit.empty())
+            throw std::runtime_error(
+                std::to_string(sit.getBytesLeft()) + " bytes of trailing data");
+    };
+    switch (type)
+    {
+        case BlobType::tx:
+            // Checks the template, and reads to the end
+            return STTx{sit};
+        case BlobType::meta: {
+            STObject meta{sit, sfTransactionMetaData};
+            checkEnd();
+            if (!meta.isFieldPresent(sfTransactionIndex) ||
+                !meta.isFieldPresent(sfTransactionResult) ||
+                !meta.isFieldPresent(sfAffectedNodes))
+                throw std::runtime_error("Not transaction metadata");
+            return meta;
+        }
+        case BlobType::ledgerEntry: {
+            STObject entry{sit, sfLedgerEntry};
+            checkEnd();
+            if (!entry.isFieldPresent(sfLedgerEntryType))
+                throw std::runtime_error("Not a ledger entry");
+            auto const format = LedgerFormats::getInstance().findByType(
+                safe_cast<LedgerEntryType>(
+                    entry.getFieldU16(sfLedgerEntryType)));
+            if (!format)
+                throw std::runtime_error("Unknown ledger entry type");
+            // Can throw
+            entry.applyTemplate(format->getSOTemplate());
+            return entry;
+        }
+        case BlobType::ledgerHeader:
+            throw std::runtime_error("A ledger header is not an object");
+        default: {
+            STObject object{sit, sfGeneric};
+            checkEnd();
+            return object;
+        }
+    }
+}
+
+Json::Value
+decode(ripple::Slice data, BlobType type)
+{
+    using namespace ripple;
+    alloc::Tally const tally(alloc::Operation::deserialize);
+
+    if (data.empty())
+        throw std::runtime_error("No data");
+    if (type == BlobType::ledgerHeader)
+        return LedgerHeader::fromSlice(data).getJson();
+    if (type == BlobType::tx)
+    {
+        // Includes the hash
+        SerialIter sit{data};
+        return STTx{sit}.getJson(JsonOptions::none);
+    }
+    return decodeObject(data, type).getJson(JsonOptions::none);
+}
+
+Json::Value
+decode(std::string const& hex, BlobType type)
+{
+    using namespace ripple;
+
+    auto const blob = unhexScratch(hex);
+    if (!blob)
+        throw std::runtime_error("Invalid hex data");
+    return decode(*blob, type);
+}
+
+bool
+unhexInto(std::string_view hex, ripple::Blob& blob)
+{
+    if (hex.size() % 2)
+        return false;
+    blob.resize(hex.size() / 2);
+    return unhexBytes(hex, blob.data()) && !blob.empty();
+}
+
+std::optional<ripple::Slice>
+unhexScratch(std::string_view hex)
+{
+    // Reused by every call on the thread
+    thread_local ripple::Blob blob;
+
+    blob.resize((hex.size() + 1) / 2);
+    auto out = blob.data();
+    if (hex.size() % 2)
+    {
+        auto const lo = ripple::charUnHex(hex.front());
+        if (lo < 0)
+            return std::nullopt;
+        *out++ = static_cast<std::uint8_t>(lo);
+        hex.remove_prefix(1);
+    }
+    if (!unhexBytes(hex, out))
+        return std::nullopt;
+    return ripple::makeSlice(blob);
+}
+
+std::string
+toCompactJson(Json::Value&& jv)
+{
+    std::ostringstream ss;
+    ss << Json::Compact{std::move(jv)};
+    return ss.str();
+}
+
 }  // namespace offline
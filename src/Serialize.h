@@ -18,10 +18,14 @@
 */
 //==============================================================================
 
+#ifndef OFFLINE_SERIALIZE_H_INCLUDED
+#define OFFLINE_SERIALIZE_H_INCLUDED
+
 #include <ripple/protocol/KeyType.h>
 #include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/st.h>
 #include <optional>
+#include <string_view>
 
 namespace boost {
 namespace filesystem {
@@ -31,19 +35,97 @@ class path;
 
 namespace offline {
 
+class AddressCache;
+
 Json::Value
 parseJson(std::string const& json);
 
 std::optional<ripple::STObject>
 makeObject(Json::Value const& json);
 
+/** Make an object from JSON it may take apart.
+
+    Top level amounts are parsed without the library's regular
+    expression, and removed from `json` before the rest is parsed.
+    Transaction type, ledger entry type and result names are replaced
+    by their codes, found in the protocol tables, so the library doesn't
+    look them up. It still looks up the name of each field it parses.
+*/
+std::optional<ripple::STObject>
+makeObject(Json::Value&& json);
+
 std::string
 serialize(ripple::STObject const& tx);
 
 std::optional<ripple::STObject>
 deserialize(std::string const& blob);
 
+/** Make a transaction from serialized hex, or else JSON.
+
+    @param addresses If set, resolves the addresses of JSON input
+*/
 ripple::STTx
-make_sttx(std::string const& data);
+make_sttx(std::string const& data, AddressCache* addresses = nullptr);
+
+/// What a serialized blob is expected to hold.
+enum class BlobType {
+    /// Any object. Fields are not checked against a format.
+    generic,
+    tx,
+    meta,
+    ledgerEntry,
+    ledgerHeader,
+};
+
+/** Parse a blob type name: tx, meta, ledger-entry or ledger-header.
+
+    @throws std::runtime_error if the name is not recognized
+*/
+BlobType
+parseBlobType(std::string const& name);
+
+/** Deserialize a blob, checking it against the format of its type.
+
+    @throws std::runtime_error if the blob is not valid for the type, has
+        trailing data, or is a ledger header, which is not an object
+*/
+ripple::STObject
+decodeObject(ripple::Slice data, BlobType type);
+
+/** Decode a blob to JSON, checking it against the format of its type.
+
+    @throws std::runtime_error if the blob is not valid for the type, or
+        has trailing data
+*/
+Json::Value
+decode(ripple::Slice data, BlobType type);
+
+/// @copydoc decode(ripple::Slice, BlobType)
+Json::Value
+decode(std::string const& hex, BlobType type);
+
+/** Decode hex into `blob`, reusing its storage.
+
+    @return false if the hex is empty or invalid
+*/
+bool
+unhexInto(std::string_view hex, ripple::Blob& blob);
+
+/** Decode hex into a buffer owned by the calling thread.
+
+    Saves an allocation per record in loops that decode and discard.
+    Odd length hex has a leading nibble, as with `ripple::strUnHex`.
+
+    @return the decoded bytes, which are valid until the thread's next
+        call, or nothing if the hex is invalid
+*/
+std::optional<ripple::Slice>
+unhexScratch(std::string_view hex);
+
+/// Single line JSON, for output with one record per line.
+std::string
+toCompactJson(Json::Value&& jv);
 
 }  // namespace offline
+
+#endif  // !OFFLINE_SERIALIZE_H_INCLUDED
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <StartupTiming.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+namespace offline {
+namespace startup {
+
+namespace {
+
+std::int64_t
+now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::int64_t preinit = 0;
+std::int64_t mainEntry = 0;
+
+#if defined(__GNUC__)
+// Priority 101 is the first available to applications. It runs before
+// the default priority initializers of every object linked into the
+// executable, including the rippled libraries. Initializers of shared
+// libraries, such as the C++ runtime, have already run by this point.
+__attribute__((constructor(101))) void
+markPreinit()
+{
+    preinit = now();
+}
+#else
+// No portable way to run first. Static initialization order within the
+// executable is unspecified, so this may land anywhere in the phase.
+[[maybe_unused]] std::int64_t const preinitMarker = (preinit = now());
+#endif
+
+}  // namespace
+
+void
+mainEntered()
+{
+    mainEntry = now();
+}
+
+void
+commandFinished()
+{
+    auto const done = now();
+    auto const path = std::getenv("OFFLINE_STARTUP_TIMING");
+    if (!path || !*path)
+        return;
+    std::ofstream o(path, std::ios::trunc);
+    o << "preinit " << preinit << "\n"
+      << "main " << mainEntry << "\n"
+      << "done " << done << "\n";
+}
+
+}  // namespace startup
+}  // namespace offline
@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_STARTUPTIMING_H_INCLUDED
+#define OFFLINE_STARTUPTIMING_H_INCLUDED
+
+namespace offline {
+
+/** Timestamps of the process startup phases, for the startup benchmark.
+
+    If the OFFLINE_STARTUP_TIMING environment variable names a file,
+    `commandFinished` writes three steady clock timestamps to it, in
+    nanoseconds: before the static initializers of this executable run,
+    when `main` is entered, and when the command finished. The harness
+    compares them with its own clock readings around the spawn to split
+    the wall time into exec, static-init, command and exit phases.
+
+    The steady clock must be system wide for the comparison to be valid,
+    as it is on Linux and macOS.
+*/
+namespace startup {
+
+/// Call first thing in `main`.
+void
+mainEntered();
+
+/// Call when the command's output has been written.
+void
+commandFinished();
+
+}  // namespace startup
+
+}  // namespace offline
+
+#endif  // !OFFLINE_STARTUPTIMING_H_INCLUDED
@@ -0,0 +1,340 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Parallel.h>
+#include <Serialize.h>
+#include <StateHash.h>
+#include <TreeHash.h>
+
+#include <ripple/json/json_reader.h>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <queue>
+
+namespace offline {
+
+namespace {
+
+std::size_t constexpr leafBytes = 64;
+
+bool
+keyLess(TreeLeaf const& a, TreeLeaf const& b)
+{
+    return a.key < b.key;
+}
+
+// Sort chunks in parallel, then merge pairs of chunks in parallel. The
+// merges go back and forth between `leaves` and `scratch`, so they need
+// no other memory.
+void
+parallelSort(
+    std::vector<TreeLeaf>& leaves,
+    std::vector<TreeLeaf>& scratch,
+    unsigned threads)
+{
+    std::size_t const chunks = workerCount(threads);
+    auto const width =
+        std::max<std::size_t>((leaves.size() + chunks - 1) / chunks, 1);
+    auto const at = [&](std::vector<TreeLeaf>& v, std::size_t i) {
+        return v.begin() + std::min(i, v.size());
+    };
+    parallelFor(chunks, threads, [&](std::uint64_t c) {
+        std::sort(at(leaves, c * width), at(leaves, (c + 1) * width), keyLess);
+    });
+    if (width >= leaves.size())
+        return;
+
+    scratch.resize(leaves.size());
+    auto* from = &leaves;
+    auto* to = &scratch;
+    for (auto w = width; w < leaves.size(); w *= 2)
+    {
+        auto const pairs = (leaves.size() + 2 * w - 1) / (2 * w);
+        parallelFor(pairs, threads, [&](std::uint64_t p) {
+            auto const begin = p * 2 * w;
+            std::merge(
+                at(*from, begin),
+                at(*from, begin + w),
+                at(*from, begin + w),
+                at(*from, begin + 2 * w),
+                at(*to, begin),
+                keyLess);
+        });
+        std::swap(from, to);
+    }
+    if (from != &leaves)
+        leaves.swap(scratch);
+}
+
+// A sorted run of leaves on disk, removed when done
+class RunFile
+{
+private:
+    boost::filesystem::path path_;
+
+public:
+    RunFile(
+        boost::filesystem::path const& dir,
+        std::vector<TreeLeaf> const& leaves)
+        : path_(dir / boost::filesystem::unique_path(
+                          "offline-state-%%%%-%%%%-%%%%.run"))
+    {
+        std::ofstream out(path_.string(), std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error(
+                "Cannot create sorted run: " + path_.string());
+        for (auto const& leaf : leaves)
+        {
+            out.write(reinterpret_cast<char const*>(leaf.key.data()), 32);
+            out.write(reinterpret_cast<char const*>(leaf.hash.data()), 32);
+        }
+        if (!out.flush())
+            throw std::runtime_error(
+                "Cannot write sorted run: " + path_.string());
+    }
+
+    RunFile(RunFile&& other) noexcept : path_(std::move(other.path_))
+    {
+        other.path_.clear();
+    }
+
+    RunFile&
+    operator=(RunFile&&) = delete;
+
+    ~RunFile()
+    {
+        if (!path_.empty())
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove(path_, ec);
+        }
+    }
+
+    boost::filesystem::path const&
+    path() const
+    {
+        return path_;
+    }
+};
+
+// Reads the leaves of a run back, a buffer at a time
+class RunReader
+{
+private:
+    std::ifstream in_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+
+public:
+    RunReader(RunFile const& file, std::size_t bufferBytes)
+        : in_(file.path().string(), std::ios::binary)
+        , buffer_(std::max(bufferBytes / leafBytes, std::size_t{1}) * leafBytes)
+    {
+        if (!in_)
+            throw std::runtime_error(
+                "Cannot open sorted run: " + file.path().string());
+    }
+
+    bool
+    next(TreeLeaf& leaf)
+    {
+        if (pos_ == end_)
+        {
+            in_.read(buffer_.data(), buffer_.size());
+            end_ = static_cast<std::size_t>(in_.gcount());
+            pos_ = 0;
+            if (end_ % leafBytes)
+                throw std::runtime_error("Truncated sorted run");
+            if (!end_)
+                return false;
+        }
+        std::copy_n(&buffer_[pos_], 32, leaf.key.begin());
+        std::copy_n(&buffer_[pos_ + 32], 32, leaf.hash.begin());
+        pos_ += leafBytes;
+        return true;
+    }
+};
+
+ripple::uint256
+mergeRuns(std::vector<RunFile> const& runs, std::size_t bufferBytes)
+{
+    std::vector<RunReader> readers;
+    readers.reserve(runs.size());
+    for (auto const& run : runs)
+        readers.emplace_back(run, bufferBytes / runs.size());
+
+    // The smallest key first
+    using Head = std::pair<TreeLeaf, std::size_t>;
+    auto const greater = [](Head const& a, Head const& b) {
+        return b.first.key < a.first.key;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(
+        greater);
+    for (std::size_t i = 0; i < readers.size(); ++i)
+    {
+        TreeLeaf leaf;
+        if (readers[i].next(leaf))
+            heads.emplace(leaf, i);
+    }
+
+    TreeRootBuilder builder;
+    while (!heads.empty())
+    {
+        auto [leaf, i] = heads.top();
+        heads.pop();
+        builder.add(leaf);
+        if (readers[i].next(leaf))
+            heads.emplace(leaf, i);
+    }
+    return builder.finish();
+}
+
+}  // namespace
+
+StateHashResult
+hashState(std::istream& in, StateHashOptions const& options)
+{
+    using namespace ripple;
+
+    auto const start = std::chrono::steady_clock::now();
+    auto const threads = workerCount(options.threads);
+    auto const tempDir = options.tempDir.empty()
+        ? boost::filesystem::temp_directory_path()
+        : boost::filesystem::path(options.tempDir);
+
+    // A quarter of the budget holds hashed leaves, and a quarter is the
+    // scratch space to sort them. A quarter holds entries waiting to be
+    // hashed, and the rest is for parsing pages.
+    auto const runCapacity =
+        std::max<std::size_t>(options.memoryBudget / 4 / sizeof(TreeLeaf), 1);
+    auto const pendingCapacity =
+        std::max<std::size_t>(options.memoryBudget / 4, 1);
+
+    StateHashResult result;
+    std::vector<TreeLeaf> run;
+    std::vector<TreeLeaf> scratch;
+    std::vector<RunFile> runs;
+    std::vector<std::pair<uint256, Blob>> pending;
+    std::size_t pendingBytes = 0;
+
+    auto const spill = [&] {
+        parallelSort(run, scratch, threads);
+        runs.emplace_back(tempDir, run);
+        run.clear();
+    };
+    auto const hashPending = [&] {
+        if (run.size() + pending.size() > runCapacity && !run.empty())
+            spill();
+        auto const base = run.size();
+        run.resize(base + pending.size());
+        stateLeaves(pending, run.data() + base, threads);
+        result.entries += pending.size();
+        pending.clear();
+        pendingBytes = 0;
+    };
+
+    std::string line;
+    for (std::size_t lineNumber = 1; std::getline(in, line); ++lineNumber)
+    {
+        boost::trim(line);
+        if (line.empty())
+            continue;
+        try
+        {
+            Json::Value jv;
+            if (!Json::Reader{}.parse(line, jv))
+                throw std::runtime_error("Invalid JSON");
+            auto page = LedgerDump::fromJson(jv);
+            if (page.header && !result.header)
+                result.header = page.header;
+            for (auto& entry : page.state)
+            {
+                pendingBytes += entry.second.size() + sizeof(entry);
+                pending.push_back(std::move(entry));
+            }
+        }
+        catch (std::exception const& e)
+        {
+            throw std::runtime_error(
+                "Line " + std::to_string(lineNumber) + ": " + e.what());
+        }
+        if (pendingBytes >= pendingCapacity)
+            hashPending();
+    }
+    hashPending();
+
+    if (runs.empty())
+    {
+        // Everything fit in memory
+        result.root = treeRoot(std::move(run), threads);
+    }
+    else
+    {
+        if (!run.empty())
+            spill();
+        // The merge has half of the budget to itself
+        std::vector<TreeLeaf>().swap(run);
+        std::vector<TreeLeaf>().swap(scratch);
+        result.root = mergeRuns(runs, options.memoryBudget / 2);
+    }
+    result.runs = runs.size();
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+int
+runVerifyState(
+    std::istream& in,
+    std::ostream& out,
+    StateHashOptions const& options)
+{
+    using namespace ripple;
+
+    auto const result = hashState(in, options);
+    auto const seconds =
+        std::chrono::duration<double>(result.elapsed).count();
+
+    Json::Value jv(Json::objectValue);
+    jv["account_hash"] = to_string(result.root);
+    jv["entries"] = static_cast<Json::UInt>(result.entries);
+    jv["sorted_runs"] = static_cast<Json::UInt>(result.runs);
+    jv["seconds"] = seconds;
+    jv["entries_per_second"] = seconds > 0 ? result.entries / seconds : 0.0;
+    bool verified = true;
+    if (result.header)
+    {
+        verified = result.root == result.header->accountHash;
+        jv["ledger_index"] = result.header->seq;
+        jv["expected_account_hash"] = to_string(result.header->accountHash);
+        jv["verified"] = verified;
+    }
+    out << toCompactJson(std::move(jv)) << std::endl;
+    return verified ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace offline
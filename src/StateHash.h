@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_STATEHASH_H_INCLUDED
+#define OFFLINE_STATEHASH_H_INCLUDED
+
+#include <Ledger.h>
+
+#include <ripple/basics/base_uint.h>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+namespace offline {
+
+struct StateHashOptions
+{
+    /// Approximate memory to use, in bytes.
+    std::size_t memoryBudget = std::size_t{1} << 30;
+    /// Number of worker threads. Zero means one per hardware thread.
+    unsigned threads = 0;
+    /// Where to write sorted runs. Empty means the system temp directory.
+    std::string tempDir;
+};
+
+struct StateHashResult
+{
+    ripple::uint256 root;
+    std::uint64_t entries = 0;
+    /// Sorted runs written to disk. Zero if everything fit in memory.
+    std::size_t runs = 0;
+    /// The header of the first page that has one.
+    std::optional<LedgerHeader> header;
+    std::chrono::nanoseconds elapsed{};
+};
+
+/** Compute the state tree root of a `ledger_data` dump, within a memory
+    budget.
+
+    The input is one binary `ledger_data` (or `ledger`) result per line,
+    as fetched page by page. Entries are hashed in parallel as they are
+    read. When the hashed leaves fill a quarter of the budget, they are
+    sorted by key, with another quarter as scratch space, and written to
+    a temporary file. The sorted runs are then
+    merged, and the root is computed in a single streaming pass that
+    holds only the inner nodes on the path to the latest leaf.
+
+    @throws std::runtime_error if the input can't be read, or holds an
+        entry twice
+*/
+StateHashResult
+hashState(std::istream& in, StateHashOptions const& options);
+
+/** Compute the state tree root of the dump read from `in` and write it,
+    with the entry count and throughput, as one line of JSON to `out`.
+
+    @return EXIT_FAILURE if the dump has a ledger header, and its
+        account_hash does not match, otherwise EXIT_SUCCESS
+*/
+int
+runVerifyState(
+    std::istream& in,
+    std::ostream& out,
+    StateHashOptions const& options);
+
+}  // namespace offline
+
+#endif  // !OFFLINE_STATEHASH_H_INCLUDED
@@ -0,0 +1,236 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <Trace.h>
+
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace offline {
+namespace trace {
+
+namespace {
+
+struct Event
+{
+    char const* name;
+    std::uint64_t start;
+    // Duration for spans, value for counters
+    std::int64_t value;
+    std::uint64_t record;
+    char phase;
+};
+
+struct ThreadBuffer
+{
+    std::vector<Event> events;
+    std::uint64_t next = 0;
+    std::size_t tid;
+    std::string name;
+
+    ThreadBuffer(std::size_t capacity, std::size_t id)
+        : events(capacity), tid(id), name("thread " + std::to_string(id))
+    {
+    }
+
+    void
+    push(Event const& e)
+    {
+        events[next % events.size()] = e;
+        ++next;
+    }
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::size_t capacity = defaultCapacity;
+    // Bumped by every `enable` so threads know to re-register
+    std::atomic<std::uint64_t> generation{0};
+    std::chrono::steady_clock::time_point epoch =
+        std::chrono::steady_clock::now();
+};
+
+Registry&
+registry()
+{
+    static Registry r;
+    return r;
+}
+
+ThreadBuffer&
+localBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+    thread_local std::uint64_t generation = 0;
+
+    auto& r = registry();
+    auto const current = r.generation.load(std::memory_order_acquire);
+    if (!buffer || generation != current)
+    {
+        // Only taken the first time a thread records after `enable`
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.push_back(
+            std::make_unique<ThreadBuffer>(r.capacity, r.buffers.size()));
+        buffer = r.buffers.back().get();
+        generation = current;
+    }
+    return *buffer;
+}
+
+void
+writeEscaped(std::ostream& os, std::string const& s)
+{
+    os << '"';
+    for (auto const c : s)
+    {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+               << static_cast<int>(c) << std::dec << std::setfill(' ');
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+void
+writeMicros(std::ostream& os, std::uint64_t nanos)
+{
+    os << nanos / 1000 << '.' << std::setw(3) << std::setfill('0')
+       << nanos % 1000 << std::setfill(' ');
+}
+
+}  // namespace
+
+namespace detail {
+
+std::atomic<bool> enabled{false};
+
+std::uint64_t
+now()
+{
+    using namespace std::chrono;
+    // Offset by one so that a valid timestamp is never zero
+    return duration_cast<nanoseconds>(
+               steady_clock::now() - registry().epoch)
+               .count() +
+        1;
+}
+
+void
+complete(char const* name, std::uint64_t start, std::uint64_t record)
+{
+    auto const end = now();
+    localBuffer().push(
+        {name, start, static_cast<std::int64_t>(end - start), record, 'X'});
+}
+
+}  // namespace detail
+
+void
+enable(std::size_t capacity)
+{
+    auto& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.clear();
+        r.capacity = capacity ? capacity : 1;
+        r.epoch = std::chrono::steady_clock::now();
+    }
+    r.generation.fetch_add(1, std::memory_order_acq_rel);
+    detail::enabled.store(true, std::memory_order_release);
+}
+
+void
+disable()
+{
+    detail::enabled.store(false, std::memory_order_release);
+}
+
+void
+setThreadName(std::string const& name)
+{
+    if (enabled())
+        localBuffer().name = name;
+}
+
+void
+counter(char const* name, std::int64_t value)
+{
+    if (enabled())
+        localBuffer().push({name, detail::now(), value, 0, 'C'});
+}
+
+void
+write(std::ostream& os)
+{
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto const separator = [&] {
+        if (!first)
+            os << ",\n";
+        first = false;
+    };
+    for (auto const& buffer : r.buffers)
+    {
+        separator();
+        os << R"({"ph":"M","pid":1,"tid":)" << buffer->tid
+           << R"(,"name":"thread_name","args":{"name":)";
+        writeEscaped(os, buffer->name);
+        os << "}}";
+
+        auto const size = buffer->events.size();
+        auto const begin = buffer->next > size ? buffer->next - size : 0;
+        for (auto i = begin; i < buffer->next; ++i)
+        {
+            auto const& e = buffer->events[i % size];
+            separator();
+            os << R"({"ph":")" << e.phase << R"(","pid":1,"tid":)"
+               << buffer->tid << R"(,"name":)";
+            writeEscaped(os, e.name);
+            os << R"(,"ts":)";
+            writeMicros(os, e.start);
+            if (e.phase == 'X')
+            {
+                os << R"(,"dur":)";
+                writeMicros(os, static_cast<std::uint64_t>(e.value));
+                os << R"(,"args":{"record":)" << e.record << "}}";
+            }
+            else
+            {
+                os << R"(,"args":{"value":)" << e.value << "}}";
+            }
+        }
+    }
+    os << "]}\n";
+}
+
+}  // namespace trace
+}  // namespace offline
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef OFFLINE_TRACE_H_INCLUDED
+#define OFFLINE_TRACE_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace offline {
+
+/** Chrome trace-event recorder.
+
+    Each recording thread appends to its own fixed size ring buffer, so
+    recording takes no locks. When a buffer fills up, the oldest events
+    are overwritten. The buffers are only read by `write`, which must be
+    called after every recording thread has finished.
+
+    The output can be loaded into Perfetto or chrome://tracing.
+*/
+namespace trace {
+
+/// Default number of events kept per thread.
+std::size_t constexpr defaultCapacity = 1 << 16;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+
+std::uint64_t
+now();
+
+void
+complete(
+    char const* name,
+    std::uint64_t start,
+    std::uint64_t record);
+}  // namespace detail
+
+/** Start recording, discarding anything previously recorded.
+
+    @param capacity Number of events kept per thread
+*/
+void
+enable(std::size_t capacity = defaultCapacity);
+
+/// Stop recording. Recorded events are kept until the next `enable`.
+void
+disable();
+
+inline bool
+enabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Name the calling thread's track in the trace output.
+void
+setThreadName(std::string const& name);
+
+/** Record the value of a counter track, e.g. a queue depth.
+
+    @param name Counter name. Must be a string literal.
+    @param value Current value
+*/
+void
+counter(char const* name, std::int64_t value);
+
+/** RAII timer recording a complete ("X") event for one pipeline stage.
+
+    @note `name` must be a string literal, since only the pointer is
+        stored.
+*/
+class Span
+{
+private:
+    char const* const name_;
+    std::uint64_t const record_;
+    std::uint64_t const start_;
+
+public:
+    Span(char const* name, std::uint64_t record)
+        : name_(name), record_(record), start_(enabled() ? detail::now() : 0)
+    {
+    }
+
+    Span(Span const&) = delete;
+    Span&
+    operator=(Span const&) = delete;
+
+    ~Span()
+    {
+        if (start_ && enabled())
+            detail::complete(name_, start_, record_);
+    }
+};
+
+/** Write everything recorded as Chrome trace-event JSON.
+
+    @note Not thread safe with respect to recording threads.
+*/
+void
+write(std::ostream& os);
+
+}  // namespace trace
+
+}  // namespace offline
+
+#endif  // !OFFLINE_TRACE_H_INCLUDED
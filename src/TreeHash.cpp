@@ -0,0 +1,329 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <MultiHash.h>
+#include <Parallel.h>
+#include <TreeHash.h>
+
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+#include <algorithm>
+
+namespace offline {
+
+namespace {
+
+using Leaves = std::vector<TreeLeaf>;
+
+// Leaves hashed side by side by each worker in turn
+std::size_t constexpr hashGroup = 64;
+
+std::uint32_t
+prefixOf(ripple::HashPrefix prefix)
+{
+    return static_cast<std::uint32_t>(prefix);
+}
+
+ripple::Slice
+sliceOf(ripple::uint256 const& key)
+{
+    return {key.data(), key.size()};
+}
+
+unsigned
+nibble(ripple::uint256 const& key, unsigned depth)
+{
+    auto const byte = key.data()[depth / 2];
+    return (depth & 1) ? (byte & 0x0F) : (byte >> 4);
+}
+
+// The number of leading nibbles two keys share
+unsigned
+sharedNibbles(ripple::uint256 const& a, ripple::uint256 const& b)
+{
+    auto const byte = static_cast<unsigned>(
+        std::mismatch(a.begin(), a.end(), b.begin()).first - a.begin());
+    if (byte == a.size())
+        return 64;
+    return byte * 2 + (nibble(a, byte * 2) == nibble(b, byte * 2));
+}
+
+// The end of the run of leaves from `begin` that share the nibble at
+// `depth`
+std::size_t
+branchEnd(
+    Leaves const& leaves,
+    std::size_t begin,
+    std::size_t end,
+    unsigned depth)
+{
+    auto const branch = nibble(leaves[begin].key, depth);
+    auto i = begin + 1;
+    while (i < end && nibble(leaves[i].key, depth) == branch)
+        ++i;
+    return i;
+}
+
+// The hash of the inner node at `depth` over [begin, end), which share
+// their first `depth` nibbles
+ripple::uint256
+innerHash(
+    Leaves const& leaves,
+    std::size_t begin,
+    std::size_t end,
+    unsigned depth)
+{
+    std::array<ripple::uint256, 16> children{};
+    for (auto i = begin; i < end;)
+    {
+        auto const j = branchEnd(leaves, i, end, depth);
+        children[nibble(leaves[i].key, depth)] = j - i == 1
+            ? leaves[i].hash
+            : innerHash(leaves, i, j, depth + 1);
+        i = j;
+    }
+    return innerNodeHash(children);
+}
+
+}  // namespace
+
+ripple::uint256
+transactionID(ripple::Slice tx)
+{
+    return ripple::sha512Half(ripple::HashPrefix::transactionID, tx);
+}
+
+ripple::uint256
+transactionLeafHash(
+    ripple::Slice tx,
+    ripple::Slice meta,
+    ripple::uint256 const& id)
+{
+    using namespace ripple;
+
+    Serializer s(tx.size() + meta.size() + 8);
+    s.addVL(tx);
+    s.addVL(meta);
+    return sha512Half(HashPrefix::txNode, s.slice(), id);
+}
+
+ripple::uint256
+stateLeafHash(ripple::Slice data, ripple::uint256 const& key)
+{
+    return ripple::sha512Half(ripple::HashPrefix::leafNode, data, key);
+}
+
+std::vector<TreeLeaf>
+transactionLeaves(
+    std::vector<std::pair<ripple::Blob, ripple::Blob>> const& txs,
+    unsigned threads)
+{
+    using namespace ripple;
+
+    std::vector<TreeLeaf> leaves(txs.size());
+    auto const groups = (txs.size() + hashGroup - 1) / hashGroup;
+    parallelFor(groups, threads, [&](std::uint64_t group) {
+        // Reused by every group a worker hashes
+        thread_local std::vector<HashInput> inputs;
+        thread_local std::vector<uint256> hashes;
+        thread_local std::vector<Serializer> nodes(hashGroup);
+
+        auto const begin = group * hashGroup;
+        auto const end = std::min<std::size_t>(begin + hashGroup, txs.size());
+        inputs.clear();
+        for (auto i = begin; i < end; ++i)
+            inputs.push_back(
+                {prefixOf(HashPrefix::transactionID),
+                 makeSlice(txs[i].first),
+                 {}});
+        hashes.resize(inputs.size());
+        sha512HalfMany(inputs.data(), inputs.size(), hashes.data());
+
+        for (auto i = begin; i < end; ++i)
+        {
+            auto& node = nodes[i - begin];
+            node.erase();
+            node.addVL(makeSlice(txs[i].first));
+            node.addVL(makeSlice(txs[i].second));
+            leaves[i].key = hashes[i - begin];
+            inputs[i - begin] = {
+                prefixOf(HashPrefix::txNode),
+                node.slice(),
+                sliceOf(leaves[i].key)};
+        }
+        sha512HalfMany(inputs.data(), inputs.size(), hashes.data());
+        for (auto i = begin; i < end; ++i)
+            leaves[i].hash = hashes[i - begin];
+    });
+    return leaves;
+}
+
+void
+stateLeaves(
+    std::vector<std::pair<ripple::uint256, ripple::Blob>> const& entries,
+    TreeLeaf* leaves,
+    unsigned threads)
+{
+    using namespace ripple;
+
+    auto const groups = (entries.size() + hashGroup - 1) / hashGroup;
+    parallelFor(groups, threads, [&](std::uint64_t group) {
+        thread_local std::vector<HashInput> inputs;
+        thread_local std::vector<uint256> hashes;
+
+        auto const begin = group * hashGroup;
+        auto const end =
+            std::min<std::size_t>(begin + hashGroup, entries.size());
+        inputs.clear();
+        for (auto i = begin; i < end; ++i)
+            inputs.push_back(
+                {prefixOf(HashPrefix::leafNode),
+                 makeSlice(entries[i].second),
+                 sliceOf(entries[i].first)});
+        hashes.resize(inputs.size());
+        sha512HalfMany(inputs.data(), inputs.size(), hashes.data());
+        for (auto i = begin; i < end; ++i)
+            leaves[i] = {entries[i].first, hashes[i - begin]};
+    });
+}
+
+ripple::uint256
+innerNodeHash(std::array<ripple::uint256, 16> const& children)
+{
+    using namespace ripple;
+
+    sha512_half_hasher h;
+    using beast::hash_append;
+    hash_append(h, HashPrefix::innerNode);
+    for (auto const& child : children)
+        hash_append(h, child);
+    return static_cast<sha512_half_hasher::result_type>(h);
+}
+
+ripple::uint256
+treeRoot(std::vector<TreeLeaf> leaves, unsigned threads)
+{
+    if (leaves.empty())
+        return {};
+
+    std::sort(leaves.begin(), leaves.end(), [](auto const& a, auto const& b) {
+        return a.key < b.key;
+    });
+    auto const duplicate = std::adjacent_find(
+        leaves.begin(), leaves.end(), [](auto const& a, auto const& b) {
+            return a.key == b.key;
+        });
+    if (duplicate != leaves.end())
+        throw std::runtime_error(
+            "Duplicate tree key: " + ripple::to_string(duplicate->key));
+
+    // Split the leaves by their first two nibbles. Each group of more
+    // than one leaf is a subtree that can be hashed on its own.
+    std::array<std::size_t, 257> bounds;
+    std::size_t i = 0;
+    for (unsigned g = 0; g < 256; ++g)
+    {
+        bounds[g] = i;
+        while (i < leaves.size() && leaves[i].key.data()[0] == g)
+            ++i;
+    }
+    bounds[256] = leaves.size();
+
+    std::array<ripple::uint256, 256> groups{};
+    parallelFor(256, threads, [&](std::uint64_t g) {
+        if (bounds[g + 1] - bounds[g] > 1)
+            groups[g] = innerHash(leaves, bounds[g], bounds[g + 1], 2);
+    });
+
+    // Merge the two levels above the groups
+    std::array<ripple::uint256, 16> root{};
+    for (unsigned first = 0; first < 16; ++first)
+    {
+        auto const begin = bounds[first * 16];
+        auto const end = bounds[first * 16 + 16];
+        if (end - begin == 1)
+        {
+            root[first] = leaves[begin].hash;
+        }
+        else if (end - begin > 1)
+        {
+            std::array<ripple::uint256, 16> children{};
+            for (unsigned second = 0; second < 16; ++second)
+            {
+                auto const g = first * 16 + second;
+                auto const count = bounds[g + 1] - bounds[g];
+                if (count == 1)
+                    children[second] = leaves[bounds[g]].hash;
+                else if (count > 1)
+                    children[second] = groups[g];
+            }
+            root[first] = innerNodeHash(children);
+        }
+    }
+    return innerNodeHash(root);
+}
+
+void
+TreeRootBuilder::place(unsigned nextShared)
+{
+    auto const& leaf = *pending_;
+    auto const depth = std::max(pendingShared_, nextShared);
+    levels_[depth][nibble(leaf.key, depth)] = leaf.hash;
+    // Close the inner nodes that no later key can reach
+    for (auto d = depth; d > nextShared; --d)
+    {
+        levels_[d - 1][nibble(leaf.key, d - 1)] = innerNodeHash(levels_[d]);
+        levels_[d] = {};
+    }
+}
+
+void
+TreeRootBuilder::add(TreeLeaf const& leaf)
+{
+    if (pending_)
+    {
+        if (!(pending_->key < leaf.key))
+            throw std::runtime_error(
+                "Tree key out of order: " + ripple::to_string(leaf.key));
+        auto const shared = sharedNibbles(pending_->key, leaf.key);
+        place(shared);
+        pendingShared_ = shared;
+    }
+    pending_ = leaf;
+    ++size_;
+}
+
+ripple::uint256
+TreeRootBuilder::finish()
+{
+    if (!pending_)
+        return {};
+    place(0);
+    auto const root = innerNodeHash(levels_[0]);
+    levels_[0] = {};
+    pending_.reset();
+    pendingShared_ = 0;
+    size_ = 0;
+    return root;
+}
+
+}  // namespace offline
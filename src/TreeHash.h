@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_TREEHASH_H_INCLUDED
+#define OFFLINE_TREEHASH_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace offline {
+
+/** SHAMap hashing, computed the same way as rippled, without building
+    the map.
+
+    A SHAMap is a radix 16 tree keyed by 256 bit keys. Each inner node
+    hashes its 16 child hashes, with zero for empty branches. A leaf sits
+    at the shallowest depth at which no other key shares its branch. The
+    root is always an inner node, and the root of an empty map is zero.
+*/
+
+struct TreeLeaf
+{
+    ripple::uint256 key;
+    ripple::uint256 hash;
+};
+
+/// The ID of a serialized transaction.
+ripple::uint256
+transactionID(ripple::Slice tx);
+
+/// The hash of a transaction tree leaf, which holds the metadata too.
+ripple::uint256
+transactionLeafHash(
+    ripple::Slice tx,
+    ripple::Slice meta,
+    ripple::uint256 const& id);
+
+/// The hash of a state tree leaf.
+ripple::uint256
+stateLeafHash(ripple::Slice data, ripple::uint256 const& key);
+
+/** The transaction tree leaves of `txs`, each a transaction and its
+    metadata, keyed by transaction ID.
+
+    Groups of transactions are hashed side by side with `sha512HalfMany`,
+    and the groups in parallel.
+*/
+std::vector<TreeLeaf>
+transactionLeaves(
+    std::vector<std::pair<ripple::Blob, ripple::Blob>> const& txs,
+    unsigned threads);
+
+/// The state tree leaves of `entries`, each a key and its data, hashed
+/// the same way into `leaves`.
+void
+stateLeaves(
+    std::vector<std::pair<ripple::uint256, ripple::Blob>> const& entries,
+    TreeLeaf* leaves,
+    unsigned threads);
+
+ripple::uint256
+innerNodeHash(std::array<ripple::uint256, 16> const& children);
+
+/** The root hash of the tree holding `leaves`.
+
+    The leaves are sorted by key. The subtrees below the first two levels
+    are hashed in parallel, and merged bottom up.
+
+    @throws std::runtime_error if two leaves have the same key
+*/
+ripple::uint256
+treeRoot(std::vector<TreeLeaf> leaves, unsigned threads);
+
+/** Computes a tree root from leaves added in key order.
+
+    Only the inner nodes on the path to the latest leaf are held, so
+    memory use does not depend on the number of leaves. A leaf's depth
+    depends on the key after it, so each leaf is placed when the next one
+    is added, or by `finish`.
+*/
+class TreeRootBuilder
+{
+private:
+    // Children of the open inner node at each depth
+    std::array<std::array<ripple::uint256, 16>, 64> levels_{};
+    std::optional<TreeLeaf> pending_;
+    // Nibbles shared by the pending leaf and the one before it
+    unsigned pendingShared_ = 0;
+    std::uint64_t size_ = 0;
+
+    void
+    place(unsigned nextShared);
+
+public:
+    /** Add the leaf after all of those already added.
+
+        @throws std::runtime_error if the key does not follow the last one
+    */
+    void
+    add(TreeLeaf const& leaf);
+
+    std::uint64_t
+    size() const
+    {
+        return size_;
+    }
+
+    /// The root over every leaf added. Starts a new, empty tree.
+    ripple::uint256
+    finish();
+};
+
+}  // namespace offline
+
+#endif  // !OFFLINE_TREEHASH_H_INCLUDED
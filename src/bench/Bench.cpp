@@ -0,0 +1,489 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <bench/BenchCommon.h>
+#include <test/KnownTestData.h>
+
+#include <AccountIDs.h>
+#include <AmountParser.h>
+#include <Base58.h>
+#include <MultiHash.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/Seed.h>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <regex>
+
+/** Microbenchmarks for the serialization and signing kernels.
+
+    Each benchmark runs its operation on the known test fixtures until
+    the minimum time has elapsed, timing every call individually, and
+    reports throughput and latency percentiles. The results are written
+    as JSON, and can be compared against a baseline written by a previous
+    run. Any benchmark whose median latency grew by more than the
+    threshold is reported as a regression, and the exit status is
+    nonzero.
+*/
+
+namespace offline {
+namespace bench {
+
+using clock_type = std::chrono::steady_clock;
+
+struct Result
+{
+    std::string name;
+    std::uint64_t iterations = 0;
+    double meanNs = 0;
+    double p50Ns = 0;
+    double p99Ns = 0;
+    double opsPerSecond = 0;
+};
+
+// Keeps the results of the benchmarked operations observable
+std::size_t volatile sink = 0;
+
+/** A benchmark is a factory for the operation to time.
+
+    Operations that consume their input, like multisigning, which adds
+    to the transaction's signer list, return a fresh input from `setup`
+    before every call. Setup is not timed.
+*/
+struct Benchmark
+{
+    std::string name;
+    std::function<std::function<void()>()> setup;
+    bool fresh = false;
+};
+
+Result
+run(Benchmark const& b, std::chrono::milliseconds minTime)
+{
+    std::size_t constexpr warmup = 3;
+    std::size_t constexpr minIterations = 10;
+
+    auto op = b.setup();
+    for (std::size_t i = 0; i < warmup; ++i)
+    {
+        if (b.fresh)
+            op = b.setup();
+        op();
+    }
+
+    std::vector<std::uint64_t> samples;
+    samples.reserve(1 << 16);
+    clock_type::duration total{};
+    while (total < minTime || samples.size() < minIterations)
+    {
+        if (b.fresh)
+            op = b.setup();
+        auto const start = clock_type::now();
+        op();
+        auto const elapsed = clock_type::now() - start;
+        total += elapsed;
+        samples.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = b.name;
+    result.iterations = samples.size();
+    auto const totalNs = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(total).count());
+    result.meanNs = totalNs / samples.size();
+    result.p50Ns = percentile(samples, 0.50);
+    result.p99Ns = percentile(samples, 0.99);
+    result.opsPerSecond = samples.size() * 1e9 / totalNs;
+    return result;
+}
+
+std::vector<Benchmark>
+makeBenchmarks()
+{
+    using namespace ripple;
+    using test::getKnownMetadata;
+    using test::getKnownTxSigned;
+    using test::getKnownTxUnsigned;
+
+    std::vector<Benchmark> benchmarks;
+    auto const add = [&benchmarks](
+                         std::string name,
+                         std::function<std::function<void()>()> setup,
+                         bool fresh = false) {
+        benchmarks.push_back({std::move(name), std::move(setup), fresh});
+    };
+
+    for (auto const& [fixture, item] :
+         {std::make_pair("tx", &getKnownTxSigned()),
+          std::make_pair("meta", &getKnownMetadata())})
+    {
+        std::string const suffix = std::string("/") + fixture;
+        add("parseJson" + suffix, [item = item] {
+            return [item] { sink = sink + parseJson(item->JsonText).size(); };
+        });
+        add("makeObject" + suffix, [item = item] {
+            auto const json = parseJson(item->JsonText);
+            return [json] { sink = sink + makeObject(json)->getCount(); };
+        });
+        // The JSON is taken apart, so each run gets its own copy
+        add(
+            "makeObject/moved" + suffix,
+            [item = item] {
+                return [json = parseJson(item->JsonText)]() mutable {
+                    sink = sink + makeObject(std::move(json))->getCount();
+                };
+            },
+            true);
+        add("serialize" + suffix, [item = item] {
+            auto const obj = *deserialize(item->SerializedText);
+            return [obj] { sink = sink + serialize(obj).size(); };
+        });
+        add("deserialize" + suffix, [item = item] {
+            return [item] {
+                sink = sink + deserialize(item->SerializedText)->getCount();
+            };
+        });
+    }
+
+    auto const& unsignedTx = getKnownTxUnsigned();
+    add("make_sttx/json", [&unsignedTx] {
+        return [&unsignedTx] {
+            sink = sink + make_sttx(unsignedTx.JsonText).getCount();
+        };
+    });
+    add("make_sttx/hex", [&unsignedTx] {
+        return [&unsignedTx] {
+            sink = sink + make_sttx(unsignedTx.SerializedText).getCount();
+        };
+    });
+
+    // IDs of 64 transactions per call
+    for (auto const kernel :
+         {HashKernel::scalar, HashKernel::avx2, HashKernel::avx512})
+    {
+        if (!supported(kernel))
+            continue;
+        add(std::string("sha512HalfMany/") + to_string(kernel), [kernel] {
+            auto const tx = std::make_shared<Blob>(
+                *strUnHex(getKnownTxSigned().SerializedText));
+            auto const inputs = std::make_shared<std::vector<HashInput>>(
+                64,
+                HashInput{
+                    static_cast<std::uint32_t>(HashPrefix::transactionID),
+                    makeSlice(*tx),
+                    {}});
+            auto const ids =
+                std::make_shared<std::vector<uint256>>(inputs->size());
+            return [kernel, tx, inputs, ids] {
+                sha512HalfMany(
+                    inputs->data(), inputs->size(), ids->data(), kernel);
+                sink = sink + ids->front().data()[0];
+            };
+        });
+    }
+
+    // Account IDs of 64 keys per call, one at a time as when writing a
+    // key file, and batched
+    auto const publicKeys = std::make_shared<std::vector<PublicKey>>();
+    for (int i = 0; i < 64; ++i)
+        publicKeys->push_back(
+            generateKeyPair(
+                i % 2 ? KeyType::ed25519 : KeyType::secp256k1,
+                generateSeed("account " + std::to_string(i)))
+                .first);
+    auto const accountIDs =
+        std::make_shared<std::vector<AccountID>>(publicKeys->size());
+    add("calcAccountID", [publicKeys, accountIDs] {
+        return [publicKeys, accountIDs] {
+            for (std::size_t i = 0; i < publicKeys->size(); ++i)
+                (*accountIDs)[i] = calcAccountID((*publicKeys)[i]);
+            sink = sink + accountIDs->front().data()[0];
+        };
+    });
+    for (auto const kernel :
+         {HashKernel::scalar, HashKernel::avx2, HashKernel::avx512})
+    {
+        if (!supported(kernel))
+            continue;
+        add(std::string("calcAccountIDs/") + to_string(kernel),
+            [kernel, publicKeys, accountIDs] {
+                return [kernel, publicKeys, accountIDs] {
+                    calcAccountIDs(
+                        publicKeys->data(),
+                        publicKeys->size(),
+                        accountIDs->data(),
+                        kernel);
+                    sink = sink + accountIDs->front().data()[0];
+                };
+            });
+    }
+
+    // Addresses both ways, with the library and with the fixed size
+    // codec
+    auto const address = std::make_shared<std::string const>(
+        toBase58(accountIDs->front()));
+    add("toBase58/AccountID", [accountIDs] {
+        return [accountIDs] {
+            sink = sink + toBase58(accountIDs->front()).size();
+        };
+    });
+    add("encodeAccount", [accountIDs] {
+        return [accountIDs] {
+            sink = sink + encodeAccount(accountIDs->front()).size();
+        };
+    });
+    add("parseBase58/AccountID", [address] {
+        return [address] {
+            sink = sink + parseBase58<AccountID>(*address)->data()[0];
+        };
+    });
+    add("decodeAccount", [address] {
+        return [address] {
+            sink = sink + decodeAccount(*address)->data()[0];
+        };
+    });
+    // The Amount of the known transaction, both ways
+    auto const amount = std::make_shared<Json::Value const>(
+        parseJson(getKnownTxSigned().JsonText)["Amount"]);
+    add("amountFromJson", [amount] {
+        return [amount] {
+            sink = sink + amountFromJson(sfAmount, *amount).mantissa();
+        };
+    });
+    add("parseAmount", [amount] {
+        return [amount] { sink = sink + parseAmount(*amount)->mantissa(); };
+    });
+    add("parseGenericSeed", [] {
+        return [] {
+            sink = sink +
+                parseGenericSeed("snoPBrXtMeMyMHUVTgbuqAfg1SUTb")->size();
+        };
+    });
+    add("decodeSeed", [] {
+        return [] {
+            sink = sink + decodeSeed("snoPBrXtMeMyMHUVTgbuqAfg1SUTb")->size();
+        };
+    });
+
+    for (auto const kt : {KeyType::secp256k1, KeyType::ed25519})
+    {
+        std::string const suffix = std::string("/") + to_string(kt);
+        add("RippleKey" + suffix, [kt] {
+            return [kt] {
+                auto const key =
+                    RippleKey::make_RippleKey(kt, std::string("alice"));
+                sink = sink + key.publicKey().size();
+            };
+        });
+
+        auto const key = std::make_shared<RippleKey const>(
+            RippleKey::make_RippleKey(kt, std::string("bob")));
+        auto const tx =
+            std::make_shared<STTx const>(make_sttx(unsignedTx.SerializedText));
+        add("singleSign" + suffix, [key, tx] {
+            // Signing replaces the previous signature, so the same
+            // transaction can be signed repeatedly
+            auto signee = std::make_shared<std::optional<STTx>>(*tx);
+            return [key, signee] { key->singleSign(*signee); };
+        });
+        add(
+            "multiSign" + suffix,
+            [key, tx] {
+                auto signee = std::make_shared<std::optional<STTx>>(*tx);
+                return [key, signee] { key->multiSign(*signee); };
+            },
+            true);
+    }
+
+    return benchmarks;
+}
+
+Json::Value
+toJson(std::vector<Result> const& results)
+{
+    Json::Value jv(Json::objectValue);
+    auto& list = jv["benchmarks"] = Json::arrayValue;
+    for (auto const& r : results)
+    {
+        Json::Value entry(Json::objectValue);
+        entry["name"] = r.name;
+        entry["iterations"] = static_cast<Json::UInt>(r.iterations);
+        entry["mean_ns"] = r.meanNs;
+        entry["p50_ns"] = r.p50Ns;
+        entry["p99_ns"] = r.p99Ns;
+        entry["ops_per_second"] = r.opsPerSecond;
+        list.append(entry);
+    }
+    return jv;
+}
+
+/** Compare the median latencies with a baseline.
+
+    @return The number of regressions
+*/
+int
+compare(
+    std::vector<Result> const& results,
+    Json::Value const& baseline,
+    double thresholdPercent,
+    std::ostream& os)
+{
+    if (!baseline.isObject() || !baseline["benchmarks"].isArray())
+        throw std::runtime_error("Baseline is not a benchmark results file.");
+
+    std::map<std::string, double> baselineP50;
+    for (auto const& entry : baseline["benchmarks"])
+    {
+        if (entry.isObject() && entry["name"].isString() &&
+            entry["p50_ns"].isNumeric())
+            baselineP50[entry["name"].asString()] = entry["p50_ns"].asDouble();
+    }
+
+    std::vector<std::pair<std::string, double>> current;
+    for (auto const& r : results)
+        current.emplace_back(r.name, r.p50Ns);
+    return compareToBaseline(
+        current, baselineP50, thresholdPercent, 0, "ns", os);
+}
+
+}  // namespace bench
+}  // namespace offline
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+    using namespace offline::bench;
+
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Display this message.")(
+        "list", "List the benchmarks and exit.")(
+        "filter",
+        po::value<std::string>(),
+        "Only run benchmarks whose name matches this regular expression.")(
+        "min-time",
+        po::value<unsigned>()->default_value(500),
+        "Minimum time to run each benchmark, in milliseconds.")(
+        "output,o",
+        po::value<std::string>(),
+        "Write the JSON results to this file instead of stdout.")(
+        "baseline",
+        po::value<std::string>(),
+        "Compare the results to this JSON results file.")(
+        "threshold",
+        po::value<double>()->default_value(10.0),
+        "Percentage increase in median latency over the baseline reported "
+        "as a regression.");
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "ripple-offline-tool-bench: " << e.what() << "\n"
+                  << desc << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << "ripple-offline-tool-bench [options]\n\n"
+                  << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    try
+    {
+        auto benchmarks = makeBenchmarks();
+        if (vm.count("filter"))
+        {
+            std::regex const filter(vm["filter"].as<std::string>());
+            benchmarks.erase(
+                std::remove_if(
+                    benchmarks.begin(),
+                    benchmarks.end(),
+                    [&filter](Benchmark const& b) {
+                        return !std::regex_search(b.name, filter);
+                    }),
+                benchmarks.end());
+        }
+
+        if (vm.count("list"))
+        {
+            for (auto const& b : benchmarks)
+                std::cout << b.name << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        std::chrono::milliseconds const minTime{vm["min-time"].as<unsigned>()};
+        std::vector<Result> results;
+        for (auto const& b : benchmarks)
+        {
+            results.push_back(run(b, minTime));
+            auto const& r = results.back();
+            std::cerr << std::left << std::setw(24) << r.name << std::right
+                      << std::fixed << std::setprecision(0) << std::setw(12)
+                      << r.p50Ns << " ns/op" << std::setw(14)
+                      << r.opsPerSecond << " ops/s" << std::endl;
+        }
+
+        writeJson(
+            toJson(results),
+            vm.count("output")
+                ? std::optional<std::string>(vm["output"].as<std::string>())
+                : std::nullopt);
+
+        if (vm.count("baseline"))
+        {
+            auto const regressions = compare(
+                results,
+                readJsonFile(vm["baseline"].as<std::string>()),
+                vm["threshold"].as<double>(),
+                std::cerr);
+            if (regressions)
+            {
+                std::cerr << regressions << " regression(s) over "
+                          << vm["threshold"].as<double>() << "%" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
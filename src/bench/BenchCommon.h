@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef OFFLINE_BENCH_BENCHCOMMON_H_INCLUDED
+#define OFFLINE_BENCH_BENCHCOMMON_H_INCLUDED
+
+#include <Serialize.h>
+
+#include <ripple/json/json_value.h>
+#include <ripple/json/to_string.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace offline {
+namespace bench {
+
+/// Nearest rank percentile of sorted samples, `p` in [0, 1].
+inline double
+percentile(std::vector<std::uint64_t> const& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    auto const index = static_cast<std::size_t>(
+        p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[index]);
+}
+
+/** Read a JSON results file.
+
+    @throws std::runtime_error if the file can not be read
+*/
+inline Json::Value
+readJsonFile(std::string const& path)
+{
+    std::ifstream i(path);
+    if (i.fail())
+        throw std::runtime_error("Cannot open baseline file: " + path);
+    std::stringstream ss;
+    ss << i.rdbuf();
+    return parseJson(ss.str());
+}
+
+/** Write JSON results to a file, or to stdout if no path is given.
+
+    @throws std::runtime_error if the file can not be written
+*/
+inline void
+writeJson(Json::Value const& jv, std::optional<std::string> const& path)
+{
+    auto const text = Json::to_string(jv);
+    if (!path)
+    {
+        std::cout << text << std::endl;
+        return;
+    }
+    std::ofstream o(*path, std::ios::trunc);
+    if (o.fail())
+        throw std::runtime_error("Cannot open output file: " + *path);
+    o << text << "\n";
+}
+
+/** Print a table comparing current and baseline values, where lower is
+    better.
+
+    A value is a regression if it grew by more than `thresholdPercent`
+    and by more than `minDelta`, which keeps noise in very short
+    measurements from failing the comparison.
+
+    @return The number of regressions
+*/
+inline int
+compareToBaseline(
+    std::vector<std::pair<std::string, double>> const& current,
+    std::map<std::string, double> const& baseline,
+    double thresholdPercent,
+    double minDelta,
+    std::string const& unit,
+    std::ostream& os)
+{
+    int regressions = 0;
+    auto const flags = os.flags();
+    os << std::left << std::setw(32) << "name" << std::right << std::setw(14)
+       << "baseline " + unit << std::setw(14) << "current " + unit
+       << std::setw(10) << "change"
+       << "\n";
+    os << std::fixed << std::setprecision(0);
+    for (auto const& [name, value] : current)
+    {
+        os << std::left << std::setw(32) << name << std::right;
+        auto const iter = baseline.find(name);
+        if (iter == baseline.end() || iter->second <= 0)
+        {
+            os << std::setw(14) << "-" << std::setw(14) << value
+               << std::setw(10) << "new"
+               << "\n";
+            continue;
+        }
+        auto const change = (value / iter->second - 1) * 100;
+        bool const regressed =
+            change > thresholdPercent && value - iter->second > minDelta;
+        if (regressed)
+            ++regressions;
+        os << std::setw(14) << iter->second << std::setw(14) << value
+           << std::setw(9) << std::showpos << std::setprecision(1) << change
+           << std::noshowpos << std::setprecision(0) << "%"
+           << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    os.flags(flags);
+    return regressions;
+}
+
+}  // namespace bench
+}  // namespace offline
+
+#endif  // !OFFLINE_BENCH_BENCHCOMMON_H_INCLUDED
@@ -0,0 +1,406 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <bench/BenchCommon.h>
+#include <test/KnownTestData.h>
+
+#include <RippleKey.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+/** Cold start benchmark for the command line tool.
+
+    Runs the tool once per iteration for each command, the way a caller
+    that spawns one signer per request does, and reports the wall time
+    distribution of each phase:
+
+        exec         spawn until the first static initializer of the
+                     executable (loading and relocating, shared library
+                     initializers)
+        static_init  the executable's static initializers, including the
+                     ones in the linked rippled libraries
+        command      main until the command's output is written
+        exit         static destructors and process teardown
+        total        spawn until the process is reaped
+
+    The phase boundaries come from the tool itself, see StartupTiming.h.
+*/
+
+namespace offline {
+namespace bench {
+
+using clock_type = std::chrono::steady_clock;
+
+namespace fs = boost::filesystem;
+
+std::array<char const*, 5> constexpr phaseNames =
+    {"exec", "static_init", "command", "exit", "total"};
+
+struct Command
+{
+    std::string name;
+    std::vector<std::string> args;
+    std::string input;
+};
+
+struct Samples
+{
+    std::string command;
+    // Microseconds, one vector per phase
+    std::array<std::vector<std::uint64_t>, phaseNames.size()> phases;
+};
+
+std::int64_t
+nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               clock_type::now().time_since_epoch())
+        .count();
+}
+
+std::vector<Command>
+makeCommands(fs::path const& dir)
+{
+    using namespace test;
+
+    auto const keyFile = (dir / "secret-key.txt").string();
+    auto const newKeyFile = (dir / "new-key.txt").string();
+    return {
+        {"serialize",
+         {"serialize", "--stdin"},
+         getKnownTxUnsigned().JsonText},
+        {"deserialize",
+         {"deserialize", "--stdin"},
+         getKnownTxSigned().SerializedText},
+        {"sign",
+         {"--keyfile", keyFile, "sign", "--stdin"},
+         getKnownTxUnsigned().SerializedText},
+        {"multisign",
+         {"--keyfile", keyFile, "multisign", "--stdin"},
+         getKnownTxUnsigned().SerializedText},
+        {"createkeyfile", {"--keyfile", newKeyFile, "createkeyfile"}, ""},
+    };
+}
+
+/** Run the tool once, with `input` on stdin and output discarded.
+
+    @return The phase durations in microseconds
+*/
+std::array<std::uint64_t, phaseNames.size()>
+runOnce(
+    std::string const& tool,
+    Command const& command,
+    fs::path const& dir)
+{
+    auto const inputFile = (dir / "input.txt").string();
+    auto const timingFile = (dir / "timing.txt").string();
+    {
+        std::ofstream o(inputFile, std::ios::trunc);
+        o << command.input;
+    }
+    fs::remove(timingFile);
+    fs::remove(dir / "new-key.txt");
+
+    std::vector<std::string> args{tool};
+    args.insert(args.end(), command.args.begin(), command.args.end());
+    std::vector<char*> argv;
+    for (auto& arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    std::string timingVar = "OFFLINE_STARTUP_TIMING=" + timingFile;
+    std::vector<char*> envp;
+    for (auto env = environ; *env; ++env)
+    {
+        if (std::strncmp(*env, "OFFLINE_STARTUP_TIMING=", 23) != 0)
+            envp.push_back(*env);
+    }
+    envp.push_back(timingVar.data());
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(
+        &actions, 0, inputFile.c_str(), O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+
+    auto const start = nowNs();
+    pid_t pid;
+    auto const err = posix_spawn(
+        &pid, tool.c_str(), &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0)
+        throw std::runtime_error(
+            "Cannot run " + tool + ": " + std::strerror(err));
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+            throw std::runtime_error("waitpid failed");
+    }
+    auto const end = nowNs();
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error("\"" + command.name + "\" failed");
+
+    std::ifstream i(timingFile);
+    std::map<std::string, std::int64_t> marks;
+    std::string name;
+    std::int64_t value;
+    while (i >> name >> value)
+        marks[name] = value;
+    if (!marks.count("preinit") || !marks.count("main") ||
+        !marks.count("done"))
+        throw std::runtime_error(
+            "No startup timing from \"" + command.name +
+            "\". Was the tool built with StartupTiming?");
+
+    auto const us = [](std::int64_t from, std::int64_t to) {
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(
+            0, (to - from) / 1000));
+    };
+    return {
+        us(start, marks["preinit"]),
+        us(marks["preinit"], marks["main"]),
+        us(marks["main"], marks["done"]),
+        us(marks["done"], end),
+        us(start, end)};
+}
+
+Json::Value
+toJson(std::vector<Samples> const& results)
+{
+    Json::Value jv(Json::objectValue);
+    auto& list = jv["commands"] = Json::arrayValue;
+    for (auto& s : results)
+    {
+        Json::Value entry(Json::objectValue);
+        entry["name"] = s.command;
+        entry["runs"] = static_cast<Json::UInt>(s.phases[0].size());
+        auto& phases = entry["phases"] = Json::objectValue;
+        for (std::size_t p = 0; p < phaseNames.size(); ++p)
+        {
+            auto& phase = phases[phaseNames[p]] = Json::objectValue;
+            phase["min_us"] = percentile(s.phases[p], 0);
+            phase["p50_us"] = percentile(s.phases[p], 0.50);
+            phase["p99_us"] = percentile(s.phases[p], 0.99);
+        }
+        list.append(entry);
+    }
+    return jv;
+}
+
+/** Compare the median of every phase with a baseline.
+
+    @return The number of regressions
+*/
+int
+compare(
+    Json::Value const& current,
+    Json::Value const& baseline,
+    double thresholdPercent,
+    double minDeltaUs,
+    std::ostream& os)
+{
+    if (!baseline.isObject() || !baseline["commands"].isArray())
+        throw std::runtime_error("Baseline is not a startup results file.");
+
+    auto const medians = [](Json::Value const& jv) {
+        std::vector<std::pair<std::string, double>> result;
+        for (auto const& entry : jv["commands"])
+        {
+            if (!entry.isObject() || !entry["phases"].isObject())
+                continue;
+            for (auto const phase : phaseNames)
+            {
+                auto const& p50 = entry["phases"][phase]["p50_us"];
+                if (p50.isNumeric())
+                    result.emplace_back(
+                        entry["name"].asString() + "/" + phase,
+                        p50.asDouble());
+            }
+        }
+        return result;
+    };
+
+    auto const baselineMedians = medians(baseline);
+    return compareToBaseline(
+        medians(current),
+        std::map<std::string, double>(
+            baselineMedians.begin(), baselineMedians.end()),
+        thresholdPercent,
+        minDeltaUs,
+        "us",
+        os);
+}
+
+}  // namespace bench
+}  // namespace offline
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+    using namespace offline::bench;
+
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Display this message.")(
+        "tool",
+        po::value<std::string>()->default_value("./ripple-offline-tool"),
+        "Path to the ripple-offline-tool executable.")(
+        "runs,n",
+        po::value<unsigned>()->default_value(50),
+        "Number of timed runs per command.")(
+        "command,c",
+        po::value<std::vector<std::string>>(),
+        "Only run this command. May be repeated.")(
+        "output,o",
+        po::value<std::string>(),
+        "Write the JSON results to this file instead of stdout.")(
+        "baseline",
+        po::value<std::string>(),
+        "Compare the results to this JSON results file.")(
+        "threshold",
+        po::value<double>()->default_value(10.0),
+        "Percentage increase in a median phase time over the baseline "
+        "reported as a regression.")(
+        "min-delta",
+        po::value<double>()->default_value(200.0),
+        "Smallest increase in microseconds reported as a regression.");
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "ripple-offline-tool-startup: " << e.what() << "\n"
+                  << desc << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << "ripple-offline-tool-startup [options]\n\n"
+                  << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    fs::path const dir = fs::temp_directory_path() /
+        fs::unique_path("ripple-offline-startup-%%%%-%%%%");
+    try
+    {
+        auto const tool = fs::absolute(vm["tool"].as<std::string>()).string();
+        auto const runs = std::max(1u, vm["runs"].as<unsigned>());
+
+        fs::create_directories(dir);
+        offline::RippleKey::make_RippleKey(
+            ripple::KeyType::secp256k1, std::string("alice"))
+            .writeToFile(dir / "secret-key.txt");
+
+        auto commands = makeCommands(dir);
+        if (vm.count("command"))
+        {
+            auto const only = vm["command"].as<std::vector<std::string>>();
+            commands.erase(
+                std::remove_if(
+                    commands.begin(),
+                    commands.end(),
+                    [&only](Command const& c) {
+                        return std::find(only.begin(), only.end(), c.name) ==
+                            only.end();
+                    }),
+                commands.end());
+            if (commands.size() != only.size())
+                throw std::runtime_error("Unknown command requested.");
+        }
+
+        std::vector<Samples> results;
+        for (auto const& command : commands)
+        {
+            Samples samples;
+            samples.command = command.name;
+            // One untimed run to warm the page cache
+            runOnce(tool, command, dir);
+            for (unsigned i = 0; i < runs; ++i)
+            {
+                auto const phases = runOnce(tool, command, dir);
+                for (std::size_t p = 0; p < phases.size(); ++p)
+                    samples.phases[p].push_back(phases[p]);
+            }
+            for (auto& phase : samples.phases)
+                std::sort(phase.begin(), phase.end());
+
+            std::cerr << std::left << std::setw(16) << command.name;
+            for (std::size_t p = 0; p < phaseNames.size(); ++p)
+                std::cerr << " " << phaseNames[p] << " "
+                          << percentile(samples.phases[p], 0.50) << "us";
+            std::cerr << std::endl;
+            results.push_back(std::move(samples));
+        }
+
+        auto const jv = toJson(results);
+        writeJson(
+            jv,
+            vm.count("output")
+                ? std::optional<std::string>(vm["output"].as<std::string>())
+                : std::nullopt);
+
+        int status = EXIT_SUCCESS;
+        if (vm.count("baseline"))
+        {
+            auto const regressions = compare(
+                jv,
+                readJsonFile(vm["baseline"].as<std::string>()),
+                vm["threshold"].as<double>(),
+                vm["min-delta"].as<double>(),
+                std::cerr);
+            if (regressions)
+            {
+                std::cerr << regressions << " regression(s) over "
+                          << vm["threshold"].as<double>() << "%" << std::endl;
+                status = EXIT_FAILURE;
+            }
+        }
+        fs::remove_all(dir);
+        return status;
+    }
+    catch (std::exception const& e)
+    {
+        boost::system::error_code ec;
+        fs::remove_all(dir, ec);
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,715 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Aggregate.h>
+#include <AllocTracker.h>
+#include <BalanceChanges.h>
+#include <Base58.h>
+#include <Batch.h>
+#include <Chain.h>
+#include <ColumnExport.h>
+#include <Corpus.h>
+#include <Derive.h>
+#include <Diff.h>
+#include <Ledger.h>
+#include <Metrics.h>
+#include <MultiHash.h>
+#include <OfflineTool.h>
+#include <Recover.h>
+#include <RippleKey.h>
+#include <StartupTiming.h>
+#include <StateHash.h>
+#include <Trace.h>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#ifdef _WIN32
+#include <cstdio>
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/*  The production entry point. The unit tests are built into a separate
+    executable, ripple-offline-tool-tests, so that this one links and
+    statically initializes only what the commands use.
+*/
+
+// Keep Windows from turning each 0x0A byte of binary output into 0x0D 0x0A
+static void
+setBinaryStdout()
+{
+#ifdef _WIN32
+    std::cout.flush();
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+// Stop tracing, and write every event so far to `traceFile`
+static void
+writeTrace(std::string const& traceFile)
+{
+    offline::trace::disable();
+    std::ofstream o(traceFile, std::ios::trunc);
+    if (o.fail())
+        throw std::runtime_error("Cannot open trace file: " + traceFile);
+    offline::trace::write(o);
+}
+
+static std::string
+getEnvVar(char const* name)
+{
+    std::string value;
+
+    auto const v = getenv(name);
+
+    if (v != nullptr)
+        value = v;
+
+    return value;
+}
+
+static void
+printHelp(
+    const boost::program_options::options_description& desc,
+    boost::filesystem::path const& defaultKeyfile)
+{
+    static std::string const name = "ripple-offline-tool";
+
+    std::cerr << name << " [options] <command> [<argument> ...]\n"
+              << desc << std::endl
+              <<
+        R"(Commands:
+  Serialization:
+    serialize <argument>|--stdin        Serialize from JSON.
+    deserialize <argument>|--stdin      Deserialize to JSON.
+      With --type, the input is checked against the format of that
+      type, and must not have trailing data.
+    deserialize-ledger                  Decode ledger or ledger_data
+      results requested with "binary": true, read from standard
+      input. Transactions, metadata and state entries are decoded in
+      parallel. Output is one line per result.
+    hash <argument>|--stdin             Write the ID of each serialized
+      transaction, one per line. Lines read from standard input are
+      hashed in parallel, several at a time with SIMD where the CPU
+      supports it.
+    diff <from> <to>|--stdin            Compare two serialized
+      objects field by field. With --stdin, each line is a pair, and
+      pairs are compared in parallel. Output is one line per pair
+      that differs, and a summary line.
+  Ledger verification:
+    verify-ledger-txs                   Rebuild the transaction tree
+      of each binary ledger result read from standard input, compare
+      its root with the header's transaction_hash, and check every
+      transaction's signature. Output is one line per ledger.
+    verify-state                        Compute the state tree root of
+      a binary ledger_data dump read from standard input, one page per
+      line, within the --memory budget. Compares it with the ledger
+      header's account_hash, if the dump has one.
+    verify-chain                        Check that the ledger headers
+      read from standard input, one per line in hex or as a binary
+      ledger result, form an unbroken chain. Output is one line per
+      break, and a summary line.
+  Ledger analysis:
+    balance-changes                     Write CSV of the XRP, trust
+      line and offer balance changes recorded in transaction metadata.
+      Each input line is a transaction and its metadata in hex, or a
+      binary ledger result.
+    aggregate                           Write CSV of transaction counts,
+      and the --sum and --histogram fields, for each --group-by group.
+      Input is the same as for balance-changes.
+    export-columns                      Write the transactions read
+      from standard input as a column file, for analytics tools, with
+      a column per field in row groups of --row-group input lines.
+      Input is the same as for aggregate.
+  Transaction signing:
+    sign <argument>|--stdin             Sign for submission.
+    multisign <argument>|--stdin        Apply a multi-signature.
+      Signing commands require a valid keyfile.
+      Input is serialized or unserialized JSON.
+      Output is unserialized JSON, or MessagePack or CBOR with
+      --output.
+  Key Management:
+    createkeyfile [<key>|--stdin]       Create keyfile. A random
+      seed will be used if no <key> is provided on the command line
+      or from standard input using --stdin.
+    derive <key>|--stdin                Write the account ID and
+      public key of each secp256k1 account in the --range of the
+      seed's family, one per line. The accounts are derived in
+      parallel, and with --key-dir, a key file is written for each.
+    recover <seed>|--stdin              Find the seed of the --account
+      from a seed with a ? for each unknown character, or its twelve
+      words with a ? for each unknown word. Candidates are checked in
+      parallel, and progress is written to standard error.
+
+      Default keyfile is: )"
+              << defaultKeyfile << "\n"
+              <<
+        R"(  Batch processing:
+    --batch reads one record per line from standard input and runs
+      serialize, deserialize, sign or multisign on each of them in
+      parallel. Output is one line per record, in input order.
+  Corpus generation:
+    gen-corpus                          Write generated transactions,
+      one per line.
+    roundtrip                           Check that generated
+      transactions survive deserializing and serializing.
+      Both accept the corpus options. The same options always produce
+      the same transactions.
+)";
+}
+
+static offline::CorpusOptions
+getCorpusOptions(boost::program_options::variables_map const& vm)
+{
+    offline::CorpusOptions options;
+    options.count = vm["count"].as<std::uint64_t>();
+    options.seed = vm["seed"].as<std::uint64_t>();
+    if (vm.count("mix"))
+        options.mix = offline::parseCorpusMix(vm["mix"].as<std::string>());
+    options.accounts = vm["accounts"].as<std::size_t>();
+    options.maxMemoBytes = vm["max-memo-bytes"].as<std::size_t>();
+    options.maxPaths = vm["max-paths"].as<std::size_t>();
+    options.sign = vm.count("signed");
+    options.encoding =
+        offline::parseEncoding(vm["encoding"].as<std::string>());
+    if (vm.count("threads"))
+        options.threads = vm["threads"].as<unsigned>();
+    return options;
+}
+
+static std::vector<std::string>
+splitList(std::string const& list)
+{
+    std::vector<std::string> items;
+    boost::split(items, list, [](char c) { return c == ','; });
+    items.erase(
+        std::remove(items.begin(), items.end(), std::string{}), items.end());
+    return items;
+}
+
+static offline::AggregateOptions
+getAggregateOptions(boost::program_options::variables_map const& vm)
+{
+    offline::AggregateOptions options;
+    options.groupBy = splitList(vm["group-by"].as<std::string>());
+    if (vm.count("sum"))
+        options.sums = splitList(vm["sum"].as<std::string>());
+    if (vm.count("histogram"))
+        options.histograms = splitList(vm["histogram"].as<std::string>());
+    options.ledgerBucket = vm["ledger-bucket"].as<std::uint32_t>();
+    if (vm.count("threads"))
+        options.threads = vm["threads"].as<unsigned>();
+    return options;
+}
+
+// Commands that read ledger dumps from stdin
+static std::map<
+    std::string,
+    int (*)(std::istream&, std::ostream&, std::ostream&, unsigned)> const
+    ledgerCommands = {
+        {"deserialize-ledger", offline::runDeserializeLedger},
+        {"verify-ledger-txs", offline::runVerifyLedgerTxs},
+        {"verify-chain", offline::runVerifyChain},
+        {"balance-changes", offline::runBalanceChanges},
+};
+
+static InputType
+getInputType(boost::program_options::variables_map const& vm)
+{
+    namespace po = boost::program_options;
+
+    bool const readstdin = vm.count("stdin") && !vm["stdin"].defaulted();
+    bool const commandline =
+        !vm["arguments"].empty() && !vm["arguments"].defaulted();
+
+    if (readstdin && commandline)
+        throw std::runtime_error(
+            "Conflicting inputs: May only specify one of \"--stdin\" "
+            "and command line parameters.");
+    if (readstdin)
+        return InputType::readstdin;
+    if (commandline)
+        return InputType::commandline;
+    return InputType::none;
+}
+
+int
+main(int argc, char** argv)
+{
+    offline::startup::mainEntered();
+
+#if defined(__GNUC__) && !defined(__clang__)
+    auto constexpr gccver =
+        (__GNUC__ * 100 * 100) + (__GNUC_MINOR__ * 100) + __GNUC_PATCHLEVEL__;
+
+    static_assert(
+        gccver >= 50100,
+        "GCC version 5.1.0 or later is required to compile "
+        "ripple-offline-tool.");
+#endif
+
+    static_assert(
+        BOOST_VERSION >= 105700,
+        "Boost version 1.57 or later is required to compile "
+        "ripple-offline-tool");
+
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+
+    // Set up option parsing.
+    //
+    // Every group is built whatever the command, because dispatch reads
+    // the defaults of options in most of them, and --help lists them all.
+    // Building and parsing them all takes well under a millisecond.
+    po::options_description general("General Options");
+    general.add_options()("help,h", "Display this message.")(
+        "version", "Display the build version.")(
+        "keyfile,f", po::value<std::string>(), "Specify the key file.")(
+        "stdin,i", "Read input (private key or argument) from stdin.")(
+        "alloc-report",
+        "Report heap allocations per operation on stderr when done.")(
+        "type",
+        po::value<std::string>(),
+        "What deserialize input holds: tx, meta, ledger-entry or "
+        "ledger-header. Default is any object, unchecked.")(
+        "output",
+        po::value<std::string>()->default_value("json"),
+        "Output format of deserialize, sign and multisign: json, msgpack "
+        "or cbor.")(
+        "ignore",
+        po::value<std::string>(),
+        "Comma separated fields that diff doesn't compare, e.g. "
+        "\"TxnSignature,SigningPubKey\".");
+
+    po::options_description key("Key File Creation Options");
+    key.add_options()(
+        "keytype,t",
+        po::value<std::string>(),
+        "Valid keytypes are secp256k1 and ed25519. Default is secp256k1.")(
+        "range",
+        po::value<std::string>(),
+        "Account ordinals derive writes, e.g. \"0..999\".")(
+        "key-dir",
+        po::value<std::string>(),
+        "Directory derive writes a key file to for each account, named "
+        "by account ID.")(
+        "account",
+        po::value<std::string>(),
+        "Account ID of the seed recover searches for.");
+
+    po::options_description batch("Batch Options");
+    batch.add_options()(
+        "batch,b", "Process one record per line read from stdin.")(
+        "threads,j",
+        po::value<unsigned>(),
+        "Number of worker threads. Default is one per core.")(
+        "address-cache",
+        po::value<std::size_t>()->default_value(65536),
+        "Number of decoded addresses serialize and sign keep for reuse "
+        "across JSON records. 0 disables the cache.")(
+        "trace",
+        po::value<std::string>(),
+        "Write Chrome trace-event JSON of batch activity to a file.")(
+        "metrics-file",
+        po::value<std::string>(),
+        "Periodically write Prometheus metrics to a file for the "
+        "node_exporter textfile collector.")(
+        "metrics-interval",
+        po::value<unsigned>()->default_value(15),
+        "Seconds between metrics file updates.");
+
+    // Interpret positional arguments as --parameters.
+    po::options_description hidden("Hidden options");
+    hidden.add_options()("command", po::value<std::string>(), "Command.")(
+        "arguments",
+        po::value<std::vector<std::string>>()->default_value(
+            std::vector<std::string>(), "empty"),
+        "Arguments.");
+    po::positional_options_description p;
+    p.add("command", 1).add("arguments", -1);
+
+    po::options_description verify("Ledger Verification Options");
+    verify.add_options()(
+        "memory",
+        po::value<std::size_t>()->default_value(1024),
+        "Memory budget for verify-state, in MiB.")(
+        "temp-dir",
+        po::value<std::string>(),
+        "Where verify-state writes sorted runs. Default is the system "
+        "temporary directory.");
+
+    po::options_description analysis("Ledger Analysis Options");
+    analysis.add_options()(
+        "group-by",
+        po::value<std::string>()->default_value("TransactionType"),
+        "Comma separated fields that aggregate groups by, e.g. "
+        "\"TransactionType,TransactionResult\". \"ledger\" groups by "
+        "ledger index bucket.")(
+        "sum",
+        po::value<std::string>(),
+        "Comma separated integer or XRP amount fields to sum, e.g. "
+        "\"Fee\".")(
+        "histogram",
+        po::value<std::string>(),
+        "Comma separated integer or XRP amount fields to count in power "
+        "of two buckets.")(
+        "ledger-bucket",
+        po::value<std::uint32_t>()->default_value(10000),
+        "Number of ledgers in each \"ledger\" group.")(
+        "row-group",
+        po::value<std::size_t>()->default_value(65536),
+        "Input lines in each export-columns row group.");
+
+    po::options_description help_options;
+    po::options_description corpus("Corpus Options");
+    corpus.add_options()(
+        "count,n",
+        po::value<std::uint64_t>()->default_value(1000),
+        "Number of transactions to generate.")(
+        "seed",
+        po::value<std::uint64_t>()->default_value(0),
+        "Random seed.")(
+        "mix",
+        po::value<std::string>(),
+        "Relative weights of transaction kinds, e.g. "
+        "\"XRPPayment=3,IOUPayment=2,OfferCreate=2,TrustSet=1,"
+        "AccountSet=1,SignerListSet=1,EscrowCreate=1\".")(
+        "accounts",
+        po::value<std::size_t>()->default_value(1000),
+        "Number of generated accounts.")(
+        "max-memo-bytes",
+        po::value<std::size_t>()->default_value(64),
+        "Largest memo. 0 for no memos.")(
+        "max-paths",
+        po::value<std::size_t>()->default_value(3),
+        "Most paths on an IOU payment.")(
+        "signed", "Sign each transaction with its account's key.")(
+        "encoding",
+        po::value<std::string>()->default_value("hex"),
+        "Output encoding: hex or json.");
+
+    help_options.add(general)
+        .add(key)
+        .add(batch)
+        .add(verify)
+        .add(analysis)
+        .add(corpus);
+    po::options_description cmdline_options;
+    cmdline_options.add(help_options).add(hidden);
+
+    // Parse options, if no error.
+    try
+    {
+        po::store(
+            po::command_line_parser(argc, argv)
+                .options(cmdline_options)  // Parse options.
+                .positional(p)             // Remainder as --parameters.
+                .run(),
+            vm);
+        po::notify(vm);  // Invoke option notify functions.
+    }
+    catch (std::exception const&)
+    {
+        std::cerr << "ripple-offline-tool: Incorrect command line syntax."
+                  << std::endl;
+        std::cerr << "Use '--help' for a list of options." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("version"))
+    {
+        std::cout << "ripple-offline-tool version " << getVersionString()
+                  << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    boost::filesystem::path const homeDir = getEnvVar("HOME");
+    auto const defaultKeyfile =
+        (homeDir.empty() ? boost::filesystem::current_path() : homeDir) /
+        ".ripple" / "secret-key.txt";
+
+    if (vm.count("help") || !vm.count("command"))
+    {
+        printHelp(help_options, defaultKeyfile);
+        return EXIT_SUCCESS;
+    }
+
+    try
+    {
+        using namespace boost::filesystem;
+
+        path const keyFile = vm.count("keyfile")
+            ? vm["keyfile"].as<std::string>()
+            : defaultKeyfile;
+        auto const keyType = vm.count("keytype")
+            ? std::optional<std::string>(vm["keytype"].as<std::string>())
+            : std::nullopt;
+        auto const inputType = getInputType(vm);
+        auto const command = vm["command"].as<std::string>();
+        auto const blobType = vm.count("type")
+            ? offline::parseBlobType(vm["type"].as<std::string>())
+            : offline::BlobType::generic;
+        auto const outputFormat =
+            offline::parseOutputFormat(vm["output"].as<std::string>());
+        unsigned const threads =
+            vm.count("threads") ? vm["threads"].as<unsigned>() : 0;
+        if (outputFormat != offline::OutputFormat::json)
+            setBinaryStdout();
+
+        if (vm.count("trace"))
+            offline::trace::enable();
+        if (vm.count("alloc-report"))
+            offline::alloc::enableReport();
+
+        // Zero would rewrite the metrics file without pause
+        if (vm["metrics-interval"].as<unsigned>() < 1)
+            throw std::runtime_error(
+                "Syntax error: --metrics-interval must be at least 1");
+        std::optional<offline::metrics::Reporter> reporter;
+        if (vm.count("metrics-file"))
+        {
+            offline::metrics::enable();
+            reporter.emplace(
+                vm["metrics-file"].as<std::string>(),
+                std::chrono::seconds(vm["metrics-interval"].as<unsigned>()));
+        }
+
+        auto const run = [&] {
+            if (command == "gen-corpus")
+            {
+                offline::writeCorpus(getCorpusOptions(vm), std::cout);
+                return EXIT_SUCCESS;
+            }
+            if (command == "roundtrip")
+            {
+                auto const options = getCorpusOptions(vm);
+                auto const failures =
+                    offline::checkRoundTrip(options, std::cerr);
+                std::cout << options.count - failures << " of "
+                          << options.count << " records round-tripped"
+                          << std::endl;
+                return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+            }
+            if (command == "derive")
+            {
+                if (keyType && *keyType != "secp256k1")
+                    throw std::runtime_error(
+                        "Only secp256k1 keys can be derived: " + *keyType);
+                if (!vm.count("range"))
+                    throw std::runtime_error(
+                        "Syntax error: \"derive\" requires --range");
+                auto const& args =
+                    vm["arguments"].as<std::vector<std::string>>();
+                if (inputType == InputType::none || args.size() > 1)
+                    throw std::runtime_error(
+                        "Syntax error: Wrong number of arguments");
+                offline::DeriveOptions options;
+                std::tie(options.first, options.last) =
+                    offline::parseAccountRange(vm["range"].as<std::string>());
+                if (vm.count("key-dir"))
+                    options.keyDir = vm["key-dir"].as<std::string>();
+                options.threads = threads;
+                auto const seed = offline::parseSeed(
+                    inputType == InputType::readstdin
+                        ? boost::trim_copy(getStdin())
+                        : args[0]);
+                return offline::runDerive(seed, std::cout, options);
+            }
+            if (command == "recover")
+            {
+                if (!vm.count("account"))
+                    throw std::runtime_error(
+                        "Syntax error: \"recover\" requires --account");
+                if (inputType == InputType::none)
+                    throw std::runtime_error(
+                        "Syntax error: Wrong number of arguments");
+                offline::RecoverOptions options;
+                auto const account = vm["account"].as<std::string>();
+                if (auto const id = offline::decodeAccount(account))
+                    options.account = *id;
+                else
+                    throw std::runtime_error("Invalid account: " + account);
+                if (keyType)
+                {
+                    auto const type = ripple::keyTypeFromString(*keyType);
+                    if (!type)
+                        throw std::runtime_error(
+                            "Invalid key type: " + *keyType);
+                    options.keyType = *type;
+                }
+                options.threads = threads;
+                // Unquoted words arrive as separate arguments
+                auto const partial = inputType == InputType::readstdin
+                    ? boost::trim_copy(getStdin())
+                    : boost::algorithm::join(
+                          vm["arguments"].as<std::vector<std::string>>(),
+                          " ");
+                return offline::runRecover(
+                    partial, std::cout, std::cerr, options);
+            }
+            if (command == "verify-state")
+            {
+                if (inputType == InputType::commandline)
+                    throw std::runtime_error(
+                        "Conflicting inputs: \"verify-state\" reads "
+                        "results from stdin.");
+                offline::StateHashOptions options;
+                options.memoryBudget = vm["memory"].as<std::size_t>() << 20;
+                options.threads = threads;
+                if (vm.count("temp-dir"))
+                    options.tempDir = vm["temp-dir"].as<std::string>();
+                return offline::runVerifyState(std::cin, std::cout, options);
+            }
+            if (command == "aggregate")
+            {
+                if (inputType == InputType::commandline)
+                    throw std::runtime_error(
+                        "Conflicting inputs: \"aggregate\" reads "
+                        "transactions from stdin.");
+                return offline::runAggregate(
+                    std::cin, std::cout, std::cerr, getAggregateOptions(vm));
+            }
+            if (command == "export-columns")
+            {
+                if (inputType == InputType::commandline)
+                    throw std::runtime_error(
+                        "Conflicting inputs: \"export-columns\" reads "
+                        "transactions from stdin.");
+                offline::ColumnExportOptions options;
+                options.rowGroupLines = vm["row-group"].as<std::size_t>();
+                options.threads = threads;
+                setBinaryStdout();
+                return offline::runExportColumns(
+                    std::cin, std::cout, std::cerr, options);
+            }
+            if (command == "hash")
+            {
+                if (inputType != InputType::commandline)
+                    return offline::runHash(
+                        std::cin, std::cout, std::cerr, threads);
+                auto const& args =
+                    vm["arguments"].as<std::vector<std::string>>();
+                if (args.size() != 1)
+                    throw std::runtime_error(
+                        "Syntax error: Wrong number of arguments");
+                std::istringstream blob(args[0]);
+                return offline::runHash(blob, std::cout, std::cerr, threads);
+            }
+            if (command == "diff")
+            {
+                offline::DiffOptions options;
+                if (vm.count("ignore"))
+                    options.ignore = splitList(vm["ignore"].as<std::string>());
+                options.threads = threads;
+                if (inputType != InputType::commandline)
+                    return offline::runDiff(
+                        std::cin, std::cout, std::cerr, options);
+                auto const& args =
+                    vm["arguments"].as<std::vector<std::string>>();
+                if (args.size() != 2)
+                    throw std::runtime_error(
+                        "Syntax error: Wrong number of arguments");
+                std::istringstream pair(args[0] + " " + args[1]);
+                return offline::runDiff(pair, std::cout, std::cerr, options);
+            }
+            if (auto const iLedger = ledgerCommands.find(command);
+                iLedger != ledgerCommands.end())
+            {
+                if (inputType == InputType::commandline)
+                    throw std::runtime_error(
+                        "Conflicting inputs: \"" + command +
+                        "\" reads results from stdin.");
+                return iLedger->second(
+                    std::cin, std::cout, std::cerr, threads);
+            }
+            if (!vm.count("batch"))
+                return runCommand(
+                    command,
+                    vm["arguments"].as<std::vector<std::string>>(),
+                    keyFile,
+                    keyType,
+                    inputType,
+                    blobType,
+                    outputFormat);
+
+            if (inputType == InputType::commandline)
+                throw std::runtime_error(
+                    "Conflicting inputs: \"--batch\" reads records from "
+                    "stdin.");
+            offline::BatchOptions options;
+            options.threads = threads;
+            options.type = blobType;
+            options.output = outputFormat;
+            options.addressCache = vm["address-cache"].as<std::size_t>();
+            return offline::runBatch(
+                command, std::cin, std::cout, std::cerr, keyFile, options);
+        };
+        int result;
+        try
+        {
+            result = run();
+        }
+        catch (std::exception const&)
+        {
+            // The trace of a failed command is the one most wanted
+            if (vm.count("trace"))
+            {
+                try
+                {
+                    writeTrace(vm["trace"].as<std::string>());
+                }
+                catch (std::exception const& e)
+                {
+                    std::cerr << e.what() << "\n";
+                }
+            }
+            throw;
+        }
+        offline::startup::commandFinished();
+
+        // Write the final metrics
+        reporter.reset();
+
+        if (vm.count("alloc-report"))
+            offline::alloc::writeReport(std::cerr);
+
+        if (vm.count("trace"))
+            writeTrace(vm["trace"].as<std::string>());
+
+        return result;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
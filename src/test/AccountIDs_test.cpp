@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <AccountIDs.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/KeyType.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/Seed.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace offline {
+
+namespace test {
+
+class AccountIDs_test : public beast::unit_test::suite
+{
+private:
+    void
+    testKnownAccount()
+    {
+        testcase("Known account");
+
+        using namespace ripple;
+
+        auto const publicKey =
+            generateKeyPair(
+                KeyType::secp256k1, generateSeed("masterpassphrase"))
+                .first;
+        std::vector<PublicKey> const keys(20, publicKey);
+        std::vector<AccountID> ids(keys.size());
+        calcAccountIDs(keys.data(), keys.size(), ids.data());
+        for (auto const& id : ids)
+            BEAST_EXPECT(
+                toBase58(id) == "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh");
+    }
+
+    void
+    testKernels()
+    {
+        testcase("Kernels");
+
+        using namespace ripple;
+
+        // Both key types, and enough keys to leave a partial group of
+        // lanes
+        std::vector<PublicKey> keys;
+        std::vector<AccountID> expected;
+        for (int i = 0; i < 37; ++i)
+        {
+            keys.push_back(
+                generateKeyPair(
+                    i % 2 ? KeyType::ed25519 : KeyType::secp256k1,
+                    generateSeed("account " + std::to_string(i)))
+                    .first);
+            expected.push_back(calcAccountID(keys.back()));
+        }
+
+        for (auto const kernel :
+             {HashKernel::scalar, HashKernel::avx2, HashKernel::avx512})
+        {
+            if (!supported(kernel))
+            {
+                log << to_string(kernel) << " is not supported here"
+                    << std::endl;
+                except<std::logic_error>([&] {
+                    calcAccountIDs(keys.data(), 1, expected.data(), kernel);
+                });
+                continue;
+            }
+            for (std::size_t count : {0, 1, 2, 8, 16, 17, 37})
+            {
+                std::vector<AccountID> out(count);
+                calcAccountIDs(keys.data(), count, out.data(), kernel);
+                BEAST_EXPECTS(
+                    std::equal(out.begin(), out.end(), expected.begin()),
+                    std::string(to_string(kernel)) + " over " +
+                        std::to_string(count));
+            }
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testKnownAccount();
+        testKernels();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountIDs, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
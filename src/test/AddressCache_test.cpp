@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <AddressCache.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace offline {
+
+namespace test {
+
+class AddressCache_test : public beast::unit_test::suite
+{
+private:
+    void
+    testDecode()
+    {
+        testcase("Decode");
+
+        using namespace ripple;
+
+        auto const address = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+        auto const account = parseBase58<AccountID>(address);
+
+        AddressCache cache(100);
+        BEAST_EXPECT(cache.decode(address) == account);
+        BEAST_EXPECT(cache.decode(address) == account);
+        BEAST_EXPECT(cache.decode(address) == account);
+        // Invalid addresses aren't kept
+        BEAST_EXPECT(!cache.decode("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi"));
+        BEAST_EXPECT(!cache.decode("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi"));
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.stats().hits == 2);
+        BEAST_EXPECT(cache.stats().misses == 3);
+
+        // Older addresses make room for newer ones
+        for (int i = 0; i < 1000; ++i)
+        {
+            auto const other = toBase58(calcAccountID(
+                generateKeyPair(
+                    KeyType::ed25519, generateSeed(std::to_string(i)))
+                    .first));
+            BEAST_EXPECT(cache.decode(other) == parseBase58<AccountID>(other));
+        }
+        BEAST_EXPECT(cache.size() <= 100);
+    }
+
+    void
+    testResolve()
+    {
+        testcase("Resolve");
+
+        using namespace ripple;
+
+        auto const& known = getKnownTxSigned();
+        AddressCache cache(100);
+        for (int i = 0; i < 2; ++i)
+        {
+            auto json = parseJson(known.JsonText);
+            cache.resolve(json);
+            BEAST_EXPECT(
+                json["Account"] ==
+                strHex(*parseBase58<AccountID>(
+                    "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn")));
+            BEAST_EXPECT(json["Amount"]["issuer"].asString().size() == 40);
+            BEAST_EXPECT(json["SendMax"]["issuer"].asString().size() == 40);
+            BEAST_EXPECT(json["Destination"].asString().size() == 40);
+            BEAST_EXPECT(json["hash"] == parseJson(known.JsonText)["hash"]);
+            BEAST_EXPECT(serialize(*makeObject(json)) == known.SerializedText);
+        }
+        // Four addresses, each decoded once
+        BEAST_EXPECT(cache.stats().misses == 4);
+        BEAST_EXPECT(cache.stats().hits == 4);
+
+        // Not an address, so left for the parser to report
+        auto json = parseJson(known.JsonText);
+        json["Destination"] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi";
+        cache.resolve(json);
+        BEAST_EXPECT(
+            json["Destination"] == "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi");
+
+        // The library only reads the accounts of issues and bridges as
+        // addresses
+        json = parseJson(R"({
+            "TransactionType": "AMMDeposit",
+            "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+            "Asset2": {
+                "currency": "USD",
+                "issuer": "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn"
+            },
+            "XChainBridge": {
+                "LockingChainDoor": "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn"
+            }
+        })");
+        cache.resolve(json);
+        BEAST_EXPECT(json["Account"].asString().size() == 40);
+        BEAST_EXPECT(
+            json["Asset2"]["issuer"] == "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn");
+        BEAST_EXPECT(
+            json["XChainBridge"]["LockingChainDoor"] ==
+            "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn");
+    }
+
+    void
+    testThreads()
+    {
+        testcase("Threads");
+
+        using namespace ripple;
+
+        std::vector<std::string> addresses;
+        for (int i = 0; i < 50; ++i)
+            addresses.push_back(toBase58(calcAccountID(
+                generateKeyPair(
+                    KeyType::secp256k1, generateSeed(std::to_string(i)))
+                    .first)));
+
+        AddressCache cache(1000, 4);
+        std::atomic<int> wrong{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+        {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 2000; ++i)
+                {
+                    auto const& address = addresses[i % addresses.size()];
+                    if (cache.decode(address) !=
+                        parseBase58<AccountID>(address))
+                        ++wrong;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        BEAST_EXPECT(wrong == 0);
+        BEAST_EXPECT(cache.size() == addresses.size());
+        auto const stats = cache.stats();
+        BEAST_EXPECT(stats.hits + stats.misses == 8 * 2000);
+        BEAST_EXPECT(stats.misses >= addresses.size());
+    }
+
+public:
+    void
+    run() override
+    {
+        testDecode();
+        testResolve();
+        testThreads();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AddressCache, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <Aggregate.h>
+#include <Ledger.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Aggregate_test : public beast::unit_test::suite
+{
+private:
+    std::string
+    aggregate(std::string const& input, AggregateOptions const& options)
+    {
+        std::istringstream in(input);
+        std::ostringstream out;
+        std::ostringstream err;
+        BEAST_EXPECTS(
+            runAggregate(in, out, err, options) == EXIT_SUCCESS, err.str());
+        return out.str();
+    }
+
+    void
+    testGroups()
+    {
+        testcase("Groups");
+
+        auto const& tx = getKnownTxSigned().SerializedText;
+        auto const& meta = getKnownMetadata().SerializedText;
+
+        std::string input;
+        for (int i = 0; i < 5000; ++i)
+            input += tx + " " + meta + "\n";
+        for (int i = 0; i < 7; ++i)
+            input += tx + "\n\n";
+
+        AggregateOptions options;
+        options.groupBy = {"TransactionType", "TransactionResult"};
+        options.sums = {"Fee", "Sequence"};
+        options.histograms = {"Fee"};
+        for (unsigned threads : {1, 3})
+        {
+            options.threads = threads;
+            // Transactions without metadata have no result, and sort first
+            auto const csv = aggregate(input, options);
+            BEAST_EXPECTS(
+                csv ==
+                    "TransactionType,TransactionResult,count,sum_Fee,"
+                    "sum_Sequence,histogram_Fee\n"
+                    "Payment,,7,700,126,64:7\n"
+                    "Payment,tesSUCCESS,5000,500000,90000,64:5000\n",
+                csv);
+        }
+
+        options = {};
+        options.groupBy = {"Account", "Amount"};
+        auto const csv = aggregate(tx + "\n", options);
+        BEAST_EXPECTS(
+            csv ==
+                "Account,Amount,count\n"
+                "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn,"
+                "D684625103A720000000000000000000000000005553440000000000"
+                "2ADB0B3959D60A6E6991F729E1918B7163925230,1\n",
+            csv);
+    }
+
+    void
+    testLedgers()
+    {
+        testcase("Ledger buckets");
+
+        auto const& tx = getKnownTxSigned().SerializedText;
+        auto const& meta = getKnownMetadata().SerializedText;
+
+        std::ostringstream input;
+        for (std::uint32_t seq : {99, 100, 150, 250})
+        {
+            LedgerHeader header;
+            header.seq = seq;
+            Json::Value entry;
+            entry["tx_blob"] = tx;
+            entry["meta"] = meta;
+            Json::Value ledger;
+            ledger["ledger"]["ledger_data"] =
+                ripple::strHex(header.serialize());
+            ledger["ledger"]["transactions"].append(entry);
+            ledger["ledger"]["transactions"].append(entry);
+            input << Json::Compact{std::move(ledger)} << "\n";
+        }
+        // No ledger index
+        input << tx << " " << meta << "\n";
+
+        AggregateOptions options;
+        options.groupBy = {ledgerGroup};
+        options.ledgerBucket = 100;
+        auto const csv = aggregate(input.str(), options);
+        BEAST_EXPECTS(
+            csv ==
+                "ledger,count\n"
+                ",1\n"
+                "0,2\n"
+                "100,4\n"
+                "200,2\n",
+            csv);
+    }
+
+    void
+    testErrors()
+    {
+        testcase("Errors");
+
+        std::istringstream in;
+        std::ostringstream out;
+        std::ostringstream err;
+        auto const fails = [&](AggregateOptions const& options) {
+            except<std::runtime_error>(
+                [&] { runAggregate(in, out, err, options); });
+        };
+
+        AggregateOptions options;
+        options.groupBy = {"NotAField"};
+        fails(options);
+        options = {};
+        options.sums = {"Account"};
+        fails(options);
+        options = {};
+        options.histograms = {ledgerGroup};
+        fails(options);
+        options = {};
+        options.ledgerBucket = 0;
+        fails(options);
+
+        // Bad lines are reported, and the rest still counted
+        in.str(getKnownTxSigned().SerializedText + "\nHello, world!\n00\n");
+        options = {};
+        BEAST_EXPECT(runAggregate(in, out, err, options) == EXIT_FAILURE);
+        BEAST_EXPECTS(
+            out.str() == "TransactionType,count\nPayment,1\n", out.str());
+        BEAST_EXPECTS(
+            err.str().find("Line 2: Invalid hex data\nLine 3: ") == 0,
+            err.str());
+    }
+
+public:
+    void
+    run() override
+    {
+        testGroups();
+        testLedgers();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Aggregate, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
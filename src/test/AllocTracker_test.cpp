@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <AllocTracker.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+
+#include <ripple/beast/unit_test.h>
+#include <memory>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+/** Allocation budgets for the hot operations.
+
+    The budgets are upper bounds with generous headroom over what the
+    operations need today. They are meant to catch a change that adds an
+    allocation per field, or a copy of the whole object, not to pin down
+    exact counts that vary between rippled versions.
+*/
+class AllocTracker_test : public beast::unit_test::suite
+{
+private:
+    template <class F>
+    alloc::Counts
+    measure(F&& f)
+    {
+        // Warm up any lazily initialized statics first
+        f();
+        alloc::Scope scope;
+        f();
+        return scope.counts();
+    }
+
+    void
+    expectWithin(
+        std::string const& what,
+        alloc::Counts const& counts,
+        std::uint64_t maxAllocations,
+        std::uint64_t maxBytes)
+    {
+        log << what << ": " << counts.allocations << " allocations, "
+            << counts.bytes << " bytes" << std::endl;
+        BEAST_EXPECTS(
+            counts.allocations <= maxAllocations,
+            what + " allocations: " + std::to_string(counts.allocations));
+        BEAST_EXPECTS(
+            counts.bytes <= maxBytes,
+            what + " bytes: " + std::to_string(counts.bytes));
+    }
+
+    void
+    testScope()
+    {
+        testcase("Scope");
+
+        alloc::Scope outer;
+        auto const p = std::make_unique<std::uint64_t>(1);
+        {
+            alloc::Scope inner;
+            auto const v = std::make_unique<std::uint64_t[]>(100);
+            BEAST_EXPECT(inner.counts().allocations == 1);
+            BEAST_EXPECT(inner.counts().bytes >= 800);
+        }
+        BEAST_EXPECT(outer.counts().allocations == 2);
+        BEAST_EXPECT(outer.counts().bytes >= 808);
+    }
+
+    void
+    testBudgets()
+    {
+        testcase("Budgets");
+
+        using namespace ripple;
+
+        struct Budget
+        {
+            char const* name;
+            TestItem const& data;
+            std::uint64_t maxAllocations;
+            std::uint64_t maxBytes;
+        };
+        for (auto const& b :
+             {Budget{"tx", getKnownTxSigned(), 32, 8 * 1024},
+              Budget{"meta", getKnownMetadata(), 256, 64 * 1024}})
+        {
+            auto const obj = deserialize(b.data.SerializedText);
+            if (!BEAST_EXPECT(obj))
+                continue;
+            expectWithin(
+                std::string("serialize ") + b.name,
+                measure([&] { serialize(*obj); }),
+                b.maxAllocations / 2,
+                b.maxBytes);
+            expectWithin(
+                std::string("deserialize ") + b.name,
+                measure([&] { deserialize(b.data.SerializedText); }),
+                b.maxAllocations,
+                b.maxBytes);
+        }
+
+        // Decoding into the thread's buffer reuses it
+        expectWithin(
+            "unhexScratch",
+            measure([] { unhexScratch(getKnownMetadata().SerializedText); }),
+            0,
+            0);
+
+        auto const& unsignedTx = getKnownTxUnsigned();
+        expectWithin(
+            "make_sttx serialized",
+            measure([&] { make_sttx(unsignedTx.SerializedText); }),
+            64,
+            16 * 1024);
+        expectWithin(
+            "make_sttx json",
+            measure([&] { make_sttx(unsignedTx.JsonText); }),
+            512,
+            64 * 1024);
+
+        for (auto const kt : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            auto const key = RippleKey::make_RippleKey(kt, std::string("bob"));
+            auto const base = make_sttx(unsignedTx.SerializedText);
+            // Copy the transaction outside of the measured scope
+            auto const measureSign = [&](auto sign) {
+                std::optional<STTx> warm{base};
+                sign(warm);
+                std::optional<STTx> tx{base};
+                alloc::Scope scope;
+                sign(tx);
+                return scope.counts();
+            };
+            expectWithin(
+                std::string("singleSign ") + to_string(kt),
+                measureSign(
+                    [&](std::optional<STTx>& tx) { key.singleSign(tx); }),
+                64,
+                16 * 1024);
+            expectWithin(
+                std::string("multiSign ") + to_string(kt),
+                measureSign(
+                    [&](std::optional<STTx>& tx) { key.multiSign(tx); }),
+                128,
+                32 * 1024);
+        }
+    }
+
+    void
+    testReport()
+    {
+        testcase("Report");
+
+        alloc::enableReport();
+        auto const& signedTx = getKnownTxSigned();
+        for (int i = 0; i < 3; ++i)
+            make_sttx(signedTx.SerializedText);
+
+        auto const makeSttx = alloc::totals(alloc::Operation::makeSttx);
+        auto const inner = alloc::totals(alloc::Operation::deserialize);
+        BEAST_EXPECT(makeSttx.calls == 3);
+        BEAST_EXPECT(inner.calls == 3);
+        // Totals are inclusive of nested operations
+        BEAST_EXPECT(makeSttx.counts.allocations >= inner.counts.allocations);
+        BEAST_EXPECT(alloc::totals(alloc::Operation::singleSign).calls == 0);
+
+        std::stringstream ss;
+        alloc::writeReport(ss);
+        BEAST_EXPECT(ss.str().find("make_sttx") != std::string::npos);
+        BEAST_EXPECT(ss.str().find("singleSign") == std::string::npos);
+
+        // Later suites run without reporting
+        alloc::disableReport();
+        make_sttx(signedTx.SerializedText);
+        BEAST_EXPECT(alloc::totals(alloc::Operation::makeSttx).calls == 3);
+    }
+
+public:
+    void
+    run() override
+    {
+        if (!alloc::hooked())
+        {
+            log << "Allocation tracking is not enabled in this build. "
+                   "Skipping."
+                << std::endl;
+            pass();
+            return;
+        }
+        testScope();
+        testBudgets();
+        testReport();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AllocTracker, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
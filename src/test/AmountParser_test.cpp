@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <AmountParser.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/jss.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace offline {
+
+namespace test {
+
+class AmountParser_test : public beast::unit_test::suite
+{
+private:
+    static std::optional<ripple::STAmount>
+    library(Json::Value const& json)
+    {
+        try
+        {
+            return ripple::amountFromJson(ripple::sfGeneric, json);
+        }
+        catch (std::exception const&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    // Anything parsed here must match the library, and `expectParsed`
+    // says whether it should have been parsed here at all
+    void
+    expectSame(Json::Value const& json, std::optional<bool> expectParsed = {})
+    {
+        auto const fast = parseAmount(json);
+        auto const expected = library(json);
+        auto const text = json.toStyledString();
+        if (fast)
+            BEAST_EXPECTS(
+                expected && *fast == *expected &&
+                    fast->getFullText() == expected->getFullText(),
+                text);
+        if (expectParsed)
+            BEAST_EXPECTS(fast.has_value() == *expectParsed, text);
+    }
+
+    static Json::Value
+    issued(std::string const& value)
+    {
+        Json::Value json(Json::objectValue);
+        json[ripple::jss::value] = value;
+        json[ripple::jss::currency] = "USD";
+        json[ripple::jss::issuer] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+        return json;
+    }
+
+    void
+    testDecimal()
+    {
+        testcase("Decimal");
+
+        auto const expect = [this](
+                                std::string_view text,
+                                std::uint64_t mantissa,
+                                int exponent,
+                                bool negative,
+                                bool fraction) {
+            auto const parts = parseDecimal(text);
+            BEAST_EXPECTS(
+                parts && parts->mantissa == mantissa &&
+                    parts->exponent == exponent &&
+                    parts->negative == negative && parts->fraction == fraction,
+                std::string(text));
+        };
+        expect("0", 0, 0, false, false);
+        expect("-0", 0, 0, true, false);
+        expect("+1", 1, 0, false, false);
+        expect("1E-5", 1, -5, false, false);
+        expect("123.456e7", 123456, 4, false, true);
+        expect("12345678.12345678e-0012", 1234567812345678, -20, false, true);
+        expect(
+            "18446744073709551615", 18446744073709551615ULL, 0, false, false);
+        expect("0." + std::string(31, '0'), 0, -31, false, true);
+        expect("1e999999", 1, 999999, false, false);
+
+        for (auto const text :
+             {"",
+              "-",
+              "1.",
+              ".1",
+              "01",
+              "00",
+              "1e",
+              "1e+",
+              "--1",
+              " 1",
+              "1 ",
+              "1.2.3",
+              "1e2e3",
+              "0x10",
+              "18446744073709551616",
+              "1e1000000",
+              "0.000000000000000000000000000000001"})
+            BEAST_EXPECTS(!parseDecimal(text), text);
+    }
+
+    void
+    testEdgeCases()
+    {
+        testcase("Edge cases");
+
+        using namespace ripple;
+
+        // Parsed here
+        for (auto const value :
+             {"0",
+              "-0",
+              "+1",
+              "1E-5",
+              "123.456e7",
+              "0.0000000000000001",
+              "9999999999999999",
+              "99999999999999999",
+              "18446744073709551615",
+              "1e80",
+              "1e81",
+              "1e-96",
+              "1e-97",
+              "1e-200",
+              "-1234567890.12345678901"})
+        {
+            expectSame(issued(value), true);
+        }
+        for (auto const drops :
+             {"0", "-0", "10", "+10", "100000000000000000", "1e6", "1e17"})
+        {
+            expectSame(Json::Value(drops), true);
+        }
+
+        // Left to the library, valid or not
+        for (auto const value :
+             {"1.",
+              ".1",
+              "01",
+              "1e",
+              "--1",
+              " 1",
+              "1e97",
+              "1e1000",
+              "18446744073709551616",
+              "1e0000001000000",
+              "11111111111111111111111111111111",
+              "111111111111111111111111111111111"})
+        {
+            expectSame(issued(value), false);
+        }
+        for (auto const drops :
+             {"1.5", "1000e-3", "1e18", "1/USD", "10 ", "-1e-1"})
+        {
+            expectSame(Json::Value(drops), false);
+        }
+
+        // Other forms of issued amounts
+        auto json = issued("1");
+        json[jss::issuer] = strHex(*parseBase58<AccountID>(
+            "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh"));
+        expectSame(json, true);
+        json[jss::currency] = "0158415500000000C1F76FF6ECB0BAC600000000";
+        expectSame(json, true);
+        json[jss::currency] = "XRP";
+        expectSame(json, false);
+        json[jss::currency] = "USD";
+        json[jss::issuer] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi";
+        expectSame(json, false);
+        json = issued("1");
+        json["extra"] = "1";
+        expectSame(json, false);
+        json = issued("1");
+        json[jss::value] = 1;
+        expectSame(json, false);
+        expectSame(Json::Value(10), false);
+    }
+
+    void
+    testRandom()
+    {
+        testcase("Random");
+
+        std::mt19937 rng(47);
+        std::string const alphabet = "0123456789.eE+-";
+        auto const digits = [&](std::size_t count) {
+            std::string s;
+            for (std::size_t i = 0; i < count; ++i)
+                s += static_cast<char>('0' + rng() % 10);
+            return s;
+        };
+        auto const sign = [&] {
+            return std::string("-+").substr(rng() % 3, 1);
+        };
+        for (int i = 0; i < 20000; ++i)
+        {
+            std::string value;
+            if (i % 4 == 0)
+            {
+                // Anything from the alphabet
+                for (std::size_t n = rng() % 24; n; --n)
+                    value += alphabet[rng() % alphabet.size()];
+            }
+            else
+            {
+                // Mostly well formed
+                value = sign() + digits(rng() % 22 + 1);
+                if (rng() % 2)
+                    value += "." + digits(rng() % 18);
+                if (rng() % 2)
+                    value += "e" + sign() + digits(rng() % 4);
+            }
+            expectSame(issued(value));
+            expectSame(Json::Value(value));
+        }
+    }
+
+    void
+    testMakeObject()
+    {
+        testcase("Make object");
+
+        auto const& known = getKnownTxSigned();
+        auto json = parseJson(known.JsonText);
+        BEAST_EXPECT(
+            serialize(*makeObject(std::move(json))) == known.SerializedText);
+
+        // Out of range for the fast path, so the library reports it
+        json = parseJson(known.JsonText);
+        json["Fee"] = "1.5";
+        except<std::runtime_error>([&] { makeObject(std::move(json)); });
+    }
+
+public:
+    void
+    run() override
+    {
+        testDecimal();
+        testEdgeCases();
+        testRandom();
+        testMakeObject();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AmountParser, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <BalanceChanges.h>
+#include <Ledger.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class BalanceChanges_test : public beast::unit_test::suite
+{
+private:
+    // The known transaction's hash
+    static std::string const&
+    txHash()
+    {
+        static std::string const hash =
+            "F2D008D2AABBABD2A882F9049AA873210908EC3EA1EB0A2044A66093C7ACD2B1";
+        return hash;
+    }
+
+    static std::string
+    metaHex(std::string const& json)
+    {
+        return serialize(*makeObject(parseJson(json)));
+    }
+
+    // A trust line payment that also consumed part of an offer
+    static std::string const&
+    tradeMeta()
+    {
+        static std::string const json = R"({
+            "AffectedNodes" : [
+                {
+                "ModifiedNode" : {
+                    "FinalFields" : {
+                        "Balance" : {
+                            "currency" : "USD",
+                            "issuer" : "rrrrrrrrrrrrrrrrrrrrBZbvji",
+                            "value" : "-10"
+                        },
+                        "Flags" : 131072,
+                        "HighLimit" : {
+                            "currency" : "USD",
+                            "issuer" : "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                            "value" : "100"
+                        },
+                        "LowLimit" : {
+                            "currency" : "USD",
+                            "issuer" : "rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq",
+                            "value" : "0"
+                        }
+                    },
+                    "LedgerEntryType" : "RippleState",
+                    "LedgerIndex" : "7EAEE1B418DC7C00FC41E8DE6BA4FC0D79CD6F7476D44B3D99B2346F3A78FE96",
+                    "PreviousFields" : {
+                        "Balance" : {
+                            "currency" : "USD",
+                            "issuer" : "rrrrrrrrrrrrrrrrrrrrBZbvji",
+                            "value" : "-4"
+                        }
+                    }
+                }
+                },
+                {
+                "DeletedNode" : {
+                    "FinalFields" : {
+                        "Account" : "rH3uSRUJYoJhK4kL9x1mzUhDimKE2n3oT6",
+                        "TakerGets" : "0",
+                        "TakerPays" : {
+                            "currency" : "EUR",
+                            "issuer" : "rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq",
+                            "value" : "0"
+                        }
+                    },
+                    "LedgerEntryType" : "Offer",
+                    "LedgerIndex" : "8C2BEAAC384B373313F4E3E736A1C933B40E1AACB9D78B9F363BBF6D9A4CCA60",
+                    "PreviousFields" : {
+                        "TakerGets" : "3000",
+                        "TakerPays" : {
+                            "currency" : "EUR",
+                            "issuer" : "rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq",
+                            "value" : "15"
+                        }
+                    }
+                }
+                }
+            ],
+            "TransactionIndex" : 3,
+            "TransactionResult" : "tesSUCCESS"
+        })";
+        return json;
+    }
+
+    void
+    testKnown()
+    {
+        testcase("Known metadata");
+
+        using namespace ripple;
+
+        auto const tx = *strUnHex(getKnownTxSigned().SerializedText);
+        auto const meta = *strUnHex(getKnownMetadata().SerializedText);
+        std::string csv;
+        appendBalanceChanges(makeSlice(tx), makeSlice(meta), csv);
+        // The new and cancelled offers are not changes
+        BEAST_EXPECTS(
+            csv == txHash() +
+                    ",balance,rH3uSRUJYoJhK4kL9x1mzUhDimKE2n3oT6,XRP,,-286\n",
+            csv);
+    }
+
+    void
+    testTrade()
+    {
+        testcase("Trust lines and offers");
+
+        using namespace ripple;
+
+        auto const tx = *strUnHex(getKnownTxSigned().SerializedText);
+        auto const meta = *strUnHex(metaHex(tradeMeta()));
+        std::string csv;
+        appendBalanceChanges(makeSlice(tx), makeSlice(meta), csv);
+
+        auto const row = [](std::string const& rest) {
+            return txHash() + "," + rest + "\n";
+        };
+        auto const expected =
+            row("trustline,rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq,USD,"
+                "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh,-6") +
+            row("trustline,rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh,USD,"
+                "rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq,6") +
+            row("offer_gets,rH3uSRUJYoJhK4kL9x1mzUhDimKE2n3oT6,XRP,,-3000") +
+            row("offer_pays,rH3uSRUJYoJhK4kL9x1mzUhDimKE2n3oT6,EUR,"
+                "rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq,-15");
+        BEAST_EXPECTS(csv == expected, csv);
+
+        except<std::runtime_error>([&] {
+            appendBalanceChanges(makeSlice(tx), makeSlice(tx), csv);
+        });
+    }
+
+    void
+    testRun()
+    {
+        testcase("Run");
+
+        auto const& tx = getKnownTxSigned().SerializedText;
+        auto const& meta = getKnownMetadata().SerializedText;
+        auto const trade = metaHex(tradeMeta());
+
+        std::stringstream in;
+        for (int i = 0; i < 3000; ++i)
+        {
+            in << tx << " " << meta << "\n";
+            in << tx << "," << trade << "\n\n";
+        }
+        in << "Hello, world!\n";
+        // A binary ledger result
+        Json::Value entry;
+        entry["tx_blob"] = tx;
+        entry["meta"] = trade;
+        Json::Value ledger;
+        ledger["ledger"]["ledger_data"] =
+            ripple::strHex(LedgerHeader{}.serialize());
+        ledger["ledger"]["transactions"].append(entry);
+        in << Json::Compact{std::move(ledger)} << "\n";
+
+        std::ostringstream out;
+        std::ostringstream err;
+        BEAST_EXPECT(runBalanceChanges(in, out, err, 4) == EXIT_FAILURE);
+        BEAST_EXPECTS(
+            err.str() == "Line 9001: Invalid hex data\n", err.str());
+
+        std::string knownRows;
+        std::string tradeRows;
+        {
+            auto const txBlob = *ripple::strUnHex(tx);
+            auto const metaBlob = *ripple::strUnHex(meta);
+            auto const tradeBlob = *ripple::strUnHex(trade);
+            appendBalanceChanges(
+                ripple::makeSlice(txBlob),
+                ripple::makeSlice(metaBlob),
+                knownRows);
+            appendBalanceChanges(
+                ripple::makeSlice(txBlob),
+                ripple::makeSlice(tradeBlob),
+                tradeRows);
+        }
+        std::string expected = std::string(balanceChangesHeader) + "\n";
+        for (int i = 0; i < 3000; ++i)
+            expected += knownRows + tradeRows;
+        expected += tradeRows;
+        BEAST_EXPECT(out.str() == expected);
+    }
+
+public:
+    void
+    run() override
+    {
+        testKnown();
+        testTrade();
+        testRun();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BalanceChanges, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
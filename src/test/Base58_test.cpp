@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Base58.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/SecretKey.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace offline {
+
+namespace test {
+
+class Base58_test : public beast::unit_test::suite
+{
+private:
+    void
+    testKnownTokens()
+    {
+        testcase("Known tokens");
+
+        using namespace ripple;
+
+        auto const seed = generateSeed("masterpassphrase");
+        auto const publicKey =
+            generateKeyPair(KeyType::secp256k1, seed).first;
+        auto const account = calcAccountID(publicKey);
+
+        BEAST_EXPECT(
+            encodeAccount(account) == "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh");
+        BEAST_EXPECT(
+            decodeAccount("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh") == account);
+        BEAST_EXPECT(
+            encodeToken(TokenType::FamilySeed, Slice(seed.data(), 16)) ==
+            "snoPBrXtMeMyMHUVTgbuqAfg1SUTb");
+        auto const decoded = decodeSeed("snoPBrXtMeMyMHUVTgbuqAfg1SUTb");
+        BEAST_EXPECT(
+            decoded && std::equal(seed.begin(), seed.end(), decoded->begin()));
+        BEAST_EXPECT(
+            encodeToken(TokenType::AccountPublic, publicKey.slice()) ==
+            "aBQG8RQAzjs1eTKFEAQXr2gS4utcDiEC9wmi7pfUPTi27VCahwgw");
+
+        // The wrong type, checksum or length
+        BEAST_EXPECT(!decodeAccount("snoPBrXtMeMyMHUVTgbuqAfg1SUTb"));
+        BEAST_EXPECT(!decodeAccount("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi"));
+        BEAST_EXPECT(!decodeAccount("rrHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh"));
+        BEAST_EXPECT(!decodeAccount("rHb9CJAWyB4rj91VRWn96DkukG4bwdty0h"));
+        BEAST_EXPECT(!decodeAccount(""));
+        BEAST_EXPECT(!decodeSeed("masterpassphrase"));
+
+        except<std::logic_error>([] {
+            std::vector<std::uint8_t> const payload(maxTokenPayload + 1);
+            encodeToken(TokenType::None, makeSlice(payload));
+        });
+    }
+
+    void
+    testMatchesLibrary()
+    {
+        testcase("Matches the library");
+
+        using namespace ripple;
+
+        std::vector<std::pair<TokenType, std::size_t>> const tokens{
+            {TokenType::AccountID, 20},
+            {TokenType::FamilySeed, 16},
+            {TokenType::AccountPublic, 33},
+            {TokenType::NodePublic, 33},
+            {TokenType::AccountSecret, 32},
+            {TokenType::NodePrivate, 32}};
+
+        std::mt19937 rng(58);
+        for (auto const& [type, size] : tokens)
+        {
+            for (int i = 0; i < 200; ++i)
+            {
+                std::vector<std::uint8_t> payload(size);
+                for (auto& b : payload)
+                    b = static_cast<std::uint8_t>(rng());
+                // Leading zero bytes have digits of their own
+                std::fill_n(payload.begin(), i % 4, 0);
+
+                auto const text = encodeToken(type, makeSlice(payload));
+                BEAST_EXPECT(
+                    text ==
+                    encodeBase58Token(type, payload.data(), payload.size()));
+                std::vector<std::uint8_t> decoded(size);
+                BEAST_EXPECT(
+                    decodeToken(text, type, decoded.data(), size) &&
+                    decoded == payload);
+
+                // Changed, added and removed digits
+                std::vector<std::string> variants{
+                    "r" + text, text.substr(1), text + "r"};
+                auto changed = text;
+                changed[rng() % changed.size()] = "rpshnaf39w"[rng() % 10];
+                variants.push_back(changed);
+                for (auto const& variant : variants)
+                {
+                    auto const expected = decodeBase58Token(variant, type);
+                    bool const valid = expected.size() == size;
+                    BEAST_EXPECT(
+                        decodeToken(variant, type, decoded.data(), size) ==
+                        valid);
+                    if (valid)
+                        BEAST_EXPECT(
+                            std::equal(
+                                decoded.begin(),
+                                decoded.end(),
+                                expected.begin()));
+                }
+            }
+        }
+    }
+
+    void
+    testBatch()
+    {
+        testcase("Batch");
+
+        using namespace ripple;
+
+        std::vector<AccountID> accounts;
+        std::vector<Slice> payloads;
+        for (int i = 0; i < 50; ++i)
+            accounts.push_back(calcAccountID(
+                generateKeyPair(
+                    KeyType::ed25519, generateSeed(std::to_string(i)))
+                    .first));
+        for (auto const& account : accounts)
+            payloads.emplace_back(account.data(), account.size());
+
+        std::vector<std::string> texts(accounts.size());
+        encodeTokens(
+            TokenType::AccountID,
+            payloads.data(),
+            payloads.size(),
+            texts.data());
+        for (std::size_t i = 0; i < accounts.size(); ++i)
+            BEAST_EXPECT(texts[i] == toBase58(accounts[i]));
+
+        std::vector<std::string_view> views(texts.begin(), texts.end());
+        std::vector<std::uint8_t> decoded(views.size() * AccountID::size());
+        BEAST_EXPECT(
+            decodeTokens(
+                views.data(),
+                views.size(),
+                TokenType::AccountID,
+                decoded.data(),
+                AccountID::size()) == views.size());
+        for (std::size_t i = 0; i < accounts.size(); ++i)
+            BEAST_EXPECT(
+                AccountID::fromVoid(decoded.data() + i * AccountID::size()) ==
+                accounts[i]);
+
+        views[17] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi";
+        BEAST_EXPECT(
+            decodeTokens(
+                views.data(),
+                views.size(),
+                TokenType::AccountID,
+                decoded.data(),
+                AccountID::size()) == 17);
+    }
+
+public:
+    void
+    run() override
+    {
+        testKnownTokens();
+        testMatchesLibrary();
+        testBatch();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Base58, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,409 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <test/KeyFileGuard.h>
+#include <test/KnownTestData.h>
+
+#include <Batch.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+#include <Trace.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <boost/algorithm/string/split.hpp>
+#include <set>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Batch_test : public beast::unit_test::suite
+{
+private:
+    static std::string
+    oneLine(std::string const& jsonText)
+    {
+        std::ostringstream ss;
+        ss << Json::Compact{parseJson(jsonText)};
+        return ss.str();
+    }
+
+    static std::vector<std::string>
+    lines(std::string const& text)
+    {
+        std::vector<std::string> result;
+        boost::split(result, text, [](char c) { return c == '\n'; });
+        // Every line is terminated, so the last "line" is always empty
+        if (!result.empty() && result.back().empty())
+            result.pop_back();
+        return result;
+    }
+
+    void
+    testSerialize()
+    {
+        testcase("Serialize");
+
+        std::vector<TestItem const*> const items = {
+            &getKnownTxSigned(), &getKnownTxUnsigned(), &getKnownMetadata()};
+
+        std::stringstream in;
+        // Repeat the items to give the workers something to share
+        for (int i = 0; i < 20; ++i)
+            for (auto const item : items)
+                in << oneLine(item->JsonText) << "\n\n";
+
+        std::stringstream out;
+        std::stringstream err;
+        BatchOptions options;
+        options.threads = 4;
+        options.queueDepth = 2;
+        auto const exit = runBatch("serialize", in, out, err, {}, options);
+        BEAST_EXPECT(exit == EXIT_SUCCESS);
+        BEAST_EXPECTS(err.str().empty(), err.str());
+
+        auto const results = lines(out.str());
+        if (BEAST_EXPECT(results.size() == 20 * items.size()))
+        {
+            for (std::size_t i = 0; i < results.size(); ++i)
+                BEAST_EXPECT(
+                    results[i] == items[i % items.size()]->SerializedText);
+        }
+    }
+
+    void
+    testDeserialize()
+    {
+        testcase("Deserialize");
+
+        using namespace ripple;
+
+        auto const& signedTx = getKnownTxSigned();
+        auto const& meta = getKnownMetadata();
+
+        std::stringstream in;
+        in << "  " << signedTx.SerializedText << "\n"
+           << "Hello, world!\n"
+           << meta.SerializedText << "\n";
+
+        std::stringstream out;
+        std::stringstream err;
+        auto const exit = runBatch("deserialize", in, out, err, {}, {});
+        BEAST_EXPECT(exit == EXIT_FAILURE);
+        BEAST_EXPECTS(
+            err.str() ==
+                "Line 2: Unable to deserialize: Is this valid serialized "
+                "data?\n",
+            err.str());
+
+        auto const results = lines(out.str());
+        if (BEAST_EXPECT(results.size() == 3))
+        {
+            auto known = parseJson(signedTx.JsonText);
+            // The hash field is STTx-specific, so it won't be in the
+            // generic output.
+            known.removeMember("hash");
+            BEAST_EXPECT(parseJson(results[0]) == known);
+            BEAST_EXPECT(results[1].empty());
+            BEAST_EXPECT(parseJson(results[2]) == parseJson(meta.JsonText));
+        }
+    }
+
+    void
+    testBinaryOutput()
+    {
+        testcase("Binary output");
+
+        auto const& tx = getKnownTxSigned().SerializedText;
+        auto const& meta = getKnownMetadata().SerializedText;
+
+        std::stringstream in;
+        in << tx << "\nHello, world!\n" << meta << "\n";
+
+        std::stringstream out;
+        std::stringstream err;
+        BatchOptions options;
+        options.output = OutputFormat::cbor;
+        auto const exit = runBatch("deserialize", in, out, err, {}, options);
+        BEAST_EXPECT(exit == EXIT_FAILURE);
+        BEAST_EXPECTS(
+            err.str() == "Line 2: Unable to deserialize: Invalid hex data\n",
+            err.str());
+        // Back to back, with null for the failed record
+        BEAST_EXPECT(
+            out.str() ==
+            decodeAs(tx, BlobType::generic, OutputFormat::cbor) +
+                encodeNull(OutputFormat::cbor) +
+                decodeAs(meta, BlobType::generic, OutputFormat::cbor));
+
+        options.output = OutputFormat::msgpack;
+        except<std::runtime_error>(
+            [&] { runBatch("serialize", in, out, err, {}, options); });
+    }
+
+    void
+    testSign()
+    {
+        testcase("Sign");
+
+        using namespace boost::filesystem;
+        using namespace ripple;
+
+        std::string const subdir = "test_key_file";
+        KeyFileGuard g(*this, subdir);
+        path const keyFile = subdir / ".ripple" / "secret-key.txt";
+
+        RippleKey const key;
+        key.writeToFile(keyFile);
+
+        auto const& unsignedTx = getKnownTxUnsigned();
+
+        for (auto const command : {"sign", "multisign"})
+        {
+            std::stringstream in;
+            for (int i = 0; i < 8; ++i)
+                in << unsignedTx.SerializedText << "\n"
+                   << oneLine(unsignedTx.JsonText) << "\n";
+
+            std::stringstream out;
+            std::stringstream err;
+            BatchOptions options;
+            options.threads = 3;
+            auto const exit =
+                runBatch(command, in, out, err, keyFile, options);
+            BEAST_EXPECT(exit == EXIT_SUCCESS);
+            BEAST_EXPECTS(err.str().empty(), err.str());
+
+            auto const results = lines(out.str());
+            BEAST_EXPECT(results.size() == 16);
+            for (auto const& result : results)
+            {
+                auto const tx = make_sttx(result);
+                BEAST_EXPECT(tx.checkSign(STTx::RequireFullyCanonicalSig::yes));
+                BEAST_EXPECT(
+                    tx.isFieldPresent(sfSigners) ==
+                    (command == std::string{"multisign"}));
+            }
+        }
+
+        {
+            // Missing key file fails before any records are read
+            std::stringstream in(unsignedTx.SerializedText);
+            std::stringstream out;
+            std::stringstream err;
+            auto const badKeyFile = subdir / "invalid.txt";
+            try
+            {
+                runBatch("sign", in, out, err, badKeyFile, {});
+                fail();
+            }
+            catch (std::exception const& e)
+            {
+                BEAST_EXPECT(
+                    e.what() ==
+                    "Failed to open key file: " + badKeyFile.string());
+            }
+            BEAST_EXPECT(out.str().empty());
+        }
+    }
+
+    void
+    testIssues()
+    {
+        testcase("Issues and bridges");
+
+        using namespace boost::filesystem;
+        using namespace ripple;
+
+        // The library only reads the accounts of an issue or a bridge
+        // as addresses, so the address cache must leave them alone.
+        std::vector<std::string> const records = {
+            oneLine(R"({
+                "TransactionType": "AMMDeposit",
+                "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                "Asset": {"currency": "XRP"},
+                "Asset2": {
+                    "currency": "USD",
+                    "issuer": "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn"
+                },
+                "Amount": "1000000",
+                "Amount2": {
+                    "currency": "USD",
+                    "issuer": "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn",
+                    "value": "10"
+                },
+                "Fee": "10",
+                "Flags": 1048576,
+                "Sequence": 1,
+                "SigningPubKey": ""
+            })"),
+            oneLine(R"({
+                "TransactionType": "XChainCommit",
+                "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                "Amount": "10000",
+                "XChainBridge": {
+                    "LockingChainDoor": "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn",
+                    "LockingChainIssue": {"currency": "XRP"},
+                    "IssuingChainDoor": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                    "IssuingChainIssue": {"currency": "XRP"}
+                },
+                "XChainClaimID": "1",
+                "OtherChainDestination": "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn",
+                "Fee": "10",
+                "Sequence": 2,
+                "SigningPubKey": ""
+            })")};
+
+        std::string const subdir = "test_key_file";
+        KeyFileGuard g(*this, subdir);
+        path const keyFile = subdir / ".ripple" / "secret-key.txt";
+        RippleKey const key;
+        key.writeToFile(keyFile);
+
+        for (auto const command : {"serialize", "sign"})
+        {
+            std::vector<std::string> outputs;
+            for (std::size_t const cache : {0, 65536})
+            {
+                std::stringstream in;
+                for (auto const& record : records)
+                    in << record << "\n";
+                std::stringstream out;
+                std::stringstream err;
+                BatchOptions options;
+                options.threads = 2;
+                options.addressCache = cache;
+                auto const exit =
+                    runBatch(command, in, out, err, keyFile, options);
+                BEAST_EXPECT(exit == EXIT_SUCCESS);
+                BEAST_EXPECTS(err.str().empty(), err.str());
+                BEAST_EXPECT(lines(out.str()).size() == records.size());
+                outputs.push_back(out.str());
+            }
+            BEAST_EXPECT(outputs[0] == outputs[1]);
+        }
+
+        // The same as serializing each record without the cache
+        std::stringstream in;
+        for (auto const& record : records)
+            in << record << "\n";
+        std::stringstream out;
+        std::stringstream err;
+        runBatch("serialize", in, out, err, {}, {});
+        auto const results = lines(out.str());
+        if (BEAST_EXPECT(results.size() == records.size()))
+        {
+            for (std::size_t i = 0; i < records.size(); ++i)
+            {
+                auto const json = parseJson(records[i]);
+                BEAST_EXPECT(results[i] == serialize(*makeObject(json)));
+            }
+        }
+    }
+
+    void
+    testTrace()
+    {
+        testcase("Trace");
+
+        auto const& known = getKnownTxSigned();
+        std::stringstream in;
+        for (int i = 0; i < 10; ++i)
+            in << known.SerializedText << "\n";
+
+        std::stringstream out;
+        std::stringstream err;
+        trace::enable(8);
+        BatchOptions options;
+        options.threads = 2;
+        runBatch("deserialize", in, out, err, {}, options);
+        trace::disable();
+
+        std::stringstream traceOut;
+        trace::write(traceOut);
+        auto const json = parseJson(traceOut.str());
+        if (!BEAST_EXPECT(json.isMember("traceEvents")))
+            return;
+        auto const& events = json["traceEvents"];
+        BEAST_EXPECT(events.isArray());
+
+        std::set<std::string> names;
+        std::set<std::string> threads;
+        for (auto const& event : events)
+        {
+            if (event["ph"].asString() == "M")
+                threads.insert(event["args"]["name"].asString());
+            else
+                names.insert(event["name"].asString());
+        }
+        BEAST_EXPECT(names.count("parse"));
+        BEAST_EXPECT(names.count("write"));
+        BEAST_EXPECT(names.count("output"));
+        BEAST_EXPECT(names.count("input queue"));
+        BEAST_EXPECT(threads.count("reader"));
+        BEAST_EXPECT(threads.count("writer"));
+        BEAST_EXPECT(threads.count("worker 0"));
+        // Each of the 4 threads keeps at most 8 events plus its name
+        BEAST_EXPECT(events.size() <= 4 * 9);
+    }
+
+    void
+    testUnsupported()
+    {
+        testcase("Unsupported command");
+
+        std::stringstream in;
+        std::stringstream out;
+        std::stringstream err;
+        try
+        {
+            runBatch("createkeyfile", in, out, err, {}, {});
+            fail();
+        }
+        catch (std::exception const& e)
+        {
+            BEAST_EXPECT(
+                e.what() ==
+                std::string{
+                    "Command does not support batch mode: createkeyfile"});
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testSerialize();
+        testDeserialize();
+        testBinaryOutput();
+        testSign();
+        testIssues();
+        testTrace();
+        testUnsupported();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Batch, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Chain.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/digest.h>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Chain_test : public beast::unit_test::suite
+{
+private:
+    static std::vector<LedgerHeader>
+    makeChain(std::size_t count)
+    {
+        std::vector<LedgerHeader> chain;
+        LedgerHeader header;
+        header.seq = 32570;
+        header.drops = 100000000000000000;
+        header.closeTime = 410000000;
+        header.closeTimeResolution = 30;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            header.txHash = ripple::sha512Half(i, std::string("tx"));
+            header.accountHash = ripple::sha512Half(i, std::string("state"));
+            chain.push_back(header);
+
+            header.parentHash = header.hash();
+            header.parentCloseTime = header.closeTime;
+            header.closeTime += 1 + i % 7;
+            header.drops -= 10;
+            ++header.seq;
+        }
+        return chain;
+    }
+
+    static std::string
+    toText(std::vector<LedgerHeader> const& chain)
+    {
+        std::string text;
+        for (auto const& header : chain)
+            text += ripple::strHex(header.serialize()) + "\n";
+        return text;
+    }
+
+    std::vector<ChainBreak>
+    check(std::string const& text, unsigned threads = 4)
+    {
+        std::vector<ChainBreak> breaks;
+        std::istringstream in(text);
+        auto const summary = verifyChain(
+            in,
+            [&breaks](ChainBreak const& b) { breaks.push_back(b); },
+            threads);
+        BEAST_EXPECT(summary.breaks == breaks.size());
+        return breaks;
+    }
+
+    void
+    testGood()
+    {
+        testcase("Good chain");
+
+        auto const chain = makeChain(300);
+        std::istringstream in(toText(chain));
+        std::ostringstream out;
+        BEAST_EXPECT(runVerifyChain(in, out, out, 4) == EXIT_SUCCESS);
+        auto const jv = parseJson(out.str());
+        BEAST_EXPECT(jv["verified"].asBool());
+        BEAST_EXPECT(jv["ledgers"].asUInt() == 300);
+        BEAST_EXPECT(jv["first_ledger_index"].asUInt() == chain.front().seq);
+        BEAST_EXPECT(jv["last_ledger_index"].asUInt() == chain.back().seq);
+        BEAST_EXPECT(
+            jv["last_ledger_hash"].asString() ==
+            ripple::to_string(chain.back().hash()));
+
+        // Binary ledger results, with blank lines between them
+        std::string text;
+        for (auto const& header : makeChain(5))
+        {
+            Json::Value result;
+            result["result"]["ledger"]["ledger_data"] =
+                ripple::strHex(header.serialize());
+            text += toCompactJson(std::move(result)) + "\n\n";
+        }
+        BEAST_EXPECT(check(text).empty());
+    }
+
+    void
+    testBreaks()
+    {
+        testcase("Breaks");
+
+        auto const chain = makeChain(300);
+
+        // Changing a header breaks the link to it and from it
+        {
+            auto changed = chain;
+            changed[49].txHash = ~changed[49].txHash;
+            auto const breaks = check(toText(changed));
+            if (BEAST_EXPECT(breaks.size() == 1))
+            {
+                BEAST_EXPECT(breaks[0].line == 51);
+                BEAST_EXPECT(breaks[0].seq == chain[50].seq);
+                BEAST_EXPECT(breaks[0].error.find("parent_hash") == 0);
+            }
+        }
+        // A gap
+        {
+            auto changed = chain;
+            changed.erase(changed.begin() + 100);
+            auto const breaks = check(toText(changed));
+            if (BEAST_EXPECT(breaks.size() == 1))
+            {
+                BEAST_EXPECT(breaks[0].line == 101);
+                BEAST_EXPECT(breaks[0].error.find("Sequence") == 0);
+            }
+        }
+        // Close time going backwards, in an otherwise linked chain
+        {
+            auto changed = chain;
+            changed[10].closeTime = changed[9].closeTime;
+            for (std::size_t i = 11; i < changed.size(); ++i)
+            {
+                changed[i].parentHash = changed[i - 1].hash();
+                changed[i].parentCloseTime = changed[i - 1].closeTime;
+            }
+            auto const breaks = check(toText(changed));
+            if (BEAST_EXPECT(breaks.size() == 1))
+            {
+                BEAST_EXPECT(breaks[0].line == 11);
+                BEAST_EXPECT(breaks[0].error.find("close_time") == 0);
+            }
+        }
+        // A line that is not a header. The next header can't be linked.
+        {
+            auto text = toText(chain);
+            text.insert(text.find('\n') + 1, "Hello, world!\n");
+            auto const breaks = check(text);
+            if (BEAST_EXPECT(breaks.size() == 1))
+            {
+                BEAST_EXPECT(breaks[0].line == 2);
+                BEAST_EXPECT(!breaks[0].seq);
+            }
+        }
+        // A binary ledger result whose ledger_hash is not the hash of its
+        // header. The header still links to the next one.
+        {
+            std::string text;
+            for (auto const& header : makeChain(3))
+            {
+                Json::Value result;
+                result["result"]["ledger"]["ledger_data"] =
+                    ripple::strHex(header.serialize());
+                result["result"]["ledger_hash"] =
+                    ripple::to_string(header.hash());
+                text += toCompactJson(std::move(result)) + "\n";
+            }
+            BEAST_EXPECT(check(text).empty());
+
+            auto const pos = text.find("\"ledger_hash\":\"") + 15;
+            text[pos] = text[pos] == '0' ? '1' : '0';
+            auto const breaks = check(text);
+            if (BEAST_EXPECT(breaks.size() == 1))
+            {
+                BEAST_EXPECT(breaks[0].line == 1);
+                BEAST_EXPECT(breaks[0].error.find("ledger_hash") == 0);
+            }
+        }
+        // Out of order
+        {
+            auto changed = chain;
+            std::swap(changed[5], changed[6]);
+            BEAST_EXPECT(check(toText(changed)).size() == 3);
+        }
+    }
+
+    void
+    testChunks()
+    {
+        testcase("Chunks");
+
+        // Longer than one chunk
+        auto chain = makeChain(70000);
+        BEAST_EXPECT(check(toText(chain)).empty());
+
+        // A break across the chunk boundary
+        chain[65535].accountHash = ~chain[65535].accountHash;
+        auto const breaks = check(toText(chain), 2);
+        if (BEAST_EXPECT(breaks.size() == 1))
+            BEAST_EXPECT(breaks[0].line == 65537);
+    }
+
+    void
+    testKnownAnswer()
+    {
+        testcase("Known answer");
+
+        // Two headers and their hashes, computed independently of rippled
+        // and of this tool. The second follows the first.
+        std::string const first =
+            "01B7A4FA01633D5EF6D40DF9FC8CB8BFE0BEE91BCC39BBB31827230BEDF273C3"
+            "00EC2F6DB212A31CA9CE7E9477CA592FF26101F98C13876E2A526470824B1CEF"
+            "630E68544C8A29BF1113660D51FF5D4B550EE8660FBBAE6FB991525F2397EFC3"
+            "93F67793C12560665FAA2413206D741C206D741D0A00";
+        std::string const second =
+            "01B7A4FB01633D5EF6D40DED813B84545D1A130F8608F7952CBBDE50325CE93E"
+            "D729411EE7C2AB68370D5CC30000000000000000000000000000000000000000"
+            "00000000000000000000000051FF5D4B550EE8660FBBAE6FB991525F2397EFC3"
+            "93F67793C12560665FAA2413206D741D206D74260A00";
+        std::string const firstHash =
+            "813B84545D1A130F8608F7952CBBDE50325CE93ED729411EE7C2AB68370D5CC3";
+        std::string const secondHash =
+            "0E92BF01886EA15E9226B2183D294A5971E6971EBF42437296AC0D50998AE977";
+
+        std::string text;
+        for (auto const& [header, hash] :
+             {std::pair(first, firstHash), std::pair(second, secondHash)})
+        {
+            Json::Value result;
+            result["result"]["ledger"]["ledger_data"] = header;
+            result["result"]["ledger_hash"] = hash;
+            text += toCompactJson(std::move(result)) + "\n";
+        }
+        std::istringstream in(text);
+        std::ostringstream out;
+        BEAST_EXPECT(runVerifyChain(in, out, out, 2) == EXIT_SUCCESS);
+        auto const jv = parseJson(out.str());
+        BEAST_EXPECT(jv["verified"].asBool());
+        BEAST_EXPECT(jv["ledgers"].asUInt() == 2);
+        BEAST_EXPECT(jv["first_ledger_index"].asUInt() == 28812538);
+        BEAST_EXPECT(jv["last_ledger_hash"].asString() == secondHash);
+
+        // The same headers in hex, in the wrong order
+        auto const breaks = check(second + "\n" + first + "\n");
+        if (BEAST_EXPECT(breaks.size() == 1))
+            BEAST_EXPECT(breaks[0].error.find("Sequence") == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testGood();
+        testBreaks();
+        testChunks();
+        testKnownAnswer();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Chain, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,267 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <ColumnExport.h>
+#include <Ledger.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/json_writer.h>
+#include <cstring>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class ColumnExport_test : public beast::unit_test::suite
+{
+private:
+    // Reads back the parts of a column file that the tests check
+    class Reader
+    {
+    private:
+        std::string const data_;
+
+        static std::uint64_t
+        littleEndian(std::string const& bytes, std::size_t pos, unsigned n)
+        {
+            std::uint64_t value = 0;
+            for (unsigned i = n; i-- > 0;)
+                value = (value << 8) |
+                    static_cast<std::uint8_t>(bytes[pos + i]);
+            return value;
+        }
+
+    public:
+        Json::Value footer;
+
+        explicit Reader(std::string data) : data_(std::move(data))
+        {
+            auto const magicSize = std::strlen(columnFileMagic);
+            if (data_.size() < 2 * magicSize + 4 ||
+                data_.compare(0, magicSize, columnFileMagic) ||
+                data_.compare(
+                    data_.size() - magicSize, magicSize, columnFileMagic))
+                return;
+            auto const end = data_.size() - magicSize - 4;
+            auto const size = littleEndian(data_, end, 4);
+            Json::Reader{}.parse(data_.substr(end - size, size), footer);
+        }
+
+        Json::Value
+        column(unsigned group, std::string const& name) const
+        {
+            for (auto const& c : footer["row_groups"][group]["columns"])
+            {
+                if (c["name"].asString() == name)
+                    return c;
+            }
+            return {};
+        }
+
+        /** The values of an integer or dictionary column, with -1 for
+            missing values. Dictionary columns give entry indexes.
+        */
+        std::vector<std::int64_t>
+        ints(unsigned group, std::string const& name) const
+        {
+            auto const c = column(group, name);
+            auto const rows = footer["row_groups"][group]["rows"].asUInt();
+            auto const type = c["type"].asString();
+            std::size_t pos = c["offset"].asUInt() + (rows + 7) / 8;
+            // Dictionary indexes are 32 bits
+            unsigned bits = 32;
+            if (type == "dictionary")
+                pos += 4 + littleEndian(data_, pos, 4) * c["width"].asUInt();
+            else
+                bits = std::stoi(type.substr(type.find_first_of("0123456789")));
+            auto const width = bits / 8;
+            std::vector<std::int64_t> values;
+            for (unsigned row = 0; row < rows; ++row)
+            {
+                auto const bitmap = static_cast<std::uint8_t>(
+                    data_[c["offset"].asUInt() + row / 8]);
+                if (!(bitmap & (1 << (row % 8))))
+                {
+                    values.push_back(-1);
+                    continue;
+                }
+                auto value = littleEndian(data_, pos, width);
+                pos += width;
+                // Sign extend
+                if (type[0] == 'i' && width < 8 &&
+                    (value >> (width * 8 - 1)))
+                    value |= ~std::uint64_t{0} << (width * 8);
+                values.push_back(static_cast<std::int64_t>(value));
+            }
+            return values;
+        }
+
+        /// The entries of a dictionary column, in hex.
+        std::vector<std::string>
+        dictionary(unsigned group, std::string const& name) const
+        {
+            auto const c = column(group, name);
+            auto const rows = footer["row_groups"][group]["rows"].asUInt();
+            auto const width = c["width"].asUInt();
+            std::size_t const pos = c["offset"].asUInt() + (rows + 7) / 8;
+            std::vector<std::string> entries;
+            for (std::size_t i = 0; i < littleEndian(data_, pos, 4); ++i)
+                entries.push_back(ripple::strHex(
+                    data_.substr(pos + 4 + i * width, width)));
+            return entries;
+        }
+    };
+
+    std::string
+    exportColumns(std::string const& input, std::size_t rowGroupLines)
+    {
+        std::istringstream in(input);
+        std::ostringstream out;
+        std::ostringstream err;
+        ColumnExportOptions options;
+        options.rowGroupLines = rowGroupLines;
+        options.threads = 3;
+        BEAST_EXPECTS(
+            runExportColumns(in, out, err, options) == EXIT_SUCCESS,
+            err.str());
+        return out.str();
+    }
+
+    void
+    testColumns()
+    {
+        testcase("Columns");
+
+        auto const& tx = getKnownTxSigned().SerializedText;
+        auto const& meta = getKnownMetadata().SerializedText;
+        Reader const file(exportColumns(
+            tx + " " + meta + "\n" + tx + "\n\n" + tx + "," + meta + "\n",
+            2));
+
+        auto const& groups = file.footer["row_groups"];
+        BEAST_EXPECT(file.footer["format"] == "xrpl-columns");
+        BEAST_EXPECT(groups.size() == 2);
+        BEAST_EXPECT(groups[0u]["rows"] == 2);
+        BEAST_EXPECT(groups[1u]["rows"] == 1);
+        BEAST_EXPECT(groups[0u]["columns"][0u]["name"] == "hash");
+        BEAST_EXPECT(groups[0u]["columns"][0u]["width"] == 32);
+        BEAST_EXPECT(file.column(0, "ledger_index").isNull());
+
+        using Ints = std::vector<std::int64_t>;
+        BEAST_EXPECT(file.column(0, "Fee")["type"] == "uint64");
+        BEAST_EXPECT(file.ints(0, "Fee") == (Ints{100, 100}));
+        BEAST_EXPECT(file.ints(0, "TransactionType") == (Ints{0, 0}));
+        BEAST_EXPECT(file.ints(0, "Sequence") == (Ints{18, 18}));
+        // Only the first row has metadata
+        BEAST_EXPECT(file.ints(0, "TransactionIndex") == (Ints{21, -1}));
+        BEAST_EXPECT(file.ints(1, "TransactionResult") == (Ints{0}));
+
+        BEAST_EXPECT(file.column(0, "Account")["type"] == "dictionary");
+        BEAST_EXPECT(file.ints(0, "Account") == (Ints{0, 0}));
+        BEAST_EXPECT(
+            file.dictionary(0, "Account") ==
+            std::vector<std::string>{
+                "AE123A8556F3CF91154711376AFB0F894F832B3D"});
+
+        BEAST_EXPECT(
+            file.ints(0, "Amount.value") ==
+            (Ints{1234000000000000, 1234000000000000}));
+        BEAST_EXPECT(file.ints(0, "Amount.exponent") == (Ints{-7, -7}));
+        BEAST_EXPECT(
+            file.dictionary(0, "Amount.currency") ==
+            std::vector<std::string>{
+                "0000000000000000000000005553440000000000"});
+        BEAST_EXPECT(file.column(0, "Amount.mpt_issuance_id").isNull());
+        BEAST_EXPECT(file.column(0, "AffectedNodes")["type"] == "binary");
+        BEAST_EXPECT(file.column(0, "TxnSignature")["values"] == 2);
+    }
+
+    void
+    testLedger()
+    {
+        testcase("Ledger results");
+
+        LedgerHeader header;
+        header.seq = 12345;
+        Json::Value entry;
+        entry["tx_blob"] = getKnownTxSigned().SerializedText;
+        entry["meta"] = getKnownMetadata().SerializedText;
+        Json::Value ledger;
+        ledger["ledger"]["ledger_data"] = ripple::strHex(header.serialize());
+        ledger["ledger"]["transactions"].append(entry);
+        ledger["ledger"]["transactions"].append(entry);
+        std::ostringstream input;
+        input << Json::Compact{std::move(ledger)} << "\n";
+
+        Reader const file(exportColumns(input.str(), 10));
+        BEAST_EXPECT(file.footer["row_groups"][0u]["rows"] == 2);
+        BEAST_EXPECT(
+            file.ints(0, "ledger_index") ==
+            (std::vector<std::int64_t>{12345, 12345}));
+    }
+
+    void
+    testErrors()
+    {
+        testcase("Errors");
+
+        std::istringstream in(
+            getKnownTxSigned().SerializedText + "\nHello, world!\n");
+        std::ostringstream out;
+        std::ostringstream err;
+        ColumnExportOptions options;
+        BEAST_EXPECT(runExportColumns(in, out, err, options) == EXIT_FAILURE);
+        BEAST_EXPECTS(err.str() == "Line 2: Invalid hex data\n", err.str());
+        Reader const file(out.str());
+        BEAST_EXPECT(file.footer["row_groups"][0u]["rows"] == 1);
+
+        // An empty input still makes a valid file
+        in.clear();
+        in.str("");
+        out.str("");
+        BEAST_EXPECT(runExportColumns(in, out, err, options) == EXIT_SUCCESS);
+        BEAST_EXPECT(Reader(out.str()).footer["row_groups"].size() == 0);
+
+        options.rowGroupLines = 0;
+        except<std::runtime_error>(
+            [&] { runExportColumns(in, out, err, options); });
+    }
+
+public:
+    void
+    run() override
+    {
+        testColumns();
+        testLedger();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ColumnExport, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Corpus.h>
+#include <Serialize.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/TxFormats.h>
+#include <set>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Corpus_test : public beast::unit_test::suite
+{
+private:
+    static std::vector<std::string>
+    lines(std::string const& text)
+    {
+        std::vector<std::string> result;
+        std::istringstream ss(text);
+        for (std::string line; std::getline(ss, line);)
+            result.push_back(line);
+        return result;
+    }
+
+    static std::string
+    generate(CorpusOptions const& options)
+    {
+        std::stringstream ss;
+        writeCorpus(options, ss);
+        return ss.str();
+    }
+
+    void
+    testDeterminism()
+    {
+        testcase("Determinism");
+
+        CorpusOptions options;
+        options.count = 300;
+        options.accounts = 20;
+        options.seed = 42;
+        options.threads = 1;
+        auto const serial = generate(options);
+        BEAST_EXPECT(lines(serial).size() == 300);
+
+        // The thread count doesn't change the output
+        options.threads = 4;
+        BEAST_EXPECT(generate(options) == serial);
+
+        // A prefix of a longer corpus is the shorter corpus
+        options.count = 200;
+        auto const shorter = lines(generate(options));
+        auto const longer = lines(serial);
+        BEAST_EXPECT(
+            std::equal(shorter.begin(), shorter.end(), longer.begin()));
+
+        // Another seed gives other transactions
+        options.count = 300;
+        options.seed = 43;
+        BEAST_EXPECT(generate(options) != serial);
+    }
+
+    void
+    testMix()
+    {
+        testcase("Mix");
+
+        using namespace ripple;
+
+        CorpusOptions options;
+        options.count = 500;
+        options.accounts = 20;
+        options.encoding = Encoding::hex;
+        std::set<std::uint16_t> types;
+        bool pathsSeen = false;
+        for (auto const& line : lines(generate(options)))
+        {
+            auto const obj = deserialize(line);
+            if (!BEAST_EXPECT(obj))
+                continue;
+            types.insert(obj->getFieldU16(sfTransactionType));
+            pathsSeen = pathsSeen || obj->isFieldPresent(sfPaths);
+        }
+        BEAST_EXPECT(
+            types ==
+            std::set<std::uint16_t>(
+                {ttPAYMENT,
+                 ttOFFER_CREATE,
+                 ttTRUST_SET,
+                 ttACCOUNT_SET,
+                 ttSIGNER_LIST_SET,
+                 ttESCROW_CREATE}));
+        BEAST_EXPECT(pathsSeen);
+
+        options.mix = parseCorpusMix("TrustSet=1, EscrowCreate=0");
+        Corpus const corpus(options);
+        for (std::uint64_t i = 0; i < 50; ++i)
+        {
+            BEAST_EXPECT(corpus.kind(i) == CorpusKind::trustSet);
+            BEAST_EXPECT(corpus.generate(i).getTxnType() == ttTRUST_SET);
+        }
+
+        for (auto const bad : {"", "Payment=1", "TrustSet", "TrustSet=x"})
+        {
+            try
+            {
+                parseCorpusMix(bad);
+                fail(std::string("Expected an exception: ") + bad);
+            }
+            catch (std::runtime_error const& e)
+            {
+                BEAST_EXPECT(
+                    std::string(e.what()).find("Invalid transaction mix") == 0);
+            }
+        }
+
+        options.mix = {};
+        try
+        {
+            Corpus const empty(options);
+            fail("Expected an exception");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                e.what() == std::string("The transaction mix is empty."));
+        }
+    }
+
+    void
+    testSigned()
+    {
+        testcase("Signed");
+
+        using namespace ripple;
+
+        CorpusOptions options;
+        options.count = 40;
+        options.accounts = 10;
+        options.sign = true;
+        options.encoding = Encoding::json;
+        std::set<std::string> keyPrefixes;
+        for (auto const& line : lines(generate(options)))
+        {
+            auto const tx = make_sttx(line);
+            auto const check =
+                tx.checkSign(STTx::RequireFullyCanonicalSig::yes);
+            BEAST_EXPECTS(check, check ? "" : check.error());
+            keyPrefixes.insert(strHex(tx.getSigningPubKey()).substr(0, 2));
+        }
+        // Both secp256k1 (02 or 03) and ed25519 (ED) accounts sign
+        BEAST_EXPECT(keyPrefixes.count("ED"));
+        BEAST_EXPECT(keyPrefixes.size() > 1);
+    }
+
+    void
+    testRoundTrip()
+    {
+        testcase("Round trip");
+
+        CorpusOptions options;
+        options.count = 2000;
+        options.accounts = 50;
+        options.maxMemoBytes = 300;
+        options.maxPaths = 6;
+        std::stringstream err;
+        BEAST_EXPECTS(checkRoundTrip(options, err) == 0, err.str());
+
+        options.sign = true;
+        options.count = 200;
+        BEAST_EXPECTS(checkRoundTrip(options, err) == 0, err.str());
+    }
+
+public:
+    void
+    run() override
+    {
+        testDeterminism();
+        testMix();
+        testSigned();
+        testRoundTrip();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Corpus, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KeyFileGuard.h>
+
+#include <Derive.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/jss.h>
+#include <algorithm>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Derive_test : public beast::unit_test::suite
+{
+private:
+    void
+    testRange()
+    {
+        testcase("Range");
+
+        using Range = std::pair<std::uint32_t, std::uint32_t>;
+        BEAST_EXPECT(parseAccountRange("0..999") == Range(0, 999));
+        BEAST_EXPECT(parseAccountRange("7") == Range(7, 7));
+        BEAST_EXPECT(parseAccountRange("5..5") == Range(5, 5));
+        BEAST_EXPECT(
+            parseAccountRange("0..4294967295") == Range(0, 4294967295u));
+        for (auto const bad :
+             {"", "..", "1..", "..2", "3..2", "-1..2", "+1..2", "1...2",
+              "1..2..3", "a..b", " 1..2", "0..4294967296"})
+        {
+            except<std::runtime_error>([&] { parseAccountRange(bad); });
+        }
+    }
+
+    void
+    testDerive()
+    {
+        testcase("Derive");
+
+        auto const seed = ripple::generateSeed("masterpassphrase");
+        DeriveOptions options;
+        options.first = 0;
+        options.last = 2;
+        std::stringstream out;
+        BEAST_EXPECT(runDerive(seed, out, options) == EXIT_SUCCESS);
+
+        std::vector<std::string> accounts;
+        std::string line;
+        for (std::uint32_t ordinal = 0; std::getline(out, line); ++ordinal)
+        {
+            auto const jv = parseJson(line);
+            BEAST_EXPECT(jv["account_index"].asUInt() == ordinal);
+            BEAST_EXPECT(jv[ripple::jss::public_key_hex].isString());
+            accounts.push_back(jv[ripple::jss::account_id].asString());
+        }
+        BEAST_EXPECT(
+            accounts ==
+            std::vector<std::string>(
+                {"rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                 "r4bYF7SLUMD7QgSLLpgJx38WJSY12ViRjP",
+                 "rLpAd4peHUMBPbVJASMYK5GTBUSwXRD9nx"}));
+
+        // Any number of threads writes the same lines in the same order
+        options.first = 1000;
+        options.last = 1300;
+        std::stringstream one;
+        options.threads = 1;
+        runDerive(seed, one, options);
+        std::stringstream many;
+        options.threads = 4;
+        runDerive(seed, many, options);
+        auto const lines = one.str();
+        BEAST_EXPECT(lines == many.str());
+        BEAST_EXPECT(std::count(lines.begin(), lines.end(), '\n') == 301);
+    }
+
+    void
+    testKeyFiles()
+    {
+        testcase("Key files");
+
+        using namespace boost::filesystem;
+
+        auto const seed = ripple::generateSeed("masterpassphrase");
+        std::string const subdir = "test_derive_key_files";
+        KeyFileGuard g(*this, subdir);
+        DeriveOptions options;
+        options.first = 1;
+        options.last = 2;
+        options.keyDir = subdir;
+        std::stringstream out;
+        runDerive(seed, out, options);
+
+        FamilyGenerator const family(seed);
+        for (std::uint32_t ordinal : {1, 2})
+        {
+            auto const publicKey = family(ordinal).first;
+            auto const keyFile = path(subdir) /
+                (ripple::toBase58(ripple::calcAccountID(publicKey)) +
+                 ".json");
+            auto const key = RippleKey::make_RippleKey(keyFile);
+            BEAST_EXPECT(key.publicKey() == publicKey);
+            BEAST_EXPECT(key.accountIndex() == ordinal);
+        }
+
+        // Existing key files are left alone
+        except<std::runtime_error>(
+            [&] { runDerive(seed, out, options); });
+    }
+
+public:
+    void
+    run() override
+    {
+        testRange();
+        testDerive();
+        testKeyFiles();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Derive, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
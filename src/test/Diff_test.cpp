@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <Diff.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/SField.h>
+#include <algorithm>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Diff_test : public beast::unit_test::suite
+{
+private:
+    static ripple::Blob
+    unhex(std::string const& hex)
+    {
+        return *ripple::strUnHex(hex);
+    }
+
+    // The signed known transaction, with memos holding `data`
+    static std::string
+    withMemos(std::vector<std::string> const& data)
+    {
+        auto jv = parseJson(getKnownTxSigned().JsonText);
+        jv.removeMember("hash");
+        for (auto const& d : data)
+        {
+            Json::Value memo;
+            memo["Memo"]["MemoData"] = d;
+            jv["Memos"].append(memo);
+        }
+        return serialize(*makeObject(jv));
+    }
+
+    void
+    testFields()
+    {
+        testcase("Fields");
+
+        using namespace ripple;
+        using Change = FieldDifference::Change;
+
+        auto const signedTx = unhex(getKnownTxSigned().SerializedText);
+        auto const unsignedTx = unhex(getKnownTxUnsigned().SerializedText);
+
+        BEAST_EXPECT(
+            diffObjects(makeSlice(signedTx), makeSlice(signedTx)).empty());
+
+        auto const differences =
+            diffObjects(makeSlice(signedTx), makeSlice(unsignedTx));
+        if (BEAST_EXPECT(differences.size() == 3))
+        {
+            BEAST_EXPECT(differences[0].field == "SigningPubKey");
+            BEAST_EXPECT(differences[0].change == Change::removed);
+            BEAST_EXPECT(
+                strHex(differences[0].from) ==
+                "0388935426E0D08083314842EDFBB2D517BD47699F9A4527318A8E10468C"
+                "97C052");
+            BEAST_EXPECT(differences[0].to.empty());
+            BEAST_EXPECT(differences[1].field == "TxnSignature");
+            BEAST_EXPECT(differences[1].change == Change::removed);
+            BEAST_EXPECT(differences[2].field == "Account");
+            BEAST_EXPECT(differences[2].change == Change::changed);
+            BEAST_EXPECT(differences[2].from.size() == 20);
+            BEAST_EXPECT(differences[2].to.size() == 20);
+        }
+
+        // The other way around
+        auto const reversed =
+            diffObjects(makeSlice(unsignedTx), makeSlice(signedTx));
+        if (BEAST_EXPECT(reversed.size() == 3))
+        {
+            BEAST_EXPECT(reversed[0].change == Change::added);
+            BEAST_EXPECT(reversed[0].from.empty());
+            BEAST_EXPECT(reversed[0].to == differences[0].from);
+        }
+
+        std::vector<int> ignore{
+            sfSigningPubKey.fieldCode, sfTxnSignature.fieldCode};
+        std::sort(ignore.begin(), ignore.end());
+        auto const ignored =
+            diffObjects(makeSlice(signedTx), makeSlice(unsignedTx), ignore);
+        if (BEAST_EXPECT(ignored.size() == 1))
+            BEAST_EXPECT(ignored[0].field == "Account");
+
+        auto const truncated = Blob(signedTx.begin(), signedTx.end() - 1);
+        except<std::runtime_error>([&] {
+            diffObjects(makeSlice(signedTx), makeSlice(truncated));
+        });
+    }
+
+    void
+    testNested()
+    {
+        testcase("Nested");
+
+        using namespace ripple;
+        using Change = FieldDifference::Change;
+
+        auto const a = unhex(withMemos({"CC"}));
+        auto const b = unhex(withMemos({"DD", "EE"}));
+
+        auto const differences = diffObjects(makeSlice(a), makeSlice(b));
+        if (BEAST_EXPECT(differences.size() == 2))
+        {
+            BEAST_EXPECT(differences[0].field == "Memos[0].Memo.MemoData");
+            BEAST_EXPECT(differences[0].change == Change::changed);
+            BEAST_EXPECT(strHex(differences[0].from) == "CC");
+            BEAST_EXPECT(strHex(differences[0].to) == "DD");
+            BEAST_EXPECT(differences[1].field == "Memos[1].Memo");
+            BEAST_EXPECT(differences[1].change == Change::added);
+            // The memo object's fields
+            BEAST_EXPECT(strHex(differences[1].to) == "7D01EE");
+        }
+
+        auto const none = unhex(withMemos({}));
+        auto const removed = diffObjects(makeSlice(a), makeSlice(none));
+        if (BEAST_EXPECT(removed.size() == 1))
+        {
+            BEAST_EXPECT(removed[0].field == "Memos");
+            BEAST_EXPECT(removed[0].change == Change::removed);
+        }
+    }
+
+    void
+    testStream()
+    {
+        testcase("Stream");
+
+        auto const& signedTx = getKnownTxSigned().SerializedText;
+        auto const& unsignedTx = getKnownTxUnsigned().SerializedText;
+
+        {
+            std::stringstream in;
+            in << signedTx << " " << signedTx << "\n\n"
+               << signedTx << "," << withMemos({"AB"}) << "\n"
+               << "ZZ " << signedTx << "\n"
+               << signedTx << "\n";
+            std::stringstream out;
+            std::stringstream err;
+            DiffOptions options;
+            options.threads = 2;
+            BEAST_EXPECT(runDiff(in, out, err, options) == EXIT_FAILURE);
+            BEAST_EXPECT(
+                out.str() ==
+                "{\"line\":3,\"differences\":[{\"field\":\"Memos\","
+                "\"change\":\"added\",\"to\":\"EA7D01ABE1\"}]}\n"
+                "{\"pairs\":4,\"different\":1,\"failed\":2}\n");
+            BEAST_EXPECT(
+                err.str() ==
+                "Line 4: Invalid hex data\n"
+                "Line 5: Expected two objects\n");
+        }
+
+        {
+            std::stringstream in;
+            for (int i = 0; i < 100; ++i)
+                in << signedTx << " " << unsignedTx << "\n";
+            std::stringstream out;
+            std::stringstream err;
+            DiffOptions options;
+            options.ignore = {"TxnSignature", "SigningPubKey", "Account"};
+            BEAST_EXPECT(runDiff(in, out, err, options) == EXIT_SUCCESS);
+            BEAST_EXPECT(
+                out.str() == "{\"pairs\":100,\"different\":0,\"failed\":0}\n");
+            BEAST_EXPECT(err.str().empty());
+        }
+
+        {
+            std::stringstream in;
+            std::stringstream out;
+            std::stringstream err;
+            DiffOptions options;
+            options.ignore = {"NotAField"};
+            except<std::runtime_error>(
+                [&] { runDiff(in, out, err, options); });
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testFields();
+        testNested();
+        testStream();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Diff, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <FieldScanner.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/SField.h>
+
+namespace offline {
+
+namespace test {
+
+class FieldScanner_test : public beast::unit_test::suite
+{
+private:
+    void
+    testNext()
+    {
+        testcase("Next");
+
+        using namespace ripple;
+
+        for (auto const& hex :
+             {getKnownTxSigned().SerializedText,
+              getKnownMetadata().SerializedText})
+        {
+            auto const blob = *strUnHex(hex);
+            auto const obj = deserialize(hex);
+            BEAST_EXPECT(obj);
+
+            // Every field is visited, in order, and the fields cover
+            // the whole blob
+            FieldScanner scanner(makeSlice(blob));
+            ScannedField f;
+            std::size_t offset = 0;
+            std::size_t i = 0;
+            while (scanner.next(f))
+            {
+                BEAST_EXPECT(i < obj->getCount());
+                if (i >= obj->getCount())
+                    break;
+                BEAST_EXPECT(f.code() == obj->getFName(i).fieldCode);
+                BEAST_EXPECT(f.encoded.data() == blob.data() + offset);
+                offset += f.encoded.size();
+                ++i;
+            }
+            BEAST_EXPECT(i == obj->getCount());
+            BEAST_EXPECT(offset == blob.size());
+        }
+    }
+
+    void
+    testFind()
+    {
+        testcase("Find");
+
+        using namespace ripple;
+
+        auto const blob = *strUnHex(getKnownTxSigned().SerializedText);
+        FieldScanner scanner(makeSlice(blob));
+        ScannedField f;
+        BEAST_EXPECT(scanner.find(sfTransactionType.fieldCode, f));
+        BEAST_EXPECT(scannedUInt(f.value) == ttPAYMENT);
+        BEAST_EXPECT(scanner.find(sfSequence.fieldCode, f));
+        BEAST_EXPECT(scannedUInt(f.value) == 18);
+        // Absent, and the next field is still found after it
+        BEAST_EXPECT(!scanner.find(sfDestinationTag.fieldCode, f));
+        BEAST_EXPECT(scanner.find(sfFee.fieldCode, f));
+        BEAST_EXPECT(strHex(f.value) == "4000000000000064");
+        BEAST_EXPECT(scanner.find(sfSigningPubKey.fieldCode, f));
+        BEAST_EXPECT(
+            strHex(f.value) ==
+            "0388935426E0D08083314842EDFBB2D517BD47699F9A4527318A8E10468C97C0"
+            "52");
+        BEAST_EXPECT(scanner.find(sfAccount.fieldCode, f));
+        BEAST_EXPECT(f.value.size() == 20);
+        // Already passed
+        BEAST_EXPECT(!scanner.find(sfFee.fieldCode, f));
+
+        // Scan inside an array
+        auto const meta = *strUnHex(getKnownMetadata().SerializedText);
+        FieldScanner metaScanner(makeSlice(meta));
+        BEAST_EXPECT(metaScanner.find(sfAffectedNodes.fieldCode, f));
+        FieldScanner nodes(f.value);
+        std::size_t count = 0;
+        while (nodes.next(f))
+            ++count;
+        BEAST_EXPECT(
+            count ==
+            deserialize(getKnownMetadata().SerializedText)
+                ->getFieldArray(sfAffectedNodes)
+                .size());
+    }
+
+    void
+    testMalformed()
+    {
+        testcase("Malformed");
+
+        using namespace ripple;
+
+        auto const blob = *strUnHex(getKnownTxSigned().SerializedText);
+        for (std::size_t size : {1, 2, 10, 70})
+        {
+            except<std::runtime_error>([&] {
+                FieldScanner scanner(Slice(blob.data(), size));
+                ScannedField f;
+                while (scanner.next(f))
+                    ;
+            });
+        }
+        BEAST_EXPECT(scannedUInt(Slice(nullptr, 0)) == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testNext();
+        testFind();
+        testMalformed();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FieldScanner, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
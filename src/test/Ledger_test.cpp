@@ -0,0 +1,553 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <Ledger.h>
+#include <RippleKey.h>
+#include <Serialize.h>
+#include <TreeHash.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/digest.h>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class Ledger_test : public beast::unit_test::suite
+{
+private:
+    static LedgerHeader
+    makeHeader()
+    {
+        LedgerHeader header;
+        header.seq = 28812538;
+        header.drops = 99991094809595385;
+        header.parentHash = ripple::sha512Half(std::string("parent"));
+        header.txHash = ripple::sha512Half(std::string("tx"));
+        header.accountHash = ripple::sha512Half(std::string("state"));
+        header.parentCloseTime = 544044060;
+        header.closeTime = 544044061;
+        header.closeTimeResolution = 10;
+        header.closeFlags = 0;
+        return header;
+    }
+
+    static std::string const&
+    accountRootJson()
+    {
+        static std::string const json = R"({
+            "Account" : "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+            "Balance" : "1000000000",
+            "Flags" : 0,
+            "LedgerEntryType" : "AccountRoot",
+            "OwnerCount" : 0,
+            "PreviousTxnID" : "FC8CB8BFE0BEE91BCC39BBB31827230BEDF273C300EC2F6DB212A31CA9CE7E94",
+            "PreviousTxnLgrSeq" : 28812538,
+            "Sequence" : 1
+        })";
+        return json;
+    }
+
+    static std::string
+    accountRootHex()
+    {
+        return serialize(*makeObject(parseJson(accountRootJson())));
+    }
+
+    void
+    testHeader()
+    {
+        testcase("Header");
+
+        using namespace ripple;
+
+        auto const header = makeHeader();
+        auto const raw = header.serialize();
+        BEAST_EXPECT(raw.size() == LedgerHeader::size);
+
+        auto const check = [&](LedgerHeader const& parsed) {
+            BEAST_EXPECT(parsed.seq == header.seq);
+            BEAST_EXPECT(parsed.drops == header.drops);
+            BEAST_EXPECT(parsed.parentHash == header.parentHash);
+            BEAST_EXPECT(parsed.txHash == header.txHash);
+            BEAST_EXPECT(parsed.accountHash == header.accountHash);
+            BEAST_EXPECT(parsed.parentCloseTime == header.parentCloseTime);
+            BEAST_EXPECT(parsed.closeTime == header.closeTime);
+            BEAST_EXPECT(
+                parsed.closeTimeResolution == header.closeTimeResolution);
+            BEAST_EXPECT(parsed.closeFlags == header.closeFlags);
+            BEAST_EXPECT(parsed.serialize() == raw);
+        };
+        check(LedgerHeader::fromSlice(makeSlice(raw)));
+
+        // With the hash prefix, as stored by rippled
+        Serializer prefixed;
+        prefixed.add32(HashPrefix::ledgerMaster);
+        prefixed.addRaw(raw);
+        check(LedgerHeader::fromSlice(prefixed.slice()));
+
+        // The hash covers exactly the prefixed serialization
+        BEAST_EXPECT(
+            header.hash() == sha512Half(makeSlice(prefixed.peekData())));
+
+        try
+        {
+            LedgerHeader::fromSlice(Slice(raw.data(), raw.size() - 1));
+            fail("Short header accepted");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                std::string(e.what()) ==
+                "A ledger header is 118 bytes, not 117");
+        }
+
+        auto const jv = header.getJson();
+        BEAST_EXPECT(jv["ledger_index"].asUInt() == header.seq);
+        BEAST_EXPECT(jv["ledger_hash"].asString() == to_string(header.hash()));
+        BEAST_EXPECT(jv["total_coins"].asString() == "99991094809595385");
+        BEAST_EXPECT(jv["close_time_resolution"].asUInt() == 10);
+
+        // A header decodes from hex like any other blob type
+        BEAST_EXPECT(decode(strHex(raw), BlobType::ledgerHeader) == jv);
+    }
+
+    void
+    testTypedDecode()
+    {
+        testcase("Typed decode");
+
+        using namespace ripple;
+
+        auto const& tx = getKnownTxSigned();
+        auto const& meta = getKnownMetadata();
+
+        BEAST_EXPECT(parseBlobType("ledger-entry") == BlobType::ledgerEntry);
+        except<std::runtime_error>([] { parseBlobType("ledger"); });
+
+        // Transactions include their hash
+        BEAST_EXPECT(
+            decode(tx.SerializedText, BlobType::tx) == parseJson(tx.JsonText));
+        BEAST_EXPECT(
+            decode(meta.SerializedText, BlobType::meta) ==
+            parseJson(meta.JsonText));
+        BEAST_EXPECT(
+            decode(accountRootHex(), BlobType::ledgerEntry) ==
+            parseJson(accountRootJson()));
+
+        auto const rejects = [&](std::string const& hex, BlobType type) {
+            try
+            {
+                decode(hex, type);
+                return false;
+            }
+            catch (std::exception const&)
+            {
+                return true;
+            }
+        };
+        // Wrong types
+        BEAST_EXPECT(rejects(meta.SerializedText, BlobType::tx));
+        BEAST_EXPECT(rejects(tx.SerializedText, BlobType::meta));
+        BEAST_EXPECT(rejects(tx.SerializedText, BlobType::ledgerEntry));
+        BEAST_EXPECT(rejects(tx.SerializedText, BlobType::ledgerHeader));
+        // Trailing data
+        BEAST_EXPECT(rejects(meta.SerializedText + "00", BlobType::meta));
+        BEAST_EXPECT(rejects(accountRootHex() + "00", BlobType::ledgerEntry));
+        // Missing a required field
+        {
+            auto json = parseJson(accountRootJson());
+            json.removeMember("Balance");
+            BEAST_EXPECT(rejects(
+                serialize(*makeObject(json)), BlobType::ledgerEntry));
+        }
+        BEAST_EXPECT(rejects("Hello, world!", BlobType::tx));
+        BEAST_EXPECT(rejects("", BlobType::meta));
+    }
+
+    void
+    testDump()
+    {
+        testcase("Dump");
+
+        using namespace ripple;
+
+        auto const header = makeHeader();
+        auto const& tx = getKnownTxSigned();
+        auto const& meta = getKnownMetadata();
+        auto const index = to_string(sha512Half(std::string("index")));
+
+        Json::Value ledger(Json::objectValue);
+        ledger["ledger_data"] = strHex(header.serialize());
+        Json::Value txEntry(Json::objectValue);
+        txEntry["tx_blob"] = tx.SerializedText;
+        txEntry["meta"] = meta.SerializedText;
+        Json::Value stateEntry(Json::objectValue);
+        stateEntry["data"] = accountRootHex();
+        stateEntry["index"] = index;
+        for (int i = 0; i < 50; ++i)
+        {
+            ledger["transactions"].append(txEntry);
+            ledger["accountState"].append(stateEntry);
+        }
+        Json::Value result(Json::objectValue);
+        result["result"]["ledger"] = ledger;
+
+        auto const dump = LedgerDump::fromJson(result);
+        BEAST_EXPECT(dump.header && dump.header->hash() == header.hash());
+        BEAST_EXPECT(dump.transactions.size() == 50);
+        BEAST_EXPECT(dump.state.size() == 50);
+
+        auto const decoded = decodeLedgerDump(dump, 4);
+        BEAST_EXPECT(
+            decoded["ledger_hash"].asString() == to_string(header.hash()));
+        auto expectedTx = parseJson(tx.JsonText);
+        expectedTx["metaData"] = parseJson(meta.JsonText);
+        auto expectedState = parseJson(accountRootJson());
+        expectedState["index"] = index;
+        if (BEAST_EXPECT(
+                decoded["transactions"].size() == 50 &&
+                decoded["accountState"].size() == 50))
+        {
+            for (Json::UInt i = 0; i < 50; ++i)
+            {
+                BEAST_EXPECT(decoded["transactions"][i] == expectedTx);
+                BEAST_EXPECT(decoded["accountState"][i] == expectedState);
+            }
+        }
+
+        // A ledger_data result has no header
+        {
+            Json::Value data(Json::objectValue);
+            data["state"].append(stateEntry);
+            auto const dataDump = LedgerDump::fromJson(data);
+            BEAST_EXPECT(!dataDump.header);
+            auto const jv = decodeLedgerDump(dataDump, 1);
+            BEAST_EXPECT(!jv.isMember("ledger_hash"));
+            BEAST_EXPECT(jv["accountState"][0u] == expectedState);
+        }
+
+        // Results that were not requested as binary and expanded
+        {
+            Json::Value notBinary(Json::objectValue);
+            notBinary["ledger"]["ledger_index"] = 5;
+            except<std::runtime_error>(
+                [&] { LedgerDump::fromJson(notBinary); });
+
+            auto notExpanded = ledger;
+            notExpanded["transactions"][0u] = "ABCD";
+            Json::Value jv(Json::objectValue);
+            jv["ledger"] = notExpanded;
+            except<std::runtime_error>([&] { LedgerDump::fromJson(jv); });
+        }
+
+        // One result per line, with a failure in the middle
+        {
+            std::stringstream in;
+            in << Json::Compact{Json::Value(result)} << "\n"
+               << R"({"result":{"error":"lgrNotFound"}})"
+               << "\n"
+               << Json::Compact{Json::Value(result)} << "\n";
+            std::stringstream out;
+            std::stringstream err;
+            BEAST_EXPECT(
+                runDeserializeLedger(in, out, err, 2) == EXIT_FAILURE);
+            BEAST_EXPECTS(
+                err.str() == "Document 2: Result is an error: lgrNotFound\n",
+                err.str());
+            std::string line;
+            std::vector<std::string> lines;
+            while (std::getline(out, line))
+                lines.push_back(line);
+            if (BEAST_EXPECT(lines.size() == 3))
+            {
+                BEAST_EXPECT(parseJson(lines[0]) == decoded);
+                BEAST_EXPECT(lines[1].empty());
+                BEAST_EXPECT(lines[2] == lines[0]);
+            }
+        }
+
+        // One result spanning lines
+        {
+            std::stringstream in(result.toStyledString());
+            std::uint64_t count = 0;
+            forEachJsonDocument(in, [&](std::uint64_t n, Json::Value const&) {
+                count = n;
+            });
+            BEAST_EXPECT(count == 1);
+
+            std::stringstream out;
+            std::stringstream err;
+            in.clear();
+            in.seekg(0);
+            BEAST_EXPECT(
+                runDeserializeLedger(in, out, err, 2) == EXIT_SUCCESS);
+            BEAST_EXPECT(parseJson(out.str()) == decoded);
+        }
+
+        // One result per line is handled before the next line is read. A
+        // line that is not JSON fails alone.
+        {
+            auto const line = toCompactJson(Json::Value(result)) + "\n";
+            auto const text = line + "\n" + line + "Hello, world!\n" + line;
+            std::stringstream in(text);
+            std::vector<std::streamoff> read;
+            std::vector<bool> objects;
+            forEachJsonDocument(
+                in, [&](std::uint64_t n, Json::Value const& jv) {
+                    BEAST_EXPECT(n == read.size() + 1);
+                    read.push_back(in.tellg());
+                    objects.push_back(jv.isObject());
+                });
+            if (BEAST_EXPECT(read.size() == 4))
+            {
+                BEAST_EXPECT(read[0] == std::streamoff(line.size()));
+                BEAST_EXPECT(read[1] == std::streamoff(line.size() * 2 + 1));
+                BEAST_EXPECT(
+                    objects == std::vector<bool>({true, true, false, true}));
+            }
+        }
+
+        // A bad document per line does not end the stream
+        {
+            std::stringstream in(
+                toCompactJson(Json::Value(result)) + "\n[1, 2]\n" +
+                toCompactJson(Json::Value(result)) + "\n");
+            std::stringstream out;
+            std::stringstream err;
+            BEAST_EXPECT(
+                runDeserializeLedger(in, out, err, 2) == EXIT_FAILURE);
+            BEAST_EXPECTS(
+                err.str() == "Document 2: Not a JSON object\n", err.str());
+        }
+    }
+
+    void
+    testVerifyTxs()
+    {
+        testcase("Verify transactions");
+
+        using namespace ripple;
+
+        auto const key = RippleKey::make_RippleKey(
+            KeyType::secp256k1, std::string("masterpassphrase"));
+        auto const meta = *strUnHex(getKnownMetadata().SerializedText);
+
+        LedgerDump dump;
+        std::vector<TreeLeaf> leaves;
+        for (int i = 0; i < 40; ++i)
+        {
+            auto json = parseJson(getKnownTxUnsigned().JsonText);
+            json["Sequence"] = i + 1;
+            std::optional<STTx> tx = make_sttx(toCompactJson(std::move(json)));
+            key.singleSign(tx);
+            auto blob = tx->getSerializer().peekData();
+            auto const id = tx->getTransactionID();
+            auto const hash =
+                transactionLeafHash(makeSlice(blob), makeSlice(meta), id);
+            leaves.push_back({id, hash});
+            dump.transactions.emplace_back(std::move(blob), meta);
+        }
+        auto header = makeHeader();
+        header.txHash = treeRoot(leaves, 1);
+        dump.header = header;
+
+        {
+            auto const jv = verifyLedgerTxs(dump, 4);
+            BEAST_EXPECT(jv["verified"].asBool());
+            BEAST_EXPECT(jv["transactions"].asUInt() == 40);
+            BEAST_EXPECT(jv["failures"].size() == 0);
+            BEAST_EXPECT(
+                jv["computed_transaction_hash"] == jv["transaction_hash"]);
+        }
+
+        // Metadata is part of the tree
+        {
+            auto changed = dump;
+            changed.transactions[7].second.back() ^= 1;
+            auto const jv = verifyLedgerTxs(changed, 4);
+            BEAST_EXPECT(!jv["verified"].asBool());
+            BEAST_EXPECT(jv["failures"].size() == 0);
+            BEAST_EXPECT(
+                jv["computed_transaction_hash"] != jv["transaction_hash"]);
+        }
+
+        // A transaction changed after signing
+        {
+            auto changed = dump;
+            SerialIter sit{makeSlice(changed.transactions[3].first)};
+            STTx tx{sit};
+            tx.setFieldAmount(sfFee, STAmount{XRPAmount{999}});
+            changed.transactions[3].first = tx.getSerializer().peekData();
+            // Keep the tree consistent, so only the signature fails
+            leaves[3] = {
+                tx.getTransactionID(),
+                transactionLeafHash(
+                    makeSlice(changed.transactions[3].first),
+                    makeSlice(meta),
+                    tx.getTransactionID())};
+            changed.header->txHash = treeRoot(leaves, 1);
+
+            auto const jv = verifyLedgerTxs(changed, 4);
+            BEAST_EXPECT(!jv["verified"].asBool());
+            BEAST_EXPECT(
+                jv["computed_transaction_hash"] == jv["transaction_hash"]);
+            if (BEAST_EXPECT(jv["failures"].size() == 1))
+            {
+                auto const& failure = jv["failures"][0u];
+                BEAST_EXPECT(failure["index"].asUInt() == 3);
+                BEAST_EXPECT(
+                    failure["hash"].asString() ==
+                    to_string(tx.getTransactionID()));
+            }
+        }
+
+        // A dump without a header can't be verified
+        {
+            auto headless = dump;
+            headless.header.reset();
+            except<std::runtime_error>(
+                [&] { verifyLedgerTxs(headless, 1); });
+        }
+
+        // A range of ledgers, one dump per line, is verified and written
+        // in order
+        {
+            auto const line = [&](std::uint32_t seq, bool good) {
+                auto h = *dump.header;
+                h.seq = seq;
+                if (!good)
+                    h.txHash = ~h.txHash;
+                Json::Value ledger(Json::objectValue);
+                ledger["ledger_data"] = strHex(h.serialize());
+                auto& txs = ledger["transactions"] = Json::arrayValue;
+                for (auto const& [tx, m] : dump.transactions)
+                {
+                    Json::Value entry(Json::objectValue);
+                    entry["tx_blob"] = strHex(tx);
+                    entry["meta"] = strHex(m);
+                    txs.append(std::move(entry));
+                }
+                Json::Value result(Json::objectValue);
+                result["result"]["ledger"] = std::move(ledger);
+                return toCompactJson(std::move(result)) + "\n";
+            };
+            std::stringstream in(
+                line(100, true) + line(101, false) + line(102, true));
+            std::stringstream out;
+            std::stringstream err;
+            BEAST_EXPECT(runVerifyLedgerTxs(in, out, err, 4) == EXIT_FAILURE);
+            BEAST_EXPECT(err.str().empty());
+            std::string text;
+            std::vector<Json::Value> results;
+            while (std::getline(out, text))
+                results.push_back(parseJson(text));
+            if (BEAST_EXPECT(results.size() == 3))
+            {
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    BEAST_EXPECT(
+                        results[i]["ledger_index"].asUInt() == 100 + i);
+                    BEAST_EXPECT(results[i]["transactions"].asUInt() == 40);
+                    BEAST_EXPECT(results[i]["verified"].asBool() == (i != 1));
+                }
+            }
+        }
+    }
+
+    void
+    testKnownHeader()
+    {
+        testcase("Known header");
+
+        using namespace ripple;
+
+        // Computed independently of rippled and of this tool. The
+        // transaction tree holds the known signed and unsigned
+        // transactions, each with the known metadata.
+        std::string const raw =
+            "01B7A4FA01633D5EF6D40DF9FC8CB8BFE0BEE91BCC39BBB31827230BEDF273C3"
+            "00EC2F6DB212A31CA9CE7E9477CA592FF26101F98C13876E2A526470824B1CEF"
+            "630E68544C8A29BF1113660D51FF5D4B550EE8660FBBAE6FB991525F2397EFC3"
+            "93F67793C12560665FAA2413206D741C206D741D0A00";
+        auto const header = LedgerHeader::fromSlice(makeSlice(*strUnHex(raw)));
+        BEAST_EXPECT(header.seq == 28812538);
+        BEAST_EXPECT(header.drops == 99991094809595385);
+        BEAST_EXPECT(
+            to_string(header.parentHash) ==
+            "FC8CB8BFE0BEE91BCC39BBB31827230BEDF273C300EC2F6DB212A31CA9CE7E94");
+        BEAST_EXPECT(
+            to_string(header.txHash) ==
+            "77CA592FF26101F98C13876E2A526470824B1CEF630E68544C8A29BF1113660D");
+        BEAST_EXPECT(
+            to_string(header.accountHash) ==
+            "51FF5D4B550EE8660FBBAE6FB991525F2397EFC393F67793C12560665FAA2413");
+        BEAST_EXPECT(header.parentCloseTime == 544044060);
+        BEAST_EXPECT(header.closeTime == 544044061);
+        BEAST_EXPECT(header.closeTimeResolution == 10);
+        BEAST_EXPECT(header.closeFlags == 0);
+        BEAST_EXPECT(
+            to_string(header.hash()) ==
+            "813B84545D1A130F8608F7952CBBDE50325CE93ED729411EE7C2AB68370D5CC3");
+
+        auto const meta = *strUnHex(getKnownMetadata().SerializedText);
+        LedgerDump dump;
+        dump.header = header;
+        dump.transactions.emplace_back(
+            *strUnHex(getKnownTxSigned().SerializedText), meta);
+        dump.transactions.emplace_back(
+            *strUnHex(getKnownTxUnsigned().SerializedText), meta);
+        auto const jv = verifyLedgerTxs(dump, 2);
+        BEAST_EXPECT(jv["ledger_hash"].asString() == to_string(header.hash()));
+        BEAST_EXPECT(
+            jv["computed_transaction_hash"] == jv["transaction_hash"]);
+        // The unsigned transaction fails its signature check
+        BEAST_EXPECT(!jv["verified"].asBool());
+        if (BEAST_EXPECT(jv["failures"].size() != 0))
+        {
+            auto const& last = jv["failures"][jv["failures"].size() - 1];
+            BEAST_EXPECT(last["index"].asUInt() == 1);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testHeader();
+        testTypedDecode();
+        testDump();
+        testVerifyTxs();
+        testKnownHeader();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Ledger, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,187 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <test/KeyFileGuard.h>
+#include <test/KnownTestData.h>
+
+#include <Batch.h>
+#include <Metrics.h>
+#include <RippleKey.h>
+
+#include <ripple/beast/unit_test.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace offline {
+
+namespace test {
+
+class Metrics_test : public beast::unit_test::suite
+{
+private:
+    static bool
+    contains(std::string const& text, std::string const& line)
+    {
+        return text.find("\n" + line + "\n") != std::string::npos;
+    }
+
+    std::string
+    written()
+    {
+        std::stringstream ss;
+        metrics::write(ss);
+        return ss.str();
+    }
+
+    void
+    testCounters()
+    {
+        testcase("Counters");
+
+        using namespace std::chrono_literals;
+
+        metrics::enable();
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([] {
+                for (int j = 0; j < 1000; ++j)
+                {
+                    metrics::recordResult(metrics::Command::sign, j % 10);
+                    metrics::addBytesIn(3);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        metrics::recordSignLatency(ripple::KeyType::ed25519, 40us);
+        metrics::recordSignLatency(ripple::KeyType::ed25519, 300us);
+        metrics::recordSignLatency(ripple::KeyType::ed25519, 1s);
+        metrics::setQueueDepth(metrics::Queue::input, 7);
+
+        auto const text = written();
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_records_total{command="sign",result="success"} 7200)"));
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_records_total{command="sign",result="failure"} 800)"));
+        BEAST_EXPECT(contains(text, "offline_input_bytes_total 24000"));
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_sign_duration_seconds_bucket{key_type="ed25519",)"
+            R"(le="0.000050000"} 1)"));
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_sign_duration_seconds_bucket{key_type="ed25519",)"
+            R"(le="0.000500000"} 2)"));
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_sign_duration_seconds_bucket{key_type="ed25519",)"
+            R"(le="+Inf"} 3)"));
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_sign_duration_seconds_sum{key_type="ed25519"} )"
+            "1.000340000"));
+        BEAST_EXPECT(contains(
+            text,
+            R"(offline_sign_duration_seconds_count{key_type="secp256k1"} 0)"));
+        BEAST_EXPECT(contains(text, R"(offline_queue_depth{queue="input"} 7)"));
+
+        // Re-enabling resets everything
+        metrics::enable();
+        BEAST_EXPECT(contains(
+            written(),
+            R"(offline_records_total{command="sign",result="success"} 0)"));
+        metrics::disable();
+    }
+
+    void
+    testBatch()
+    {
+        testcase("Batch");
+
+        using namespace boost::filesystem;
+
+        std::string const subdir = "test_key_file";
+        KeyFileGuard g(*this, subdir);
+        path const keyFile = subdir / ".ripple" / "secret-key.txt";
+
+        RippleKey const key{ripple::KeyType::secp256k1};
+        key.writeToFile(keyFile);
+
+        auto const& unsignedTx = getKnownTxUnsigned();
+        std::stringstream in;
+        for (int i = 0; i < 5; ++i)
+            in << unsignedTx.SerializedText << "\n";
+        in << "Hello, world!\n";
+
+        metrics::enable();
+        {
+            metrics::Reporter const reporter(
+                subdir / "metrics.prom", std::chrono::hours(1));
+
+            std::stringstream out;
+            std::stringstream err;
+            runBatch("sign", in, out, err, keyFile, {});
+        }
+        metrics::disable();
+
+        std::ifstream file((subdir / "metrics.prom").string());
+        std::stringstream text;
+        text << file.rdbuf();
+        BEAST_EXPECT(!exists(subdir / "metrics.prom.tmp"));
+        BEAST_EXPECT(contains(
+            text.str(),
+            R"(offline_records_total{command="sign",result="success"} 5)"));
+        BEAST_EXPECT(contains(
+            text.str(),
+            R"(offline_records_total{command="sign",result="failure"} 1)"));
+        BEAST_EXPECT(contains(
+            text.str(),
+            R"(offline_sign_duration_seconds_count{key_type="secp256k1"} 5)"));
+        BEAST_EXPECT(contains(
+            text.str(),
+            "offline_input_bytes_total " +
+                std::to_string(5 * (unsignedTx.SerializedText.size() + 1) +
+                               14)));
+#ifndef _WIN32
+        BEAST_EXPECT(metrics::peakRss() > 0);
+#endif
+    }
+
+public:
+    void
+    run() override
+    {
+        testCounters();
+        testBatch();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Metrics, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
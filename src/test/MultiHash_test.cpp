@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <MultiHash.h>
+#include <Serialize.h>
+#include <TreeHash.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/digest.h>
+#include <random>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class MultiHash_test : public beast::unit_test::suite
+{
+private:
+    static std::uint32_t
+    txPrefix()
+    {
+        return static_cast<std::uint32_t>(
+            ripple::HashPrefix::transactionID);
+    }
+
+    void
+    testKernels()
+    {
+        testcase("Kernels");
+
+        using namespace ripple;
+
+        // Every length around the one and two block boundaries, and
+        // some longer ones
+        std::mt19937 rng(7);
+        std::vector<Blob> blobs;
+        for (std::size_t size = 0; size < 300; ++size)
+            blobs.emplace_back(size);
+        for (std::size_t size : {1000, 4093, 10000})
+            blobs.emplace_back(size);
+        for (auto& blob : blobs)
+            for (auto& b : blob)
+                b = static_cast<std::uint8_t>(rng());
+        auto const key = sha512Half(std::string("key"));
+
+        std::vector<HashInput> inputs;
+        std::vector<uint256> expected;
+        for (std::size_t i = 0; i < blobs.size(); ++i)
+        {
+            HashInput input{
+                txPrefix() + static_cast<std::uint32_t>(i),
+                makeSlice(blobs[i]),
+                {}};
+            if (i % 3 == 0)
+                input.suffix = Slice(key.data(), key.size());
+            inputs.push_back(input);
+            expected.push_back(
+                sha512Half(input.prefix, input.data, input.suffix));
+        }
+
+        for (auto const kernel :
+             {HashKernel::scalar, HashKernel::avx2, HashKernel::avx512})
+        {
+            if (!supported(kernel))
+            {
+                log << to_string(kernel) << " is not supported here"
+                    << std::endl;
+                except<std::logic_error>([&] {
+                    sha512HalfMany(
+                        inputs.data(), 1, expected.data(), kernel);
+                });
+                continue;
+            }
+            for (std::size_t count : {0, 1, 2, 5, 9, 17, 305})
+            {
+                std::vector<uint256> out(count);
+                sha512HalfMany(inputs.data(), count, out.data(), kernel);
+                BEAST_EXPECTS(
+                    std::equal(out.begin(), out.end(), expected.begin()),
+                    std::string(to_string(kernel)) + " over " +
+                        std::to_string(count));
+            }
+        }
+        BEAST_EXPECT(supported(bestHashKernel()));
+    }
+
+    void
+    testTransactionID()
+    {
+        testcase("Transaction ID");
+
+        using namespace ripple;
+
+        auto const tx = *strUnHex(getKnownTxSigned().SerializedText);
+        std::vector<HashInput> const inputs(
+            10, HashInput{txPrefix(), makeSlice(tx), {}});
+        std::vector<uint256> ids(inputs.size());
+        sha512HalfMany(inputs.data(), inputs.size(), ids.data());
+        for (auto const& id : ids)
+            BEAST_EXPECT(id == transactionID(makeSlice(tx)));
+    }
+
+    void
+    testRunHash()
+    {
+        testcase("Run hash");
+
+        auto const& known = getKnownTxSigned();
+        auto const id = ripple::to_string(
+            transactionID(ripple::makeSlice(*ripple::strUnHex(
+                known.SerializedText))));
+        BEAST_EXPECT(id == parseJson(known.JsonText)["hash"].asString());
+
+        std::stringstream in;
+        for (int i = 0; i < 100; ++i)
+            in << known.SerializedText << "\n";
+        in << "\n"
+           << "XYZ\n"
+           << known.SerializedText << "\n";
+        std::stringstream out;
+        std::stringstream err;
+        BEAST_EXPECT(runHash(in, out, err, 4) == EXIT_FAILURE);
+        std::string expected;
+        for (int i = 0; i < 100; ++i)
+            expected += id + "\n";
+        expected += "\n" + id + "\n";
+        BEAST_EXPECT(out.str() == expected);
+        BEAST_EXPECT(err.str() == "Line 102: Invalid hex data\n");
+    }
+
+public:
+    void
+    run() override
+    {
+        testKernels();
+        testTransactionID();
+        testRunHash();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MultiHash, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,305 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <OutputFormat.h>
+#include <Serialize.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+
+namespace offline {
+
+namespace test {
+
+class OutputFormat_test : public beast::unit_test::suite
+{
+private:
+    /** Decodes MessagePack or CBOR to JSON-like text, with byte strings
+        as 0x prefixed hex.
+    */
+    class Dump
+    {
+    private:
+        OutputFormat const format_;
+        std::string const& data_;
+        std::size_t pos_ = 0;
+
+        std::uint64_t
+        bigEndian(unsigned width)
+        {
+            std::uint64_t value = 0;
+            for (unsigned i = 0; i < width; ++i)
+                value = (value << 8) |
+                    static_cast<std::uint8_t>(data_.at(pos_++));
+            return value;
+        }
+
+        std::string
+        items(std::uint64_t count, bool map)
+        {
+            std::string text = map ? "{" : "[";
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                text += i ? "," : "";
+                text += value();
+                if (map)
+                    text += ":" + value();
+            }
+            return text + (map ? "}" : "]");
+        }
+
+        std::string
+        chunk(std::uint64_t size, bool isText)
+        {
+            auto const bytes = data_.substr(pos_, size);
+            pos_ += size;
+            return isText ? "\"" + bytes + "\"" : "0x" + ripple::strHex(bytes);
+        }
+
+        std::string
+        cbor()
+        {
+            auto const initial = static_cast<std::uint8_t>(data_.at(pos_++));
+            if (initial == 0xF6)
+                return "null";
+            auto const info = initial & 0x1F;
+            auto const arg = info < 24 ? info : bigEndian(1 << (info - 24));
+            switch (initial >> 5)
+            {
+                case 0:
+                    return std::to_string(arg);
+                case 1:
+                    return "-" + std::to_string(arg + 1);
+                case 2:
+                    return chunk(arg, false);
+                case 3:
+                    return chunk(arg, true);
+                case 4:
+                    return items(arg, false);
+                case 5:
+                    return items(arg, true);
+            }
+            return "?";
+        }
+
+        std::string
+        msgpack()
+        {
+            auto const b = static_cast<std::uint8_t>(data_.at(pos_++));
+            if (b < 0x80)
+                return std::to_string(b);
+            if (b >= 0xE0)
+                return std::to_string(static_cast<std::int8_t>(b));
+            if (b <= 0x8F)
+                return items(b & 0x0F, true);
+            if (b <= 0x9F)
+                return items(b & 0x0F, false);
+            if (b <= 0xBF)
+                return chunk(b & 0x1F, true);
+            switch (b)
+            {
+                case 0xC0:
+                    return "null";
+                case 0xC4:
+                case 0xC5:
+                case 0xC6:
+                    return chunk(bigEndian(1 << (b - 0xC4)), false);
+                case 0xCC:
+                case 0xCD:
+                case 0xCE:
+                case 0xCF:
+                    return std::to_string(bigEndian(1 << (b - 0xCC)));
+                case 0xD0:
+                case 0xD1:
+                case 0xD2:
+                case 0xD3: {
+                    auto const width = 1u << (b - 0xD0);
+                    auto value = bigEndian(width);
+                    if (width < 8)
+                        value |= ~std::uint64_t{0} << (width * 8);
+                    return std::to_string(static_cast<std::int64_t>(value));
+                }
+                case 0xD9:
+                case 0xDA:
+                case 0xDB:
+                    return chunk(bigEndian(1 << (b - 0xD9)), true);
+                case 0xDC:
+                case 0xDD:
+                    return items(bigEndian(2 << (b - 0xDC)), false);
+                case 0xDE:
+                case 0xDF:
+                    return items(bigEndian(2 << (b - 0xDE)), true);
+            }
+            return "?";
+        }
+
+    public:
+        Dump(OutputFormat format, std::string const& data)
+            : format_(format), data_(data)
+        {
+        }
+
+        std::string
+        value()
+        {
+            return format_ == OutputFormat::cbor ? cbor() : msgpack();
+        }
+
+        bool
+        done() const
+        {
+            return pos_ == data_.size();
+        }
+    };
+
+    static std::string
+    dump(OutputFormat format, std::string const& data)
+    {
+        Dump d(format, data);
+        auto text = d.value();
+        if (!d.done())
+            text += " and trailing data";
+        return text;
+    }
+
+    void
+    testEncoding()
+    {
+        testcase("Encoding");
+
+        // A lone field, byte for byte
+        auto const sequence = *deserialize("2400000012");
+        BEAST_EXPECT(
+            encodeObject(sequence, OutputFormat::msgpack) ==
+            "\x81\xA8Sequence\x12");
+        BEAST_EXPECT(
+            encodeObject(sequence, OutputFormat::cbor) ==
+            "\xA1\x68Sequence\x12");
+
+        auto const object = *deserialize(serialize(*makeObject(parseJson(R"({
+            "Account" : "rG1QQv2nh2gr7RCZ1P8YYcBUKCCN633jCn",
+            "Amount" : {
+                "currency" : "USD",
+                "issuer" : "rhub8VRN55s94qWKDv6jmDy1pUykJzF3wq",
+                "value" : "-1.5"
+            },
+            "Fee" : "100",
+            "Memos" : [{"Memo" : {"MemoData" : "ABCD"}}],
+            "Sequence" : 70000,
+            "TransactionType" : "Payment"
+        })"))));
+        std::string const expected =
+            R"({"TransactionType":"Payment","Sequence":70000,)"
+            R"("Amount":{"value":-1500000000000000,"exponent":-15,)"
+            R"("currency":0x0000000000000000000000005553440000000000,)"
+            R"("issuer":0x2ADB0B3959D60A6E6991F729E1918B7163925230},)"
+            R"("Fee":100,"Account":0xAE123A8556F3CF91154711376AFB0F894F832B3D,)"
+            R"("Memos":[{"Memo":{"MemoData":0xABCD}}]})";
+        for (auto const format : {OutputFormat::msgpack, OutputFormat::cbor})
+        {
+            auto const text = dump(format, encodeObject(object, format));
+            BEAST_EXPECTS(text == expected, text);
+        }
+
+        BEAST_EXPECT(encodeNull(OutputFormat::msgpack) == "\xC0");
+        BEAST_EXPECT(encodeNull(OutputFormat::cbor) == "\xF6");
+        except<std::logic_error>(
+            [&] { encodeObject(object, OutputFormat::json); });
+    }
+
+    void
+    testDecode()
+    {
+        testcase("Decode");
+
+        auto const& tx = getKnownTxSigned();
+        std::string const txHash =
+            "F2D008D2AABBABD2A882F9049AA873210908EC3EA1EB0A2044A66093C7ACD2B1";
+        auto const msgpack = dump(
+            OutputFormat::msgpack,
+            decodeAs(tx.SerializedText, BlobType::tx, OutputFormat::msgpack));
+        auto const cbor = dump(
+            OutputFormat::cbor,
+            decodeAs(tx.SerializedText, BlobType::generic, OutputFormat::cbor));
+        // Only transactions get their hash
+        auto const hash = R"(,"hash":0x)" + txHash + "}";
+        BEAST_EXPECTS(
+            msgpack == cbor.substr(0, cbor.size() - 1) + hash, msgpack);
+        BEAST_EXPECT(
+            msgpack.find(R"("SendMax":{"value":5678900000000000,)") !=
+            std::string::npos);
+
+        auto const meta = dump(
+            OutputFormat::cbor,
+            decodeAs(
+                getKnownMetadata().SerializedText,
+                BlobType::meta,
+                OutputFormat::cbor));
+        BEAST_EXPECTS(
+            meta.find(R"("TransactionResult":"tesSUCCESS")") !=
+                std::string::npos,
+            meta);
+
+        except<std::runtime_error>([&] {
+            decodeAs("Hello, world!", BlobType::generic, OutputFormat::cbor);
+        });
+        except<std::runtime_error>([&] {
+            decodeAs(
+                getKnownMetadata().SerializedText,
+                BlobType::tx,
+                OutputFormat::cbor);
+        });
+        except<std::runtime_error>([&] {
+            decodeAs(
+                ripple::strHex(std::string(118, '\0')),
+                BlobType::ledgerHeader,
+                OutputFormat::cbor);
+        });
+    }
+
+    void
+    testParse()
+    {
+        testcase("Parse");
+
+        BEAST_EXPECT(parseOutputFormat("json") == OutputFormat::json);
+        BEAST_EXPECT(parseOutputFormat("msgpack") == OutputFormat::msgpack);
+        BEAST_EXPECT(parseOutputFormat("cbor") == OutputFormat::cbor);
+        except<std::runtime_error>([] { parseOutputFormat("xml"); });
+    }
+
+public:
+    void
+    run() override
+    {
+        testEncoding();
+        testDecode();
+        testParse();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OutputFormat, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
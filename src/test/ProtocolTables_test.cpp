@@ -0,0 +1,183 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <PerfectHash.h>
+#include <ProtocolTables.h>
+#include <Serialize.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/TER.h>
+#include <ripple/protocol/TxFormats.h>
+#include <string>
+
+namespace offline {
+
+namespace test {
+
+class ProtocolTables_test : public beast::unit_test::suite
+{
+private:
+    void
+    testPerfectHash()
+    {
+        testcase("Perfect hash");
+
+        constexpr std::array<std::string_view, 5> names{
+            "Account", "Amount", "Fee", "", "Flags"};
+        constexpr PerfectHash<names.size()> table(names);
+        static_assert(table.find("Fee") == 2);
+        for (std::size_t i = 0; i < names.size(); ++i)
+            BEAST_EXPECT(table.find(names[i]) == i);
+        for (auto const other : {"account", "Amoun", "Fees", "Sequence"})
+            BEAST_EXPECT(table.find(other) == names.size());
+
+        except<std::logic_error>([] {
+            PerfectHash<3> const duplicate({"Fee", "Flags", "Fee"});
+        });
+    }
+
+    void
+    testFields()
+    {
+        testcase("Fields");
+
+        using namespace ripple;
+
+        for (auto const name : knownFieldNames())
+        {
+            auto const& field = SField::getField(std::string(name));
+            BEAST_EXPECTS(
+                &fieldByName(name) == &field && field.getName() == name,
+                std::string(name));
+        }
+        // Left to the library
+        BEAST_EXPECT(&fieldByName("Nope") == &sfInvalid);
+        BEAST_EXPECT(&fieldByName("Generic") == &SField::getField("Generic"));
+    }
+
+    void
+    testTypes()
+    {
+        testcase("Types");
+
+        using namespace ripple;
+
+        for (auto const name : knownTxTypeNames())
+        {
+            auto const type = txTypeByName(name);
+            BEAST_EXPECTS(
+                type &&
+                    *type ==
+                        TxFormats::getInstance().findTypeByName(
+                            std::string(name)) &&
+                    txTypeName(*type) == name,
+                std::string(name));
+        }
+        for (auto const& item : TxFormats::getInstance())
+        {
+            auto const name = txTypeName(item.getType());
+            BEAST_EXPECT(!name || *name == item.getName());
+        }
+
+        for (auto const name : knownLedgerEntryTypeNames())
+        {
+            auto const type = ledgerEntryTypeByName(name);
+            BEAST_EXPECTS(
+                type &&
+                    *type ==
+                        LedgerFormats::getInstance().findTypeByName(
+                            std::string(name)) &&
+                    ledgerEntryTypeName(*type) == name,
+                std::string(name));
+        }
+        for (auto const& item : LedgerFormats::getInstance())
+        {
+            auto const name = ledgerEntryTypeName(item.getType());
+            BEAST_EXPECT(!name || *name == item.getName());
+        }
+
+        BEAST_EXPECT(!txTypeByName("payment"));
+        BEAST_EXPECT(!ledgerEntryTypeByName(""));
+    }
+
+    void
+    testResults()
+    {
+        testcase("Results");
+
+        using namespace ripple;
+
+        for (auto const name : knownResultNames())
+        {
+            auto const ter = transCode(std::string(name));
+            auto const code = resultByName(name);
+            BEAST_EXPECTS(
+                ter && code && *code == TERtoInt(*ter) &&
+                    resultName(*code) == name,
+                std::string(name));
+        }
+        for (int code = 0; code < 256; ++code)
+        {
+            if (auto const name = resultName(code))
+                BEAST_EXPECT(*name == transToken(TER::fromInt(code)));
+        }
+        BEAST_EXPECT(!resultByName("tefPAST_SEQ"));
+        BEAST_EXPECT(!resultName(-1));
+    }
+
+    void
+    testMakeObject()
+    {
+        testcase("Make object");
+
+        for (auto const* known : {&getKnownTxSigned(), &getKnownMetadata()})
+        {
+            BEAST_EXPECT(
+                serialize(*makeObject(parseJson(known->JsonText))) ==
+                known->SerializedText);
+        }
+
+        // Names the tables don't have are left to the library
+        auto json = parseJson(getKnownTxSigned().JsonText);
+        json["TransactionType"] = "NotATransaction";
+        except<std::runtime_error>([&] { makeObject(std::move(json)); });
+    }
+
+public:
+    void
+    run() override
+    {
+        testPerfectHash();
+        testFields();
+        testTypes();
+        testResults();
+        testMakeObject();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ProtocolTables, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <Recover.h>
+#include <Serialize.h>
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/Seed.h>
+#include <ripple/protocol/jss.h>
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+namespace offline {
+
+namespace test {
+
+class Recover_test : public beast::unit_test::suite
+{
+private:
+    ripple::Seed const seed_ = ripple::generateSeed("masterpassphrase");
+
+    RecoverOptions
+    options(ripple::KeyType keyType) const
+    {
+        RecoverOptions options;
+        options.account = ripple::calcAccountID(
+            ripple::generateKeyPair(keyType, seed_).first);
+        options.keyType = keyType;
+        options.progressInterval = std::chrono::milliseconds(0);
+        return options;
+    }
+
+    void
+    expectRecovered(std::string const& partial, RecoverOptions const& options)
+    {
+        using namespace ripple;
+
+        std::stringstream out;
+        std::stringstream err;
+        BEAST_EXPECT(
+            runRecover(partial, out, err, options) == EXIT_SUCCESS);
+        auto const jv = parseJson(out.str());
+        BEAST_EXPECT(
+            jv[jss::master_seed].asString() ==
+            "snoPBrXtMeMyMHUVTgbuqAfg1SUTb");
+        BEAST_EXPECT(jv[jss::master_key].asString() == seedAs1751(seed_));
+        BEAST_EXPECT(
+            jv[jss::key_type].asString() == to_string(options.keyType));
+        BEAST_EXPECT(
+            jv[jss::account_id].asString() == toBase58(options.account));
+        BEAST_EXPECT(err.str().find("Checked ") != std::string::npos);
+    }
+
+    void
+    testBase58()
+    {
+        testcase("Base58");
+
+        auto opts = options(ripple::KeyType::secp256k1);
+        expectRecovered("snoPBrXtMeMyMHUVTgbuqAfg1SUTb", opts);
+        // The first character is always s
+        expectRecovered("?noPBrXtMeMyMHUVTgbuqAfg1SUTb", opts);
+        for (unsigned threads : {1, 4})
+        {
+            opts.threads = threads;
+            expectRecovered("snoPB?XtMeMyMHUVTgbuqAf?1SUTb", opts);
+        }
+        expectRecovered(
+            "snoPBrXtMeMyMHUV?gbuqAfg1SUTb",
+            options(ripple::KeyType::ed25519));
+    }
+
+    void
+    testWords()
+    {
+        testcase("Words");
+
+        std::vector<std::string> words;
+        std::istringstream ss(ripple::seedAs1751(seed_));
+        for (std::string word; ss >> word;)
+            words.push_back(word);
+        BEAST_EXPECT(words.size() == 12);
+        auto const join = [](std::vector<std::string> const& words) {
+            std::string joined;
+            for (auto const& word : words)
+                joined += (joined.empty() ? "" : " ") + word;
+            return joined;
+        };
+
+        // An unknown word, and a lower case one
+        auto partial = words;
+        partial[2] = "?";
+        for (auto& c : partial[0])
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        expectRecovered(join(partial), options(ripple::KeyType::secp256k1));
+
+        partial = words;
+        partial[10] = "?";
+        expectRecovered(join(partial), options(ripple::KeyType::ed25519));
+        expectRecovered(join(words), options(ripple::KeyType::ed25519));
+    }
+
+    void
+    testNoMatch()
+    {
+        testcase("No match");
+
+        // The account of the other key type
+        auto opts = options(ripple::KeyType::ed25519);
+        opts.keyType = ripple::KeyType::secp256k1;
+        std::stringstream out;
+        std::stringstream err;
+        BEAST_EXPECT(
+            runRecover("snoPBrXtMeMyMHUVTgbuqAfg1SU?b", out, err, opts) ==
+            EXIT_FAILURE);
+        BEAST_EXPECT(out.str().empty());
+        BEAST_EXPECT(err.str().find("No seed matches") != std::string::npos);
+    }
+
+    void
+    testInvalid()
+    {
+        testcase("Invalid");
+
+        auto const words = ripple::seedAs1751(seed_);
+        auto const opts = options(ripple::KeyType::secp256k1);
+        for (std::string const bad :
+             {"snoPBrXtMeMyMHUVTgbuqAfg1SUT",
+              "snoPBrXtMeMyMHUVTgbuqAfg1SUTbb",
+              "snoPBrXtMeMyMHUVTgbuqAfg1SU0b",
+              "snoPBrXtMeMyMHUVTgbuqAfg1SU*b",
+              // More candidates than can be counted
+              "???????????yMHUVTgbuqAfg1SUTb",
+              "? ? ? ? ? ? ? ? ? ? ? ?",
+              "A B C D E F G H I J K",
+              words + " A",
+              "XYZZY" + words.substr(words.find(' '))})
+        {
+            std::stringstream out;
+            std::stringstream err;
+            except<std::runtime_error>(
+                [&] { runRecover(bad, out, err, opts); });
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testBase58();
+        testWords();
+        testNoMatch();
+        testInvalid();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Recover, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
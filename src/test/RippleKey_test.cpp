@@ -29,6 +29,7 @@
 #include <ripple/beast/unit_test.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/protocol/jss.h>
+#include <tuple>
 
 namespace offline {
 
@@ -363,6 +364,62 @@ private:
         }
     }
 
+    void
+    testFamily()
+    {
+        testcase("Family");
+
+        using namespace ripple;
+        using namespace boost::filesystem;
+
+        auto const seed = generateSeed(passphrase);
+        FamilyGenerator const family(seed);
+
+        // Ordinal 0 is the master key
+        auto const master = family(0);
+        auto const expected = generateKeyPair(KeyType::secp256k1, seed);
+        BEAST_EXPECT(master.first == expected.first);
+        BEAST_EXPECT(master.second == expected.second);
+
+        for (auto const& [ordinal, account, publicKey] :
+             {std::make_tuple(
+                  1u,
+                  "r4bYF7SLUMD7QgSLLpgJx38WJSY12ViRjP",
+                  "02CD8C4CE87F86AAD1D9D18B03DE28E6E756F040BD72A9C127862833"
+                  "EB90D60BAD"),
+              std::make_tuple(
+                  2u,
+                  "rLpAd4peHUMBPbVJASMYK5GTBUSwXRD9nx",
+                  "0259A57642A6F4AEFC9B8062AF453FDEEEAC5572BA602BB1DBD5EF01"
+                  "1394C6F9FC")})
+        {
+            auto const keys = family(ordinal);
+            BEAST_EXPECT(toBase58(calcAccountID(keys.first)) == account);
+            BEAST_EXPECT(strHex(keys.first) == publicKey);
+            BEAST_EXPECT(
+                derivePublicKey(KeyType::secp256k1, keys.second) ==
+                keys.first);
+        }
+
+        // The ordinal is kept in the key file
+        std::string const subdir = "test_family_key_file";
+        KeyFileGuard g(*this, subdir);
+        path const keyFile = subdir / "family-key.txt";
+        auto const key = RippleKey::make_RippleKey(family, 2);
+        key.writeToFile(keyFile);
+        auto const key2 = RippleKey::make_RippleKey(keyFile);
+        BEAST_EXPECT(key2.accountIndex() == 2);
+        BEAST_EXPECT(key2.publicKey() == family(2).first);
+
+        {
+            std::ofstream o(keyFile.string(), std::ios_base::trunc);
+            o << R"({ "key_type": "ed25519", "master_seed": )"
+              << R"("masterpassphrase", "account_index": 1 })";
+        }
+        except<std::runtime_error>(
+            [&] { RippleKey::make_RippleKey(keyFile); });
+    }
+
     void
     testFaults()
     {
@@ -413,6 +470,7 @@ public:
             testSign(kt);
         }
 
+        testFamily();
         testFaults();
     }
 };
@@ -25,6 +25,7 @@
 #include <Serialize.h>
 
 #include <ripple/basics/base64.h>
+#include <ripple/basics/strHex.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/Sign.h>
@@ -288,6 +289,34 @@ private:
         }
     }
 
+    void
+    testUnhexScratch()
+    {
+        testcase("Unhex scratch");
+
+        using namespace ripple;
+
+        auto const& known = getKnownTxSigned().SerializedText;
+        auto const tx = unhexScratch(known);
+        if (BEAST_EXPECT(tx))
+            BEAST_EXPECT(strHex(*tx) == known);
+
+        // The buffer is reused
+        auto const data = tx->data();
+        auto const odd = unhexScratch("ABC");
+        if (BEAST_EXPECT(odd))
+        {
+            BEAST_EXPECT(odd->data() == data);
+            BEAST_EXPECT(strHex(*odd) == "0ABC");
+        }
+
+        auto const empty = unhexScratch("");
+        BEAST_EXPECT(empty && empty->empty());
+        BEAST_EXPECT(!unhexScratch("ABCG"));
+        BEAST_EXPECT(!unhexScratch("G12"));
+        BEAST_EXPECT(!unhexScratch("{}"));
+    }
+
 public:
     void
     run() override
@@ -298,6 +327,7 @@ public:
         testDeserialize();
         testMakeSttx();
         testBad();
+        testUnhexScratch();
     }
 };
 
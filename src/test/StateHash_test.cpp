@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <Serialize.h>
+#include <StateHash.h>
+#include <TreeHash.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/protocol/digest.h>
+#include <boost/filesystem.hpp>
+#include <sstream>
+
+namespace offline {
+
+namespace test {
+
+class StateHash_test : public beast::unit_test::suite
+{
+private:
+    struct Dump
+    {
+        std::string text;
+        ripple::uint256 root;
+    };
+
+    // `count` entries in pages of 100, one page per line. The first page
+    // has a header if `accountHash` is set.
+    static Dump
+    makeDump(
+        std::uint64_t count,
+        std::optional<ripple::uint256> const& accountHash = std::nullopt)
+    {
+        using namespace ripple;
+
+        std::vector<TreeLeaf> leaves;
+        std::ostringstream ss;
+        Json::Value page;
+        auto const endPage = [&] {
+            ss << Json::Compact{std::move(page)} << "\n\n";
+            page = Json::Value{};
+        };
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            if (i == 0 && accountHash)
+            {
+                LedgerHeader header;
+                header.seq = 5;
+                header.accountHash = *accountHash;
+                page["result"]["ledger"]["ledger_data"] =
+                    strHex(header.serialize());
+            }
+            auto const key = sha512Half(i);
+            Blob const data(1 + i % 97, static_cast<std::uint8_t>(i));
+            Json::Value entry(Json::objectValue);
+            entry["index"] = to_string(key);
+            entry["data"] = strHex(data);
+            page["result"]["state"].append(entry);
+            leaves.push_back({key, stateLeafHash(makeSlice(data), key)});
+            if (i % 100 == 99)
+                endPage();
+        }
+        if (!page.isNull())
+            endPage();
+        return {ss.str(), treeRoot(std::move(leaves), 1)};
+    }
+
+    void
+    testInMemory()
+    {
+        testcase("In memory");
+
+        auto const dump = makeDump(1234);
+        std::istringstream in(dump.text);
+        StateHashOptions options;
+        options.threads = 4;
+        auto const result = hashState(in, options);
+        BEAST_EXPECT(result.root == dump.root);
+        BEAST_EXPECT(result.entries == 1234);
+        BEAST_EXPECT(result.runs == 0);
+        BEAST_EXPECT(!result.header);
+    }
+
+    void
+    testSpilled()
+    {
+        testcase("Spilled");
+
+        using namespace boost::filesystem;
+
+        auto const dir = temp_directory_path() / unique_path();
+        create_directories(dir);
+
+        auto const dump = makeDump(5000);
+        for (unsigned threads : {1u, 4u})
+        {
+            std::istringstream in(dump.text);
+            StateHashOptions options;
+            options.memoryBudget = 32 * 1024;
+            options.threads = threads;
+            options.tempDir = dir.string();
+            auto const result = hashState(in, options);
+            BEAST_EXPECT(result.root == dump.root);
+            BEAST_EXPECT(result.entries == 5000);
+            BEAST_EXPECT(result.runs > 10);
+        }
+        // The runs are removed
+        BEAST_EXPECT(is_empty(dir));
+        remove_all(dir);
+    }
+
+    void
+    testVerify()
+    {
+        testcase("Verify");
+
+        auto const root = makeDump(700).root;
+        {
+            std::istringstream in(makeDump(700, root).text);
+            std::ostringstream out;
+            BEAST_EXPECT(runVerifyState(in, out, {}) == EXIT_SUCCESS);
+            auto const jv = parseJson(out.str());
+            BEAST_EXPECT(jv["verified"].asBool());
+            BEAST_EXPECT(jv["entries"].asUInt() == 700);
+            BEAST_EXPECT(jv["ledger_index"].asUInt() == 5);
+            BEAST_EXPECT(
+                jv["account_hash"].asString() == ripple::to_string(root));
+        }
+        {
+            std::istringstream in(makeDump(700, ~root).text);
+            std::ostringstream out;
+            BEAST_EXPECT(runVerifyState(in, out, {}) == EXIT_FAILURE);
+            BEAST_EXPECT(!parseJson(out.str())["verified"].asBool());
+        }
+
+        // The same entry twice
+        {
+            auto const text = makeDump(150).text;
+            auto const secondPage = text.substr(text.find("\n\n") + 2);
+            std::istringstream in(text + secondPage);
+            except<std::runtime_error>([&] { hashState(in, {}); });
+        }
+        {
+            std::istringstream in("{\"result\":{\"state\":[\n");
+            except<std::runtime_error>([&] { hashState(in, {}); });
+        }
+    }
+
+    void
+    testKnownAnswer()
+    {
+        testcase("Known answer");
+
+        using namespace ripple;
+
+        // Computed independently of rippled and of this tool, with the
+        // SHAMap prefixes "MLN" and "MIN". The state holds the known
+        // signed transaction and the known metadata, keyed by the IDs of
+        // the known signed and unsigned transactions.
+        std::string const header =
+            "01B7A4FA01633D5EF6D40DF9FC8CB8BFE0BEE91BCC39BBB31827230BEDF273C3"
+            "00EC2F6DB212A31CA9CE7E9477CA592FF26101F98C13876E2A526470824B1CEF"
+            "630E68544C8A29BF1113660D51FF5D4B550EE8660FBBAE6FB991525F2397EFC3"
+            "93F67793C12560665FAA2413206D741C206D741D0A00";
+        std::string const signedKey =
+            "F2D008D2AABBABD2A882F9049AA873210908EC3EA1EB0A2044A66093C7ACD2B1";
+        std::string const unsignedKey =
+            "5E9A6C55F74E7EBD9AEB54978A141E077791F9879AFCCA6EA216434B6831BDEB";
+        uint256 key;
+        BEAST_EXPECT(key.parseHex(signedKey));
+        auto const data = *strUnHex(getKnownTxSigned().SerializedText);
+        BEAST_EXPECT(
+            to_string(stateLeafHash(makeSlice(data), key)) ==
+            "51D8EF8CA59747BC30B12B9A0C691531CD95FDD9265AA06C4C1171532BB6A91E");
+
+        Json::Value page;
+        page["result"]["ledger"]["ledger_data"] = header;
+        Json::Value entry(Json::objectValue);
+        entry["index"] = unsignedKey;
+        entry["data"] = getKnownMetadata().SerializedText;
+        page["result"]["state"].append(entry);
+        entry["index"] = signedKey;
+        entry["data"] = getKnownTxSigned().SerializedText;
+        page["result"]["state"].append(entry);
+
+        std::istringstream in(toCompactJson(std::move(page)) + "\n");
+        std::ostringstream out;
+        BEAST_EXPECT(runVerifyState(in, out, {}) == EXIT_SUCCESS);
+        auto const jv = parseJson(out.str());
+        BEAST_EXPECT(jv["verified"].asBool());
+        BEAST_EXPECT(jv["entries"].asUInt() == 2);
+        BEAST_EXPECT(jv["ledger_index"].asUInt() == 28812538);
+        BEAST_EXPECT(
+            jv["account_hash"].asString() ==
+            "51FF5D4B550EE8660FBBAE6FB991525F2397EFC393F67793C12560665FAA2413");
+    }
+
+public:
+    void
+    run() override
+    {
+        testInMemory();
+        testSpilled();
+        testVerify();
+        testKnownAnswer();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StateHash, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
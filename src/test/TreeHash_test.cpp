@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <test/KnownTestData.h>
+
+#include <Serialize.h>
+#include <TreeHash.h>
+
+#include <ripple/basics/strHex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/digest.h>
+#include <random>
+
+namespace offline {
+
+namespace test {
+
+class TreeHash_test : public beast::unit_test::suite
+{
+private:
+    static ripple::uint256
+    makeKey(std::string const& hexPrefix, std::uint64_t n)
+    {
+        auto key = ripple::sha512Half(n);
+        auto const prefix = *ripple::strUnHex(hexPrefix);
+        std::copy(prefix.begin(), prefix.end(), key.begin());
+        return key;
+    }
+
+    static TreeLeaf
+    makeLeaf(ripple::uint256 const& key)
+    {
+        return {key, ripple::sha512Half(key)};
+    }
+
+    void
+    testTransactionID()
+    {
+        testcase("Transaction ID");
+
+        using namespace ripple;
+
+        auto const& known = getKnownTxSigned();
+        auto const blob = *strUnHex(known.SerializedText);
+        BEAST_EXPECT(
+            to_string(transactionID(makeSlice(blob))) ==
+            parseJson(known.JsonText)["hash"].asString());
+    }
+
+    void
+    testLeaves()
+    {
+        testcase("Leaves");
+
+        using namespace ripple;
+
+        std::vector<std::pair<Blob, Blob>> txs;
+        std::vector<std::pair<uint256, Blob>> entries;
+        for (std::size_t i = 0; i < 150; ++i)
+        {
+            Blob a(i * 3 % 400, static_cast<std::uint8_t>(i));
+            Blob b(i * 7 % 500, static_cast<std::uint8_t>(~i));
+            txs.emplace_back(a, b);
+            entries.emplace_back(sha512Half(i), a);
+        }
+
+        auto const leaves = transactionLeaves(txs, 3);
+        if (BEAST_EXPECT(leaves.size() == txs.size()))
+        {
+            for (std::size_t i = 0; i < txs.size(); ++i)
+            {
+                auto const tx = makeSlice(txs[i].first);
+                auto const id = transactionID(tx);
+                BEAST_EXPECT(leaves[i].key == id);
+                BEAST_EXPECT(
+                    leaves[i].hash ==
+                    transactionLeafHash(tx, makeSlice(txs[i].second), id));
+            }
+        }
+        BEAST_EXPECT(transactionLeaves({}, 3).empty());
+
+        std::vector<TreeLeaf> state(entries.size());
+        stateLeaves(entries, state.data(), 3);
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            auto const& [key, data] = entries[i];
+            BEAST_EXPECT(state[i].key == key);
+            BEAST_EXPECT(state[i].hash == stateLeafHash(makeSlice(data), key));
+        }
+    }
+
+    void
+    testShape()
+    {
+        testcase("Shape");
+
+        using namespace ripple;
+
+        BEAST_EXPECT(treeRoot({}, 1) == uint256{});
+
+        // The root is an inner node, even over one leaf
+        auto const a = makeLeaf(makeKey("A0", 1));
+        {
+            std::array<uint256, 16> root{};
+            root[0xA] = a.hash;
+            BEAST_EXPECT(treeRoot({a}, 1) == innerNodeHash(root));
+        }
+
+        // Leaves in different branches hang from the root
+        auto const b = makeLeaf(makeKey("B0", 2));
+        {
+            std::array<uint256, 16> root{};
+            root[0xA] = a.hash;
+            root[0xB] = b.hash;
+            BEAST_EXPECT(treeRoot({b, a}, 1) == innerNodeHash(root));
+        }
+
+        // Leaves that share three nibbles are below three inner nodes
+        auto const c1 = makeLeaf(makeKey("C3A1", 3));
+        auto const c2 = makeLeaf(makeKey("C3A2", 4));
+        {
+            std::array<uint256, 16> depth3{};
+            depth3[1] = c1.hash;
+            depth3[2] = c2.hash;
+            std::array<uint256, 16> depth2{};
+            depth2[0xA] = innerNodeHash(depth3);
+            std::array<uint256, 16> depth1{};
+            depth1[3] = innerNodeHash(depth2);
+            std::array<uint256, 16> root{};
+            root[0xA] = a.hash;
+            root[0xC] = innerNodeHash(depth1);
+            BEAST_EXPECT(treeRoot({c2, a, c1}, 1) == innerNodeHash(root));
+        }
+
+        except<std::runtime_error>([&] { treeRoot({a, b, a}, 1); });
+    }
+
+    void
+    testParallel()
+    {
+        testcase("Parallel");
+
+        std::vector<TreeLeaf> leaves;
+        for (std::uint64_t i = 0; i < 5000; ++i)
+            leaves.push_back(makeLeaf(makeKey(i % 7 ? "" : "5A5A", i)));
+
+        auto const expected = treeRoot(leaves, 1);
+        std::shuffle(leaves.begin(), leaves.end(), std::mt19937{42});
+        BEAST_EXPECT(treeRoot(leaves, 8) == expected);
+        leaves.pop_back();
+        BEAST_EXPECT(treeRoot(leaves, 8) != expected);
+    }
+
+    void
+    testBuilder()
+    {
+        testcase("Builder");
+
+        std::vector<TreeLeaf> leaves;
+        for (std::uint64_t i = 0; i < 3000; ++i)
+            leaves.push_back(makeLeaf(makeKey(i % 5 ? "" : "E1E1E1", i)));
+        std::sort(leaves.begin(), leaves.end(), [](auto& a, auto& b) {
+            return a.key < b.key;
+        });
+
+        TreeRootBuilder builder;
+        BEAST_EXPECT(builder.finish() == ripple::uint256{});
+        for (std::size_t n : {std::size_t{1}, std::size_t{2}, leaves.size()})
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                builder.add(leaves[i]);
+            BEAST_EXPECT(builder.size() == n);
+            BEAST_EXPECT(
+                builder.finish() ==
+                treeRoot({leaves.begin(), leaves.begin() + n}, 1));
+        }
+
+        builder.add(leaves[1]);
+        except<std::runtime_error>([&] { builder.add(leaves[0]); });
+        except<std::runtime_error>([&] { builder.add(leaves[1]); });
+    }
+
+    void
+    testKnownAnswers()
+    {
+        testcase("Known answers");
+
+        using namespace ripple;
+
+        // Computed independently of rippled and of this tool, from the
+        // known transactions and metadata, with the SHAMap prefixes "SND"
+        // and "MIN".
+        auto const signedTx = *strUnHex(getKnownTxSigned().SerializedText);
+        auto const unsignedTx =
+            *strUnHex(getKnownTxUnsigned().SerializedText);
+        auto const meta = *strUnHex(getKnownMetadata().SerializedText);
+        // The metadata is long enough for a two byte length
+        BEAST_EXPECT(meta.size() == 998);
+
+        auto const txs = transactionLeaves(
+            {{signedTx, meta}, {unsignedTx, meta}}, 2);
+        if (!BEAST_EXPECT(txs.size() == 2))
+            return;
+        BEAST_EXPECT(
+            to_string(txs[0].key) ==
+            "F2D008D2AABBABD2A882F9049AA873210908EC3EA1EB0A2044A66093C7ACD2B1");
+        BEAST_EXPECT(
+            to_string(txs[0].hash) ==
+            "CB7A17394215244D4EF5C5A75BBC96DD0ED3BF4ADC35EE02E404A622622C53AB");
+        BEAST_EXPECT(
+            to_string(txs[1].key) ==
+            "5E9A6C55F74E7EBD9AEB54978A141E077791F9879AFCCA6EA216434B6831BDEB");
+        BEAST_EXPECT(
+            to_string(treeRoot({txs[0]}, 1)) ==
+            "AAB1AAB378488E390C4E3D7BB3A232643576188262C56A958F1488F3049A289C");
+        BEAST_EXPECT(
+            to_string(treeRoot(txs, 1)) ==
+            "77CA592FF26101F98C13876E2A526470824B1CEF630E68544C8A29BF1113660D");
+
+    }
+
+public:
+    void
+    run() override
+    {
+        testTransactionID();
+        testLeaves();
+        testShape();
+        testParallel();
+        testBuilder();
+        testKnownAnswers();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TreeHash, keys, serialize);
+
+}  // namespace test
+
+}  // namespace offline
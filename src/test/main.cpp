@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of ripple-offline-tool:
+        https://github.com/ximinez/ripple-offline-tool
+    Copyright (c) 2017 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <ripple/beast/unit_test.h>
+#include <beast/unit_test/dstream.hpp>
+#include <cstdlib>
+#include <iostream>
+
+/*  Runs every unit test suite, or those matching the first argument.
+    The match follows the same rules as rippled's --unittest option, e.g.
+    "Serialize" for a suite name, or "serialize" for a library name.
+*/
+int
+main(int argc, char** argv)
+{
+    using namespace beast::unit_test;
+    beast::unit_test::dstream dout{std::cout};
+    reporter r{dout};
+    bool const anyFailed = argc > 1
+        ? r.run_each_if(global_suites(), match_auto(argv[1]))
+        : r.run_each(global_suites());
+    if (anyFailed)
+        return EXIT_FAILURE;  // LCOV_EXCL_LINE
+    return EXIT_SUCCESS;
+}